@@ -0,0 +1,92 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Cache-blocked Level 3 kernels for the internal CBLAS
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The reference routines ?gemm_ and ?trsm_ hand off to these kernels
+ * once the problem is larger than the thresholds below.  GEMM packs
+ * op(A) and op(B) into contiguous slivers and runs a register-blocked
+ * micro-kernel, selected at run time for the host CPU; TRSM recurses
+ * on the triangular dimension and performs the off-diagonal updates
+ * with GEMM.  The M-loop of GEMM is threaded with OpenMP when called
+ * outside a parallel region.
+ * </pre>
+ */
+#ifndef __SUPERLU_BLAS_BLOCKED /* allow multiple inclusions */
+#define __SUPERLU_BLAS_BLOCKED
+
+#include <stdio.h>
+#include <stddef.h>
+#include "f2c.h"
+
+/* The packing buffers come from the allocator of the SuperLU_DIST library
+   this BLAS is linked with, and a failed allocation is fatal, as with
+   SUPERLU_MALLOC and ABORT in util_dist.h. */
+extern void *superlu_malloc_dist(size_t);
+extern void  superlu_free_dist(void *);
+extern void  superlu_abort_and_exit_dist(char *);
+#ifndef SUPERLU_MALLOC
+#define SUPERLU_MALLOC(size) superlu_malloc_dist(size)
+#define SUPERLU_FREE(addr)   superlu_free_dist(addr)
+#endif
+#ifndef ABORT
+#define ABORT(err_msg) \
+ { char msg[256];\
+   sprintf(msg,"%s at line %d in file %s\n",err_msg,__LINE__, __FILE__);\
+   superlu_abort_and_exit_dist(msg); }
+#endif
+
+/* GEMMs with m*n*k below this use the reference triple loop. */
+#define BLAS_GEMM_MIN_MNK  4096
+/* TRSMs whose triangular dimension is at most this use the reference loop. */
+#define BLAS_TRSM_NB       64
+
+/* Reference entry points, used for the recursion. */
+extern int sgemm_(char *, char *, integer *, integer *, integer *, real *,
+		  real *, integer *, real *, integer *, real *, real *, integer *);
+extern int strsm_(char *, char *, char *, char *, integer *, integer *,
+		  real *, real *, integer *, real *, integer *);
+extern int dgemm_(char *, char *, integer *, integer *, integer *,
+		  doublereal *, doublereal *, integer *, doublereal *,
+		  integer *, doublereal *, doublereal *, integer *);
+extern int dtrsm_(char *, char *, char *, char *, integer *, integer *,
+		  doublereal *, doublereal *, integer *, doublereal *, integer *);
+extern int zgemm_(char *, char *, integer *, integer *, integer *,
+		  doublecomplex *, doublecomplex *, integer *, doublecomplex *,
+		  integer *, doublecomplex *, doublecomplex *, integer *);
+extern int ztrsm_(char *, char *, char *, char *, integer *, integer *,
+		  doublecomplex *, doublecomplex *, integer *,
+		  doublecomplex *, integer *);
+
+extern void sgemm_blocked(char *, char *, integer, integer, integer, real,
+			  real *, integer, real *, integer, real,
+			  real *, integer);
+extern void strsm_blocked(char *, char *, char *, char *, integer, integer,
+			  real, real *, integer, real *, integer);
+extern void dgemm_blocked(char *, char *, integer, integer, integer,
+			  doublereal, doublereal *, integer, doublereal *,
+			  integer, doublereal, doublereal *, integer);
+extern void dtrsm_blocked(char *, char *, char *, char *, integer, integer,
+			  doublereal, doublereal *, integer, doublereal *,
+			  integer);
+extern void zgemm_blocked(char *, char *, integer, integer, integer,
+			  doublecomplex, doublecomplex *, integer,
+			  doublecomplex *, integer, doublecomplex,
+			  doublecomplex *, integer);
+extern void ztrsm_blocked(char *, char *, char *, char *, integer, integer,
+			  doublecomplex, doublecomplex *, integer,
+			  doublecomplex *, integer);
+
+#endif /* __SUPERLU_BLAS_BLOCKED */
@@ -5,6 +5,7 @@
 */
 #include <string.h>
 #include "f2c.h"
+#include "blas_blocked.h"
 
 /* Subroutine */ int dgemm_(char *transa, char *transb, integer *m, integer *n,
 			    integer *k, doublereal *alpha, doublereal *a, integer *lda, 
@@ -18,11 +19,11 @@
 	    i__3;
 
     /* Local variables */
-    static integer info;
-    static logical nota, notb;
-    static doublereal temp;
-    static integer i, j, l, ncola;
-    static integer nrowa, nrowb;
+    integer info;
+    logical nota, notb;
+    doublereal temp;
+    integer i, j, l, ncola;
+    integer nrowa, nrowb;
     extern /* Subroutine */ int input_error_dist(char *, integer *);
 
 
@@ -265,6 +266,14 @@
 	return 0;
     }
 
+/*     Use the cache-blocked kernel for all but small products. */
+
+    if ((doublereal) *m * *n * *k >= BLAS_GEMM_MIN_MNK) {
+	dgemm_blocked(transa, transb, *m, *n, *k, *alpha, a, *lda, b, *ldb,
+		      *beta, c, *ldc);
+	return 0;
+    }
+
 /*     Start the operations. */
 
     if (notb) {
@@ -0,0 +1,265 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Cache-blocked DGEMM and recursive DTRSM for the internal CBLAS
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Loop order follows the usual packed-GEMM scheme:
+ *   jc (NC columns of C) -> pc (KC-deep panel, pack op(B))
+ *     -> ic (MC rows, pack op(A), threaded) -> jr -> ir (micro-kernel).
+ * </pre>
+ */
+#include <stdlib.h>
+#include "f2c.h"
+#include "blas_blocked.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define DMR  8     /* micro-tile rows    */
+#define DNR  4     /* micro-tile columns */
+#define DMC  128   /* rows of packed A, multiple of DMR    */
+#define DKC  256   /* depth of packed panels               */
+#define DNC  2048  /* columns of packed B, multiple of DNR */
+
+typedef void (*dgemm_micro_t)(integer, const doublereal *, const doublereal *,
+			      doublereal *, integer, integer, integer,
+			      doublereal);
+
+/*
+ * C(0:mr,0:nr) += alpha * Ap * Bp, where Ap is a DMR x kc sliver and
+ * Bp a kc x DNR sliver, both zero padded.  The accumulator tile lives
+ * in registers; the i-loop is the vectorized one.
+ */
+#define DGEMM_MICRO_BODY                                                \
+{                                                                       \
+    doublereal ab[DNR][DMR];                                            \
+    integer i, j, p;                                                    \
+    for (j = 0; j < DNR; ++j)                                           \
+	for (i = 0; i < DMR; ++i) ab[j][i] = 0.;                        \
+    for (p = 0; p < kc; ++p) {                                          \
+	for (j = 0; j < DNR; ++j) {                                     \
+	    doublereal bj = bp[j];                                      \
+	    for (i = 0; i < DMR; ++i) ab[j][i] += ap[i] * bj;           \
+	}                                                               \
+	ap += DMR;                                                      \
+	bp += DNR;                                                      \
+    }                                                                   \
+    for (j = 0; j < nr; ++j)                                            \
+	for (i = 0; i < mr; ++i) c[i + j*ldc] += alpha * ab[j][i];      \
+}
+
+static void
+dgemm_micro_generic(integer kc, const doublereal *ap, const doublereal *bp,
+		    doublereal *c, integer ldc, integer mr, integer nr,
+		    doublereal alpha)
+DGEMM_MICRO_BODY
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BLAS_X86_DISPATCH
+__attribute__((target("avx2,fma"))) static void
+dgemm_micro_avx2(integer kc, const doublereal *ap, const doublereal *bp,
+		 doublereal *c, integer ldc, integer mr, integer nr,
+		 doublereal alpha)
+DGEMM_MICRO_BODY
+
+__attribute__((target("avx512f"))) static void
+dgemm_micro_avx512(integer kc, const doublereal *ap, const doublereal *bp,
+		   doublereal *c, integer ldc, integer mr, integer nr,
+		   doublereal alpha)
+DGEMM_MICRO_BODY
+#endif
+
+/*! \brief Pick the widest micro-kernel the running CPU supports. */
+static dgemm_micro_t
+dgemm_select_micro(void)
+{
+#ifdef BLAS_X86_DISPATCH
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx512f") ) return dgemm_micro_avx512;
+    if ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") )
+	return dgemm_micro_avx2;
+#endif
+    return dgemm_micro_generic;
+}
+
+/*! \brief Pack the mc x kc block of op(A) at a into DMR-row slivers. */
+static void
+dpack_a(int trans, integer mc, integer kc, const doublereal *a, integer lda,
+	doublereal *ap)
+{
+    integer i, ir, p, mr;
+    for (ir = 0; ir < mc; ir += DMR) {
+	mr = min(DMR, mc - ir);
+	for (p = 0; p < kc; ++p) {
+	    if ( trans ) {
+		for (i = 0; i < mr; ++i) ap[i] = a[p + (ir+i)*lda];
+	    } else {
+		for (i = 0; i < mr; ++i) ap[i] = a[ir+i + p*lda];
+	    }
+	    for (; i < DMR; ++i) ap[i] = 0.;
+	    ap += DMR;
+	}
+    }
+}
+
+/*! \brief Pack the kc x nc block of op(B) at b into DNR-column slivers. */
+static void
+dpack_b(int trans, integer kc, integer nc, const doublereal *b, integer ldb,
+	doublereal *bp)
+{
+    integer j, jr, p, nr;
+    for (jr = 0; jr < nc; jr += DNR) {
+	nr = min(DNR, nc - jr);
+	for (p = 0; p < kc; ++p) {
+	    if ( trans ) {
+		for (j = 0; j < nr; ++j) bp[j] = b[jr+j + p*ldb];
+	    } else {
+		for (j = 0; j < nr; ++j) bp[j] = b[p + (jr+j)*ldb];
+	    }
+	    for (; j < DNR; ++j) bp[j] = 0.;
+	    bp += DNR;
+	}
+    }
+}
+
+/*! \brief C := alpha*op(A)*op(B) + beta*C; arguments already checked. */
+void
+dgemm_blocked(char *transa, char *transb, integer m, integer n, integer k,
+	      doublereal alpha, doublereal *a, integer lda, doublereal *b,
+	      integer ldb, doublereal beta, doublereal *c, integer ldc)
+{
+    int ta = (*transa != 'N' && *transa != 'n');
+    int tb = (*transb != 'N' && *transb != 'n');
+    integer i, j, jc, pc, nc, kc, nblk_m;
+    doublereal *bp, *ap;
+    integer nthr = 1, lap;
+    dgemm_micro_t micro = dgemm_select_micro();
+
+    if ( beta != 1. ) {
+	for (j = 0; j < n; ++j)
+	    for (i = 0; i < m; ++i)
+		c[i + j*ldc] = (beta == 0.) ? 0. : beta * c[i + j*ldc];
+    }
+    if ( alpha == 0. || k == 0 ) return;
+
+    nblk_m = (m + DMC - 1) / DMC;
+#ifdef _OPENMP
+    if ( nblk_m > 1 && !omp_in_parallel() ) nthr = omp_get_max_threads();
+#endif
+    /* One packed op(B) panel, and one packed op(A) block per thread. */
+    lap = DMC * min(k, DKC);
+    if ( !(bp = (doublereal *) SUPERLU_MALLOC(sizeof(doublereal) * min(k, DKC)
+			       * ((min(n, DNC) + DNR - 1) / DNR * DNR))) )
+	ABORT("Malloc fails for bp[].");
+    if ( !(ap = (doublereal *) SUPERLU_MALLOC(sizeof(doublereal) * lap * nthr)) )
+	ABORT("Malloc fails for ap[].");
+
+    for (jc = 0; jc < n; jc += DNC) {
+	nc = min(DNC, n - jc);
+	for (pc = 0; pc < k; pc += DKC) {
+	    kc = min(DKC, k - pc);
+	    dpack_b(tb, kc, nc, tb ? &b[jc + pc*ldb] : &b[pc + jc*ldb], ldb, bp);
+
+#ifdef _OPENMP
+#pragma omp parallel if (nblk_m > 1 && !omp_in_parallel())
+#endif
+	    {
+		integer ib, ic, mc, ir, jr;
+#ifdef _OPENMP
+		doublereal *apt = &ap[lap * omp_get_thread_num()];
+#else
+		doublereal *apt = ap;
+#endif
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+		for (ib = 0; ib < nblk_m; ++ib) {
+		    ic = ib * DMC;
+		    mc = min(DMC, m - ic);
+		    dpack_a(ta, mc, kc, ta ? &a[pc + ic*lda] : &a[ic + pc*lda],
+			    lda, apt);
+		    for (jr = 0; jr < nc; jr += DNR)
+			for (ir = 0; ir < mc; ir += DMR)
+			    micro(kc, &apt[ir*kc], &bp[jr*kc],
+				  &c[ic+ir + (jc+jr)*ldc], ldc,
+				  min(DMR, mc - ir), min(DNR, nc - jr), alpha);
+		}
+	    }
+	}
+    }
+    SUPERLU_FREE(ap);
+    SUPERLU_FREE(bp);
+}
+
+/*! \brief Solve op(A)*X = alpha*B or X*op(A) = alpha*B by splitting the
+ * triangular dimension in two: one half is solved by dtrsm_ (which
+ * recurses again while large), the coupling block is applied by dgemm_.
+ */
+void
+dtrsm_blocked(char *side, char *uplo, char *transa, char *diag,
+	      integer m, integer n, doublereal alpha, doublereal *a,
+	      integer lda, doublereal *b, integer ldb)
+{
+    int lside   = (*side == 'L' || *side == 'l');
+    int upper   = (*uplo == 'U' || *uplo == 'u');
+    int notrans = (*transa == 'N' || *transa == 'n');
+    int lower_op = (upper != notrans);   /* op(A) is lower triangular */
+    integer i, j, t, n1, n2;
+    doublereal one = 1., mone = -1.;
+    doublereal *a22, *op21, *op12, *b1, *b2;
+    char *tr = notrans ? "N" : "T";
+
+    if ( alpha != 1. ) {
+	for (j = 0; j < n; ++j)
+	    for (i = 0; i < m; ++i) b[i + j*ldb] *= alpha;
+    }
+
+    t = lside ? m : n;
+    n1 = t / 2;
+    n2 = t - n1;
+    a22  = &a[n1 + n1*lda];
+    op21 = notrans ? &a[n1] : &a[n1*lda];  /* op(A)(n1:t, 0:n1) */
+    op12 = notrans ? &a[n1*lda] : &a[n1];  /* op(A)(0:n1, n1:t) */
+
+    if ( lside ) {
+	b1 = b;
+	b2 = &b[n1];
+	if ( lower_op ) {
+	    dtrsm_(side, uplo, transa, diag, &n1, &n, &one, a, &lda, b1, &ldb);
+	    dgemm_(tr, "N", &n2, &n, &n1, &mone, op21, &lda, b1, &ldb,
+		   &one, b2, &ldb);
+	    dtrsm_(side, uplo, transa, diag, &n2, &n, &one, a22, &lda, b2, &ldb);
+	} else {
+	    dtrsm_(side, uplo, transa, diag, &n2, &n, &one, a22, &lda, b2, &ldb);
+	    dgemm_(tr, "N", &n1, &n, &n2, &mone, op12, &lda, b2, &ldb,
+		   &one, b1, &ldb);
+	    dtrsm_(side, uplo, transa, diag, &n1, &n, &one, a, &lda, b1, &ldb);
+	}
+    } else {
+	b1 = b;
+	b2 = &b[n1*ldb];
+	if ( lower_op ) {
+	    dtrsm_(side, uplo, transa, diag, &m, &n2, &one, a22, &lda, b2, &ldb);
+	    dgemm_("N", tr, &m, &n1, &n2, &mone, b2, &ldb, op21, &lda,
+		   &one, b1, &ldb);
+	    dtrsm_(side, uplo, transa, diag, &m, &n1, &one, a, &lda, b1, &ldb);
+	} else {
+	    dtrsm_(side, uplo, transa, diag, &m, &n1, &one, a, &lda, b1, &ldb);
+	    dgemm_("N", tr, &m, &n2, &n1, &mone, b1, &ldb, op12, &lda,
+		   &one, b2, &ldb);
+	    dtrsm_(side, uplo, transa, diag, &m, &n2, &one, a22, &lda, b2, &ldb);
+	}
+    }
+}
@@ -0,0 +1,265 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Cache-blocked SGEMM and recursive STRSM for the internal CBLAS
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Loop order follows the usual packed-GEMM scheme:
+ *   jc (NC columns of C) -> pc (KC-deep panel, pack op(B))
+ *     -> ic (MC rows, pack op(A), threaded) -> jr -> ir (micro-kernel).
+ * </pre>
+ */
+#include <stdlib.h>
+#include "f2c.h"
+#include "blas_blocked.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define SMR  16    /* micro-tile rows    */
+#define SNR  4     /* micro-tile columns */
+#define SMC  128   /* rows of packed A, multiple of SMR    */
+#define SKC  256   /* depth of packed panels               */
+#define SNC  2048  /* columns of packed B, multiple of SNR */
+
+typedef void (*sgemm_micro_t)(integer, const real *, const real *,
+			      real *, integer, integer, integer,
+			      real);
+
+/*
+ * C(0:mr,0:nr) += alpha * Ap * Bp, where Ap is a SMR x kc sliver and
+ * Bp a kc x SNR sliver, both zero padded.  The accumulator tile lives
+ * in registers; the i-loop is the vectorized one.
+ */
+#define SGEMM_MICRO_BODY                                                \
+{                                                                       \
+    real ab[SNR][SMR];                                            \
+    integer i, j, p;                                                    \
+    for (j = 0; j < SNR; ++j)                                           \
+	for (i = 0; i < SMR; ++i) ab[j][i] = 0.f;                        \
+    for (p = 0; p < kc; ++p) {                                          \
+	for (j = 0; j < SNR; ++j) {                                     \
+	    real bj = bp[j];                                      \
+	    for (i = 0; i < SMR; ++i) ab[j][i] += ap[i] * bj;           \
+	}                                                               \
+	ap += SMR;                                                      \
+	bp += SNR;                                                      \
+    }                                                                   \
+    for (j = 0; j < nr; ++j)                                            \
+	for (i = 0; i < mr; ++i) c[i + j*ldc] += alpha * ab[j][i];      \
+}
+
+static void
+sgemm_micro_generic(integer kc, const real *ap, const real *bp,
+		    real *c, integer ldc, integer mr, integer nr,
+		    real alpha)
+SGEMM_MICRO_BODY
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BLAS_X86_DISPATCH
+__attribute__((target("avx2,fma"))) static void
+sgemm_micro_avx2(integer kc, const real *ap, const real *bp,
+		 real *c, integer ldc, integer mr, integer nr,
+		 real alpha)
+SGEMM_MICRO_BODY
+
+__attribute__((target("avx512f"))) static void
+sgemm_micro_avx512(integer kc, const real *ap, const real *bp,
+		   real *c, integer ldc, integer mr, integer nr,
+		   real alpha)
+SGEMM_MICRO_BODY
+#endif
+
+/*! \brief Pick the widest micro-kernel the running CPU supports. */
+static sgemm_micro_t
+sgemm_select_micro(void)
+{
+#ifdef BLAS_X86_DISPATCH
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx512f") ) return sgemm_micro_avx512;
+    if ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") )
+	return sgemm_micro_avx2;
+#endif
+    return sgemm_micro_generic;
+}
+
+/*! \brief Pack the mc x kc block of op(A) at a into SMR-row slivers. */
+static void
+spack_a(int trans, integer mc, integer kc, const real *a, integer lda,
+	real *ap)
+{
+    integer i, ir, p, mr;
+    for (ir = 0; ir < mc; ir += SMR) {
+	mr = min(SMR, mc - ir);
+	for (p = 0; p < kc; ++p) {
+	    if ( trans ) {
+		for (i = 0; i < mr; ++i) ap[i] = a[p + (ir+i)*lda];
+	    } else {
+		for (i = 0; i < mr; ++i) ap[i] = a[ir+i + p*lda];
+	    }
+	    for (; i < SMR; ++i) ap[i] = 0.f;
+	    ap += SMR;
+	}
+    }
+}
+
+/*! \brief Pack the kc x nc block of op(B) at b into SNR-column slivers. */
+static void
+spack_b(int trans, integer kc, integer nc, const real *b, integer ldb,
+	real *bp)
+{
+    integer j, jr, p, nr;
+    for (jr = 0; jr < nc; jr += SNR) {
+	nr = min(SNR, nc - jr);
+	for (p = 0; p < kc; ++p) {
+	    if ( trans ) {
+		for (j = 0; j < nr; ++j) bp[j] = b[jr+j + p*ldb];
+	    } else {
+		for (j = 0; j < nr; ++j) bp[j] = b[p + (jr+j)*ldb];
+	    }
+	    for (; j < SNR; ++j) bp[j] = 0.f;
+	    bp += SNR;
+	}
+    }
+}
+
+/*! \brief C := alpha*op(A)*op(B) + beta*C; arguments already checked. */
+void
+sgemm_blocked(char *transa, char *transb, integer m, integer n, integer k,
+	      real alpha, real *a, integer lda, real *b,
+	      integer ldb, real beta, real *c, integer ldc)
+{
+    int ta = (*transa != 'N' && *transa != 'n');
+    int tb = (*transb != 'N' && *transb != 'n');
+    integer i, j, jc, pc, nc, kc, nblk_m;
+    real *bp, *ap;
+    integer nthr = 1, lap;
+    sgemm_micro_t micro = sgemm_select_micro();
+
+    if ( beta != 1. ) {
+	for (j = 0; j < n; ++j)
+	    for (i = 0; i < m; ++i)
+		c[i + j*ldc] = (beta == 0.) ? 0. : beta * c[i + j*ldc];
+    }
+    if ( alpha == 0. || k == 0 ) return;
+
+    nblk_m = (m + SMC - 1) / SMC;
+#ifdef _OPENMP
+    if ( nblk_m > 1 && !omp_in_parallel() ) nthr = omp_get_max_threads();
+#endif
+    /* One packed op(B) panel, and one packed op(A) block per thread. */
+    lap = SMC * min(k, SKC);
+    if ( !(bp = (real *) SUPERLU_MALLOC(sizeof(real) * min(k, SKC)
+			       * ((min(n, SNC) + SNR - 1) / SNR * SNR))) )
+	ABORT("Malloc fails for bp[].");
+    if ( !(ap = (real *) SUPERLU_MALLOC(sizeof(real) * lap * nthr)) )
+	ABORT("Malloc fails for ap[].");
+
+    for (jc = 0; jc < n; jc += SNC) {
+	nc = min(SNC, n - jc);
+	for (pc = 0; pc < k; pc += SKC) {
+	    kc = min(SKC, k - pc);
+	    spack_b(tb, kc, nc, tb ? &b[jc + pc*ldb] : &b[pc + jc*ldb], ldb, bp);
+
+#ifdef _OPENMP
+#pragma omp parallel if (nblk_m > 1 && !omp_in_parallel())
+#endif
+	    {
+		integer ib, ic, mc, ir, jr;
+#ifdef _OPENMP
+		real *apt = &ap[lap * omp_get_thread_num()];
+#else
+		real *apt = ap;
+#endif
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+		for (ib = 0; ib < nblk_m; ++ib) {
+		    ic = ib * SMC;
+		    mc = min(SMC, m - ic);
+		    spack_a(ta, mc, kc, ta ? &a[pc + ic*lda] : &a[ic + pc*lda],
+			    lda, apt);
+		    for (jr = 0; jr < nc; jr += SNR)
+			for (ir = 0; ir < mc; ir += SMR)
+			    micro(kc, &apt[ir*kc], &bp[jr*kc],
+				  &c[ic+ir + (jc+jr)*ldc], ldc,
+				  min(SMR, mc - ir), min(SNR, nc - jr), alpha);
+		}
+	    }
+	}
+    }
+    SUPERLU_FREE(ap);
+    SUPERLU_FREE(bp);
+}
+
+/*! \brief Solve op(A)*X = alpha*B or X*op(A) = alpha*B by splitting the
+ * triangular dimension in two: one half is solved by strsm_ (which
+ * recurses again while large), the coupling block is applied by sgemm_.
+ */
+void
+strsm_blocked(char *side, char *uplo, char *transa, char *diag,
+	      integer m, integer n, real alpha, real *a,
+	      integer lda, real *b, integer ldb)
+{
+    int lside   = (*side == 'L' || *side == 'l');
+    int upper   = (*uplo == 'U' || *uplo == 'u');
+    int notrans = (*transa == 'N' || *transa == 'n');
+    int lower_op = (upper != notrans);   /* op(A) is lower triangular */
+    integer i, j, t, n1, n2;
+    real one = 1.f, mone = -1.f;
+    real *a22, *op21, *op12, *b1, *b2;
+    char *tr = notrans ? "N" : "T";
+
+    if ( alpha != 1. ) {
+	for (j = 0; j < n; ++j)
+	    for (i = 0; i < m; ++i) b[i + j*ldb] *= alpha;
+    }
+
+    t = lside ? m : n;
+    n1 = t / 2;
+    n2 = t - n1;
+    a22  = &a[n1 + n1*lda];
+    op21 = notrans ? &a[n1] : &a[n1*lda];  /* op(A)(n1:t, 0:n1) */
+    op12 = notrans ? &a[n1*lda] : &a[n1];  /* op(A)(0:n1, n1:t) */
+
+    if ( lside ) {
+	b1 = b;
+	b2 = &b[n1];
+	if ( lower_op ) {
+	    strsm_(side, uplo, transa, diag, &n1, &n, &one, a, &lda, b1, &ldb);
+	    sgemm_(tr, "N", &n2, &n, &n1, &mone, op21, &lda, b1, &ldb,
+		   &one, b2, &ldb);
+	    strsm_(side, uplo, transa, diag, &n2, &n, &one, a22, &lda, b2, &ldb);
+	} else {
+	    strsm_(side, uplo, transa, diag, &n2, &n, &one, a22, &lda, b2, &ldb);
+	    sgemm_(tr, "N", &n1, &n, &n2, &mone, op12, &lda, b2, &ldb,
+		   &one, b1, &ldb);
+	    strsm_(side, uplo, transa, diag, &n1, &n, &one, a, &lda, b1, &ldb);
+	}
+    } else {
+	b1 = b;
+	b2 = &b[n1*ldb];
+	if ( lower_op ) {
+	    strsm_(side, uplo, transa, diag, &m, &n2, &one, a22, &lda, b2, &ldb);
+	    sgemm_("N", tr, &m, &n1, &n2, &mone, b2, &ldb, op21, &lda,
+		   &one, b1, &ldb);
+	    strsm_(side, uplo, transa, diag, &m, &n1, &one, a, &lda, b1, &ldb);
+	} else {
+	    strsm_(side, uplo, transa, diag, &m, &n1, &one, a, &lda, b1, &ldb);
+	    sgemm_("N", tr, &m, &n2, &n1, &mone, b1, &ldb, op12, &lda,
+		   &one, b2, &ldb);
+	    strsm_(side, uplo, transa, diag, &m, &n2, &one, a22, &lda, b2, &ldb);
+	}
+    }
+}
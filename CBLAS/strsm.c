@@ -5,6 +5,7 @@
 */
 #include <string.h>
 #include "f2c.h"
+#include "blas_blocked.h"
 
 /* Subroutine */ int strsm_(char *side, char *uplo, char *transa, char *diag, 
 	integer *m, integer *n, real *alpha, real *a, integer *
@@ -16,14 +17,14 @@
     integer a_dim1, a_offset, b_dim1, b_offset, i__1, i__2, i__3;
 
     /* Local variables */
-    static integer info;
-    static real temp;
-    static integer i, j, k;
-    static logical lside;
-    static integer nrowa;
-    static logical upper;
+    integer info;
+    real temp;
+    integer i, j, k;
+    logical lside;
+    integer nrowa;
+    logical upper;
     extern /* Subroutine */ int input_error_dist(char *, integer *);
-    static logical nounit;
+    logical nounit;
 
 
 /*  Purpose   
@@ -233,6 +234,14 @@
 	return 0;
     }
 
+/*     Recurse on the triangular dimension when it is large. */
+
+    if ((lside ? *m : *n) > BLAS_TRSM_NB) {
+	strsm_blocked(side, uplo, transa, diag, *m, *n, *alpha, a, *lda,
+		      b, *ldb);
+	return 0;
+    }
+
 /*     Start the operations. */
 
     if (lside) {
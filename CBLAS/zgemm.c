@@ -5,6 +5,7 @@
 */
 #include <string.h>
 #include "f2c.h"
+#include "blas_blocked.h"
 
 /* Subroutine */ int zgemm_(char *transa, char *transb, integer *m, integer *
 	n, integer *k, doublecomplex *alpha, doublecomplex *a, integer *lda, 
@@ -22,13 +23,13 @@
     void d_cnjg(doublecomplex *, doublecomplex *);
 
     /* Local variables */
-    static integer info;
-    static logical nota, notb;
-    static doublecomplex temp;
-    static integer i, j, l;
-    static logical conja, conjb;
-    static integer ncola;
-    static integer nrowa, nrowb;
+    integer info;
+    logical nota, notb;
+    doublecomplex temp;
+    integer i, j, l;
+    logical conja, conjb;
+    integer ncola;
+    integer nrowa, nrowb;
     extern /* Subroutine */ int input_error_dist(char *, integer *);
 
 
@@ -276,6 +277,14 @@
 	return 0;
     }
 
+/*     Use the cache-blocked kernel for all but small products. */
+
+    if ((doublereal) *m * *n * *k >= BLAS_GEMM_MIN_MNK) {
+	zgemm_blocked(transa, transb, *m, *n, *k, *alpha, a, *lda, b, *ldb,
+		      *beta, c, *ldc);
+	return 0;
+    }
+
 /*     Start the operations. */
 
     if (notb) {
@@ -0,0 +1,298 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Cache-blocked ZGEMM and recursive ZTRSM for the internal CBLAS
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Same blocking as dgemm_blocked.c.  Packed A slivers are stored split
+ * (ZMR real parts followed by ZMR imaginary parts per k), so that the
+ * micro-kernel vectorizes over rows without complex shuffles;
+ * conjugation of op(A)/op(B) is applied while packing.
+ * </pre>
+ */
+#include <stdlib.h>
+#include "f2c.h"
+#include "blas_blocked.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define ZMR  8     /* micro-tile rows    */
+#define ZNR  2     /* micro-tile columns */
+#define ZMC  64    /* rows of packed A, multiple of ZMR    */
+#define ZKC  256   /* depth of packed panels               */
+#define ZNC  1024  /* columns of packed B, multiple of ZNR */
+
+typedef void (*zgemm_micro_t)(integer, const doublereal *, const doublereal *,
+			      doublecomplex *, integer, integer, integer,
+			      doublecomplex);
+
+/*
+ * C(0:mr,0:nr) += alpha * Ap * Bp.  Ap holds, per k, ZMR real parts then
+ * ZMR imaginary parts; Bp holds, per k, ZNR interleaved (re,im) pairs.
+ */
+#define ZGEMM_MICRO_BODY                                                \
+{                                                                       \
+    doublereal abr[ZNR][ZMR], abi[ZNR][ZMR];                            \
+    doublereal cr, ci;                                                  \
+    integer i, j, p;                                                    \
+    for (j = 0; j < ZNR; ++j)                                           \
+	for (i = 0; i < ZMR; ++i) abr[j][i] = abi[j][i] = 0.;           \
+    for (p = 0; p < kc; ++p) {                                          \
+	for (j = 0; j < ZNR; ++j) {                                     \
+	    doublereal br = bp[2*j], bi = bp[2*j+1];                    \
+	    for (i = 0; i < ZMR; ++i) {                                 \
+		abr[j][i] += ap[i] * br - ap[ZMR+i] * bi;               \
+		abi[j][i] += ap[i] * bi + ap[ZMR+i] * br;               \
+	    }                                                           \
+	}                                                               \
+	ap += 2*ZMR;                                                    \
+	bp += 2*ZNR;                                                    \
+    }                                                                   \
+    for (j = 0; j < nr; ++j)                                            \
+	for (i = 0; i < mr; ++i) {                                      \
+	    cr = alpha.r * abr[j][i] - alpha.i * abi[j][i];             \
+	    ci = alpha.r * abi[j][i] + alpha.i * abr[j][i];             \
+	    c[i + j*ldc].r += cr;                                       \
+	    c[i + j*ldc].i += ci;                                       \
+	}                                                               \
+}
+
+static void
+zgemm_micro_generic(integer kc, const doublereal *ap, const doublereal *bp,
+		    doublecomplex *c, integer ldc, integer mr, integer nr,
+		    doublecomplex alpha)
+ZGEMM_MICRO_BODY
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BLAS_X86_DISPATCH
+__attribute__((target("avx2,fma"))) static void
+zgemm_micro_avx2(integer kc, const doublereal *ap, const doublereal *bp,
+		 doublecomplex *c, integer ldc, integer mr, integer nr,
+		 doublecomplex alpha)
+ZGEMM_MICRO_BODY
+
+__attribute__((target("avx512f"))) static void
+zgemm_micro_avx512(integer kc, const doublereal *ap, const doublereal *bp,
+		   doublecomplex *c, integer ldc, integer mr, integer nr,
+		   doublecomplex alpha)
+ZGEMM_MICRO_BODY
+#endif
+
+/*! \brief Pick the widest micro-kernel the running CPU supports. */
+static zgemm_micro_t
+zgemm_select_micro(void)
+{
+#ifdef BLAS_X86_DISPATCH
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx512f") ) return zgemm_micro_avx512;
+    if ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") )
+	return zgemm_micro_avx2;
+#endif
+    return zgemm_micro_generic;
+}
+
+/*! \brief Pack the mc x kc block of op(A) at a into split ZMR-row slivers.
+ * trans: 0 = 'N', 1 = 'T', 2 = 'C'.
+ */
+static void
+zpack_a(int trans, integer mc, integer kc, const doublecomplex *a,
+	integer lda, doublereal *ap)
+{
+    integer i, ir, p, mr;
+    const doublecomplex *x;
+    doublereal s = (trans == 2) ? -1. : 1.;
+    for (ir = 0; ir < mc; ir += ZMR) {
+	mr = min(ZMR, mc - ir);
+	for (p = 0; p < kc; ++p) {
+	    for (i = 0; i < mr; ++i) {
+		x = trans ? &a[p + (ir+i)*lda] : &a[ir+i + p*lda];
+		ap[i] = x->r;
+		ap[ZMR+i] = s * x->i;
+	    }
+	    for (; i < ZMR; ++i) ap[i] = ap[ZMR+i] = 0.;
+	    ap += 2*ZMR;
+	}
+    }
+}
+
+/*! \brief Pack the kc x nc block of op(B) at b into ZNR-column slivers. */
+static void
+zpack_b(int trans, integer kc, integer nc, const doublecomplex *b,
+	integer ldb, doublereal *bp)
+{
+    integer j, jr, p, nr;
+    const doublecomplex *x;
+    doublereal s = (trans == 2) ? -1. : 1.;
+    for (jr = 0; jr < nc; jr += ZNR) {
+	nr = min(ZNR, nc - jr);
+	for (p = 0; p < kc; ++p) {
+	    for (j = 0; j < nr; ++j) {
+		x = trans ? &b[jr+j + p*ldb] : &b[p + (jr+j)*ldb];
+		bp[2*j] = x->r;
+		bp[2*j+1] = s * x->i;
+	    }
+	    for (; j < ZNR; ++j) bp[2*j] = bp[2*j+1] = 0.;
+	    bp += 2*ZNR;
+	}
+    }
+}
+
+static int
+ztrans_code(char *trans)
+{
+    if ( *trans == 'N' || *trans == 'n' ) return 0;
+    if ( *trans == 'C' || *trans == 'c' ) return 2;
+    return 1;
+}
+
+/*! \brief C := alpha*op(A)*op(B) + beta*C; arguments already checked. */
+void
+zgemm_blocked(char *transa, char *transb, integer m, integer n, integer k,
+	      doublecomplex alpha, doublecomplex *a, integer lda,
+	      doublecomplex *b, integer ldb, doublecomplex beta,
+	      doublecomplex *c, integer ldc)
+{
+    int ta = ztrans_code(transa), tb = ztrans_code(transb);
+    integer i, j, jc, pc, nc, kc, nblk_m;
+    doublereal *bp, *ap, cr;
+    integer nthr = 1, lap;
+    zgemm_micro_t micro = zgemm_select_micro();
+
+    if ( beta.r != 1. || beta.i != 0. ) {
+	for (j = 0; j < n; ++j)
+	    for (i = 0; i < m; ++i) {
+		doublecomplex *x = &c[i + j*ldc];
+		if ( beta.r == 0. && beta.i == 0. ) {
+		    x->r = x->i = 0.;
+		} else {
+		    cr = beta.r * x->r - beta.i * x->i;
+		    x->i = beta.r * x->i + beta.i * x->r;
+		    x->r = cr;
+		}
+	    }
+    }
+    if ( (alpha.r == 0. && alpha.i == 0.) || k == 0 ) return;
+
+    nblk_m = (m + ZMC - 1) / ZMC;
+#ifdef _OPENMP
+    if ( nblk_m > 1 && !omp_in_parallel() ) nthr = omp_get_max_threads();
+#endif
+    /* One packed op(B) panel, and one packed op(A) block per thread. */
+    lap = 2 * ZMC * min(k, ZKC);
+    if ( !(bp = (doublereal *) SUPERLU_MALLOC(sizeof(doublereal) * 2 * min(k, ZKC)
+			       * ((min(n, ZNC) + ZNR - 1) / ZNR * ZNR))) )
+	ABORT("Malloc fails for bp[].");
+    if ( !(ap = (doublereal *) SUPERLU_MALLOC(sizeof(doublereal) * lap * nthr)) )
+	ABORT("Malloc fails for ap[].");
+
+    for (jc = 0; jc < n; jc += ZNC) {
+	nc = min(ZNC, n - jc);
+	for (pc = 0; pc < k; pc += ZKC) {
+	    kc = min(ZKC, k - pc);
+	    zpack_b(tb, kc, nc, tb ? &b[jc + pc*ldb] : &b[pc + jc*ldb], ldb, bp);
+
+#ifdef _OPENMP
+#pragma omp parallel if (nblk_m > 1 && !omp_in_parallel())
+#endif
+	    {
+		integer ib, ic, mc, ir, jr;
+#ifdef _OPENMP
+		doublereal *apt = &ap[lap * omp_get_thread_num()];
+#else
+		doublereal *apt = ap;
+#endif
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+		for (ib = 0; ib < nblk_m; ++ib) {
+		    ic = ib * ZMC;
+		    mc = min(ZMC, m - ic);
+		    zpack_a(ta, mc, kc, ta ? &a[pc + ic*lda] : &a[ic + pc*lda],
+			    lda, apt);
+		    for (jr = 0; jr < nc; jr += ZNR)
+			for (ir = 0; ir < mc; ir += ZMR)
+			    micro(kc, &apt[2*ir*kc], &bp[2*jr*kc],
+				  &c[ic+ir + (jc+jr)*ldc], ldc,
+				  min(ZMR, mc - ir), min(ZNR, nc - jr), alpha);
+		}
+	    }
+	}
+    }
+    SUPERLU_FREE(ap);
+    SUPERLU_FREE(bp);
+}
+
+/*! \brief Recursive ZTRSM; see dtrsm_blocked() for the splitting. */
+void
+ztrsm_blocked(char *side, char *uplo, char *transa, char *diag,
+	      integer m, integer n, doublecomplex alpha, doublecomplex *a,
+	      integer lda, doublecomplex *b, integer ldb)
+{
+    int lside   = (*side == 'L' || *side == 'l');
+    int upper   = (*uplo == 'U' || *uplo == 'u');
+    int notrans = (*transa == 'N' || *transa == 'n');
+    int lower_op = (upper != notrans);   /* op(A) is lower triangular */
+    integer i, j, t, n1, n2;
+    doublereal cr;
+    doublecomplex one = {1., 0.}, mone = {-1., 0.};
+    doublecomplex *a22, *op21, *op12, *b1, *b2;
+
+    if ( alpha.r != 1. || alpha.i != 0. ) {
+	for (j = 0; j < n; ++j)
+	    for (i = 0; i < m; ++i) {
+		doublecomplex *x = &b[i + j*ldb];
+		cr = alpha.r * x->r - alpha.i * x->i;
+		x->i = alpha.r * x->i + alpha.i * x->r;
+		x->r = cr;
+	    }
+    }
+
+    t = lside ? m : n;
+    n1 = t / 2;
+    n2 = t - n1;
+    a22  = &a[n1 + n1*lda];
+    op21 = notrans ? &a[n1] : &a[n1*lda];  /* op(A)(n1:t, 0:n1) */
+    op12 = notrans ? &a[n1*lda] : &a[n1];  /* op(A)(0:n1, n1:t) */
+
+    if ( lside ) {
+	b1 = b;
+	b2 = &b[n1];
+	if ( lower_op ) {
+	    ztrsm_(side, uplo, transa, diag, &n1, &n, &one, a, &lda, b1, &ldb);
+	    zgemm_(transa, "N", &n2, &n, &n1, &mone, op21, &lda, b1, &ldb,
+		   &one, b2, &ldb);
+	    ztrsm_(side, uplo, transa, diag, &n2, &n, &one, a22, &lda, b2, &ldb);
+	} else {
+	    ztrsm_(side, uplo, transa, diag, &n2, &n, &one, a22, &lda, b2, &ldb);
+	    zgemm_(transa, "N", &n1, &n, &n2, &mone, op12, &lda, b2, &ldb,
+		   &one, b1, &ldb);
+	    ztrsm_(side, uplo, transa, diag, &n1, &n, &one, a, &lda, b1, &ldb);
+	}
+    } else {
+	b1 = b;
+	b2 = &b[n1*ldb];
+	if ( lower_op ) {
+	    ztrsm_(side, uplo, transa, diag, &m, &n2, &one, a22, &lda, b2, &ldb);
+	    zgemm_("N", transa, &m, &n1, &n2, &mone, b2, &ldb, op21, &lda,
+		   &one, b1, &ldb);
+	    ztrsm_(side, uplo, transa, diag, &m, &n1, &one, a, &lda, b1, &ldb);
+	} else {
+	    ztrsm_(side, uplo, transa, diag, &m, &n1, &one, a, &lda, b1, &ldb);
+	    zgemm_("N", transa, &m, &n2, &n1, &mone, b1, &ldb, op12, &lda,
+		   &one, b2, &ldb);
+	    ztrsm_(side, uplo, transa, diag, &m, &n2, &one, a22, &lda, b2, &ldb);
+	}
+    }
+}
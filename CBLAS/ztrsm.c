@@ -5,6 +5,7 @@
 */
 #include <string.h>
 #include "f2c.h"
+#include "blas_blocked.h"
 
 /* Table of constant values */
 
@@ -26,14 +27,14 @@ static doublecomplex c_b1 = {1.,0.};
 	    doublecomplex *, doublecomplex *);
 
     /* Local variables */
-    static integer info;
-    static doublecomplex temp;
-    static integer i, j, k;
-    static logical lside;
-    static integer nrowa;
-    static logical upper;
+    integer info;
+    doublecomplex temp;
+    integer i, j, k;
+    logical lside;
+    integer nrowa;
+    logical upper;
     extern /* Subroutine */ int input_error_dist(char *, integer *);
-    static logical noconj, nounit;
+    logical noconj, nounit;
 
 
 /*  Purpose   
@@ -247,6 +248,14 @@ static doublecomplex c_b1 = {1.,0.};
 	return 0;
     }
 
+/*     Recurse on the triangular dimension when it is large. */
+
+    if ((lside ? *m : *n) > BLAS_TRSM_NB) {
+	ztrsm_blocked(side, uplo, transa, diag, *m, *n, *alpha, a, *lda,
+		      b, *ldb);
+	return 0;
+    }
+
 /*     Start the operations. */
 
     if (lside) {
@@ -41,6 +41,9 @@ at the top-level directory.
  *        ScalePermstruct : perm_c
  *        LUstruct        : etree
  *
+ * A superlu_workspace_t is attached to LUstruct, so the factorization
+ * buffers allocated in the first call are reused in the second one.
+ *
  * With MPICH,  program may be run by typing:
  *    mpiexec -n <np> pddrive2 -r <proc rows> -c <proc columns> g20.rua
  * </pre>
@@ -54,6 +57,7 @@ int main(int argc, char *argv[])
     NRformat_loc *Astore;
     dScalePermstruct_t ScalePermstruct;
     dLUstruct_t LUstruct;
+    superlu_workspace_t work;
     dSOLVEstruct_t SOLVEstruct;
     gridinfo_t grid;
     double   *berr;
@@ -182,6 +186,8 @@ int main(int argc, char *argv[])
     /* Initialize ScalePermstruct and LUstruct. */
     dScalePermstructInit(m, n, &ScalePermstruct);
     dLUstructInit(n, &LUstruct);
+    superlu_workspace_init(&work);
+    LUstruct.work = &work;
 
     /* Initialize the statistics variables. */
     PStatInit(&stat);
@@ -261,6 +267,7 @@ int main(int argc, char *argv[])
 					the L and U matrices.               */
     dScalePermstructFree(&ScalePermstruct);
     dLUstructFree(&LUstruct);         /* Deallocate the structure of L and U.*/
+    superlu_workspace_free(&work);    /* Release the factorization buffers. */
     if ( options.SolveInitialized ) {
         dSolveFinalize(&options, &SOLVEstruct);
     }
@@ -41,6 +41,9 @@ at the top-level directory.
  *        ScalePermstruct : perm_c
  *        LUstruct        : etree
  *
+ * A superlu_workspace_t is attached to LUstruct, so the factorization
+ * buffers allocated in the first call are reused in the second one.
+ *
  * With MPICH,  program may be run by typing:
  *    mpiexec -n <np> psdrive2 -r <proc rows> -c <proc columns> g20.rua
  * </pre>
@@ -54,6 +57,7 @@ int main(int argc, char *argv[])
     NRformat_loc *Astore;
     sScalePermstruct_t ScalePermstruct;
     sLUstruct_t LUstruct;
+    superlu_workspace_t work;
     sSOLVEstruct_t SOLVEstruct;
     gridinfo_t grid;
     float   *berr;
@@ -183,6 +187,8 @@ int main(int argc, char *argv[])
     /* Initialize ScalePermstruct and LUstruct. */
     sScalePermstructInit(m, n, &ScalePermstruct);
     sLUstructInit(n, &LUstruct);
+    superlu_workspace_init(&work);
+    LUstruct.work = &work;
 
     /* Initialize the statistics variables. */
     PStatInit(&stat);
@@ -262,6 +268,7 @@ int main(int argc, char *argv[])
 					the L and U matrices.               */
     sScalePermstructFree(&ScalePermstruct);
     sLUstructFree(&LUstruct);         /* Deallocate the structure of L and U.*/
+    superlu_workspace_free(&work);    /* Release the factorization buffers. */
     if ( options.SolveInitialized ) {
         sSolveFinalize(&options, &SOLVEstruct);
     }
@@ -40,6 +40,9 @@ at the top-level directory.
  *        ScalePermstruct : perm_c
  *        LUstruct        : etree
  *
+ * A superlu_workspace_t is attached to LUstruct, so the factorization
+ * buffers allocated in the first call are reused in the second one.
+ *
  * With MPICH,  program may be run by typing:
  *    mpiexec -n <np> pzdrive2 -r <proc rows> -c <proc columns> g20.rua
  * </pre>
@@ -53,6 +56,7 @@ int main(int argc, char *argv[])
     NRformat_loc *Astore;
     zScalePermstruct_t ScalePermstruct;
     zLUstruct_t LUstruct;
+    superlu_workspace_t work;
     zSOLVEstruct_t SOLVEstruct;
     gridinfo_t grid;
     double   *berr;
@@ -181,6 +185,8 @@ int main(int argc, char *argv[])
     /* Initialize ScalePermstruct and LUstruct. */
     zScalePermstructInit(m, n, &ScalePermstruct);
     zLUstructInit(n, &LUstruct);
+    superlu_workspace_init(&work);
+    LUstruct.work = &work;
 
     /* Initialize the statistics variables. */
     PStatInit(&stat);
@@ -260,6 +266,7 @@ int main(int argc, char *argv[])
 					the L and U matrices.               */
     zScalePermstructFree(&ScalePermstruct);
     zLUstructFree(&LUstruct);         /* Deallocate the structure of L and U.*/
+    superlu_workspace_free(&work);    /* Release the factorization buffers. */
     if ( options.SolveInitialized ) {
         zSolveFinalize(&options, &SOLVEstruct);
     }
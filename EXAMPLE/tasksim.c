@@ -0,0 +1,661 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Offline simulator of the supernodal factorization task graph
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Replays the task graph written by superlu_write_taskgraph() (set
+ * SUPERLU_TASKGRAPH=<file> when running a p?drive or p?drive3d driver)
+ * on a model machine, to predict the numerical factorization time for
+ * other process counts, grid shapes and look-ahead depths without
+ * running them.
+ *
+ * The 2D right-looking algorithm is replayed panel by panel on an
+ * nprow x npcol block-cyclic grid:
+ *   - diagonal factorization on the owner, broadcast along its process
+ *     row and column, then the L and U panel solves on their owners;
+ *   - L(:,k) broadcast along process rows and U(k,:) along process
+ *     columns, each a binomial tree of alpha + beta*bytes hops;
+ *   - the Schur update on every process that owns a block (i,j).
+ * With a look-ahead window of w, the updates of the next w block
+ * columns/rows are done first, and a later panel may start as soon as
+ * its own updates are done, but not before the remaining updates of the
+ * panel w+1 steps back.  The panels are taken in the order of the DAG
+ * edges: a panel is ready once all of its predecessors have been
+ * replayed, and of the ready panels the one whose updates arrived first
+ * goes next.  With npdep > 1, every layer factors its forest
+ * in turn and the ancestor blocks are summed pairwise between levels as
+ * in pdgstrf3d().  The 3D forests come from the file when npdep matches,
+ * otherwise from a greedy weight-balanced split of the supernodal etree.
+ * Compute runs at a fixed rate per core; all costs are per process.
+ *
+ * The critical path is traced back from the last panel through the
+ * update that released each panel, or through the work that kept the
+ * panel's owner busy, and split into panel work, busy owners, broadcasts
+ * and Schur updates.
+ *
+ * Usage: tasksim [options] <task graph file>
+ *   -r <int>    process rows                 (default: from the file)
+ *   -c <int>    process columns              (default: from the file)
+ *   -d <int>    Z-layers, a power of 2       (default: from the file)
+ *   -l <int>    look-ahead window            (default: 10)
+ *   -t <int>    cores per process            (default: 1)
+ *   -f <float>  Gflop/s per core             (default: 10)
+ *   -a <float>  message latency in us        (default: 2)
+ *   -b <float>  link bandwidth in GB/s       (default: 10)
+ *   -k <int>    critical-path panels listed  (default: 10)
+ * </pre>
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef struct {
+    long   blk;      /* supernode number */
+    double len;      /* rows (L) or nonzeros (U) */
+} sim_block_t;
+
+typedef struct {
+    long   fstcol, ncols, parent, tree;
+    double flops;    /* panel + update */
+    double bytes;    /* L and U blocks */
+    int    nl, nu, ne;
+    sim_block_t *l, *u;
+    long   *e;       /* successors in the DAG */
+} sim_snode_t;
+
+typedef struct {
+    long   n, nsupers;
+    int    dsize, is_complex, nprow, npcol, npdep;
+    sim_snode_t *s;
+} sim_graph_t;
+
+typedef struct {
+    int    Pr, Pc, Pz, la, topk;
+    double alpha, beta, rate;   /* s, s/byte, flop/s per process */
+} sim_model_t;
+
+/* Clocks of the processes of one layer. */
+typedef struct {
+    double *tb;      /* end of all queued work */
+    double *tc;      /* end of look-ahead (critical) work */
+    double *ring;    /* tb at the end of the last la+2 steps */
+    double *busy;    /* accumulated work */
+    long   *last;    /* last step that changed tb */
+    long   *owner;   /* panel whose work was last queued on the process */
+    long   step, cur;
+} sim_layer_t;
+
+/* Per-panel record for the critical path. */
+typedef struct {
+    double ready;    /* all updates into the panel are done */
+    double start;    /* diagonal factorization starts */
+    double fin;      /* panel solves are done */
+    double sent;     /* L and U panels have arrived everywhere */
+    long   pred;     /* panel whose update released this one */
+    long   busy_by;  /* panel keeping the diagonal owner busy, or -1 */
+} sim_trace_t;
+
+static int    W;     /* ring length, la + 2 */
+static double fw;    /* flop weight of the arithmetic */
+
+static int hops(int p)
+{
+    int h = 0;
+    while ( (1 << h) < p ) ++h;
+    return h;
+}
+
+static void touch(sim_layer_t *L, int p)
+{
+    long q = L->last[p] > L->step - W ? L->last[p] : L->step - W;
+    for (; q < L->step; ++q) if ( q >= 0 ) L->ring[p * W + q % W] = L->tb[p];
+    L->last[p] = L->step;
+    L->owner[p] = L->cur;
+}
+
+/* tb of process p at the end of step q of this layer */
+static double bulk_at(sim_layer_t *L, int p, long q)
+{
+    if ( q < 0 ) return 0.;
+    if ( q >= L->last[p] ) return L->tb[p];
+    return L->ring[p * W + q % W];
+}
+
+static double avail(sim_layer_t *L, int p, int la)
+{
+    double t;
+    if ( la == 0 ) return L->tb[p];
+    t = bulk_at(L, p, L->step - la - 1);
+    return L->tc[p] > t ? L->tc[p] : t;
+}
+
+/* Critical work on p from t0 to t1 pushes its queued work back. */
+static void charge(sim_layer_t *L, int p, double t0, double t1)
+{
+    touch(L, p);
+    L->tc[p] = t1;
+    L->tb[p] = L->tb[p] + (t1 - t0) > t1 ? L->tb[p] + (t1 - t0) : t1;
+    L->busy[p] += t1 - t0;
+}
+
+static double dmax(double a, double b) { return a > b ? a : b; }
+static double dmin(double a, double b) { return a < b ? a : b; }
+
+static void read_error(const char *what)
+{
+    fprintf(stderr, "tasksim: malformed task graph (%s)\n", what);
+    exit(1);
+}
+
+static void read_graph(const char *fname, sim_graph_t *G)
+{
+    FILE *fp = fopen(fname, "r");
+    char tag[16], line[256];
+    long k, i, nb;
+    double pf, uf, lb, ub;
+    sim_snode_t *s;
+
+    if ( !fp ) { perror(fname); exit(1); }
+    do {
+	if ( !fgets(line, sizeof(line), fp) ) read_error("header");
+    } while ( line[0] == '#' );
+    if ( sscanf(line, "n %ld nsupers %ld dsize %d complex %d nprow %d "
+		"npcol %d npdep %d", &G->n, &G->nsupers, &G->dsize,
+		&G->is_complex, &G->nprow, &G->npcol, &G->npdep) != 7 )
+	read_error("header");
+
+    G->s = (sim_snode_t *) calloc(G->nsupers, sizeof(sim_snode_t));
+    if ( G->nsupers > 0 && !G->s ) read_error("nsupers");
+    for (k = 0; k < G->nsupers; ++k) {
+	s = &G->s[k];
+	if ( fscanf(fp, "%15s %ld %ld %ld %ld %ld %lf %lf %lf %lf", tag, &i,
+		    &s->fstcol, &s->ncols, &s->parent, &s->tree,
+		    &pf, &uf, &lb, &ub) != 10 || strcmp(tag, "s") || i != k )
+	    read_error("s");
+	s->flops = pf + uf;
+	s->bytes = lb + ub;
+	if ( fscanf(fp, "%15s %ld", tag, &nb) != 2 || strcmp(tag, "l") )
+	    read_error("l");
+	s->nl = nb;
+	s->l = (sim_block_t *) malloc((nb + 1) * sizeof(sim_block_t));
+	for (i = 0; i < nb; ++i)
+	    if ( fscanf(fp, "%ld %lf", &s->l[i].blk, &s->l[i].len) != 2 )
+		read_error("l");
+	if ( fscanf(fp, "%15s %ld", tag, &nb) != 2 || strcmp(tag, "u") )
+	    read_error("u");
+	s->nu = nb;
+	s->u = (sim_block_t *) malloc((nb + 1) * sizeof(sim_block_t));
+	for (i = 0; i < nb; ++i)
+	    if ( fscanf(fp, "%ld %lf", &s->u[i].blk, &s->u[i].len) != 2 )
+		read_error("u");
+	/* Successors are later panels, in increasing order. */
+	if ( fscanf(fp, "%15s %ld", tag, &nb) != 2 || strcmp(tag, "e")
+	     || nb < 0 || nb > G->nsupers )
+	    read_error("e");
+	s->ne = nb;
+	s->e = (long *) malloc((nb + 1) * sizeof(long));
+	for (i = 0; i < nb; ++i)
+	    if ( fscanf(fp, "%ld", &s->e[i]) != 1 || s->e[i] <= k
+		 || s->e[i] >= G->nsupers || (i && s->e[i] <= s->e[i-1]) )
+		read_error("e");
+    }
+    fclose(fp);
+}
+
+/*! \brief Split the etree into 2*Pz-1 forests, heaviest subtrees first. */
+static void part_forest(sim_graph_t *G, long *cptr, long *cidx, double *wt,
+			long *roots, long nr, long h, int cnt)
+{
+    long i, j, k, na = 0, nb = 0, top, *S, *A, *B, *stack;
+    double wa = 0., wb = 0.;
+
+    if ( cnt == 1 ) { /* the whole forest goes to this layer */
+	stack = (long *) malloc((G->nsupers + 1) * sizeof(long));
+	for (i = 0; i < nr; ++i) {
+	    top = 0;
+	    stack[top++] = roots[i];
+	    while ( top ) {
+		k = stack[--top];
+		G->s[k].tree = h;
+		for (j = cptr[k]; j < cptr[k+1]; ++j) stack[top++] = cidx[j];
+	    }
+	}
+	free(stack);
+	return;
+    }
+    /* A single tree is replicated down to where it branches. */
+    while ( nr == 1 ) {
+	k = roots[0];
+	G->s[k].tree = h;
+	roots = &cidx[cptr[k]];
+	nr = cptr[k+1] - cptr[k];
+    }
+    if ( nr == 0 ) return;
+
+    S = (long *) malloc(3 * nr * sizeof(long));
+    A = S + nr;
+    B = A + nr;
+    /* Greedy: heaviest remaining subtree to the lighter half. */
+    for (i = 0; i < nr; ++i) {
+	k = roots[i];
+	for (j = i; j > 0 && wt[S[j-1]] < wt[k]; --j) S[j] = S[j-1];
+	S[j] = k;
+    }
+    for (i = 0; i < nr; ++i) {
+	k = S[i];
+	if ( wa <= wb ) { A[na++] = k; wa += wt[k]; }
+	else            { B[nb++] = k; wb += wt[k]; }
+    }
+    part_forest(G, cptr, cidx, wt, A, na, 2 * h + 1, cnt / 2);
+    part_forest(G, cptr, cidx, wt, B, nb, 2 * h + 2, cnt / 2);
+    free(S);
+}
+
+static void make_forests(sim_graph_t *G, int Pz)
+{
+    long ns = G->nsupers, k, p, nr = 0;
+    long *cptr = (long *) calloc(ns + 1, sizeof(long));
+    long *cidx = (long *) malloc((ns + 1) * sizeof(long));
+    long *fill = (long *) calloc(ns + 1, sizeof(long));
+    long *roots = (long *) malloc((ns + 1) * sizeof(long));
+    double *wt = (double *) calloc(ns, sizeof(double));
+
+    for (k = 0; k < ns; ++k) {
+	G->s[k].tree = 0;
+	wt[k] += G->s[k].flops;
+	p = G->s[k].parent;
+	if ( p >= 0 ) { ++cptr[p + 1]; wt[p] += wt[k]; }
+	else roots[nr++] = k;
+    }
+    for (k = 0; k < ns; ++k) cptr[k+1] += cptr[k];
+    for (k = 0; k < ns; ++k)
+	if ( (p = G->s[k].parent) >= 0 ) cidx[cptr[p] + fill[p]++] = k;
+    if ( Pz > 1 ) part_forest(G, cptr, cidx, wt, roots, nr, 0, Pz);
+    free(cptr); free(cidx); free(fill); free(roots); free(wt);
+}
+
+/* Min-heap of the ready panels, keyed by ready time, then number. */
+static int earlier(double *ready, long a, long b)
+{
+    return ready[a] < ready[b] || (ready[a] == ready[b] && a < b);
+}
+
+static void heap_push(long *heap, long *nh, long k, double *ready)
+{
+    long i = (*nh)++, up;
+    for (; i > 0 && earlier(ready, k, heap[up = (i - 1) / 2]); i = up)
+	heap[i] = heap[up];
+    heap[i] = k;
+}
+
+static long heap_pop(long *heap, long *nh, double *ready)
+{
+    long top = heap[0], k = heap[--*nh], i = 0, c;
+    while ( (c = 2 * i + 1) < *nh ) {
+	if ( c + 1 < *nh && earlier(ready, heap[c+1], heap[c]) ) ++c;
+	if ( !earlier(ready, heap[c], k) ) break;
+	heap[i] = heap[c];
+	i = c;
+    }
+    heap[i] = k;
+    return top;
+}
+
+/*! \brief Replay panel k and its Schur update on the layer's grid. */
+static void sim_panel(sim_graph_t *G, sim_model_t *M, sim_layer_t *L,
+		      long k, double *ready, sim_trace_t *tr, double *scratch,
+		      int *touched, double *comm)
+{
+    sim_snode_t *s = &G->s[k];
+    int Pr = M->Pr, Pc = M->Pc, la = M->la;
+    int dr = k % Pr, dc = k % Pc, d = dr * Pc + dc, pr, pc, p, nt = 0;
+    double w = s->ncols, ds = G->dsize, rate = M->rate;
+    double *mrows = scratch, *nnzU = mrows + Pr, *arrL = nnzU + Pc;
+    double *arrU = arrL + Pr, *Fc = arrU + Pc, *Fb = Fc + Pr * Pc;
+    double *finc = Fb + Pr * Pc, *finb = finc + Pr * Pc;
+    double t0, t1, dfin, dcol, drow, f, bytes, pfin;
+    long i, j, bi, bj, t;
+
+    /* Diagonal block, then broadcast along its row and column. */
+    L->cur = k;
+    t0 = dmax(ready[k], avail(L, d, la));
+    tr[k].busy_by = t0 > ready[k] ? L->owner[d] : -1;
+    dfin = t0 + fw * 2. / 3. * w * w * w / rate;
+    charge(L, d, t0, dfin);
+    tr[k].ready = ready[k];
+    tr[k].start = t0;
+    bytes = w * w * ds;
+    dcol = dfin + hops(Pr) * (M->alpha + M->beta * bytes);
+    drow = dfin + hops(Pc) * (M->alpha + M->beta * bytes);
+    *comm += bytes * (Pr + Pc - 2);
+    pfin = dfin;
+
+    for (pr = 0; pr < Pr; ++pr) { mrows[pr] = 0.; arrL[pr] = 0.; }
+    for (pc = 0; pc < Pc; ++pc) { nnzU[pc] = 0.; arrU[pc] = 0.; }
+    for (i = 0; i < s->nl; ++i) mrows[s->l[i].blk % Pr] += s->l[i].len;
+    for (j = 0; j < s->nu; ++j) nnzU[s->u[j].blk % Pc] += s->u[j].len;
+
+    /* Panel solves; L(:,k) goes along rows, U(k,:) down columns. */
+    for (pr = 0; pr < Pr; ++pr) {
+	if ( mrows[pr] == 0. ) continue;
+	p = pr * Pc + dc;
+	t0 = dmax(pr == dr ? dfin : dcol, avail(L, p, la));
+	t1 = t0 + fw * w * w * mrows[pr] / rate;
+	charge(L, p, t0, t1);
+	pfin = dmax(pfin, t1);
+	bytes = mrows[pr] * w * ds;
+	arrL[pr] = t1 + hops(Pc) * (M->alpha + M->beta * bytes);
+	*comm += bytes * (Pc - 1);
+    }
+    for (pc = 0; pc < Pc; ++pc) {
+	if ( nnzU[pc] == 0. ) continue;
+	p = dr * Pc + pc;
+	t0 = dmax(pc == dc ? dfin : drow, avail(L, p, la));
+	t1 = t0 + fw * w * nnzU[pc] / rate;
+	charge(L, p, t0, t1);
+	pfin = dmax(pfin, t1);
+	bytes = nnzU[pc] * ds;
+	arrU[pc] = t1 + hops(Pr) * (M->alpha + M->beta * bytes);
+	*comm += bytes * (Pr - 1);
+    }
+    tr[k].fin = pfin;
+    tr[k].sent = pfin;
+
+    /* Schur update, look-ahead part first. */
+    for (i = 0; i < s->nl; ++i) {
+	bi = s->l[i].blk;
+	for (j = 0; j < s->nu; ++j) {
+	    bj = s->u[j].blk;
+	    p = (bi % Pr) * Pc + bj % Pc;
+	    if ( Fc[p] == 0. && Fb[p] == 0. ) touched[nt++] = p;
+	    f = 2. * fw * s->l[i].len * s->u[j].len;
+	    if ( la > 0 && (bi < bj ? bi : bj) <= k + la ) Fc[p] += f;
+	    else Fb[p] += f;
+	}
+    }
+    for (i = 0; i < nt; ++i) {
+	p = touched[i];
+	pr = p / Pc;
+	pc = p % Pc;
+	t0 = dmax(arrL[pr], arrU[pc]);
+	tr[k].sent = dmax(tr[k].sent, t0);
+	if ( Fc[p] > 0. ) {
+	    t1 = dmax(t0, avail(L, p, la));
+	    charge(L, p, t1, t1 + Fc[p] / rate);
+	    finc[p] = t1 + Fc[p] / rate;
+	}
+	if ( Fb[p] > 0. ) {
+	    touch(L, p);
+	    L->tb[p] = dmax(t0, L->tb[p]) + Fb[p] / rate;
+	    L->busy[p] += Fb[p] / rate;
+	    finb[p] = L->tb[p];
+	}
+    }
+    for (i = 0; i < s->nl; ++i) {
+	bi = s->l[i].blk;
+	for (j = 0; j < s->nu; ++j) {
+	    bj = s->u[j].blk;
+	    p = (bi % Pr) * Pc + bj % Pc;
+	    t = bi < bj ? bi : bj;
+	    t1 = (la > 0 && t <= k + la) ? finc[p] : finb[p];
+	    if ( t1 > ready[t] ) { ready[t] = t1; tr[t].pred = k; }
+	}
+    }
+    for (i = 0; i < nt; ++i) {
+	p = touched[i];
+	Fc[p] = Fb[p] = finc[p] = finb[p] = 0.;
+    }
+    ++L->step;
+}
+
+int main(int argc, char *argv[])
+{
+    sim_graph_t G;
+    sim_model_t M;
+    sim_layer_t *lay;
+    sim_trace_t *tr;
+    char *fname = NULL;
+    int i, g, lvl, maxLvl, P, span, threads = 1, *touched;
+    long j, k, h, nf, next, *cnt, **list, *path, npath;
+    long *npred, *heap, nh, nk;
+    double gflops = 10., alpha_us = 2., bw = 10., tflops = 0., comm = 0.;
+    double *ready, *scratch, *anc, T = 0., bmax = 0., bsum = 0., red = 0.;
+    double c_panel = 0., c_busy = 0., c_comm = 0., c_upd = 0., tail, t, *cost;
+
+    M.la = 10;
+    M.topk = 10;
+    M.Pr = M.Pc = M.Pz = 0;
+    for (i = 1; i < argc; ++i) {
+	if ( !strcmp(argv[i], "-h") ) { fname = NULL; break; }
+	if ( argv[i][0] == '-' && i + 1 < argc ) {
+	    switch ( argv[i][1] ) {
+	    case 'r': M.Pr = atoi(argv[++i]); break;
+	    case 'c': M.Pc = atoi(argv[++i]); break;
+	    case 'd': M.Pz = atoi(argv[++i]); break;
+	    case 'l': M.la = atoi(argv[++i]); break;
+	    case 't': threads = atoi(argv[++i]); break;
+	    case 'f': gflops = atof(argv[++i]); break;
+	    case 'a': alpha_us = atof(argv[++i]); break;
+	    case 'b': bw = atof(argv[++i]); break;
+	    case 'k': M.topk = atoi(argv[++i]); break;
+	    default:
+		fprintf(stderr, "tasksim: unknown option %s\n", argv[i]);
+		return 1;
+	    }
+	} else fname = argv[i];
+    }
+    if ( !fname ) {
+	fprintf(stderr, "Usage: %s [-r nprow] [-c npcol] [-d npdep] "
+		"[-l lookahead] [-t cores] [-f Gflop/s] [-a us] [-b GB/s] "
+		"[-k n] <task graph file>\n", argv[0]);
+	return 1;
+    }
+
+    read_graph(fname, &G);
+    if ( G.n <= 0 || G.nsupers <= 0 || G.nsupers > G.n || G.dsize <= 0
+	 || G.nprow <= 0 || G.npcol <= 0 || G.npdep <= 0 ) {
+	fprintf(stderr, "tasksim: malformed task graph (header)\n");
+	return 1;
+    }
+    if ( M.Pr <= 0 ) M.Pr = G.nprow;
+    if ( M.Pc <= 0 ) M.Pc = G.npcol;
+    if ( M.Pz <= 0 ) M.Pz = G.npdep;
+    if ( M.Pz & (M.Pz - 1) ) {
+	fprintf(stderr, "tasksim: npdep must be a power of 2\n");
+	return 1;
+    }
+    if ( M.la < 0 ) M.la = 0;
+    if ( M.Pz != G.npdep ) make_forests(&G, M.Pz);
+    M.rate = gflops * 1e9 * threads;
+    M.alpha = alpha_us * 1e-6;
+    M.beta = 1. / (bw * 1e9);
+    fw = G.is_complex ? 4. : 1.;
+    W = M.la + 2;
+    P = M.Pr * M.Pc;
+    for (maxLvl = 1; (1 << (maxLvl - 1)) < M.Pz; ++maxLvl) ;
+
+    /* Panels of each forest, in elimination order. */
+    nf = 2 * M.Pz - 1;
+    cnt = (long *) calloc(nf + 1, sizeof(long));
+    list = (long **) malloc(nf * sizeof(long *));
+    anc = (double *) calloc(nf, sizeof(double));
+    for (k = 0; k < G.nsupers; ++k) {
+	if ( G.s[k].tree < 0 || G.s[k].tree >= nf ) read_error("tree");
+	++cnt[G.s[k].tree];
+	anc[G.s[k].tree] += G.s[k].bytes;
+	tflops += G.s[k].flops;
+    }
+    for (h = 0; h < nf; ++h) {
+	list[h] = (long *) malloc((cnt[h] + 1) * sizeof(long));
+	cnt[h] = 0;
+    }
+    for (k = 0; k < G.nsupers; ++k) list[G.s[k].tree][cnt[G.s[k].tree]++] = k;
+    for (h = 1; h < nf; ++h) anc[h] += anc[(h - 1) / 2]; /* path to root */
+
+    lay = (sim_layer_t *) malloc(M.Pz * sizeof(sim_layer_t));
+    for (g = 0; g < M.Pz; ++g) {
+	lay[g].tb = (double *) calloc(4 * P + (size_t) P * W, sizeof(double));
+	lay[g].tc = lay[g].tb + P;
+	lay[g].busy = lay[g].tc + P;
+	lay[g].ring = lay[g].busy + P;
+	lay[g].last = (long *) calloc(2 * (size_t) P, sizeof(long));
+	lay[g].owner = lay[g].last + P;
+	for (i = 0; i < P; ++i) lay[g].owner[i] = -1;
+	lay[g].step = 0;
+    }
+    ready = (double *) calloc(G.nsupers, sizeof(double));
+    tr = (sim_trace_t *) calloc(G.nsupers, sizeof(sim_trace_t));
+    for (k = 0; k < G.nsupers; ++k) tr[k].pred = -1;
+    scratch = (double *) calloc(2 * (M.Pr + M.Pc) + 4 * (size_t) P,
+				sizeof(double));
+    touched = (int *) malloc(P * sizeof(int));
+    npred = (long *) calloc(G.nsupers, sizeof(long));
+    heap = (long *) malloc(G.nsupers * sizeof(long));
+    for (k = 0; k < G.nsupers; ++k)
+	for (j = 0; j < G.s[k].ne; ++j) ++npred[G.s[k].e[j]];
+
+    /* Leaves first; after each level the ancestor blocks are summed
+       into the lower layer of every pair, which carries on. */
+    for (lvl = 0; lvl < maxLvl; ++lvl) {
+	span = 1 << lvl;
+	for (g = 0; g < M.Pz; g += span) {
+	    for (h = M.Pz - 1 + g, i = 0; i < lvl; ++i) h = (h - 1) / 2;
+	    /* The predecessors in lower forests are all done by now. */
+	    for (nh = 0, j = 0; j < cnt[h]; ++j)
+		if ( !npred[list[h][j]] ) heap_push(heap, &nh, list[h][j], ready);
+	    for (nk = 0; nh; ++nk) {
+		k = heap_pop(heap, &nh, ready);
+		sim_panel(&G, &M, &lay[g], k, ready, tr, scratch, touched,
+			  &comm);
+		for (j = 0; j < G.s[k].ne; ++j) {
+		    next = G.s[k].e[j];
+		    if ( !--npred[next] && G.s[next].tree == h )
+			heap_push(heap, &nh, next, ready);
+		}
+	    }
+	    if ( nk < cnt[h] ) {
+		fprintf(stderr, "tasksim: the e edges do not match the "
+			"forests\n");
+		return 1;
+	    }
+	}
+	if ( lvl == maxLvl - 1 ) break;
+	for (g = 0; g < M.Pz; g += 2 * span) {
+	    double bytes, t, t1;
+	    for (h = M.Pz - 1 + g, i = 0; i <= lvl; ++i) h = (h - 1) / 2;
+	    bytes = anc[h] / P;
+	    for (i = 0; i < P; ++i) {
+		t = dmax(lay[g].tb[i], lay[g + span].tb[i]);
+		t1 = t + M.alpha + M.beta * bytes
+		   + fw * bytes / G.dsize / M.rate;
+		if ( lay[g + span].tb[i] > lay[g].tb[i] )
+		    lay[g].cur = lay[g + span].owner[i];
+		else
+		    lay[g].cur = lay[g].owner[i];
+		touch(&lay[g], i);
+		lay[g].tb[i] = lay[g].tc[i] = t1;
+		lay[g].busy[i] += t1 - t;
+		red = dmax(red, t1 - t);
+	    }
+	    comm += anc[h];
+	}
+    }
+
+    for (g = 0; g < M.Pz; ++g)
+	for (i = 0; i < P; ++i) {
+	    T = dmax(T, lay[g].tb[i]);
+	    bmax = dmax(bmax, lay[g].busy[i]);
+	    bsum += lay[g].busy[i];
+	}
+
+    printf("Task graph   : n %ld, %ld supernodes, %.3e flops\n",
+	   G.n, G.nsupers, tflops);
+    printf("Machine      : %d x %d x %d processes, %d cores @ %.2f Gflop/s, "
+	   "alpha %.2f us, %.2f GB/s, look-ahead %d\n",
+	   M.Pr, M.Pc, M.Pz, threads, gflops, alpha_us, bw, M.la);
+    printf("Factor time  : %.6e s  (%.2f Gflop/s)\n", T,
+	   T > 0. ? tflops / T * 1e-9 : 0.);
+    printf("Busy time    : max %.6e s, avg %.6e s, balance %.2f\n",
+	   bmax, bsum / (P * M.Pz), bmax > 0. ? bsum / (P * M.Pz) / bmax : 1.);
+    printf("Traffic      : %.2f MB", comm * 1e-6);
+    if ( M.Pz > 1 ) printf(", longest ancestor reduction %.6e s", red);
+    printf("\n");
+
+    /* Trace back from the panel that finished last, through the update
+       that released each panel or the work that kept its owner busy. */
+    for (h = 0, k = 1; k < G.nsupers; ++k)
+	if ( tr[k].fin > tr[h].fin ) h = k;
+    tail = T - tr[h].fin;
+    path = (long *) malloc(G.nsupers * sizeof(long));
+    cost = (double *) malloc(G.nsupers * sizeof(double));
+    t = tr[h].fin; /* walks back in time, so the parts add up */
+    for (npath = 0, k = h; k >= 0; k = next, ++npath) {
+	cost[npath] = t;
+	c_panel += t - dmin(t, tr[k].start);
+	t = dmin(t, tr[k].start);
+	if ( tr[k].busy_by >= 0 ) {
+	    next = tr[k].busy_by;
+	    c_busy += t - dmin(t, tr[next].fin);
+	    t = dmin(t, tr[next].fin);
+	} else if ( (next = tr[k].pred) >= 0 ) {
+	    c_busy += t - dmin(t, tr[k].ready);
+	    t = dmin(t, tr[k].ready);
+	    c_upd += t - dmin(t, tr[next].sent);
+	    t = dmin(t, tr[next].sent);
+	    c_comm += t - dmin(t, tr[next].fin);
+	    t = dmin(t, tr[next].fin);
+	} else {
+	    c_busy += t;
+	    t = 0.;
+	}
+	path[npath] = k;
+	cost[npath] -= t;
+    }
+    printf("Critical path: %ld panels, ends at supernode %ld\n", npath, h);
+    if ( T > 0. )
+	printf("   panel %.1f%%, owner busy %.1f%%, broadcast %.1f%%, "
+	       "update %.1f%%, trailing updates %.1f%%\n",
+	       100. * c_panel / T, 100. * c_busy / T, 100. * c_comm / T,
+	       100. * c_upd / T, 100. * tail / T);
+
+    /* The panels that add most to the path. */
+    for (i = 0; i < M.topk && i < npath; ++i) {
+	for (j = i + 1; j < npath; ++j)
+	    if ( cost[j] > cost[i] ) {
+		double c = cost[i]; cost[i] = cost[j]; cost[j] = c;
+		k = path[i]; path[i] = path[j]; path[j] = k;
+	    }
+    }
+    if ( M.topk > 0 )
+	printf("   %10s %10s %8s %6s %14s %14s\n", "supernode", "fstcol",
+	       "ncols", "tree", "on path (s)", "ready at (s)");
+    for (i = 0; i < M.topk && i < npath; ++i) {
+	k = path[i];
+	printf("   %10ld %10ld %8ld %6ld %14.6e %14.6e\n", k,
+	       G.s[k].fstcol, G.s[k].ncols, G.s[k].tree, cost[i], tr[k].ready);
+    }
+    free(path);
+    free(cost);
+
+    for (g = 0; g < M.Pz; ++g) { free(lay[g].tb); free(lay[g].last); }
+    for (h = 0; h < nf; ++h) free(list[h]);
+    for (k = 0; k < G.nsupers; ++k) {
+	free(G.s[k].l); free(G.s[k].u); free(G.s[k].e);
+    }
+    free(lay); free(list); free(cnt); free(anc); free(ready); free(tr);
+    free(scratch); free(touched); free(npred); free(heap); free(G.s);
+    return 0;
+}
@@ -58,6 +58,8 @@ at the top-level directory.
 		 done in multiple partitions, may be slower.
 	    = 9: number of GPU streams
 	    = 10: whether to offload work to GPU or not
+	    = 11 - 26: the options fields of the same name; see the
+	          sp_ienv_dist() of the library, SRC/prec-independent/sp_ienv.c
 
    options (input) superlu_dist_options_t*
            The structure defines the input parameters to control
@@ -143,6 +145,22 @@ sp_ienv_dist(int ispec, superlu_dist_options_t *options)
 	    if (ttemp) 
 		return atoi (ttemp);
 	    else return (options->superlu_acc_offload);
+         case 11: return 0;
+         case 12: return (options->superlu_mem_budget);
+         case 13: return (options->superlu_propmap);
+         case 14: return (options->superlu_lookahead_adapt);
+         case 15: return (options->superlu_msg_priority);
+         case 16: return (options->superlu_progress);
+         case 17: return (options->superlu_rhs3d);
+         case 18: return (options->superlu_ruiz);
+         case 19: return (options->superlu_costmodel);
+         case 20: return (options->superlu_amalg);
+         case 21: return (options->superlu_split);
+         case 22: return (options->superlu_mf);
+         case 23: return (options->superlu_dense);
+         case 24: return (options->superlu_blocks);
+         case 25: return (options->superlu_subset);
+         case 26: return (options->superlu_cpu_batch);
     }
 
     /* Invalid value for ISPEC */
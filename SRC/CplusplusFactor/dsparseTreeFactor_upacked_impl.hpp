@@ -3,6 +3,7 @@
 #include "lupanels.hpp"
 #include "superlu_blas.hpp"
 #include "luAuxStructTemplated.hpp"
+#include "sparseTreeFactorBatchCPU_impl.hpp"
 
 template <typename Ftype>
 int_t xLUstruct_t<Ftype>::dsparseTreeFactor(
@@ -57,17 +58,33 @@ int_t xLUstruct_t<Ftype>::dsparseTreeFactor(
     int_t k_st = eTreeTopLims[topoLvl];
     int_t k_end = eTreeTopLims[topoLvl + 1];
     //TODO: make this asynchronous 
-    for (int_t k0 = k_st; k0 < k_end; k0++)
+    if (superlu_cpu_batch(options))
     {
-        int_t k = perm_c_supno[k0];
-        int_t offset = 0;
-        dDiagFactorPanelSolve(k, offset,dFBufs);
-        donePanelSolve[k0]=1;
+        /* the leaves are independent: factor them as one batch */
+        dDiagFactorPanelSolveBatch(k_st, k_end, perm_c_supno, dFBufs);
+        for (int_t k0 = k_st; k0 < k_end; k0++)
+            donePanelSolve[k0]=1;
     }
+    else
+    {
+        for (int_t k0 = k_st; k0 < k_end; k0++)
+        {
+            int_t k = perm_c_supno[k0];
+            int_t offset = 0;
+            dDiagFactorPanelSolve(k, offset,dFBufs);
+            donePanelSolve[k0]=1;
+        }
+    }
+
+    /* Each half of the buffers holds one window; with
+       SUPERLU_LOOKAHEAD_ADAPT the window is resized between 1 and numLA/2
+       from the time spent in the panel broadcasts. */
+    superlu_lookahead_t la_ctl;
+    superlu_lookahead_init(&la_ctl, options, numLA/2, 1, grid->comm);
 
     //TODO: its really the panels that needs to be doubled 
     // everything else can remain as it is 
-    int_t winSize =  SUPERLU_MIN(numLA/2, eTreeTopLims[1]);
+    int_t winSize =  SUPERLU_MIN(la_ctl.la, eTreeTopLims[1]);
     for (int k0 = k_st; k0 < winSize; ++k0)
     {
         int_t k = perm_c_supno[k0];
@@ -84,6 +101,7 @@ int_t xLUstruct_t<Ftype>::dsparseTreeFactor(
     int_t halfWin = numLA/2; 
     while(k1<nnodes)
     {
+        double t_win = SuperLU_timer_();
         for (int_t k0 = k1; k0 < SUPERLU_MIN(nnodes, k1+winSize); ++k0)
         { 
             int_t k = perm_c_supno[k0];
@@ -127,6 +145,9 @@ int_t xLUstruct_t<Ftype>::dsparseTreeFactor(
         }
 
         k1 = k1+winSize;
+        if (la_ctl.level)   /* the next window may also grow */
+            winSize = la_ctl.la;
+        double t_bcast = SuperLU_timer_();
         for (int_t k0_next = k1; k0_next < SUPERLU_MIN(nnodes, k1+winSize); ++k0_next)
         {
             int k_next = perm_c_supno[k0_next];
@@ -144,9 +165,13 @@ int_t xLUstruct_t<Ftype>::dsparseTreeFactor(
                 break; 
             }
         }
+        t_bcast = SuperLU_timer_() - t_bcast;
+        superlu_lookahead_step(&la_ctl, k1, t_bcast,
+                               SuperLU_timer_() - t_win - t_bcast);
 
         winParity++;
     }
+    superlu_lookahead_finalize(&la_ctl);
 
 #if 0
     for (int_t topoLvl = 0; topoLvl < maxTopoLevel; ++topoLvl)
@@ -8,7 +8,7 @@ xlpanel_t<Ftype>::xlpanel_t(int_t k, int_t *lsub, Ftype* lval, int_t *xsup, int_
     val = lval;
     int_t nlb = lsub[0];
     int_t nzrow = lsub[1];
-    int_t lIndexSize = LPANEL_HEADER_SIZE + 2 * nlb + 1 + nzrow;
+    int_t lIndexSize = LPANEL_HEADER_SIZE + 3 * nlb + 1 + nzrow;
     //
     index = (int_t *)SUPERLU_MALLOC(sizeof(int_t) * lIndexSize);
     index[0] = nlb;
@@ -44,20 +44,14 @@ xlpanel_t<Ftype>::xlpanel_t(int_t k, int_t *lsub, Ftype* lval, int_t *xsup, int_
         // Update the lsub_ptr
         lsub_ptr += LB_DESCRIPTOR + nrows;
     }
+    sortPanelBlocks(nlb, &index[LPANEL_HEADER_SIZE], blkOrder());
     return;
 }
 
-//TODO: can be optimized
 template <typename Ftype>
 int_t xlpanel_t<Ftype>::find(int_t k)
 {
-    for (int_t i = 0; i < nblocks(); i++)
-    {
-        if (k == gid(i))
-            return i;
-    }
-    //TODO: it shouldn't come here
-    return GLOBAL_BLOCK_NOT_FOUND;
+    return findPanelBlock(k, nblocks(), &index[LPANEL_HEADER_SIZE], blkOrder());
 }
 
 template <typename Ftype>
@@ -232,8 +232,8 @@ xLUstruct_t<Ftype>::xLUstruct_t(int_t nsupers_, int_t ldt_,
 
     for (int i = 0; i < options->num_lookaheads; i++)
     {
-        LvalRecvBufs[i] = (Ftype *)SUPERLU_MALLOC(sizeof(Ftype) * maxLvalCount);
-        UvalRecvBufs[i] = (Ftype *)SUPERLU_MALLOC(sizeof(Ftype) * maxUvalCount);
+        LvalRecvBufs[i] = panelValAlloc<Ftype>(maxLvalCount);
+        UvalRecvBufs[i] = panelValAlloc<Ftype>(maxUvalCount);
         LidxRecvBufs[i] = (int_t *)SUPERLU_MALLOC(sizeof(int_t) * maxLidxCount);
         UidxRecvBufs[i] = (int_t *)SUPERLU_MALLOC(sizeof(int_t) * maxUidxCount);
 
@@ -19,6 +19,7 @@
 #include "anc25d_impl.hpp"
 #include "dsparseTreeFactorGPU_impl.hpp"  //needed???
 #include "dsparseTreeFactor_upacked_impl.hpp"
+#include "sparseTreeFactorBatchCPU_impl.hpp"
 #include "schurCompUpdate_impl.cuh"
 #include "l_panels_impl.hpp"
 #include "u_panels_impl.hpp"
@@ -304,6 +305,10 @@ int_t xLUstruct_t<Ftype>::pdgstrf3d()
 				// Sherry commented out the following
                                 //dsparseTreeFactorBatchGPU(sforest, dFBufs, &gEtreeInfo, tag_ub);
 			    }
+                        } else if ( Pr * Pc == 1 && superlu_cpu_batch(options) ) {
+                            dsparseTreeFactorBatchCPU(sforest, dFBufs,
+                                                      &gEtreeInfo,
+                                                      tag_ub);
                         } else {
                             dsparseTreeFactor(sforest, dFBufs,
                                             &gEtreeInfo,
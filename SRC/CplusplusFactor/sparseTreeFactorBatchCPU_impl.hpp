@@ -0,0 +1,225 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "superlu_defs.h"
+#include "lupanels.hpp"
+#include "superlu_blas.hpp"
+#include "luAuxStructTemplated.hpp"
+
+/* CPU counterpart of the batched GPU tree factorization.  The supernodes
+ * of one topological level of the etree are independent, so they are
+ * factored together, one supernode per thread, instead of one after the
+ * other with a parallel loop inside each supernode.  The small leaves of
+ * a 3D forest gain the most from this.
+ *
+ * Off by default; set options->superlu_cpu_batch or SUPERLU_CPU_BATCH=1
+ * (sp_ienv_dist(26)) to use it instead of the per-supernode pipeline.
+ * EXAMPLE/CMakeLists.txt runs it in the pddrive3d_cpu_batch test of
+ * CUDA builds, the only builds that compile this code.
+ */
+
+/* One GEMM + scatter of the batched Schur complement update: the
+ * L block ii of node k0 times the U block jj of the same node.  (ib, jb)
+ * is the destination block, used to group the updates so that each
+ * destination is written by a single thread. */
+struct scuBatchTask_t
+{
+    int_t ib, jb;
+    int_t k0, ii, jj;
+};
+
+static inline bool scuBatchTaskLess(const scuBatchTask_t &a, const scuBatchTask_t &b)
+{
+    return a.ib < b.ib || (a.ib == b.ib && (a.jb < b.jb ||
+                                           (a.jb == b.jb && a.k0 < b.k0)));
+}
+
+/* Whether the level-batched CPU engine is used; see sp_ienv_dist(26). */
+static inline int superlu_cpu_batch(superlu_dist_options_t *options)
+{
+    return sp_ienv_dist(26, options) > 0;
+}
+
+/* Diagonal factorization and panel solves of nodes
+ * perm_c_supno[k_st..k_end), all independent of each other.
+ * The diagonal blocks owned by this process are factored concurrently,
+ * broadcast in order, then the L and U panels are solved concurrently.
+ */
+template <typename Ftype>
+int_t xLUstruct_t<Ftype>::dDiagFactorPanelSolveBatch(
+    int_t k_st, int_t k_end, int_t *perm_c_supno,
+    diagFactBufs_type<Ftype> **dFBufs)
+{
+    int_t nb = numDiagBufs;
+
+    for (int_t c_st = k_st; c_st < k_end; c_st += nb)
+    {
+        int_t c_end = SUPERLU_MIN(k_end, c_st + nb);
+        int_t nc = c_end - c_st;
+
+        /* Each concurrent diagFactor() updates its own copy of stat;
+         * the copies are merged into stat after the loop. */
+        std::vector<SuperLUStat_t> tstat(nc, *stat);
+        std::vector<flops_t> tops(nc * NPHASES, 0);
+        std::vector<int> tinfo(nc, 0);
+
+        /*=======   Diagonal Factorization      ======*/
+#pragma omp parallel for schedule(dynamic)
+        for (int_t k0 = c_st; k0 < c_end; ++k0)
+        {
+            int_t k = perm_c_supno[k0];
+            if (iam != procIJ(k, k))
+                continue;
+
+            int_t ksupc = SuperSize(k);
+            int_t i = k0 - c_st;
+            diagFactBufs_type<Ftype> *dFBuf = dFBufs[i];
+            tstat[i].ops = &tops[i * NPHASES];
+            tstat[i].TinyPivots = 0;
+
+            lPanelVec[g2lCol(k)].diagFactor(k, dFBuf->BlockUFactor, ksupc,
+                                            thresh, xsup, options, &tstat[i], &tinfo[i]);
+            lPanelVec[g2lCol(k)].packDiagBlock(dFBuf->BlockLFactor, ksupc);
+        }
+
+        /* Merge the statistics; info keeps the first zero pivot. */
+        for (int_t i = 0; i < nc; ++i)
+        {
+            for (int p = 0; p < NPHASES; ++p)
+                stat->ops[p] += tops[i * NPHASES + p];
+            stat->TinyPivots += tstat[i].TinyPivots;
+            if (tinfo[i] && (!*info || tinfo[i] < *info))
+                *info = tinfo[i];
+        }
+
+        /*=======   Diagonal Broadcast          ======*/
+        if (Pr * Pc > 1)
+        {
+            for (int_t k0 = c_st; k0 < c_end; ++k0)
+            {
+                int_t k = perm_c_supno[k0];
+                int_t ksupc = SuperSize(k);
+                diagFactBufs_type<Ftype> *dFBuf = dFBufs[k0 - c_st];
+                if (myrow == krow(k))
+                    MPI_Bcast((void *)dFBuf->BlockLFactor, ksupc * ksupc,
+                              get_mpi_type<Ftype>(), kcol(k), (grid->rscp).comm);
+                if (mycol == kcol(k))
+                    MPI_Bcast((void *)dFBuf->BlockUFactor, ksupc * ksupc,
+                              get_mpi_type<Ftype>(), krow(k), (grid->cscp).comm);
+            }
+        }
+
+        /*=======   Panel Update                ======*/
+#pragma omp parallel for schedule(dynamic)
+        for (int_t kk = 0; kk < 2 * (c_end - c_st); ++kk)
+        {
+            int_t k0 = c_st + kk / 2;
+            int_t k = perm_c_supno[k0];
+            int_t ksupc = SuperSize(k);
+            diagFactBufs_type<Ftype> *dFBuf = dFBufs[k0 - c_st];
+            if (kk % 2 == 0 && myrow == krow(k))
+                uPanelVec[g2lRow(k)].panelSolve(ksupc, dFBuf->BlockLFactor, ksupc);
+            if (kk % 2 == 1 && mycol == kcol(k))
+                lPanelVec[g2lCol(k)].panelSolve(ksupc, dFBuf->BlockUFactor, ksupc);
+        }
+    }
+
+    return 0;
+}
+
+/* Schur complement update of all nodes perm_c_supno[k_st..k_end) on a
+ * single-process 2D grid.  The block GEMMs of the whole level are
+ * marshalled into one task list, as marshallBatchedSCUData() does for the
+ * GPU, and sorted by destination block; each destination is then owned by
+ * one thread, so the scatters need no atomics.
+ */
+template <typename Ftype>
+int_t xLUstruct_t<Ftype>::dSchurCompUpdateBatch(
+    int_t k_st, int_t k_end, int_t *perm_c_supno)
+{
+    std::vector<scuBatchTask_t> tasks;
+
+    for (int_t k0 = k_st; k0 < k_end; ++k0)
+    {
+        int_t k = perm_c_supno[k0];
+        xlpanel_t<Ftype> &lpanel = lPanelVec[g2lCol(k)];
+        xupanel_t<Ftype> &upanel = uPanelVec[g2lRow(k)];
+        if (lpanel.isEmpty() || upanel.isEmpty())
+            continue;
+
+        int_t nlb = lpanel.nblocks();
+        int_t nub = upanel.nblocks();
+        for (int_t ii = 1; ii < nlb; ++ii)
+            for (int_t jj = 0; jj < nub; ++jj)
+                tasks.push_back({lpanel.gid(ii), upanel.gid(jj), k0, ii, jj});
+    }
+    if (tasks.empty())
+        return 0;
+
+    std::sort(tasks.begin(), tasks.end(), scuBatchTaskLess);
+
+    std::vector<int_t> groupPtr;
+    for (size_t t = 0; t < tasks.size(); ++t)
+        if (t == 0 || tasks[t].ib != tasks[t - 1].ib || tasks[t].jb != tasks[t - 1].jb)
+            groupPtr.push_back(t);
+    groupPtr.push_back(tasks.size());
+
+    int_t ngroups = groupPtr.size() - 1;
+#pragma omp parallel for schedule(dynamic)
+    for (int_t g = 0; g < ngroups; ++g)
+    {
+        for (int_t t = groupPtr[g]; t < groupPtr[g + 1]; ++t)
+        {
+            int_t k = perm_c_supno[tasks[t].k0];
+            blockUpdate(k, tasks[t].ii, tasks[t].jj,
+                        lPanelVec[g2lCol(k)], uPanelVec[g2lRow(k)]);
+        }
+    }
+
+    return 0;
+}
+
+/* Level-by-level factorization of a forest on a single-process 2D grid:
+ * each topological level is one batch of diagonal factorizations, one
+ * batch of panel solves and one batch of Schur complement updates.
+ */
+template <typename Ftype>
+int_t xLUstruct_t<Ftype>::dsparseTreeFactorBatchCPU(
+    sForest_t *sforest,
+    diagFactBufs_type<Ftype> **dFBufs, // size maxEtree level
+    gEtreeInfo_t *gEtreeInfo,          // global etree info
+    int tag_ub)
+{
+    int_t nnodes = sforest->nNodes; // number of nodes in the tree
+    if (nnodes < 1)
+    {
+        return 1;
+    }
+
+#if (DEBUGlevel >= 1)
+    CHECK_MALLOC(grid3d->iam, "Enter dsparseTreeFactorBatchCPU()");
+#endif
+
+    int_t *perm_c_supno = sforest->nodeList; // list of nodes in the order of factorization
+    treeTopoInfo_t *treeTopoInfo = &sforest->topoInfo;
+    int_t maxTopoLevel = treeTopoInfo->numLvl;
+    int_t *eTreeTopLims = treeTopoInfo->eTreeTopLims;
+
+    for (int_t topoLvl = 0; topoLvl < maxTopoLevel; ++topoLvl)
+    {
+        int_t k_st = eTreeTopLims[topoLvl];
+        int_t k_end = eTreeTopLims[topoLvl + 1];
+
+        dDiagFactorPanelSolveBatch(k_st, k_end, perm_c_supno, dFBufs);
+
+        double tsch = SuperLU_timer_();
+        dSchurCompUpdateBatch(k_st, k_end, perm_c_supno);
+        SCT->NetSchurUpTimer += SuperLU_timer_() - tsch;
+    } /*for topoLvl = 0:maxTopoLevel*/
+
+#if (DEBUGlevel >= 1)
+    CHECK_MALLOC(grid3d->iam, "Exit dsparseTreeFactorBatchCPU()");
+#endif
+
+    return 0;
+} /* dsparseTreeFactorBatchCPU */
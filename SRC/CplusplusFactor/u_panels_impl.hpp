@@ -25,10 +25,10 @@ xupanel_t<Ftype>::xupanel_t(int_t k, int_t *usub, Ftype *uval, int_t *xsup)
         usubPtr += UB_DESCRIPTOR + gsupc;
     }
 
-    int_t uIndexSize = UPANEL_HEADER_SIZE + 2 * nub + 1 + nonZeroCols;
+    int_t uIndexSize = UPANEL_HEADER_SIZE + 3 * nub + 1 + nonZeroCols;
     //Allocating the index and val
     index = (int_t*) SUPERLU_MALLOC(sizeof(int_t) * uIndexSize);
-    val = (Ftype *)SUPERLU_MALLOC(sizeof(Ftype) * nonZeroCols * kSupSz);
+    val = panelValAlloc<Ftype>(nonZeroCols * kSupSz);
     index[0] = nub;
     index[1] = nonZeroCols;
     index[2] = kSupSz;
@@ -68,6 +68,7 @@ xupanel_t<Ftype>::xupanel_t(int_t k, int_t *usub, Ftype *uval, int_t *xsup)
         pxSumPtr++;
         usubPtr += UB_DESCRIPTOR + gsupc;
     }
+    sortPanelBlocks(nub, &index[UPANEL_HEADER_SIZE], blkOrder());
 
     return;
 }
@@ -111,14 +112,7 @@ int_t xupanel_t<Ftype>::packed2skyline(int_t k, int_t *usub, Ftype *uval, int_t*
 template <typename Ftype>
 int_t xupanel_t<Ftype>::find(int_t k)
 {
-    //TODO: possible to optimize
-    for (int_t i = 0; i < nblocks(); i++)
-    {
-        if (k == gid(i))
-            return i;
-    }
-    //TODO: it shouldn't come here
-    return GLOBAL_BLOCK_NOT_FOUND;
+    return findPanelBlock(k, nblocks(), &index[UPANEL_HEADER_SIZE], blkOrder());
 }
 template <typename Ftype>
 int_t xupanel_t<Ftype>::panelSolve(int_t ksupsz, Ftype *DiagBlk, int_t LDD)
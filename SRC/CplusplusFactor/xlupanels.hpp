@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <iostream>
+#include <algorithm>
 #include "superlu_ddefs.h"   // superlu_defs.h ??
 #include "lu_common.hpp"
 #ifdef HAVE_CUDA
@@ -16,6 +17,57 @@
 #define GLOBAL_BLOCK_NOT_FOUND -1
 // it can be templatized for Ftype and complex Ftype
 
+/* Panel blocks are kept in the order of the Lrowind_bc_ptr/Ufstnz_br_ptr
+ * structures, which is not the order of their global ids.  The index of a
+ * panel therefore ends with the local block numbers sorted by global id,
+ * and find() is a binary search over them. */
+#define PANEL_FIND_LINEAR 8     /* panels this small are searched linearly */
+#define PANEL_VAL_ALIGN 64      /* cache line, and the widest SIMD register */
+
+inline void sortPanelBlocks(int_t nb, int_t *gids, int_t *blkOrder)
+{
+    for (int_t i = 0; i < nb; i++)
+        blkOrder[i] = i;
+    std::sort(blkOrder, blkOrder + nb,
+              [gids](int_t a, int_t b) { return gids[a] < gids[b]; });
+}
+
+inline int_t findPanelBlock(int_t k, int_t nb, int_t *gids, int_t *blkOrder)
+{
+    if (nb <= PANEL_FIND_LINEAR)
+    {
+        for (int_t i = 0; i < nb; i++)
+            if (k == gids[i])
+                return i;
+        return GLOBAL_BLOCK_NOT_FOUND;
+    }
+    int_t lo = 0, hi = nb;
+    while (lo < hi)
+    {
+        int_t mid = lo + (hi - lo) / 2;
+        if (gids[blkOrder[mid]] < k)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo < nb && gids[blkOrder[lo]] == k)
+        return blkOrder[lo];
+    return GLOBAL_BLOCK_NOT_FOUND;
+}
+
+/* Values of the panels owned by xLUstruct_t and of the panel receive
+ * buffers start on a PANEL_VAL_ALIGN boundary. */
+template <typename Ftype>
+Ftype *panelValAlloc(size_t n)
+{
+    void *p = NULL;
+    if (posix_memalign(&p, PANEL_VAL_ALIGN, SUPERLU_MAX(n, 1) * sizeof(Ftype)))
+        ABORT("Malloc fails for panel values.");
+    return (Ftype *)p;
+}
+
+inline void panelValFree(void *p) { free(p); }
+
 
 template <typename Ftype>
 class xlpanel_t
@@ -98,6 +150,11 @@ public:
     }
 
     int_t LDA() { return index[1]; }
+    // local block numbers in increasing order of global id
+    int_t *blkOrder()
+    {
+        return &index[LPANEL_HEADER_SIZE + 2 * nblocks() + 1 + nzrows()];
+    }
     int_t find(int_t k);
     // for L panel I don't need any special transformation function
     int_t panelSolve(int_t ksupsz, Ftype *DiagBlk, int_t LDD);
@@ -116,7 +173,7 @@ public:
     {
         if (index == NULL)
             return 0;
-        return LPANEL_HEADER_SIZE + 2 * nblocks() + 1 + nzrows();
+        return LPANEL_HEADER_SIZE + 3 * nblocks() + 1 + nzrows();
     }
 
     size_t totalSize()
@@ -254,6 +311,11 @@ public:
 
     // Ftype* blkPtr(int_t k);
     // int_t LDA();
+    // local block numbers in increasing order of global id
+    int_t *blkOrder()
+    {
+        return &index[UPANEL_HEADER_SIZE + 2 * nblocks() + 1 + nzcols()];
+    }
     int_t find(int_t k);
     int_t isEmpty() { return index == NULL; }
     int_t nzvalSize()
@@ -267,7 +329,7 @@ public:
     {
         if (index == NULL)
             return 0;
-        return UPANEL_HEADER_SIZE + 2 * nblocks() + 1 + nzcols();
+        return UPANEL_HEADER_SIZE + 3 * nblocks() + 1 + nzcols();
     }
     size_t totalSize()
     {
@@ -289,7 +351,7 @@ public:
             exit(-1);
         }
 
-        return UPANEL_HEADER_SIZE + 2 * nblocks() + 1 + nzcols();
+        return UPANEL_HEADER_SIZE + 3 * nblocks() + 1 + nzcols();
     }
 
     int_t stCol(int k)
@@ -459,7 +521,7 @@ struct xLUstruct_t
                 if (uPanelVec[i].index)
                     SUPERLU_FREE(uPanelVec[i].index);
                 if (uPanelVec[i].val)
-                    SUPERLU_FREE(uPanelVec[i].val);
+                    panelValFree(uPanelVec[i].val);
             }
 
         delete[] lPanelVec;
@@ -477,8 +539,8 @@ struct xLUstruct_t
         int i;
         for (i = 0; i < options->num_lookaheads; i++)
         {
-            SUPERLU_FREE(LvalRecvBufs[i]);
-            SUPERLU_FREE(UvalRecvBufs[i]);
+            panelValFree(LvalRecvBufs[i]);
+            panelValFree(UvalRecvBufs[i]);
             SUPERLU_FREE(LidxRecvBufs[i]);
             SUPERLU_FREE(UidxRecvBufs[i]);
         }
@@ -540,6 +602,16 @@ struct xLUstruct_t
         gEtreeInfo_t *gEtreeInfo, // global etree info
         int tag_ub);
 
+    // Level-batched CPU factorization, see sparseTreeFactorBatchCPU_impl.hpp
+    int_t dsparseTreeFactorBatchCPU(
+        sForest_t *sforest,
+        diagFactBufs_type<Ftype>** dFBufs, // size maxEtree level
+        gEtreeInfo_t *gEtreeInfo, // global etree info
+        int tag_ub);
+    int_t dDiagFactorPanelSolveBatch(int_t k_st, int_t k_end, int_t *perm_c_supno,
+                                     diagFactBufs_type<Ftype>** dFBufs);
+    int_t dSchurCompUpdateBatch(int_t k_st, int_t k_end, int_t *perm_c_supno);
+
     diagFactBufs_type<Ftype>** initDiagFactBufsArr(int_t mxLeafNode, int_t ldt);
 
     // Helper routine to marshall batch LU data into the device data in A_gpu
@@ -127,7 +127,7 @@ class xlpanelGPU_t
         {
             if (index == NULL)
                 return 0;
-            return LPANEL_HEADER_SIZE + 2 * nblocks() + 1 + nzrows();
+            return LPANEL_HEADER_SIZE + 3 * nblocks() + 1 + nzrows();
         }
     
         // return the maximal iEnd such that stRow(iEnd)-stRow(iSt) < maxRow;
@@ -266,7 +266,7 @@ public:
     {
         if (index == NULL)
             return 0;
-        return UPANEL_HEADER_SIZE + 2 * nblocks() + 1 + nzcols();
+        return UPANEL_HEADER_SIZE + 3 * nblocks() + 1 + nzcols();
     }
 
     CUDA_CALLABLE
@@ -179,6 +179,17 @@ at the top-level directory.
  *                            equilibrated and row permuted
  *        o  LUstruct, modified to contain the new L and U factors
  *
+ *      If options->superlu_subset is set and LUstruct still holds the
+ *      L and U factors of the previous matrix, that is, zDestroy_LU() is
+ *      not called in between, they are checked first.  When every entry
+ *      of A, permuted by the previous ScalePermstruct->perm_r and perm_c,
+ *      falls in the structure of those factors, the row permutation and
+ *      the symbolic factorization are kept and A is factored as with
+ *      SamePattern_SameRowPerm, including the reuse of R and C.  New
+ *      entries then take the place of fill or explicit zeros.  Otherwise
+ *      the old factors are freed and A is factored as above.
+ *      options->Fact is left unchanged.
+ *
  *   4. The third value of options->Fact assumes that a matrix B with the same
  *      sparsity pattern as A has already been factored, and where the
  *      row permutation of B can be reused for A. This is useful when A and B
@@ -336,6 +347,10 @@ at the top-level directory.
  *           = MMD_AT_PLUS_A: minimum degree ordering on structure of A'+A.
  *           = MMD_ATA:       minimum degree ordering on structure of A'*A.
  *           = MY_PERMC:      the ordering given in ScalePermstruct->perm_c.
+ *           Except for NATURAL and MY_PERMC, the rows and columns found dense
+ *           by sp_ienv_dist(23) are left out and ordered last, and with
+ *           sp_ienv_dist(24) the decoupled blocks are ordered each on its
+ *           own; see get_perm_c_dense_dist().
  *
  *         o ReplaceTinyPivot (yes_no_t)
  *           = NO:  do not modify pivots
@@ -454,7 +469,10 @@ at the top-level directory.
  *           with the same nonzero pattern.
  *           On exit of sp_colorder(), the columns of A are permuted so that
  *           the etree is in a certain postorder. This postorder is reflected
- *           in ScalePermstruct->perm_c.
+ *           in ScalePermstruct->perm_c.  If options->superlu_propmap is
+ *           set, the postorder is replaced after symbolic factorization by
+ *           a topological order that maps the subtrees proportionally onto
+ *           the process grid; see superlu_propmap().
  *           NOTE:
  *           Etree is a vector of parent pointers for a forest whose vertices
  *           are the integers 0 to A->ncol-1; etree[root]==A->ncol.
@@ -496,6 +514,10 @@ at the top-level directory.
  *                so the solution could not be computed.
  *             > A->ncol: number of bytes allocated when memory allocation
  *                failure occurred, plus A->ncol.
+ *                If a memory budget is set (options->superlu_mem_budget)
+ *                and cannot be met, the MB needed per process, plus
+ *                A->ncol; see superlu_plan_memory().  LUstruct then
+ *                holds no factors and zDestroy_LU() does nothing.
  *
  * See superlu_zdefs.h for the definitions of various data types.
  * </pre>
@@ -528,11 +550,18 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	      If options->Fact == SamePattern_SameRowPerm, these
 	      structures are not used.                                  */
     fact_t  Fact;
+    int_t   nmiss = SLU_EMPTY; /* entries of A outside the old L and U */
+    /* Options the memory plan lowers for this call only. */
+    int     num_lookaheads = options->num_lookaheads;
+    int     max_buffer_size = options->superlu_max_buffer_size;
     doublecomplex *a;
     int_t   *colptr, *rowind;
     int_t   *perm_r; /* row permutations from partial pivoting */
     int_t   *perm_c; /* column permutation vector */
     int_t   *etree;  /* elimination tree */
+    char    *tgfile; /* task graph export, see superlu_write_taskgraph() */
+    int_t   *propmap_q; /* supernode renumbering, see superlu_propmap() */
+    yes_no_t print_stat; /* options->PrintStat around the second symbfact() */
     int_t   *rowptr, *colind;  /* Local A in NR*/
     int_t   nnz_loc, nnz;
     int     m_loc, fst_row, icol, iinfo;
@@ -618,11 +647,37 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	return;
     }
 
+    /* Region profiler, off unless SUPERLU_PROFILE > 0. */
+    superlu_prof_init(options, stat);
+
     factored = (Fact == FACTORED);
     Equil = (!factored && options->Equil == YES);
     notran = (options->Trans == NOTRANS);
     parSymbFact = options->ParSymbFact;
 
+    /* Keep the previous row permutation and L and U structure if A fits
+       in them.  A caller that destroyed the factors, as for a plain
+       SamePattern, gets the plain SamePattern path. */
+    if ( Fact == SamePattern && options->superlu_subset
+	 && LUstruct->Llu->Lrowind_bc_ptr ) {
+	t = SuperLU_timer_();
+	nmiss = (parSymbFact == NO) ?
+	    pzcheck_LU_pattern(A, ScalePermstruct, LUstruct, grid) : 1;
+	if ( nmiss == 0 ) Fact = SamePattern_SameRowPerm;
+	else zDestroy_LU(n, grid, LUstruct);
+	if ( !grid->iam && options->PrintStat == YES ) {
+	    printf("\tSamePattern subset: " IFMT " entries outside L and U, %s"
+		   " (%.2f s)\n", nmiss,
+		   nmiss ? "new symbolic factorization" : "structure kept",
+		   SuperLU_timer_() - t);
+	    fflush(stdout);
+	}
+    }
+
+    /* The etree weights may use the calibrated cost model. */
+    if ( !factored )
+	superlu_costmodel_setup(options, &LUstruct->costmodel, grid->comm);
+
     iam = grid->iam;
     job = 5;
     if ( factored || (Fact == SamePattern_SameRowPerm && Equil) ) {
@@ -680,6 +735,7 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	CHECK_MALLOC(iam, "Enter equil");
 #endif
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "equil");
 
 	if ( Fact == SamePattern_SameRowPerm ) {
 	    /* Reuse R and C. */
@@ -716,7 +772,11 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    }
 	} else { /* Compute R & C from scratch */
             /* Compute the row and column scalings. */
-	    pzgsequ(A, R, C, &rowcnd, &colcnd, &amax, &iinfo, grid);
+	    if ( sp_ienv_dist(18, options) > 0 )
+		pzgsequ_ruiz(A, R, C, sp_ienv_dist(18, options), &rowcnd,
+			       &colcnd, &amax, &iinfo, grid);
+	    else
+		pzgsequ(A, R, C, &rowcnd, &colcnd, &amax, &iinfo, grid);
 
 	    if ( iinfo > 0 ) {
 		if ( iinfo <= m ) {
@@ -724,7 +784,10 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 		} else {
                     fprintf(stderr, "The %d-th column of A is exactly zero\n", (int)(iinfo-n));
                 }
- 	    } else if ( iinfo < 0 ) return;
+ 	    } else if ( iinfo < 0 ) {
+		SUPERLU_PROF_END(stat, "equil");
+		return;
+	    }
 
 	    /* Now iinfo == 0 */
 
@@ -752,6 +815,7 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 #endif
 	} /* end if Fact ... */
 
+	SUPERLU_PROF_END(stat, "equil");
 	stat->utime[EQUIL] = SuperLU_timer_() - t;
 #if ( DEBUGlevel>=1 )
 	CHECK_MALLOC(iam, "Exit equil");
@@ -792,6 +856,7 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
         if ( options->RowPerm != NO ) {
 	    t = SuperLU_timer_();
 	    if ( Fact != SamePattern_SameRowPerm ) {
+	        SUPERLU_PROF_BEGIN(stat, "rowperm");
 	        if ( options->RowPerm == MY_PERMR ) { /* Use user's perm_r. */
 	            /* Permute the global matrix GA for symbfact() */
 	            for (i = 0; i < colptr[n]; ++i) {
@@ -922,6 +987,7 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 #endif
                 } /* end if options->RowPerm ... */
 
+	        SUPERLU_PROF_END(stat, "rowperm");
 	        t = SuperLU_timer_() - t;
 	        stat->utime[ROWPERM] = t;
 #if ( PRNTlevel>=1 )
@@ -957,6 +1023,7 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
        ------------------------------------------------------------*/
     if ( !factored ) {
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "colperm");
 	/*
 	 * Get column permutation vector perm_c[], according to permc_spec:
 	 *   permc_spec = NATURAL:  natural ordering
@@ -1019,13 +1086,15 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	      if (flinfo > 0) {
 	          fprintf(stderr, "Insufficient memory for get_perm_c parmetis\n");
 		  *info = flinfo;
+		  SUPERLU_PROF_END(stat, "colperm");
 		  return;
      	      }
 	  } else {
-	      get_perm_c_dist(iam, permc_spec, &GA, perm_c);
+	      get_perm_c_dense_dist(options, iam, permc_spec, &GA, perm_c);
           }
         }
 
+	SUPERLU_PROF_END(stat, "colperm");
 	stat->utime[COLPERM] = SuperLU_timer_() - t;
 
 	/* Symbolic factorization. */
@@ -1063,6 +1132,7 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	        }
 #endif
   	        t = SuperLU_timer_();
+  	        SUPERLU_PROF_BEGIN(stat, "symbfact");
 	        if ( !(Glu_freeable = (Glu_freeable_t *)
 		      SUPERLU_MALLOC(sizeof(Glu_freeable_t))) )
 		    ABORT("Malloc fails for Glu_freeable.");
@@ -1073,6 +1143,7 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    	linfo = symbfact(options, iam, &GAC, perm_c, etree,
 			     	 Glu_persist, Glu_freeable);
 		nnzLU = Glu_freeable->nnzLU;
+	    	SUPERLU_PROF_END(stat, "symbfact");
 	    	stat->utime[SYMBFAC] = SuperLU_timer_() - t;
 	    	if ( linfo <= 0 ) { /* Successful return */
 		    QuerySpace_dist(n, -linfo, Glu_freeable, &symb_mem_usage);
@@ -1097,15 +1168,80 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 		    *info = linfo;
 		    return;
 	        }
+
+		/* Renumber the supernodes to map the subtrees of the etree
+		   proportionally onto the process grid, then redo the
+		   symbolic factorization in the new order. */
+		if ( sp_ienv_dist(13, options) > 0
+		     && (propmap_q = superlu_propmap(n, etree, Glu_persist,
+						     &LUstruct->costmodel,
+						     grid->nprow, grid->npcol)) ) {
+		    t = SuperLU_timer_();
+		    superlu_propmap_apply(n, propmap_q, perm_c, etree, &GAC);
+		    SUPERLU_FREE(propmap_q);
+		    symbfact_SubFree(Glu_freeable);
+		    SUPERLU_FREE(Glu_persist->xsup);
+		    SUPERLU_FREE(Glu_persist->supno);
+		    /* The first pass already printed the statistics. */
+		    print_stat = options->PrintStat;
+		    options->PrintStat = NO;
+		    linfo = symbfact(options, iam, &GAC, perm_c, etree,
+				     Glu_persist, Glu_freeable);
+		    options->PrintStat = print_stat;
+		    nnzLU = Glu_freeable->nnzLU;
+		    stat->utime[SYMBFAC] += SuperLU_timer_() - t;
+		    if ( linfo > 0 ) {
+			if ( !iam )
+			    fprintf(stderr,"symbfact() error returns " IFMT "\n", linfo);
+			*info = linfo;
+			return;
+		    }
+		    QuerySpace_dist(n, -linfo, Glu_freeable, &symb_mem_usage);
+#if ( PRNTlevel>=1 )
+		    if ( !iam ) {
+			printf("\tProportional mapping: No of supers " IFMT "\n",
+			       Glu_persist->supno[n-1]+1);
+			fflush(stdout);
+		    }
+#endif
+		}
+
+		/* Merge supernodes with their parents where the cost model
+		   predicts a speedup for the explicit zeros. */
+		if ( sp_ienv_dist(20, options) > 0 ) {
+		    t = SuperLU_timer_();
+		    superlu_amalgamate(options, n, etree, Glu_persist,
+				       Glu_freeable, &LUstruct->costmodel, iam);
+		    nnzLU = Glu_freeable->nnzLU;
+		    stat->utime[SYMBFAC] += SuperLU_timer_() - t;
+		}
+
+		/* Split wide supernodes for the process grid. */
+		if ( sp_ienv_dist(21, options) > 0 ) {
+		    t = SuperLU_timer_();
+		    superlu_split_supernodes(options, n, Glu_persist,
+					     Glu_freeable, &LUstruct->costmodel,
+					     grid->nprow, grid->npcol, iam);
+		    stat->utime[SYMBFAC] += SuperLU_timer_() - t;
+		}
+
+		/* Export the task graph for offline scaling studies. */
+		if ( !iam && (tgfile = superlu_getenv_dist("SUPERLU_TASKGRAPH",
+							   options)) )
+		    superlu_write_taskgraph(tgfile, n, sizeof(doublecomplex), 1,
+					    Glu_persist, Glu_freeable, etree,
+					    NULL, grid->nprow, grid->npcol, 1);
 	    } /* end serial symbolic factorization */
 	    else {  /* parallel symbolic factorization */
 	    	t = SuperLU_timer_();
+	    	SUPERLU_PROF_BEGIN(stat, "symbfact");
 	    	flinfo = symbfact_dist(options, nprocs_num, noDomains,
 		                       A, perm_c, perm_r,
 				       sizes, fstVtxSep, &Pslu_freeable,
 				       &(grid->comm), &symb_comm,
 				       &symb_mem_usage);
 			nnzLU = Pslu_freeable.nnzLU;
+	    	SUPERLU_PROF_END(stat, "symbfact");
 	    	stat->utime[SYMBFAC] = SuperLU_timer_() - t;
 	    	if (flinfo > 0) {
 	      	    fprintf(stderr, "Insufficient memory for parallel symbolic factorization.");
@@ -1120,6 +1256,24 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
             if ( parSymbFact == NO )
  	        Destroy_CompCol_Permuted_dist(&GAC);
 
+	    /* Fit look-ahead depth and buffers into the memory budget,
+	       before any of the factor storage is allocated. */
+	    if ( parSymbFact == NO && sp_ienv_dist(12, options) > 0 ) {
+		iinfo = superlu_plan_memory(options, n, sizeof(doublecomplex),
+					    Glu_persist, Glu_freeable,
+					    grid, &symb_mem_usage);
+		if ( iinfo > 0 ) {
+		    /* Leave nothing for zDestroy_LU() to free. */
+		    symbfact_SubFree(Glu_freeable);
+		    SUPERLU_FREE(Glu_freeable);
+		    SUPERLU_FREE(Glu_persist->xsup);
+		    SUPERLU_FREE(Glu_persist->supno);
+		    Glu_persist->xsup = Glu_persist->supno = NULL;
+		    *info = n + iinfo;
+		    return;
+		}
+	    }
+
 	} /* end if Fact != SamePattern_SameRowPerm ... */
 
         if (sizes) SUPERLU_FREE (sizes);
@@ -1137,8 +1291,14 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	       NOTE: the row permutation Pc*Pr is applied internally in the
   	       distribution routine. */
 	    t = SuperLU_timer_();
+	    SUPERLU_PROF_BEGIN(stat, "distribute");
+	    /* Under superlu_subset, Fact differs from options->Fact for
+	       this call only. */
+	    options->Fact = Fact;
 	    dist_mem_use = pzdistribute(options, n, A, ScalePermstruct,
                                       Glu_freeable, LUstruct, grid);
+	    if ( nmiss == 0 ) options->Fact = SamePattern;
+	    SUPERLU_PROF_END(stat, "distribute");
 	    stat->utime[DIST] = SuperLU_timer_() - t;
 
   	    /* Deallocate storage used in symbolic factorization. */
@@ -1154,6 +1314,7 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    for (j = 0; j < nnz_loc; ++j) colind[j] = perm_c[colind[j]];
 
     	    t = SuperLU_timer_();
+    	    SUPERLU_PROF_BEGIN(stat, "distribute");
 	    dist_mem_use = zdist_psymbtonum(options, n, A, ScalePermstruct,
 		  			   &Pslu_freeable, LUstruct, grid);
 
@@ -1161,6 +1322,7 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    if (dist_mem_use > 0)
 	        ABORT ("Not enough memory available for dist_psymbtonum\n");
 
+	    SUPERLU_PROF_END(stat, "distribute");
 	    stat->utime[DIST] = SuperLU_timer_() - t;
 	}
 
@@ -1173,11 +1335,15 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 
 	/* Perform numerical factorization in parallel. */
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "factor");
     // #pragma omp parallel
     // {
 	// #pragma omp master
 	// {
 	pzgstrf(options, m, n, anorm, LUstruct, grid, stat, info);
+	options->num_lookaheads = num_lookaheads;
+	options->superlu_max_buffer_size = max_buffer_size;
+	SUPERLU_PROF_END(stat, "factor");
 	stat->utime[FACT] = SuperLU_timer_() - t;
 	// }
 	// }
@@ -1413,7 +1579,8 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 		}
 	#endif
 
-	if ( options->Fact != SamePattern_SameRowPerm) {
+	if ( Fact != SamePattern_SameRowPerm) {
+#ifdef GPU_ACC
 		nsupers = Glu_persist->supno[n-1] + 1;
 		int* supernodeMask = int32Malloc_dist(nsupers);
 		for(int ii=0; ii<nsupers; ii++)
@@ -1421,11 +1588,19 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 		ztrs_compute_communication_structure(options, n, LUstruct,
 						ScalePermstruct, supernodeMask, grid, stat);
 		SUPERLU_FREE(supernodeMask);
+#else
+		/* The communication trees of the triangular solves are built
+		   by the first pzgstrs() call, so that a factorization
+		   without right-hand side never pays for them. */
+		LUstruct->Llu->LBtree_ptr = LUstruct->Llu->LRtree_ptr = NULL;
+		LUstruct->Llu->UBtree_ptr = LUstruct->Llu->URtree_ptr = NULL;
+		LUstruct->Llu->bcols_masked = NULL;
+#endif
 	}
 
     } /* end if (!factored) */
 
-    if ( options->Fact == DOFACT || options->Fact == SamePattern ) {
+    if ( Fact == DOFACT || Fact == SamePattern ) {
 	/* Need to reset the solve's communication pattern,
 	   because perm_r[] and/or perm_c[] is changed.    */
 	if ( options->SolveInitialized == YES ) { /* Initialized before */
@@ -1570,8 +1745,11 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	    zSOLVEstruct_t *SOLVEstruct1;  /* Used by refinement. */
 
 	    t = SuperLU_timer_();
-	    if ( options->RefineInitialized == NO || Fact == DOFACT ) {
-	        /* All these cases need to re-initialize gsmv structure */
+	    SUPERLU_PROF_BEGIN(stat, "refine");
+	    if ( options->RefineInitialized == NO || Fact == DOFACT
+		 || nmiss != SLU_EMPTY ) {
+	        /* All these cases need to re-initialize gsmv structure;
+		   under superlu_subset, A may have a new pattern. */
 	        if ( options->RefineInitialized )
 		    pzgsmv_finalize(SOLVEstruct->gsmv_comm);
 	        pzgsmv_init(A, SOLVEstruct->row_to_proc, grid,
@@ -1653,6 +1831,7 @@ pzgssvx(superlu_dist_options_t *options, SuperMatrix *A,
 	        SUPERLU_FREE(SOLVEstruct1);
 	    }
 
+	    SUPERLU_PROF_END(stat, "refine");
 	    stat->utime[REFINE] = SuperLU_timer_() - t;
 	} /* end if IterRefine */
 
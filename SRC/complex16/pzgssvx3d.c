@@ -545,6 +545,7 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
     int_t *perm_r;			/* row permutations from partial pivoting */
     int_t *perm_c;			/* column permutation vector */
     int_t *etree;			/* elimination tree */
+    char *tgfile;			/* task graph export */
     int_t *rowptr, *colind; /* Local A in NR */
     int colequ, Equil, factored, job, notran, rowequ, need_value;
     int_t i, j, irow, m, n, nnz;
@@ -560,6 +561,7 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
     superlu_dist_mem_usage_t num_mem_usage, symb_mem_usage;
     float flinfo; /* track memory usage of parallel symbolic factorization */
     bool Solve3D = true;
+    int rhs3d;  /* B stays on the 3D grid for the solve */
     int_t nsupers;
 #if (PRNTlevel >= 2)
     double dmin, dsum, dprod;
@@ -568,8 +570,8 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
     ztrf3Dpartition_t *trf3Dpartition=LUstruct->trf3Dpart;
     int gpu3dVersion = 1;  // default is to use C++ code in CplusplusFactor/ directory
 #ifdef GPU_ACC
-    if (getenv("GPU3DVERSION")) {
-       gpu3dVersion = atoi(getenv("GPU3DVERSION"));
+    if (superlu_getenv_dist("GPU3DVERSION", options)) {
+       gpu3dVersion = atoi(superlu_getenv_dist("GPU3DVERSION", options));
     }
 
     LUgpu_Handle LUgpu;
@@ -599,9 +601,16 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 
     options->Algo3d = YES;
 
+    /* Region profiler, off unless SUPERLU_PROFILE > 0. */
+    superlu_prof_init(options, stat);
+
     /* definition of factored seen by each process layer */
     factored = (Fact == FACTORED);
 
+    /* The etree weights may use the calibrated cost model. */
+    if ( !factored )
+	superlu_costmodel_setup(options, &LUstruct->costmodel, grid3d->comm);
+
     /* Save the inputs: ldb -> ldb3d, and B -> B3d, Astore -> Astore3d,
        so that the names {ldb, B, and Astore} can be used internally.
        B3d and Astore3d will be assigned back to B and Astore on return.*/
@@ -609,19 +618,38 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
     NRformat_loc *Astore3d = (NRformat_loc *)A->Store;
     NRformat_loc3d *A3d = SOLVEstruct->A3d;
 
+    /* With sp_ienv_dist(17) > 0 the 3D solve takes B on the 3D grid and
+       returns X in place, so B is not gathered; see pzgstrs3d().
+       The iterative refinement still needs B2d. */
+    rhs3d = Solve3D && nrhs > 0 && superlu_solve_rhs3d(options);
+
+    /* Layer 0 needs the values of A in A2d for the scaling, the row
+       permutation, the ordering and the residual of the refinement.  With
+       SamePattern_SameRowPerm the first three are reused and zScatter_A3d()
+       sends the values to L and U from the 3D grid, so without refinement
+       A2d is not gathered (FactA2d = FACTORED: B only).  A later FACTORED
+       call that refines then gathers it.  */
+    fact_t FactA2d = Fact;
+    if ( Fact == SamePattern_SameRowPerm && options->IterRefine == NOREFINE )
+	FactA2d = FACTORED;
+    else if ( factored && options->IterRefine != NOREFINE && A3d->A2d_stale )
+	FactA2d = SamePattern_SameRowPerm;
+
     /* B3d is aliased to B;
        B2d is allocated;
        B is then aliased to B2d for the following 2D solve;
     */
-    zGatherNRformat_loc3d_allgrid(Fact, (NRformat_loc *)A->Store,
-				     B, ldb, nrhs, grid3d, &A3d);
+    zGatherNRformat_loc3d_allgrid(FactA2d, (NRformat_loc *)A->Store,
+				     B, ldb, rhs3d ? 0 : nrhs, grid3d, &A3d);
 
-    B = (doublecomplex *)A3d->B2d; /* B is now pointing to B2d,
+    if ( !rhs3d )
+	B = (doublecomplex *)A3d->B2d; /* B is now pointing to B2d,
 			   allocated in zGatherNRformat_loc3d.  */
     // PrintDouble5("after gather B=B2d", ldb, B);
 
     SOLVEstruct->A3d = A3d; /* This structure need to be persistent across
 				   multiple calls of pzgssvx3d()   */
+    if ( Fact == SamePattern_SameRowPerm ) A3d->A2d_stale = (FactA2d == FACTORED);
 
     NRformat_loc *Astore0 = A3d->A_nfmt; // on all grids
     NRformat_loc *A_orig = A->Store;
@@ -670,6 +698,11 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
     notran = (options->Trans == NOTRANS);
     iam = grid->iam;
 
+    /* Without A2d, norm(A) is taken from A on the 3D grid. */
+    if ( !factored && FactA2d == FACTORED )
+	anorm = zcomputeA3d_Norm(notran, Equil, A, Astore3d, ScalePermstruct,
+				 grid3d);
+
     if (grid3d->zscp.Iam == 0) { /* on 2D grid-0 */
 	/* The following code now works on 2D grid-0 */
 
@@ -698,8 +731,8 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 	/* ------------------------------------------------------------
 	   Diagonal scaling to equilibrate the matrix.
 	   ------------------------------------------------------------ */
-	if (Equil) {
-	    zscaleMatrixDiagonally(Fact, ScalePermstruct,
+	if (Equil && FactA2d != FACTORED) {
+	    zscaleMatrixDiagonally(options, Fact, ScalePermstruct,
 				  A, stat, grid, &rowequ, &colequ, &iinfo);
 	    if (iinfo < 0) {
 		*info = -20 - iinfo;
@@ -736,8 +769,16 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 
 	} /* end if (!factored) */
 
+	/* A2d was gathered again for the refinement; scale and permute it
+	   as the factored call did. */
+	if (factored && FactA2d != FACTORED) {
+	    zscalePrecomputed(A, ScalePermstruct);
+	    for (j = 0; j < nnz_loc; ++j)
+		colind[j] = perm_c[colind[j]];
+	}
+
 	/* Compute norm(A), which will be used to adjust small diagonal. */
-	if (!factored || options->IterRefine)
+	if (FactA2d != FACTORED && (!factored || options->IterRefine))
 	    anorm = zcomputeA_Norm(notran, A, grid);
 
 	/* ------------------------------------------------------------
@@ -745,6 +786,7 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 	   ------------------------------------------------------------ */
 	if (!factored) {
 	    t = SuperLU_timer_();
+	    SUPERLU_PROF_BEGIN(stat, "colperm");
 	    /*
 	     * Get column permutation vector perm_c[], according to permc_spec:
 	     *   permc_spec = NATURAL:  natural ordering
@@ -759,6 +801,7 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 	    if (parSymbFact == YES || permc_spec == PARMETIS) {
 		if(grid3d->npdep!=1){
     		    fprintf(stderr, "Error: ParMETIS and Parallel Symbolic Factorization are not yet supported with grid3d->npdep>1.\n");
+			SUPERLU_PROF_END(stat, "colperm");
 			return; // or exit(-1); if you want to terminate the program
 		}
 		nprocs_num = grid->nprow * grid->npcol;
@@ -807,10 +850,11 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 		    if (flinfo > 0)
 			ABORT("ERROR in get perm_c parmetis.");
 		} else {
-		    get_perm_c_dist(iam, permc_spec, &GA, perm_c);
+		    get_perm_c_dense_dist(options, iam, permc_spec, &GA, perm_c);
 		}
 	    }
 
+	    SUPERLU_PROF_END(stat, "colperm");
 	    stat->utime[COLPERM] = SuperLU_timer_() - t;
 
 	    /* Compute the elimination tree of Pc*(A'+A)*Pc' or Pc*A'*A*Pc'
@@ -829,17 +873,19 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 		    permCol_SymbolicFact3d(options, n, &GA, perm_c, etree,
 					   Glu_persist, Glu_freeable, stat,
 					   &symb_mem_usage,
-					   grid3d);
+					   grid3d, &LUstruct->costmodel);
 
 		} /* end serial symbolic factorization */
 		else { /* parallel symbolic factorization */
 		    //TODO: need a 3D version of symbfact_dist
 		    t = SuperLU_timer_();
+		    SUPERLU_PROF_BEGIN(stat, "symbfact");
 		    flinfo = symbfact_dist(options, nprocs_num, noDomains,
 					  A, perm_c, perm_r,
 					  sizes, fstVtxSep, &Pslu_freeable,
 					  &(grid->comm), &symb_comm,
 					  &symb_mem_usage);
+		    SUPERLU_PROF_END(stat, "symbfact");
 		    stat->utime[SYMBFAC] = SuperLU_timer_() - t;
 		    if (flinfo > 0)
 		        ABORT("Insufficient memory for parallel symbolic factorization.");
@@ -893,6 +939,7 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 	if (!factored)
 	{
 		/* Apply column permutation to the original distributed A */
+		if (FactA2d != FACTORED)
 		for (j = 0; j < nnz_loc; ++j)
 			colind[j] = perm_c[colind[j]];
 		// free quauntities used in Parmetis
@@ -907,6 +954,14 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 			// computes the new partition for 3D factorization here
 			trf3Dpartition=LUstruct->trf3Dpart;
 			znewTrfPartitionInit(nsupers, LUstruct, grid3d);
+
+			/* Export the task graph for offline scaling studies. */
+			if ( parSymbFact == NO && !grid3d->iam &&
+			     (tgfile = superlu_getenv_dist("SUPERLU_TASKGRAPH", options)) )
+				superlu_write_taskgraph(tgfile, n, sizeof(doublecomplex), 1,
+							Glu_persist, Glu_freeable, etree,
+							trf3Dpartition->supernode2treeMap,
+							grid->nprow, grid->npcol, grid3d->npdep);
 		}
 	}
 
@@ -921,9 +976,11 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 				NOTE: the row permutation Pc*Pr is applied internally in the
 				distribution routine. */
 			t = SuperLU_timer_();
+			SUPERLU_PROF_BEGIN(stat, "distribute");
 
-			dist_mem_use = pzdistribute3d_Yang(options, n, A, ScalePermstruct,
+			dist_mem_use = pzdistribute3d_Yang(options, n, A, A3d, ScalePermstruct,
 							   Glu_freeable, LUstruct, grid3d);
+			SUPERLU_PROF_END(stat, "distribute");
 			stat->utime[DIST] = SuperLU_timer_() - t;
 
 			/* Deallocate storage used in symbolic factorization. */
@@ -941,11 +998,13 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 
 			// TODO: need a 3D version of zdist_psymbtonum
 			t = SuperLU_timer_();
+			SUPERLU_PROF_BEGIN(stat, "distribute");
 			dist_mem_use = zdist_psymbtonum(options, n, A, ScalePermstruct,
 											&Pslu_freeable, LUstruct, grid);
 			if (dist_mem_use > 0)
 				ABORT("Not enough memory available for dist_psymbtonum\n");
 
+			SUPERLU_PROF_END(stat, "distribute");
 			stat->utime[DIST] = SuperLU_timer_() - t;
 
 			ABORT("zdist_psymbtonum does not yet work with 3D factorization\n");
@@ -1010,6 +1069,7 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 	if ( options->SolveOnly != YES ) { // Now we need factorization
 		
 		t = SuperLU_timer_();
+		SUPERLU_PROF_BEGIN(stat, "factor");
 
 		/*factorize in grid 1*/
 		// if(grid3d->zscp.Iam)
@@ -1100,6 +1160,7 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 		}
 
 
+		SUPERLU_PROF_END(stat, "factor");
 		stat->utime[FACT] = SuperLU_timer_() - t;
 
 		/*factorize in grid 1*/
@@ -1113,9 +1174,9 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 
 		// Write LU to file
 		int writeLU = 0;
-		if (getenv("WRITELU"))
+		if (superlu_getenv_dist("WRITELU", options))
 		{
-			writeLU = atoi(getenv("WRITELU"));
+			writeLU = atoi(superlu_getenv_dist("WRITELU", options));
 		}
 
 		if (writeLU)
@@ -1125,9 +1186,9 @@ void pzgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 		}
 
 		int checkLU = 0;
-		if (getenv("CHECKLU"))
+		if (superlu_getenv_dist("CHECKLU", options))
 		{
-			checkLU = atoi(getenv("CHECKLU"));
+			checkLU = atoi(superlu_getenv_dist("CHECKLU", options));
 		}
 
 		if (checkLU)
@@ -1468,6 +1529,16 @@ if (get_acc_solve()){
 
 		stat->utime[SOLVE] = 0.0;
 		if(Solve3D){
+			if (rhs3d) {
+			/* B, ldb and m_loc refer to the 3D grid, fst_row to the
+			   row order of the gathered A, as R and perm_r do. */
+				ldb = ldb3d;
+				m_loc = A3d->m_loc;
+				if (grid3d->rankorder == 1) // XY-major
+					fst_row = Astore3d->fst_row;
+				else // Z-major
+					fst_row = Astore0->fst_row + A3d->row_disp[grid3d->zscp.Iam];
+			}
 
 			// if (!(b_work = doublecomplexMalloc_dist(n)))
 			// 	ABORT("Malloc fails for b_work[]");
@@ -1536,10 +1607,10 @@ if (get_acc_solve()){
 			}
 			if (get_new3dsolve()){
 				pzgstrs3d_newsolve (options, n, LUstruct,ScalePermstruct, trf3Dpartition, grid3d, X,
-				m_loc, fst_row, ldb, nrhs,SOLVEstruct, stat, info);
+				m_loc, fst_row, ldb, nrhs, SOLVEstruct, stat, info);
 			}else{
 				pzgstrs3d (options, n, LUstruct,ScalePermstruct, trf3Dpartition, grid3d, X,
-				m_loc, fst_row, ldb, nrhs,SOLVEstruct, stat, info);
+				m_loc, fst_row, ldb, nrhs, SOLVEstruct, stat, info);
 			}
 			if (options->IterRefine)
 				{
@@ -1548,6 +1619,7 @@ if (get_acc_solve()){
 				zSOLVEstruct_t *SOLVEstruct1; /* Used by refinement */
 
 				t = SuperLU_timer_ ();
+				SUPERLU_PROF_BEGIN(stat, "refine");
 				if (options->RefineInitialized == NO || Fact == DOFACT) {
 					/* All these cases need to re-initialize gsmv structure */
 					if (options->RefineInitialized)
@@ -1564,7 +1636,7 @@ if (get_acc_solve()){
 					for (i = 0; i < nnz_loc; ++i) colind_gsmv[i] = colind[i];
 					options->RefineInitialized = YES;
 				}
-				else if (Fact == SamePattern || Fact == SamePattern_SameRowPerm) {
+				else if (FactA2d == SamePattern || FactA2d == SamePattern_SameRowPerm) {
 					doublecomplex at;
 					int_t k, jcol, p;
 					/* Swap to beginning the part of A corresponding to the
@@ -1636,6 +1708,7 @@ if (get_acc_solve()){
 					SUPERLU_FREE (SOLVEstruct1);
 					}
 
+				SUPERLU_PROF_END(stat, "refine");
 				stat->utime[REFINE] = SuperLU_timer_ () - t;
 				} /* end IterRefine */
 		}else{
@@ -1718,6 +1791,7 @@ if (get_acc_solve()){
 				zSOLVEstruct_t *SOLVEstruct1; /* Used by refinement */
 
 				t = SuperLU_timer_ ();
+				SUPERLU_PROF_BEGIN(stat, "refine");
 				if (options->RefineInitialized == NO || Fact == DOFACT) {
 					/* All these cases need to re-initialize gsmv structure */
 					if (options->RefineInitialized)
@@ -1734,7 +1808,7 @@ if (get_acc_solve()){
 					for (i = 0; i < nnz_loc; ++i) colind_gsmv[i] = colind[i];
 					options->RefineInitialized = YES;
 				}
-				else if (Fact == SamePattern || Fact == SamePattern_SameRowPerm) {
+				else if (FactA2d == SamePattern || FactA2d == SamePattern_SameRowPerm) {
 					doublecomplex at;
 					int_t k, jcol, p;
 					/* Swap to beginning the part of A corresponding to the
@@ -1810,13 +1884,28 @@ if (get_acc_solve()){
 					SUPERLU_FREE (SOLVEstruct1);
 					}
 
+				SUPERLU_PROF_END(stat, "refine");
 				stat->utime[REFINE] = SuperLU_timer_ () - t;
 				} /* end IterRefine */
 			}
 		}
 
-if (grid3d->zscp.Iam == 0)  /* on 2D grid-0 */
+if (grid3d->zscp.Iam == 0 || rhs3d)  /* on 2D grid-0, or B on 3D grid */
 	{
+		if (rhs3d) {
+		/* X came back already permuted by Pc', in the rows of B;
+		   these are columns fst_row, ... of the original matrix. */
+			fst_row = Astore3d->fst_row;
+			x_col = X;
+			b_col = B;
+			for (j = 0; j < nrhs; ++j)
+			{
+				for (i = 0; i < m_loc; ++i)
+					b_col[i] = x_col[i];
+				x_col += ldx;
+				b_col += ldb;
+			}
+		} else
 		/* Permute the solution matrix B <= Pc'*X. */
 		pzPermute_Dense_Matrix (fst_row, m_loc, SOLVEstruct->row_to_proc,
 					SOLVEstruct->inv_perm_c,
@@ -1900,7 +1989,7 @@ if (grid3d->zscp.Iam == 0)  /* on 2D grid-0 */
 	} /* process layer 0 done solve */
 
 	/* Scatter the solution from 2D grid-0 to 3D grid */
-	if (nrhs > 0)
+	if (nrhs > 0 && !rhs3d)
 		zScatter_B3d(A3d, grid3d);
 
 	B = A3d->B3d;		 // B is now assigned back to B3d on return
@@ -503,12 +503,15 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
     double   *C, *R, *C1, *R1, amax, anorm, colcnd, rowcnd;
     doublecomplex   *X, *b_col, *b_work, *x_col;
     double   t;
-    static superlu_dist_mem_usage_t num_mem_usage, symb_mem_usage;
+    superlu_dist_mem_usage_t num_mem_usage, symb_mem_usage;
 #if ( PRNTlevel>= 2 )
     double   dmin, dsum, dprod;
 #endif
 	LUstruct->dt = 'z';
 
+    num_mem_usage.for_lu = num_mem_usage.total = 0.0;
+    symb_mem_usage.for_lu = symb_mem_usage.total = 0.0;
+
     /* Test input parameters. */
     *info = 0;
     Fact = options->Fact;
@@ -536,6 +539,9 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 	return;
     }
 
+    /* Region profiler, off unless SUPERLU_PROFILE > 0. */
+    superlu_prof_init(options, stat);
+
     /* Initialization */
     factored = (Fact == FACTORED);
     Equil = (!factored && options->Equil == YES);
@@ -598,6 +604,7 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 	CHECK_MALLOC(iam, "Enter equil");
 #endif
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "equil");
 
 	if ( Fact == SamePattern_SameRowPerm ) {
 	    /* Reuse R and C. */
@@ -689,6 +696,7 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 #endif
 	} /* if Fact ... */
 
+	SUPERLU_PROF_END(stat, "equil");
 	stat->utime[EQUIL] = SuperLU_timer_() - t;
 #if ( DEBUGlevel>=1 )
 	CHECK_MALLOC(iam, "Exit equil");
@@ -700,6 +708,7 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
        ------------------------------------------------------------*/
     if ( options->RowPerm != NO ) {
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "rowperm");
 
 	if ( Fact == SamePattern_SameRowPerm /* Reuse perm_r. */
 	    || options->RowPerm == MY_PERMR ) { /* Use my perm_r. */
@@ -824,6 +833,7 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 
         } /* else !factored */
 
+	SUPERLU_PROF_END(stat, "rowperm");
 	t = SuperLU_timer_() - t;
 	stat->utime[ROWPERM] = t;
 
@@ -843,6 +853,7 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
        ------------------------------------------------------------*/
     if ( !factored ) {
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "colperm");
 	/*
 	 * Get column permutation vector perm_c[], according to permc_spec:
 	 *   permc_spec = NATURAL:  natural ordering
@@ -868,6 +879,7 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 		irow = ACstore->rowind[i];
 		ACstore->rowind[i] = perm_c[irow];
 	    }
+	SUPERLU_PROF_END(stat, "colperm");
 	stat->utime[COLPERM] = SuperLU_timer_() - t;
 
 	/* Perform a symbolic factorization on matrix A and set up the
@@ -879,6 +891,7 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 		       sp_ienv_dist(2,options), sp_ienv_dist(3,options), sp_ienv_dist(6,options));
 #endif
 	    t = SuperLU_timer_();
+	    SUPERLU_PROF_BEGIN(stat, "symbfact");
 	    if ( !(Glu_freeable = (Glu_freeable_t *)
 		   SUPERLU_MALLOC(sizeof(Glu_freeable_t))) )
 		ABORT("Malloc fails for Glu_freeable.");
@@ -886,6 +899,7 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 	    iinfo = symbfact(options, iam, &AC, perm_c, etree,
 			     Glu_persist, Glu_freeable);
 
+	    SUPERLU_PROF_END(stat, "symbfact");
 	    stat->utime[SYMBFAC] = SuperLU_timer_() - t;
 
 	    if ( iinfo <= 0 ) {
@@ -916,7 +930,9 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 
 	/* Distribute the L and U factors onto the process grid. */
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "distribute");
 	dist_mem_use = zdistribute(options, n, &AC, Glu_freeable, LUstruct, grid);
+	SUPERLU_PROF_END(stat, "distribute");
 	stat->utime[DIST] = SuperLU_timer_() - t;
 
 	/* Flatten L metadata into one buffer. */
@@ -932,7 +948,9 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 
 	/* Perform numerical factorization in parallel. */
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "factor");
 	pzgstrf(options, m, n, anorm, LUstruct, grid, stat, info);
+	SUPERLU_PROF_END(stat, "factor");
 	stat->utime[FACT] = SuperLU_timer_() - t;
 
 
@@ -1084,8 +1102,10 @@ pzgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 	if ( options->IterRefine ) {
 	    /* Improve the solution by iterative refinement. */
 	    t = SuperLU_timer_();
+	    SUPERLU_PROF_BEGIN(stat, "refine");
 	    pzgsrfs_ABXglobal(options, n, &AC, anorm, LUstruct, grid, B, ldb,
 			      X, ldx, nrhs, berr, stat, info);
+	    SUPERLU_PROF_END(stat, "refine");
 	    stat->utime[REFINE] = SuperLU_timer_() - t;
 	}
 
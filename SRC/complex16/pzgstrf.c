@@ -301,11 +301,23 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     int **msgcnts, **msgcntsU; /* counts in the look-ahead window */
     int *factored;  /* factored[j] == 0 : L col panel j is factorized. */
     int *factoredU; /* factoredU[i] == 1 : U row panel i is factorized. */
+    int *front_done; /* front_done[k] == 1 : supernode k is done in a leaf front. */
     int nnodes, *sendcnts, *sdispls, *recvcnts, *rdispls, *srows, *rrows;
     etree_node *head, *tail, *ptr;
     int *num_child;
     int num_look_aheads, look_id;
     int *look_ahead; /* global look_ahead table */
+    int look_end;    /* last panel admitted to the look-ahead window */
+    int nlook;       /* current size of the window, <= num_look_aheads */
+    superlu_lookahead_t la_ctl; /* see superlu_lookahead_step() */
+    double la_t0, la_t1, la_wait;
+    superlu_progress_t progress; /* see superlu_progress_start() */
+    int msg_level;   /* see superlu_panel_priority() */
+    double *msg_prio; /* priority of the panels in the window */
+    char *msg_crit;   /* msg_crit[k] = 1: messages of k use rscp_hi/cscp_hi */
+    superlu_scope_t rscp_hi, cscp_hi; /* channel of the critical path */
+    int_t *look_ord;  /* window positions in priority order */
+    int nlook_ord, jw;
     int_t *perm_c_supno, *iperm_c_supno;
           /* perm_c_supno[k] = j means at the k-th step of elimination,
 	   * the j-th supernode is chosen. */
@@ -445,6 +457,9 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     /* make sure the range of look-ahead window [0, MAX_LOOKAHEADS-1] */
     num_look_aheads = SUPERLU_MAX(0, SUPERLU_MIN(options->num_lookaheads, MAX_LOOKAHEADS - 1));
 
+    /* Optional workspace kept alive across calls; NULL = malloc/free. */
+    superlu_workspace_t *work = LUstruct->work;
+
     if (Pr * Pc > 1) {
         if (!(U_diag_blk_send_req =
               (MPI_Request *) SUPERLU_MALLOC (Pr * sizeof (MPI_Request))))
@@ -455,7 +470,8 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         /* allocating buffers for look-ahead */
         i = Llu->bufmax[0];
         if (i != 0) {
-            if ( !(Llu->Lsub_buf_2[0] = intMalloc_dist ((num_look_aheads + 1) * ((size_t) i))) )
+            if ( !(Llu->Lsub_buf_2[0] = (int_t *) superlu_workspace_get(work, WS_LSUB_BUF,
+                                 (num_look_aheads + 1) * ((size_t) i) * iword)) )
                 ABORT ("Malloc fails for Lsub_buf.");
 	    tempi = Llu->Lsub_buf_2[0];
             for (jj = 0; jj < num_look_aheads; jj++)
@@ -464,7 +480,8 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         }
         i = Llu->bufmax[1];
         if (i != 0) {
-            if (!(Llu->Lval_buf_2[0] = doublecomplexMalloc_dist ((num_look_aheads + 1) * ((size_t) i))))
+            if (!(Llu->Lval_buf_2[0] = (doublecomplex *) superlu_workspace_get(work, WS_LVAL_BUF,
+                                 (num_look_aheads + 1) * ((size_t) i) * dword)))
                 ABORT ("Malloc fails for Lval_buf[].");
 	    tempr = Llu->Lval_buf_2[0];
             for (jj = 0; jj < num_look_aheads; jj++)
@@ -473,7 +490,8 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         }
         i = Llu->bufmax[2];
         if (i != 0) {
-            if (!(Llu->Usub_buf_2[0] = intMalloc_dist ((num_look_aheads + 1) * i)))
+            if (!(Llu->Usub_buf_2[0] = (int_t *) superlu_workspace_get(work, WS_USUB_BUF,
+                                 (num_look_aheads + 1) * ((size_t) i) * iword)))
                 ABORT ("Malloc fails for Usub_buf_2[].");
 	    tempi = Llu->Usub_buf_2[0];
             for (jj = 0; jj < num_look_aheads; jj++)
@@ -482,7 +500,8 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         }
         i = Llu->bufmax[3];
         if (i != 0) {
-            if (!(Llu->Uval_buf_2[0] = doublecomplexMalloc_dist ((num_look_aheads + 1) * i)))
+            if (!(Llu->Uval_buf_2[0] = (doublecomplex *) superlu_workspace_get(work, WS_UVAL_BUF,
+                                 (num_look_aheads + 1) * ((size_t) i) * dword)))
                 ABORT ("Malloc fails for Uval_buf_2[].");
 	    tempr = Llu->Uval_buf_2[0];
             for (jj = 0; jj < num_look_aheads; jj++)
@@ -549,6 +568,9 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     if (!(factoredU = SUPERLU_MALLOC (nsupers * sizeof (int))))
         ABORT ("Malloc fails for factoredU[].");
     for (i = 0; i < nsupers; i++) factored[i] = factoredU[i] = -1;
+    if (!(front_done = SUPERLU_MALLOC (nsupers * sizeof (int))))
+        ABORT ("Malloc fails for front_done[].");
+    for (i = 0; i < nsupers; i++) front_done[i] = 0;
 
     log_memory(2 * nsupers * iword, stat);
 
@@ -877,9 +899,9 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                                      + buffer_size );                // dC
 
     } else { /* now superlu_acc_offload==0, GEMM will use CPU buffer */
-        if ( !(bigU = doublecomplexMalloc_dist(bigu_size)) )
+        if ( !(bigU = (doublecomplex *) superlu_workspace_get(work, WS_BIGU, bigu_size * dword)) )
 	     ABORT ("Malloc fails for dgemm U buffer");
-	if ( !(bigV = doublecomplexMalloc_dist(bigv_size)) )
+	if ( !(bigV = (doublecomplex *) superlu_workspace_get(work, WS_BIGV, bigv_size * dword)) )
 	     ABORT ("Malloc failed for dgemm V buffer");
     }
 
@@ -906,9 +928,9 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 //    bigU = _mm_malloc(bigu_size * sizeof(doublecomplex), 1<<12); // align at 4K page
 //    bigV = _mm_malloc(bigv_size * sizeof(doublecomplex), 1<<12);
 //#else
-    if ( !(bigU = doublecomplexMalloc_dist(bigu_size)) )
+    if ( !(bigU = (doublecomplex *) superlu_workspace_get(work, WS_BIGU, bigu_size * dword)) )
         ABORT ("Malloc fails for zgemm U buffer");
-    if ( !(bigV = doublecomplexMalloc_dist(bigv_size)) )
+    if ( !(bigV = (doublecomplex *) superlu_workspace_get(work, WS_BIGV, bigv_size * dword)) )
         ABORT ("Malloc failed for zgemm V buffer");
 //#endif
 
@@ -930,9 +952,9 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     /* Sherry: (ldt + 16), avoid cache line false sharing.
        KNL cacheline size = 64 bytes = 16 int */
     iinfo = ldt + CACHELINE / sizeof(int);
-    if (!(indirect = SUPERLU_MALLOC (iinfo * num_threads * sizeof(int))))
+    if (!(indirect = superlu_workspace_get(work, WS_INDIRECT, iinfo * num_threads * sizeof(int))))
         ABORT ("Malloc fails for indirect[].");
-    if (!(indirect2 = SUPERLU_MALLOC (iinfo * num_threads * sizeof(int))))
+    if (!(indirect2 = superlu_workspace_get(work, WS_INDIRECT2, iinfo * num_threads * sizeof(int))))
         ABORT ("Malloc fails for indirect[].");
 
     log_memory(2 * ldt*ldt * dword + 2 * iinfo * num_threads * iword, stat);
@@ -968,7 +990,8 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     Ublock_info_t *Ublock_info;
     ldt = sp_ienv_dist(3, options); /* max supernode size */
     /* The following is quite loose */
-    lookAhead_L_buff = doublecomplexMalloc_dist(ldt*ldt* (num_look_aheads+1) );
+    lookAhead_L_buff = (doublecomplex *) superlu_workspace_get(work, WS_LOOKAHEAD_L,
+                           (size_t) ldt*ldt* (num_look_aheads+1) * dword);
 
 #if 0
     Remain_L_buff = (doublecomplex *) _mm_malloc( sizeof(doublecomplex)*(Llu->bufmax[1]),64);
@@ -978,7 +1001,8 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
       int * Ublock_info_jb = (int *) _mm_malloc(mcb*sizeof(int),64); */
 #else
     j = gemm_m_pad * (ldt + max_row_size + gemm_k_pad);
-    Remain_L_buff = doublecomplexMalloc_dist(Llu->bufmax[1] + j); /* This is loose */
+    Remain_L_buff = (doublecomplex *) superlu_workspace_get(work, WS_REMAIN_L,
+                        (Llu->bufmax[1] + j) * dword); /* This is loose */
     Ublock_info = (Ublock_info_t *) SUPERLU_MALLOC(mcb*sizeof(Ublock_info_t));
     /*int *Ublock_info_iukp = (int *) SUPERLU_MALLOC(mcb*sizeof(int));
       int *Ublock_info_rukp = (int *) SUPERLU_MALLOC(mcb*sizeof(int));
@@ -990,10 +1014,42 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
  			+ Llu->bufmax[1] * dword ;
     log_memory(alloc_mem, stat);
 
+    /* Post the messages of the window in critical-path order; with
+       msg_level = 2 the critical path also has communicators of its own.
+       The priorities need the etree of the serial symbolic factorization. */
+    msg_level = options->ParSymbFact == NO ?
+                SUPERLU_MAX(sp_ienv_dist(15, options), 0) : 0;
+    msg_prio = NULL;
+    if ( !(msg_crit = SUPERLU_MALLOC (nsupers * sizeof (char))) )
+        ABORT ("Malloc fails for msg_crit[].");
+    for (i = 0; i < nsupers; ++i) msg_crit[i] = 0;
+    rscp_hi = grid->rscp;
+    cscp_hi = grid->cscp;
+    if ( msg_level ) {
+        msg_prio = superlu_panel_priority(nsupers, LUstruct->etree, Glu_persist,
+                                          &LUstruct->costmodel, msg_level >= 2 ? msg_crit : NULL);
+        if ( msg_level >= 2 ) {
+            MPI_Comm_dup (grid->rscp.comm, &rscp_hi.comm);
+            MPI_Comm_dup (grid->cscp.comm, &cscp_hi.comm);
+        }
+    }
+    look_ord = intMalloc_dist (num_look_aheads + 1);
+
     InitTimer = SuperLU_timer_() - tt1;
 
+    /* Keep the nonblocking panel messages moving during the updates. */
+    superlu_progress_start(&progress, options, grid->comm);
+
     double pxgstrfTimer = SuperLU_timer_();
 
+    /* Factor the leaf subtrees in dense fronts; their panels and
+       Schur complement updates are skipped below. */
+#ifdef GPU_ACC
+    if (!superlu_acc_offload)
+#endif
+        zleafFrontFactor (options, n, nsupers, NULL, thresh, LUstruct, grid,
+                          stat, info, front_done);
+
     /* ##################################################################
        ** Handle first block column separately to start the pipeline. **
        ################################################################## */
@@ -1008,14 +1064,17 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     krow = PROW (k, grid);
     if (mycol == kcol) {
         double ttt1 = SuperLU_timer_();
+        SUPERLU_PROF_BEGIN(stat, "panel");
 
 	/* panel factorization */
-        PZGSTRF2 (options, k0, k, thresh, Glu_persist, grid, Llu,
-                  U_diag_blk_send_req, tag_ub, stat, info);
+        if (!front_done[k])
+            PZGSTRF2 (options, k0, k, thresh, Glu_persist, grid, Llu,
+                      U_diag_blk_send_req, tag_ub, stat, info);
 
+        SUPERLU_PROF_END(stat, "panel");
         pdgstrf2_timer += SuperLU_timer_()-ttt1;
 
-        scp = &grid->rscp;      /* The scope of process row. */
+        scp = msg_crit[k] ? &rscp_hi : &grid->rscp;      /* The scope of process row. */
 
         /* Multicasts numeric values of L(:,0) to process rows. */
         lk = LBj (k, grid);     /* Local block number. */
@@ -1059,7 +1118,7 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         }  /* end for pj ... */
     } else {  /* Post immediate receives. */
         if (ToRecv[k] >= 1) {   /* Recv block column L(:,0). */
-            scp = &grid->rscp;  /* The scope of process row. */
+            scp = msg_crit[k] ? &rscp_hi : &grid->rscp;  /* The scope of process row. */
 #if ( PROFlevel>=1 )
 	    TIC (t1);
 #endif
@@ -1082,7 +1141,7 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     /* post receive of first U-row */
     if (myrow != krow) {
         if (ToRecv[k] == 2) {   /* Recv block row U(k,:). */
-            scp = &grid->cscp;  /* The scope of process column. */
+            scp = msg_crit[k] ? &cscp_hi : &grid->cscp;  /* The scope of process column. */
             Usub_buf = Llu->Usub_buf_2[0];
             Uval_buf = Llu->Uval_buf_2[0];
 #if ( PROFlevel>=1 )
@@ -1102,27 +1161,42 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         }
     }
 
+    superlu_lookahead_init(&la_ctl, options, num_look_aheads, 16, grid->comm);
+    nlook = la_ctl.la;
+    look_end = 0;
+    la_t0 = SuperLU_timer_();
+    la_wait = 0.0;
+
     /* ##################################################################
        **** MAIN LOOP ****
        ################################################################## */
     for (k0 = 0; k0 < nsupers; ++k0) {
         k = perm_c_supno[k0];
 
+        if (k0 > 0) { /* account the previous step; may resize the window */
+            la_t1 = SuperLU_timer_();
+            nlook = superlu_lookahead_step(&la_ctl, k0, la_wait,
+                                           la_t1 - la_t0 - la_wait);
+            la_t0 = la_t1;
+            la_wait = 0.0;
+        }
+
         /* ============================================ *
          * ======= look-ahead the new L columns ======= *
          * ============================================ */
         /* tt1 = SuperLU_timer_(); */
-        if (k0 == 0) { /* look-ahead all the columns in the window */
-            kk1 = k0 + 1;
-            kk2 = SUPERLU_MIN (k0 + num_look_aheads, nsupers - 1);
-        } else {  /* look-ahead one new column after the current window */
-            kk1 = k0 + num_look_aheads;
-            kk2 = SUPERLU_MIN (kk1, nsupers - 1);
-        }
-
-        for (kk0 = kk1; kk0 <= kk2; kk0++) {
+        /* Admit the columns after the current window, all of the window
+           when k0 = 0.  The end of the window never moves back: after
+           the window is shrunk, no column is admitted until it drains. */
+        kk1 = look_end + 1;
+        kk2 = SUPERLU_MAX (look_end, SUPERLU_MIN (k0 + nlook, nsupers - 1));
+        look_end = kk2;
+
+        nlook_ord = superlu_window_order(kk1, kk2, perm_c_supno, msg_prio, look_ord);
+        for (jw = 0; jw < nlook_ord; jw++) {
 	    /* loop through look-ahead window in L */
 
+            kk0 = look_ord[jw];
             kk = perm_c_supno[kk0]; /* use the ordering from static schedule */
             look_id = kk0 % (1 + num_look_aheads); /* which column in window */
 
@@ -1134,10 +1208,13 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                        L blocks and test for exact singularity.  */
                     factored[kk] = 0; /* flag column kk as factored */
                     double ttt1 = SuperLU_timer_();
+                    SUPERLU_PROF_BEGIN(stat, "panel");
 
-                    PZGSTRF2 (options, kk0, kk, thresh, Glu_persist,
-                              grid, Llu, U_diag_blk_send_req, tag_ub, stat, info);
+                    if (!front_done[kk])
+                        PZGSTRF2 (options, kk0, kk, thresh, Glu_persist, grid,
+                                  Llu, U_diag_blk_send_req, tag_ub, stat, info);
 
+                     SUPERLU_PROF_END(stat, "panel");
                      pdgstrf2_timer += SuperLU_timer_() - ttt1;
 
                     /* Multicasts numeric values of L(:,kk) to process rows. */
@@ -1154,7 +1231,7 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                         msgcnt[0] = 0;
                         msgcnt[1] = 0;
                     }
-                    scp = &grid->rscp;  /* The scope of process row. */
+                    scp = msg_crit[kk] ? &rscp_hi : &grid->rscp;  /* The scope of process row. */
                     for (pj = 0; pj < Pc; ++pj) {
                         if (ToSendR[lk][pj] != SLU_EMPTY) {
                             lusup1 = Lnzval_bc_ptr[lk];
@@ -1183,7 +1260,7 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                 } else {     /* Post Recv of block column L(:,kk). */
                     /* double ttt1 = SuperLU_timer_(); */
                     if (ToRecv[kk] >= 1) {
-                        scp = &grid->rscp;  /* The scope of process row. */
+                        scp = msg_crit[kk] ? &rscp_hi : &grid->rscp;  /* The scope of process row. */
                         recv_req = recv_reqs[look_id];
 #if ( PROFlevel>=1 )
 			TIC (t1);
@@ -1209,7 +1286,7 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
             krow = PROW (kk, grid);
             if (myrow != krow) {
                 if (ToRecv[kk] == 2) { /* post iRecv block row U(kk,:). */
-                    scp = &grid->cscp;  /* The scope of process column. */
+                    scp = msg_crit[kk] ? &cscp_hi : &grid->cscp;  /* The scope of process column. */
                     Usub_buf = Llu->Usub_buf_2[look_id];
                     Uval_buf = Llu->Uval_buf_2[look_id];
 #if ( PROFlevel>=1 )
@@ -1237,8 +1314,10 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
          * ==== look-ahead the U rows    === *
          * ================================= */
         kk1 = k0;
-        kk2 = SUPERLU_MIN (k0 + num_look_aheads, nsupers - 1);
-        for (kk0 = kk1; kk0 < kk2; kk0++) {
+        kk2 = look_end;
+        nlook_ord = superlu_window_order(kk1, kk2 - 1, perm_c_supno, msg_prio, look_ord);
+        for (jw = 0; jw < nlook_ord; jw++) {
+            kk0 = look_ord[jw];
             kk = perm_c_supno[kk0]; /* order determined from static schedule */
             if (factoredU[kk0] != 1 && look_ahead[kk] < k0) {
 		/* does not depend on current column k */
@@ -1292,20 +1371,22 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 
                 if (flag0 && flag1) { /* L(:,kk) is ready */
                     /* tt1 = SuperLU_timer_(); */
-                    scp = &grid->cscp;  /* The scope of process column. */
+                    scp = msg_crit[kk] ? &cscp_hi : &grid->cscp;  /* The scope of process column. */
                     if (myrow == krow) {
                         factoredU[kk0] = 1;
                         /* Parallel triangular solve across process row *krow* --
                            U(k,j) = L(k,k) \ A(k,j).  */
                         double ttt2 = SuperLU_timer_();
+                        SUPERLU_PROF_BEGIN(stat, "trsm_u");
 #ifdef _OPENMP
 /* #pragma omp parallel */ /* Sherry -- parallel done inside pzgstrs2 */
 #endif
-			{
+			if (!front_done[kk]) {
                             pzgstrs2_omp (kk0, kk, Glu_persist, grid, Llu,
                                         Ublock_info, stat);
                         }
 
+                        SUPERLU_PROF_END(stat, "trsm_u");
                         pdgstrs2_timer += SuperLU_timer_()-ttt2;
                         /* stat->time8 += SuperLU_timer_()-ttt2; */
 
@@ -1404,6 +1485,8 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 #if ( PROFlevel>=1 )
                 TIC (t1);
 #endif
+                SUPERLU_PROF_BEGIN(stat, "wait_L");
+                la_t1 = SuperLU_timer_();
                 if (recv_req[0] != MPI_REQUEST_NULL) {
                     MPI_Wait (&recv_req[0], &status);
                     MPI_Get_count (&status, mpi_int_t, &msgcnt[0]);
@@ -1427,6 +1510,8 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 			   iam, k, look_id, msgcnt[1]);
 #endif
                 }
+                la_wait += SuperLU_timer_() - la_t1;
+                SUPERLU_PROF_END(stat, "wait_L");
 
 #if ( PROFlevel>=1 )
                 TOC (t2, t1);
@@ -1452,7 +1537,7 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         }  /* else if mycol = Pc(k) */
         /* stat->time1 += SuperLU_timer_()-tt1; */
 
-        scp = &grid->cscp;      /* The scope of process column. */
+        scp = msg_crit[k] ? &cscp_hi : &grid->cscp;      /* The scope of process column. */
 
         /* tt1 = SuperLU_timer_(); */
         if (myrow == krow) { /* I own U(k,:) */
@@ -1464,13 +1549,15 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                 /* Parallel triangular solve across process row *krow* --
                    U(k,j) = L(k,k) \ A(k,j).  */
                  double ttt2 = SuperLU_timer_();
+                 SUPERLU_PROF_BEGIN(stat, "trsm_u");
 #ifdef _OPENMP
 /* #pragma omp parallel */ /* Sherry -- parallel done inside pzgstrs2 */
 #endif
-                {
+                if (!front_done[k]) {
                     pzgstrs2_omp (k0, k, Glu_persist, grid, Llu,
 		                    Ublock_info, stat);
                 }
+                SUPERLU_PROF_END(stat, "trsm_u");
                 pdgstrs2_timer += SuperLU_timer_() - ttt2;
 
 	        /* Sherry -- need to set factoredU[k0] = 1; ?? */
@@ -1547,10 +1634,14 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 #if ( PROFlevel>=1 )
                 TIC (t1);
 #endif
+                SUPERLU_PROF_BEGIN(stat, "wait_U");
+                la_t1 = SuperLU_timer_();
                 MPI_Wait (&recv_reqs_u[look_id][0], &status);
                 MPI_Get_count (&status, mpi_int_t, &msgcnt[2]);
                 MPI_Wait (&recv_reqs_u[look_id][1], &status);
                 MPI_Get_count (&status, SuperLU_MPI_DOUBLE_COMPLEX, &msgcnt[3]);
+                la_wait += SuperLU_timer_() - la_t1;
+                SUPERLU_PROF_END(stat, "wait_U");
 
 #if ( PROFlevel>=1 )
                 TOC (t2, t1);
@@ -1582,6 +1673,7 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
          */
         msg0 = msgcnt[0];
         msg2 = msgcnt[2];
+        if (front_done[k]) msg0 = msg2 = 0; /* updated in its front */
         /* tt1 = SuperLU_timer_(); */
         if (msg0 && msg2) {     /* L(:,k) and U(k,:) are not empty. */
             nsupr = lsub[1];    /* LDA of lusup. */
@@ -1631,10 +1723,12 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 
 /************************************************************************/
             double ttx =SuperLU_timer_();
+            SUPERLU_PROF_BEGIN(stat, "lookahead");
 
 //#include "zlook_ahead_update_v4.c"
 #include "zlook_ahead_update.c"
 
+            SUPERLU_PROF_END(stat, "lookahead");
             lookaheadupdatetimer += SuperLU_timer_() - ttx;
 /************************************************************************/
 
@@ -1647,15 +1741,17 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         /* ================== */
         /* == post receive == */
         /* ================== */
-        kk1 = SUPERLU_MIN (k0 + num_look_aheads, nsupers - 1);
-        for (kk0 = k0 + 1; kk0 <= kk1; kk0++) {
+        kk1 = look_end;
+        nlook_ord = superlu_window_order(k0 + 1, kk1, perm_c_supno, msg_prio, look_ord);
+        for (jw = 0; jw < nlook_ord; jw++) {
+            kk0 = look_ord[jw];
             kk = perm_c_supno[kk0];
             kcol = PCOL (kk, grid);
 
             if (look_ahead[kk] == k0) {
                 if (mycol != kcol) {
                     if (ToRecv[kk] >= 1) {
-                        scp = &grid->rscp;  /* The scope of process row. */
+                        scp = msg_crit[kk] ? &rscp_hi : &grid->rscp;  /* The scope of process row. */
 
                         look_id = kk0 % (1 + num_look_aheads);
                         recv_req = recv_reqs[look_id];
@@ -1684,9 +1780,12 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 			   test for exact singularity.  */
                         factored[kk] = 0; /* flag column kk as factored */
                         double ttt1 = SuperLU_timer_();
-                        PZGSTRF2 (options, kk0, kk, thresh,
-                                  Glu_persist, grid, Llu, U_diag_blk_send_req,
-                                  tag_ub, stat, info);
+                        SUPERLU_PROF_BEGIN(stat, "panel");
+                        if (!front_done[kk])
+                            PZGSTRF2 (options, kk0, kk, thresh,
+                                      Glu_persist, grid, Llu, U_diag_blk_send_req,
+                                      tag_ub, stat, info);
+                        SUPERLU_PROF_END(stat, "panel");
                         pdgstrf2_timer += SuperLU_timer_() - ttt1;
 
                         /* Process column *kcol+1* multicasts numeric
@@ -1703,7 +1802,7 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
                             msgcnt[1] = 0;
                         }
 
-                        scp = &grid->rscp;  /* The scope of process row. */
+                        scp = msg_crit[kk] ? &rscp_hi : &grid->rscp;  /* The scope of process row. */
                         for (pj = 0; pj < Pc; ++pj) {
                             if (ToSendR[lk][pj] != SLU_EMPTY) {
 #if ( PROFlevel>=1 )
@@ -1729,6 +1828,7 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         }
 
         double tsch = SuperLU_timer_();
+        SUPERLU_PROF_BEGIN(stat, "schur");
 
 	/*******************************************************************/
 
@@ -1751,6 +1851,7 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         /* #include "SchCompUdt--baseline.c"  */
 	/************************************************************************/
 
+        SUPERLU_PROF_END(stat, "schur");
         NetSchurUpTimer += SuperLU_timer_() - tsch;
 
     }  /* MAIN LOOP for k0 = 0, ... */
@@ -1759,6 +1860,16 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
        ** END MAIN LOOP: for k0 = ...
        ################################################################## */
 
+    superlu_lookahead_finalize(&la_ctl);
+    superlu_progress_stop(&progress);
+    if ( msg_level >= 2 ) {
+        MPI_Comm_free (&rscp_hi.comm);
+        MPI_Comm_free (&cscp_hi.comm);
+    }
+    if ( msg_prio ) SUPERLU_FREE (msg_prio);
+    SUPERLU_FREE (msg_crit);
+    SUPERLU_FREE (look_ord);
+
     pxgstrfTimer = SuperLU_timer_() - pxgstrfTimer;
 
 #if ( PRNTlevel>=1 )
@@ -1806,12 +1917,12 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
      ********************************************************/
 
     if (Pr * Pc > 1) {
-        SUPERLU_FREE (Lsub_buf_2[0]);   /* also free Lsub_buf_2[1] */
-        SUPERLU_FREE (Lval_buf_2[0]);   /* also free Lval_buf_2[1] */
+        superlu_workspace_put(work, WS_LSUB_BUF, Lsub_buf_2[0]); /* also Lsub_buf_2[1] */
+        superlu_workspace_put(work, WS_LVAL_BUF, Lval_buf_2[0]); /* also Lval_buf_2[1] */
         if (Llu->bufmax[2] != 0)
-            SUPERLU_FREE (Usub_buf_2[0]);
+            superlu_workspace_put(work, WS_USUB_BUF, Usub_buf_2[0]);
         if (Llu->bufmax[3] != 0)
-            SUPERLU_FREE (Uval_buf_2[0]);
+            superlu_workspace_put(work, WS_UVAL_BUF, Uval_buf_2[0]);
         if (U_diag_blk_send_req[myrow] != MPI_REQUEST_NULL) {
             /* wait for last Isend requests to complete, deallocate objects */
             for (krow = 0; krow < Pr; ++krow) {
@@ -1838,6 +1949,7 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     SUPERLU_FREE (look_ahead);
     SUPERLU_FREE (factoredU);
     SUPERLU_FREE (factored);
+    SUPERLU_FREE (front_done);
     log_memory(-(6 * nsupers * iword), stat);
 
     for (i = 0; i <= num_look_aheads; i++) {
@@ -1871,13 +1983,13 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
         SUPERLU_FREE( streams );
         SUPERLU_FREE( stream_end_col );
     } else {
-        SUPERLU_FREE (bigV);    // allocated on CPU
-        SUPERLU_FREE (bigU);
+        superlu_workspace_put(work, WS_BIGV, bigV);    // allocated on CPU
+        superlu_workspace_put(work, WS_BIGU, bigU);
     }
 #else
 
-    SUPERLU_FREE (bigV);
-    SUPERLU_FREE (bigU);
+    superlu_workspace_put(work, WS_BIGV, bigV);
+    superlu_workspace_put(work, WS_BIGU, bigU);
 
     /* Decrement freed memory from memory stat. */
     log_memory(-(bigv_size + bigu_size) * dword, stat);
@@ -1885,8 +1997,8 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
 
     SUPERLU_FREE (Llu->ujrow);
     // SUPERLU_FREE (tempv2d);/* Sherry */
-    SUPERLU_FREE (indirect);
-    SUPERLU_FREE (indirect2); /* Sherry added */
+    superlu_workspace_put(work, WS_INDIRECT, indirect);
+    superlu_workspace_put(work, WS_INDIRECT2, indirect2); /* Sherry added */
 
     ldt = sp_ienv_dist(3, options);
     log_memory( -(3 * ldt *ldt * dword + 2 * ldt * num_threads * iword), stat );
@@ -1908,8 +2020,8 @@ pzgstrf(superlu_dist_options_t * options, int m, int n, double anorm,
     SUPERLU_FREE(Remain_lptr);
     SUPERLU_FREE(Remain_ib);
     SUPERLU_FREE(Remain_info);
-    SUPERLU_FREE(lookAhead_L_buff);
-    SUPERLU_FREE(Remain_L_buff);
+    superlu_workspace_put(work, WS_LOOKAHEAD_L, lookAhead_L_buff);
+    superlu_workspace_put(work, WS_REMAIN_L, Remain_L_buff);
     log_memory( -(3 * mrb * iword + mrb * sizeof(Remain_info_t) +
 		  ldt * ldt * (num_look_aheads + 1) * dword +
 		  Llu->bufmax[1] * dword), stat );
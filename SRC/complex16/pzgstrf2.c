@@ -77,6 +77,7 @@ at the top-level directory.
 
 #include <math.h>
 #include "superlu_zdefs.h"
+#include "dcomplex_simd.h"
 //#include "cblas.h"
 
 /*****************************************************************************
@@ -248,8 +249,7 @@ pzgstrf2_trsm
                 *info = j + jfst + 1;
             } else {              /* Scale the j-th column within diag. block. */
                 slud_z_div(&temp, &one, &ujrow[0]);
-                for (i = luptr + 1; i < luptr - j + nsupc; ++i)
-                    zz_mult(&lusup[i], &lusup[i], &temp);
+                zsimd_scal(nsupc - j - 1, &temp, &lusup[luptr + 1]);
                 stat->ops[FACT] += 6*(nsupc-j-1) + 10;
             }
 
@@ -461,8 +461,7 @@ void zgstrf2(int_t k, doublecomplex* diagBlk, int_t LDA, doublecomplex* BlockUfa
         {
             doublecomplex temp;
             slud_z_div(&temp, &one, &ujrow[0]);
-            for (i = luptr + 1; i < luptr - j + nsupc; ++i)
-                zz_mult(&diagBlk[i], &diagBlk[i], &temp);
+            zsimd_scal(nsupc - j - 1, &temp, &diagBlk[luptr + 1]);
             stat->ops[FACT] += 6*(nsupc-j-1) + 10;
         }
 
@@ -575,8 +574,7 @@ void Local_Zgstrf2(superlu_dist_options_t *options, int_t k, double thresh,
         {
             doublecomplex temp;
             slud_z_div(&temp, &one, &ujrow[0]);
-            for (i = luptr + 1; i < luptr - j + nsupc; ++i)
-                zz_mult(&lusup[i], &lusup[i], &temp);
+            zsimd_scal(nsupc - j - 1, &temp, &lusup[luptr + 1]);
             stat->ops[FACT] += 6*(nsupc-j-1) + 10;
         }
 
@@ -342,6 +342,7 @@ int_t pzgstrf3d(superlu_dist_options_t *options, int m, int n, double anorm,
             if (sforest) /* 2D factorization at individual subtree */
             {
                 double tilvl = SuperLU_timer_();
+                SUPERLU_PROF_BEGIN(stat, "subtree");
 #ifdef GPU_ACC
                 zsparseTreeFactor_ASYNC_GPU(
                     sforest,
@@ -351,14 +352,21 @@ int_t pzgstrf3d(superlu_dist_options_t *options, int m, int n, double anorm,
                     sluGPU,  d2Hred,  HyP, LUstruct, grid3d, stat,
                     thresh,  SCT, tag_ub, info);
 #else
+                /* Factor its leaf subtrees in dense fronts first. */
+                int finfo = 0;
+                zleafFrontFactor(options, n, sforest->nNodes, sforest->nodeList,
+                                 thresh, LUstruct, &(grid3d->grid2d), stat,
+                                 &finfo, factStat.frontDone);
                 zsparseTreeFactor_ASYNC(sforest, comReqss,  &scuBufs, &packLUInfo,
 					msgss, LUvsbs, dFBufs, &factStat, &fNlists,
 					&gEtreeInfo, options, iperm_c_supno, ldt,
 					HyP, LUstruct, grid3d, stat,
 					thresh,  SCT, tag_ub, info );
+                if (finfo && !*info) *info = finfo;
 #endif
 
                 /*now reduce the updates*/
+                SUPERLU_PROF_END(stat, "subtree");
                 SCT->tFactor3D[ilvl] = SuperLU_timer_() - tilvl;
                 sForests[myTreeIdxs[ilvl]]->cost = SCT->tFactor3D[ilvl];
             }
@@ -372,8 +380,10 @@ int_t pzgstrf3d(superlu_dist_options_t *options, int m, int n, double anorm,
                     SCT, stat );
 #else
 
+                SUPERLU_PROF_BEGIN(stat, "reduce");
                 zreduceAllAncestors3d( ilvl, myNodeCount, treePerm,
                                       LUvsb, LUstruct, grid3d, SCT );
+                SUPERLU_PROF_END(stat, "reduce");
 #endif
 
             }
@@ -1054,6 +1054,7 @@ pzgstrs(superlu_dist_options_t *options, int_t n,
 	pxerr_dist("PZGSTRS", grid, -*info);
 	return;
     }
+    SUPERLU_PROF_BEGIN(stat, "solve");
 
     /*
      * Initialization.
@@ -1066,6 +1067,17 @@ pzgstrs(superlu_dist_options_t *options, int_t n,
     xsup = Glu_persist->xsup;
     supno = Glu_persist->supno;
     nsupers = supno[n-1] + 1;
+    if ( !Llu->LBtree_ptr ) { /* first solve after the factorization */
+	int *supernodeMask = int32Malloc_dist(nsupers);
+	for (int js = 0; js < nsupers; ++js) supernodeMask[js] = 1;
+	ztrs_compute_communication_structure(options, n, LUstruct,
+				ScalePermstruct, supernodeMask, grid, stat);
+	SUPERLU_FREE(supernodeMask);
+	LBtree_ptr = Llu->LBtree_ptr;
+	LRtree_ptr = Llu->LRtree_ptr;
+	UBtree_ptr = Llu->UBtree_ptr;
+	URtree_ptr = Llu->URtree_ptr;
+    }
     Lrowind_bc_ptr = Llu->Lrowind_bc_ptr;
     Lnzval_bc_ptr = Llu->Lnzval_bc_ptr;
     Linv_bc_ptr = Llu->Linv_bc_ptr;
@@ -1215,6 +1227,8 @@ pzgstrs(superlu_dist_options_t *options, int_t n,
     zDumpLblocks(iam, nsupers, grid, Glu_persist, Llu);
 #endif
 
+    SUPERLU_PROF_BEGIN(stat, "lsolve");
+
     /*---------------------------------------------------
      * Forward solve Ly = b.
      *---------------------------------------------------*/
@@ -1943,6 +1957,9 @@ if (get_acc_solve()){  /* GPU trisolve*/
 #endif
 
 
+	SUPERLU_PROF_END(stat, "lsolve");
+	SUPERLU_PROF_BEGIN(stat, "usolve");
+
 	/*---------------------------------------------------
 	 * Back solve Ux = y.
 	 *
@@ -2658,6 +2675,8 @@ for (lk=0;lk<nsupers_j;++lk){
 	}
 #endif
 
+    SUPERLU_PROF_END(stat, "usolve");
+    SUPERLU_PROF_END(stat, "solve");
     stat->utime[SOLVE] = SuperLU_timer_() - t1_sol;
 
 #if ( DEBUGlevel>=1 )
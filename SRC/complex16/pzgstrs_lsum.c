@@ -26,6 +26,7 @@ at the top-level directory.
  */
 
 #include "superlu_zdefs.h"
+#include "dcomplex_simd.h"
 #include "superlu_defs.h"
 
 #ifndef CACHELINE
@@ -81,7 +82,7 @@ void zlsum_fmod
     doublecomplex *lusup, *lusup1;
     doublecomplex *dest;
     int    iam, iknsupc, myrow, nbrow, nsupr, nsupr1, p, pi;
-    int_t  i, ii, ik, il, ikcol, irow, j, lb, lk, lib, rel;
+    int_t  i, ii, ik, il, ikcol, j, lb, lk, lib, rel;
     int_t  *lsub, *lsub1, nlb1, lptr1, luptr1;
     int_t  *ilsum = Llu->ilsum; /* Starting position of each supernode in lsum.   */
     int  *frecv = Llu->frecv;
@@ -128,13 +129,10 @@ void zlsum_fmod
 	dest = &lsum[il];
 	lptr += LB_DESCRIPTOR;
 	rel = xsup[ik]; /* Global row index of block ik. */
-	for (i = 0; i < nbrow; ++i) {
-	    irow = lsub[lptr++] - rel; /* Relative row. */
-	    RHS_ITERATE(j)
-		z_sub(&dest[irow + j*iknsupc],
-		      &dest[irow + j*iknsupc],
-		      &rtemp[i + j*nbrow]);
-	}
+	RHS_ITERATE(j)
+	    zsimd_scatter_sub_rel(nbrow, &lsub[lptr], rel, &rtemp[j*nbrow],
+				  &dest[j*iknsupc]);
+	lptr += nbrow;
 	luptr += nbrow;
 
 #if ( PROFlevel>=1 )
@@ -271,7 +269,7 @@ void zlsum_bmod
  */
     doublecomplex alpha = {1.0, 0.0}, beta = {0.0, 0.0};
     int    iam, iknsupc, knsupc, myrow, nsupr, p, pi;
-    int_t  fnz, gik, gikcol, i, ii, ik, ikfrow, iklrow, il, irow,
+    int_t  fnz, gik, gikcol, i, ii, ik, ikfrow, iklrow, il,
            j, jj, lk, lk1, nub, ub, uptr;
     int_t  *usub;
     doublecomplex *uval, *dest, *y;
@@ -310,12 +308,9 @@ void zlsum_bmod
 		fnz = usub[i + jj];
 		if ( fnz < iklrow ) { /* Nonzero segment. */
 		    /* AXPY */
-		    for (irow = fnz; irow < iklrow; ++irow) {
-			zz_mult(&temp, &uval[uptr], &y[jj]);
-			z_sub(&dest[irow - ikfrow], &dest[irow - ikfrow],
-			      &temp);
-			++uptr;
-		    }
+		    zsimd_axpy_sub(iklrow - fnz, &y[jj], &uval[uptr],
+		    	       &dest[fnz - ikfrow]);
+		    uptr += iklrow - fnz;
 		    stat->ops[SOLVE] += 8 * (iklrow - fnz);
 		}
 	    } /* for jj ... */
@@ -451,7 +446,7 @@ void zlsum_fmod_inv
     doublecomplex *dest;
 	doublecomplex *Linv;/* Inverse of diagonal block */
 	int    iam, iknsupc, myrow, krow, nbrow, nbrow1, nbrow_ref, nsupr, nsupr1, p, pi, idx_r,m;
-	int_t  i, ii,jj, ik, il, ikcol, irow, j, lb, lk, rel, lib,lready;
+	int_t  i, ii,jj, ik, il, ikcol, j, lb, lk, rel, lib,lready;
 	int_t  *lsub, *lsub1, nlb1, lptr1, luptr1,*lloc;
     int_t  *ilsum = Llu->ilsum; /* Starting position of each supernode in lsum.   */
     int  *frecv = Llu->frecv;
@@ -536,11 +531,11 @@ void zlsum_fmod_inv
 
 #ifdef _OPENMP
 #ifdef __INTEL_COMPILER
-#pragma	omp	parallel for private (lptr1,luptr1,nlb1,thread_id1,lsub1,lusup1,nsupr1,Linv,nn,lbstart,lbend,luptr_tmp1,nbrow,lb,lptr1_tmp,rtemp_loc,nbrow_ref,lptr,nbrow1,ik,rel,lk,iknsupc,il,i,irow,fmod_tmp,ikcol,p,ii,jj,t1,t2,j,nleaf_send_tmp)
+#pragma	omp	parallel for private (lptr1,luptr1,nlb1,thread_id1,lsub1,lusup1,nsupr1,Linv,nn,lbstart,lbend,luptr_tmp1,nbrow,lb,lptr1_tmp,rtemp_loc,nbrow_ref,lptr,nbrow1,ik,rel,lk,iknsupc,il,i,fmod_tmp,ikcol,p,ii,jj,t1,t2,j,nleaf_send_tmp)
 #else
 // This taskloop causes code to crash or generate wrong solution for some intel and nv compilers
 #if defined __GNUC__  && !defined __NVCOMPILER
-#pragma	omp	taskloop private (lptr1,luptr1,nlb1,thread_id1,lsub1,lusup1,nsupr1,Linv,nn,lbstart,lbend,luptr_tmp1,nbrow,lb,lptr1_tmp,rtemp_loc,nbrow_ref,lptr,nbrow1,ik,rel,lk,iknsupc,il,i,irow,fmod_tmp,ikcol,p,ii,jj,t1,t2,j,nleaf_send_tmp) untied nogroup
+#pragma	omp	taskloop private (lptr1,luptr1,nlb1,thread_id1,lsub1,lusup1,nsupr1,Linv,nn,lbstart,lbend,luptr_tmp1,nbrow,lb,lptr1_tmp,rtemp_loc,nbrow_ref,lptr,nbrow1,ik,rel,lk,iknsupc,il,i,fmod_tmp,ikcol,p,ii,jj,t1,t2,j,nleaf_send_tmp) untied nogroup
 #endif
 #endif
 #endif
@@ -600,17 +595,12 @@ void zlsum_fmod_inv
 					    iknsupc = SuperSize( ik );
 					    il = LSUM_BLK( lk );
 
-					    RHS_ITERATE(j)
-		#ifdef _OPENMP
-		#pragma omp simd
-		#endif
-						for (i = 0; i < nbrow1; ++i) {
-					   	    irow = lsub[lptr+i] - rel; /* Relative row. */
-						    z_sub(&lsum[il+irow + j*iknsupc+sizelsum*thread_id1],
-							  &lsum[il+irow + j*iknsupc+sizelsum*thread_id1],
-							  &rtemp_loc[nbrow_ref+i + j*nbrow]);
-						}
-						nbrow_ref+=nbrow1;
+					    RHS_ITERATE(j) {
+					        zsimd_scatter_sub_rel(nbrow1, &lsub[lptr], rel,
+					    		&rtemp_loc[nbrow_ref + j*nbrow],
+					    		&lsum[il + j*iknsupc+sizelsum*thread_id1]);
+					    }
+					    nbrow_ref+=nbrow1;
 					} /* endd for lb ... */
 
 #if ( PROFlevel>=1 )
@@ -639,13 +629,7 @@ void zlsum_fmod_inv
 						p = PNUM( myrow, ikcol, grid );
 						if ( iam != p ) {
 						    for (ii=1;ii<num_thread;ii++)
-						#ifdef _OPENMP
-						#pragma omp simd
-						#endif
-							for (jj=0;jj<iknsupc*nrhs;jj++)
-								z_add(&lsum[il + jj ],
-									  &lsum[il + jj ],
-									  &lsum[il + jj + ii*sizelsum]);
+						        zsimd_add(iknsupc*nrhs, &lsum[il + ii*sizelsum], &lsum[il]);
 
 #ifdef _OPENMP
 #pragma omp atomic capture
@@ -660,13 +644,7 @@ void zlsum_fmod_inv
 							TIC(t1);
 #endif
 							for (ii=1;ii<num_thread;ii++)
-						#ifdef _OPENMP
-						#pragma omp simd
-						#endif
-							    for (jj=0;jj<iknsupc*nrhs;jj++)
-								z_add(&lsum[il + jj ],
-									  &lsum[il + jj ],
-									  &lsum[il + jj + ii*sizelsum]);
+							    zsimd_add(iknsupc*nrhs, &lsum[il + ii*sizelsum], &lsum[il]);
 
 							ii = X_BLK( lk );
 							RHS_ITERATE(j)
@@ -808,17 +786,11 @@ void zlsum_fmod_inv
 				iknsupc = SuperSize( ik );
 				il = LSUM_BLK( lk );
 
-				RHS_ITERATE(j)
-		#ifdef _OPENMP
-		#pragma omp simd
-		#endif
-				    for (i = 0; i < nbrow1; ++i) {
-					irow = lsub[lptr+i] - rel; /* Relative row. */
-
-					z_sub(&lsum[il+irow + j*iknsupc+sizelsum*thread_id],
-						  &lsum[il+irow + j*iknsupc+sizelsum*thread_id],
-						  &rtemp_loc[nbrow_ref+i + j*nbrow]);
-				    }
+				RHS_ITERATE(j) {
+				    zsimd_scatter_sub_rel(nbrow1, &lsub[lptr], rel,
+						&rtemp_loc[nbrow_ref + j*nbrow],
+						&lsum[il + j*iknsupc+sizelsum*thread_id]);
+				}
 				nbrow_ref+=nbrow1;
 			} /* end for lb ... */
 
@@ -849,13 +821,7 @@ void zlsum_fmod_inv
 				    p = PNUM( myrow, ikcol, grid );
 				    if ( iam != p ) {
 					for (ii=1;ii<num_thread;ii++)
-				#ifdef _OPENMP
-				#pragma omp simd
-				#endif
-				    	    for (jj=0;jj<iknsupc*nrhs;jj++)
-						z_add(&lsum[il + jj ],
-							  &lsum[il + jj ],
-							  &lsum[il + jj + ii*sizelsum]);
+					    zsimd_add(iknsupc*nrhs, &lsum[il + ii*sizelsum], &lsum[il]);
 
 #ifdef _OPENMP
 #pragma omp atomic capture
@@ -869,13 +835,7 @@ void zlsum_fmod_inv
 					TIC(t1);
 #endif
 					for (ii=1;ii<num_thread;ii++)
-				#ifdef _OPENMP
-				#pragma omp simd
-				#endif
-					    for (jj=0;jj<iknsupc*nrhs;jj++)
-						z_add(&lsum[il + jj ],
-							  &lsum[il + jj ],
-							  &lsum[il + jj + ii*sizelsum]);
+					    zsimd_add(iknsupc*nrhs, &lsum[il + ii*sizelsum], &lsum[il]);
 
 					ii = X_BLK( lk );
 					RHS_ITERATE(j)
@@ -1016,7 +976,7 @@ void zlsum_fmod_inv_master
     doublecomplex *dest;
 	doublecomplex *Linv;/* Inverse of diagonal block */
 	int    iam, iknsupc, myrow, krow, nbrow, nbrow1, nbrow_ref, nsupr, nsupr1, p, pi, idx_r;
-	int_t  i, ii,jj, ik, il, ikcol, irow, j, lb, lk, rel, lib,lready;
+	int_t  i, ii,jj, ik, il, ikcol, j, lb, lk, rel, lib,lready;
 	int_t  *lsub, *lsub1, nlb1, lptr1, luptr1,*lloc;
     int_t  *ilsum = Llu->ilsum; /* Starting position of each supernode in lsum.   */
     int  *frecv = Llu->frecv;
@@ -1100,7 +1060,7 @@ void zlsum_fmod_inv_master
 
 #ifdef _OPENMP
 #if defined __GNUC__  && !defined __NVCOMPILER
-#pragma	omp	taskloop private (lptr1,luptr1,nlb1,thread_id1,lsub1,lusup1,nsupr1,Linv,nn,lbstart,lbend,luptr_tmp1,nbrow,lb,lptr1_tmp,rtemp_loc,nbrow_ref,lptr,nbrow1,ik,rel,lk,iknsupc,il,i,irow,fmod_tmp,ikcol,p,ii,jj,t1,t2,j) untied
+#pragma	omp	taskloop private (lptr1,luptr1,nlb1,thread_id1,lsub1,lusup1,nsupr1,Linv,nn,lbstart,lbend,luptr_tmp1,nbrow,lb,lptr1_tmp,rtemp_loc,nbrow_ref,lptr,nbrow1,ik,rel,lk,iknsupc,il,i,fmod_tmp,ikcol,p,ii,jj,t1,t2,j) untied
 #endif
 #endif
 			for (nn=0;nn<Nchunk;++nn){
@@ -1159,16 +1119,11 @@ void zlsum_fmod_inv_master
 						iknsupc = SuperSize( ik );
 						il = LSUM_BLK( lk );
 
-						RHS_ITERATE(j)
-					#ifdef _OPENMP
-					#pragma omp simd lastprivate(irow)
-					#endif
-							for (i = 0; i < nbrow1; ++i) {
-								irow = lsub[lptr+i] - rel; /* Relative row. */
-								z_sub(&lsum[il+irow + j*iknsupc],
-									  &lsum[il+irow + j*iknsupc],
-									  &rtemp_loc[nbrow_ref+i + j*nbrow]);
-							}
+						RHS_ITERATE(j) {
+						    zsimd_scatter_sub_rel(nbrow1, &lsub[lptr], rel,
+								&rtemp_loc[nbrow_ref + j*nbrow],
+								&lsum[il + j*iknsupc]);
+						}
 						nbrow_ref+=nbrow1;
 					} /* end for lb ... */
 
@@ -1218,17 +1173,11 @@ void zlsum_fmod_inv_master
 				iknsupc = SuperSize( ik );
 				il = LSUM_BLK( lk );
 
-				RHS_ITERATE(j)
-			#ifdef _OPENMP
-			#pragma omp simd lastprivate(irow)
-			#endif
-					for (i = 0; i < nbrow1; ++i) {
-						irow = lsub[lptr+i] - rel; /* Relative row. */
-
-						z_sub(&lsum[il+irow + j*iknsupc+sizelsum*thread_id],
-							  &lsum[il+irow + j*iknsupc+sizelsum*thread_id],
-							  &rtemp_loc[nbrow_ref+i + j*nbrow]);
-					}
+				RHS_ITERATE(j) {
+				    zsimd_scatter_sub_rel(nbrow1, &lsub[lptr], rel,
+						&rtemp_loc[nbrow_ref + j*nbrow],
+						&lsum[il + j*iknsupc+sizelsum*thread_id]);
+				}
 				nbrow_ref+=nbrow1;
 			} /* end for lb ... */
 #if ( PROFlevel>=1 )
@@ -1431,7 +1380,7 @@ void zlsum_bmod_inv
 	 */
     doublecomplex alpha = {1.0, 0.0}, beta = {0.0, 0.0};
 	int    iam, iknsupc, knsupc, myrow, nsupr, p, pi;
-	int_t  fnz, gik, gikcol, i, ii, ik, ikfrow, iklrow, il, irow,
+	int_t  fnz, gik, gikcol, i, ii, ik, ikfrow, iklrow, il,
 	       j, jj, lk, lk1, nub, ub, uptr;
 	int_t  *usub;
 	doublecomplex *uval, *dest, *y;
@@ -1477,11 +1426,11 @@ void zlsum_bmod_inv
 		// printf("Unnz: %5d nub: %5d knsupc: %5d\n",Llu->Unnz[lk],nub,knsupc);
 #ifdef _OPENMP
 #ifdef __INTEL_COMPILER
-#pragma	omp	parallel for private (thread_id1,Uinv,nn,lbstart,lbend,ub,temp,rtemp_loc,ik,lk1,gik,gikcol,usub,uval,lsub,lusup,iknsupc,il,i,irow,bmod_tmp,p,ii,jj,t1,t2,j,ikfrow,iklrow,dest,y,uptr,fnz,nsupr)
+#pragma	omp	parallel for private (thread_id1,Uinv,nn,lbstart,lbend,ub,temp,rtemp_loc,ik,lk1,gik,gikcol,usub,uval,lsub,lusup,iknsupc,il,i,bmod_tmp,p,ii,jj,t1,t2,j,ikfrow,iklrow,dest,y,uptr,fnz,nsupr)
 #else
 // This taskloop causes code to crash or generate wrong solution for some intel and nv compilers
 #if defined __GNUC__  && !defined __NVCOMPILER
-#pragma	omp	taskloop firstprivate (stat) private (thread_id1,Uinv,nn,lbstart,lbend,ub,temp,rtemp_loc,ik,lk1,gik,gikcol,usub,uval,lsub,lusup,iknsupc,il,i,irow,bmod_tmp,p,ii,jj,t1,t2,j,ikfrow,iklrow,dest,y,uptr,fnz,nsupr,nroot_send_tmp) untied nogroup
+#pragma	omp	taskloop firstprivate (stat) private (thread_id1,Uinv,nn,lbstart,lbend,ub,temp,rtemp_loc,ik,lk1,gik,gikcol,usub,uval,lsub,lusup,iknsupc,il,i,bmod_tmp,p,ii,jj,t1,t2,j,ikfrow,iklrow,dest,y,uptr,fnz,nsupr,nroot_send_tmp) untied nogroup
 #endif
 #endif
 #endif
@@ -1525,16 +1474,9 @@ void zlsum_bmod_inv
 						fnz = usub[i + jj];
 						if ( fnz < iklrow ) { /* Nonzero segment. */
 							/* AXPY */
-//#ifdef _OPENMP
-//#pragma omp simd // In complex case, this SIMD loop has 2 instructions, the compiler may generate incoreect code, so need to disable this omp simd
-//#endif
-							for (irow = fnz; irow < iklrow; ++irow)
-								{
-								zz_mult(&temp, &uval[uptr], &y[jj]);
-								z_sub(&dest[irow - ikfrow], &dest[irow - ikfrow],
-									  &temp);
-								++uptr;
-								}
+							zsimd_axpy_sub(iklrow - fnz, &y[jj], &uval[uptr],
+								       &dest[fnz - ikfrow]);
+							uptr += iklrow - fnz;
 								stat[thread_id1]->ops[SOLVE] += 8 * (iklrow - fnz);
 
 						}
@@ -1718,17 +1660,9 @@ void zlsum_bmod_inv
 					fnz = usub[i + jj];
 					if ( fnz < iklrow ) { /* Nonzero segment. */
 						/* AXPY */
-//#ifdef _OPENMP
-//#pragma omp simd // In complex case, this SIMD loop has 2 instructions, the compiler may generate incoreect code, so need to disable this omp simd
-//#endif
-						for (irow = fnz; irow < iklrow; ++irow)
-
-							{
-								zz_mult(&temp, &uval[uptr], &y[jj]);
-								z_sub(&dest[irow - ikfrow], &dest[irow - ikfrow],
-									  &temp);
-								++uptr;
-							}
+						zsimd_axpy_sub(iklrow - fnz, &y[jj], &uval[uptr],
+							       &dest[fnz - ikfrow]);
+						uptr += iklrow - fnz;
 							stat[thread_id]->ops[SOLVE] += 8 * (iklrow - fnz);
 					}
 				} /* for jj ... */
@@ -1924,7 +1858,7 @@ void zlsum_bmod_inv_master
 	 */
     doublecomplex alpha = {1.0, 0.0}, beta = {0.0, 0.0};
 	int    iam, iknsupc, knsupc, myrow, nsupr, p, pi;
-	int_t  fnz, gik, gikcol, i, ii, ik, ikfrow, iklrow, il, irow,
+	int_t  fnz, gik, gikcol, i, ii, ik, ikfrow, iklrow, il,
 	       j, jj, lk, lk1, nub, ub, uptr;
 	int_t  *usub;
 	doublecomplex *uval, *dest, *y;
@@ -1972,7 +1906,7 @@ void zlsum_bmod_inv_master
 		remainder = nub % Nchunk;
 
 //#ifdef _OPENMP
-//#pragma	omp	taskloop firstprivate (stat) private (thread_id1,nn,lbstart,lbend,ub,temp,rtemp_loc,ik,gik,usub,uval,iknsupc,il,i,irow,jj,t1,t2,j,ikfrow,iklrow,dest,y,uptr,fnz) untied
+//#pragma	omp	taskloop firstprivate (stat) private (thread_id1,nn,lbstart,lbend,ub,temp,rtemp_loc,ik,gik,usub,uval,iknsupc,il,i,jj,t1,t2,j,ikfrow,iklrow,dest,y,uptr,fnz) untied
 //#endif
 		for (nn=0;nn<Nchunk;++nn){
 
@@ -2014,16 +1948,9 @@ void zlsum_bmod_inv_master
 						fnz = usub[i + jj];
 						if ( fnz < iklrow ) { /* Nonzero segment. */
 							/* AXPY */
-//#ifdef _OPENMP
-//#pragma omp simd // In complex case, this SIMD loop has 2 instructions, the compiler may generate incoreect code, so need to disable this omp simd
-//#endif
-							for (irow = fnz; irow < iklrow; ++irow)
-								{
-								zz_mult(&temp, &uval[uptr], &y[jj]);
-								z_sub(&dest[irow - ikfrow], &dest[irow - ikfrow],
-									  &temp);
-								++uptr;
-								}
+							zsimd_axpy_sub(iklrow - fnz, &y[jj], &uval[uptr],
+								       &dest[fnz - ikfrow]);
+							uptr += iklrow - fnz;
 							stat[thread_id1]->ops[SOLVE] += 8 * (iklrow - fnz);
 
 						}
@@ -2061,16 +1988,9 @@ void zlsum_bmod_inv_master
 					fnz = usub[i + jj];
 					if ( fnz < iklrow ) { /* Nonzero segment. */
 						/* AXPY */
-//#ifdef _OPENMP
-//#pragma omp simd // In complex case, this SIMD loop has 2 instructions, the compiler may generate incoreect code, so need to disable this omp simd
-//#endif
-						for (irow = fnz; irow < iklrow; ++irow)
-							{
-							zz_mult(&temp, &uval[uptr], &y[jj]);
-							z_sub(&dest[irow - ikfrow], &dest[irow - ikfrow],
-								  &temp);
-							++uptr;
-							}
+						zsimd_axpy_sub(iklrow - fnz, &y[jj], &uval[uptr],
+							       &dest[fnz - ikfrow]);
+						uptr += iklrow - fnz;
 						stat[thread_id]->ops[SOLVE] += 8 * (iklrow - fnz);
 
 					}
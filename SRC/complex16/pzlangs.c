@@ -71,7 +71,7 @@ double pzlangs(char *norm, SuperMatrix *A, gridinfo_t *grid)
     double   value=0., sum;
     double   *rwork;
     double   tempvalue;
-    double   *temprwork;
+    superlu_colmap_t cm;
 
     Astore = (NRformat_loc *) A->Store;
     m_loc = Astore->m_loc;
@@ -101,6 +101,9 @@ double pzlangs(char *norm, SuperMatrix *A, gridinfo_t *grid)
 	    value = SUPERLU_MAX(value,sum);
 	}
 #else /* Sherry ==> */
+	/* The column sums are reduced on the owners of the columns. */
+	superlu_colmap_init(&cm, A->ncol, Astore->nnz_loc, Astore->colind,
+			    grid->comm);
 	if ( !(rwork = doubleCalloc_dist(A->ncol)) )
 	    ABORT("doubleCalloc_dist fails for rwork.");
 	for (i = 0; i < m_loc; ++i) {
@@ -109,16 +112,16 @@ double pzlangs(char *norm, SuperMatrix *A, gridinfo_t *grid)
 		rwork[jcol] += slud_z_abs(&Aval[j]);
 	    }
 	}
+	superlu_colmap_reduce(&cm, rwork, MPI_DOUBLE, MPI_SUM);
 
-	if ( !(temprwork = doubleCalloc_dist(A->ncol)) )
-	    ABORT("doubleCalloc_dist fails for temprwork.");
-	MPI_Allreduce(rwork, temprwork, A->ncol, MPI_DOUBLE, MPI_SUM, grid->comm);
 	value = 0.;
-	for (j = 0; j < A->ncol; ++j) {
-	    value = SUPERLU_MAX(value, temprwork[j]);
+	for (j = cm.fst_col; j < cm.fst_col + cm.ncol_loc; ++j) {
+	    value = SUPERLU_MAX(value, rwork[j]);
 	}
-	SUPERLU_FREE (temprwork);
+	MPI_Allreduce(&value, &tempvalue, 1, MPI_DOUBLE, MPI_MAX, grid->comm);
+	value = tempvalue;
 	SUPERLU_FREE (rwork);
+	superlu_colmap_free(&cm);
 #endif
     } else if ( strncmp(norm, "I", 1)==0 ) {
 	/* Find normI(A). */
@@ -414,7 +414,11 @@ void zLUstructInit(const int_t n, zLUstruct_t *LUstruct)
     if ( !(LUstruct->Llu = (zLocalLU_t *)
 	   SUPERLU_MALLOC(sizeof(zLocalLU_t))) )
 	ABORT("Malloc fails for LocalLU_t.");
-	LUstruct->Llu->inv = 0;
+    /* No L and U yet: zDestroy_LU() is a no-op until they are built. */
+    memset(LUstruct->Glu_persist, 0, sizeof(Glu_persist_t));
+    memset(LUstruct->Llu, 0, sizeof(zLocalLU_t));
+    LUstruct->work = NULL;
+    memset(&LUstruct->costmodel, 0, sizeof(superlu_costmodel_t));
 }
 
 /*! \brief Deallocate LUstruct */
@@ -450,6 +454,9 @@ zDestroy_LU(int_t n, gridinfo_t *grid, zLUstruct_t *LUstruct)
     CHECK_MALLOC(iam, "Enter zDestroy_LU()");
 #endif
 
+    /* Nothing was distributed, or the factors were freed already. */
+    if ( !Llu->Lrowind_bc_ptr ) return;
+
     zDestroy_Tree(n, grid, LUstruct);
 
     nsupers = Glu_persist->supno[n-1] + 1;
@@ -548,7 +555,9 @@ zDestroy_LU(int_t n, gridinfo_t *grid, zLUstruct_t *LUstruct)
 
     SUPERLU_FREE(Glu_persist->xsup);
     SUPERLU_FREE(Glu_persist->supno);
-    SUPERLU_FREE(Llu->bcols_masked);
+    Glu_persist->xsup = Glu_persist->supno = NULL;
+    Llu->Lrowind_bc_ptr = NULL;
+    if ( Llu->bcols_masked ) SUPERLU_FREE(Llu->bcols_masked);
 
 #ifdef GPU_ACC
 if (get_acc_solve()){
@@ -1243,14 +1252,16 @@ void zDestroy_A3d_gathered_on_2d(zSOLVEstruct_t *SOLVEstruct, gridinfo3d_t *grid
 #else
 void zDestroy_A3d_gathered_on_2d(zSOLVEstruct_t *SOLVEstruct, gridinfo3d_t *grid3d)
 {
-    /* free A2d and B2d, which are allocated on all 2D layers*/
+    /* free A2d and B2d, which are allocated on all 2D layers;
+       the nonzeros of A2d are only on layer 0 */
     NRformat_loc3d *A3d = SOLVEstruct->A3d;
     NRformat_loc *A2d = A3d->A_nfmt;
-    // if (grid3d->zscp.Iam == 0) {
 	SUPERLU_FREE( A2d->rowptr );
+    if (grid3d->zscp.Iam == 0) {
 	SUPERLU_FREE( A2d->colind );
 	SUPERLU_FREE( A2d->nzval );
-    // }
+    }
+    if ( A3d->route ) superlu_free_route_A3d(A3d->route);
     SUPERLU_FREE(A3d->row_counts_int);  // free displacements and counts
     SUPERLU_FREE(A3d->row_disp);
     SUPERLU_FREE(A3d->nnz_counts_int);
@@ -1258,7 +1269,8 @@ void zDestroy_A3d_gathered_on_2d(zSOLVEstruct_t *SOLVEstruct, gridinfo3d_t *grid
     SUPERLU_FREE(A3d->b_counts_int);
     SUPERLU_FREE(A3d->b_disp);
     int rankorder = grid3d->rankorder;
-    if ( rankorder == 0 ) { /* Z-major in 3D grid */
+    /* The X(2d) -> X(3d) schedule is only built by zScatter_B3d(). */
+    if ( rankorder == 0 && A3d->num_procs_to_send != SLU_EMPTY ) { /* Z-major in 3D grid */
         SUPERLU_FREE(A3d->procs_to_send_list);
         SUPERLU_FREE(A3d->send_count_list);
         SUPERLU_FREE(A3d->procs_recv_from_list);
@@ -1322,6 +1334,7 @@ zDestroy_Tree(int_t n, gridinfo_t *grid, zLUstruct_t *LUstruct)
 #endif
 
     nsupers = Glu_persist->supno[n-1] + 1;
+    if ( !Llu->LBtree_ptr ) return; /* not built, no solve was done */
 
     nb = CEILING(nsupers, grid->npcol);
     for (i=0;i<nb;++i){
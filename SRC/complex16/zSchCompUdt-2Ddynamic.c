@@ -69,7 +69,7 @@ if ( msg0 && msg2 ) { /* L(:,k) and U(k,:) are not empty. */
 	 temp_nbrow = lsub[lptr+1];  /* Number of full rows. */
 
 	 int look_up_flag = 1; /* assume ib is outside look-up window */
-	 for (int j = k0+1; j < SUPERLU_MIN (k0 + num_look_aheads+2, nsupers );
+	 for (int j = k0+1; j < SUPERLU_MIN (look_end + 2, nsupers );
 	      ++j) {
 		 if ( ib == perm_c_supno[j] ) {
 		     look_up_flag = 0; /* flag ib within look-up window */
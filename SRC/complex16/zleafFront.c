@@ -0,0 +1,391 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Factor the leaf subtrees of a process in dense frontal matrices
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * In the right-looking supernodal factorization every supernode scatters
+ * its Schur complement update into the L and U blocks of its ancestors,
+ * locating each destination block through the index lists of the block
+ * column and row.  Low in the etree the updates are small, so the
+ * searches and the cache misses on blocks far apart dominate.  When a
+ * whole subtree of the supernodal etree is on the process, i.e. on a
+ * 1 x 1 (layer) grid, and its front -- the columns of the subtree, plus
+ * the rows and columns outside it that they update -- fits in SUPERLU_MF
+ * kilobytes, zleafFrontFactor() factors it multifrontally:
+ *   1. the updates of the subtree's supernodes go to a dense front,
+ *      addressed directly by row and column,
+ *   2. each supernode adds the updates of its descendants from the front
+ *      to its L and U blocks before it is eliminated,
+ *   3. the part of the front outside the subtree is extend-added to the
+ *      ancestors' blocks once.
+ * The caller skips the factorization and the Schur complement updates of
+ * the supernodes done here; the upper levels stay supernodal.
+ * </pre>
+ */
+
+#include "superlu_zdefs.h"
+
+/*! \brief Count the rows and columns outside supernodes fst..lst (columns
+ * fc..lc) updated by them, marking them with stamp in rmap[] and cmap[].
+ * If rlist (clist) is not NULL, the rows (columns) are instead numbered in
+ * the front from m on, and listed; those not numbered yet are SLU_EMPTY. */
+static void zfrontBorder(int_t fst, int_t lst, int_t stamp, int_t m,
+			 int_t *xsup, int_t **Lrowind_bc_ptr,
+			 int_t **Ufstnz_br_ptr, int_t *rmap, int_t *cmap,
+			 int_t *rlist, int_t *clist, int_t *nbr, int_t *nbc)
+{
+    int_t lc = xsup[lst+1] - 1, k, b, i, jj, row, col, ip, iukp, klst;
+    int_t *lsub, *usub;
+
+    *nbr = *nbc = 0;
+    for (k = fst; k <= lst; ++k) {
+	if ( (lsub = Lrowind_bc_ptr[k]) ) {
+	    for (b = 0, ip = BC_HEADER; b < lsub[0]; ++b) {
+		for (i = 0; i < lsub[ip+1]; ++i) {
+		    row = lsub[ip + LB_DESCRIPTOR + i];
+		    if ( row > lc && (rlist ? rmap[row] == SLU_EMPTY
+					   : rmap[row] != stamp) ) {
+			rmap[row] = rlist ? m + *nbr : stamp;
+			if ( rlist ) rlist[*nbr] = row;
+			++(*nbr);
+		    }
+		}
+		ip += LB_DESCRIPTOR + lsub[ip+1];
+	    }
+	}
+	if ( (usub = Ufstnz_br_ptr[k]) ) {
+	    klst = xsup[k+1];
+	    for (b = 0, iukp = BR_HEADER; b < usub[0]; ++b) {
+		col = xsup[usub[iukp]];
+		for (jj = 0; jj < SuperSize(usub[iukp]); ++jj, ++col) {
+		    if ( usub[iukp + UB_DESCRIPTOR + jj] < klst && col > lc
+			 && (clist ? cmap[col] == SLU_EMPTY
+				   : cmap[col] != stamp) ) {
+			cmap[col] = clist ? m + *nbc : stamp;
+			if ( clist ) clist[*nbc] = col;
+			++(*nbc);
+		    }
+		}
+		iukp += UB_DESCRIPTOR + SuperSize(usub[iukp]);
+	    }
+	}
+    }
+}
+
+/*! \brief Add the updates in the front F to the L blocks of supernode k,
+ * and gather its U blocks with their updates in the dense w x nc matrix
+ * Up (dir = 0), or scatter Up back to the U blocks (dir = 1).  On exit,
+ * ridx[] (cidx[]) are the front rows (columns) of L(:,k) (U(k,:)). */
+static void zfrontPanel(int_t k, int dir, doublecomplex *F, int_t ldf,
+			int_t *xsup, int_t *rmap, int_t *cmap, zLocalLU_t *Llu,
+			int_t *ridx, int_t *cidx, doublecomplex *Up, int_t *nc)
+{
+    int_t *lsub = Llu->Lrowind_bc_ptr[k], *usub = Llu->Ufstnz_br_ptr[k];
+    doublecomplex *lusup = Llu->Lnzval_bc_ptr[k], *uval = Llu->Unzval_br_ptr[k];
+    int_t w = SuperSize(k), fstr = xsup[k], nsupr, b, i, jj, ip, off;
+    int_t iukp, rukp, fnz, fc;
+    doublecomplex *f;
+
+    if ( !dir && lsub ) {
+	nsupr = lsub[1];
+	for (b = 0, ip = BC_HEADER, off = 0; b < lsub[0]; ++b) {
+	    for (i = 0; i < lsub[ip+1]; ++i, ++off)
+		ridx[off] = rmap[lsub[ip + LB_DESCRIPTOR + i]];
+	    ip += LB_DESCRIPTOR + lsub[ip+1];
+	}
+	for (jj = 0; jj < w; ++jj) {
+	    f = &F[cmap[fstr + jj] * ldf];
+	    for (i = 0; i < nsupr; ++i)
+		z_add(&lusup[i + jj * nsupr], &lusup[i + jj * nsupr],
+		      &f[ridx[i]]);
+	}
+    }
+    *nc = 0;
+    if ( usub ) {
+	for (b = 0, iukp = BR_HEADER, rukp = 0; b < usub[0]; ++b) {
+	    for (jj = 0; jj < SuperSize(usub[iukp]); ++jj) {
+		fnz = usub[iukp + UB_DESCRIPTOR + jj];
+		if ( fnz == xsup[k+1] ) continue; /* empty segment */
+		fc = cmap[xsup[usub[iukp]] + jj];
+		f = &Up[*nc * w];
+		if ( dir ) {
+		    for (i = fnz; i < xsup[k+1]; ++i, ++rukp)
+			uval[rukp] = f[i - fstr];
+		} else {
+		    cidx[*nc] = fc;
+		    for (i = fstr; i < fnz; ++i)
+			f[i - fstr] = F[rmap[i] + fc * ldf];
+		    for ( ; i < xsup[k+1]; ++i, ++rukp)
+			z_add(&f[i - fstr], &uval[rukp], &F[rmap[i] + fc * ldf]);
+		}
+		++(*nc);
+	    }
+	    iukp += UB_DESCRIPTOR + SuperSize(usub[iukp]);
+	}
+    }
+}
+
+/*! \brief Add the Schur complement of the front, rows and columns m and
+ * beyond, to the L blocks of block column gj and the U blocks of block
+ * row gi of the ancestors; gj (gi) < 0 skips the L (U) part.  Only the
+ * blocks in block rows (columns) with rsup[] (csup[]) equal to stamp are
+ * reached by the front. */
+static void zfrontExtendAdd(int_t gi, int_t gj, int_t stamp, doublecomplex *F,
+			    int_t ldf, int_t m, int_t *xsup, int_t *rmap,
+			    int_t *cmap, int_t *rsup, int_t *csup,
+			    zLocalLU_t *Llu)
+{
+    int_t *lsub, *usub, nsupr, b, i, jj, ip, off, fr, fc, iukp, rukp, klst;
+    doublecomplex *lusup, *uval;
+
+    if ( gj >= 0 && (lsub = Llu->Lrowind_bc_ptr[gj]) ) {
+	lusup = Llu->Lnzval_bc_ptr[gj];
+	nsupr = lsub[1];
+	for (b = 0, ip = BC_HEADER, off = 0; b < lsub[0]; ++b) {
+	    if ( rsup[lsub[ip]] == stamp ) {
+		for (i = 0; i < lsub[ip+1]; ++i) {
+		    fr = rmap[lsub[ip + LB_DESCRIPTOR + i]];
+		    if ( fr < m ) continue;
+		    for (jj = 0; jj < SuperSize(gj); ++jj)
+			if ( (fc = cmap[xsup[gj] + jj]) >= m )
+			    z_add(&lusup[off + i + jj * nsupr],
+				  &lusup[off + i + jj * nsupr],
+				  &F[fr + fc * ldf]);
+		}
+	    }
+	    off += lsub[ip+1];
+	    ip += LB_DESCRIPTOR + lsub[ip+1];
+	}
+    }
+    if ( gi >= 0 && (usub = Llu->Ufstnz_br_ptr[gi]) ) {
+	uval = Llu->Unzval_br_ptr[gi];
+	klst = xsup[gi+1];
+	for (b = 0, iukp = BR_HEADER, rukp = 0; b < usub[0]; ++b) {
+	    for (jj = 0; jj < SuperSize(usub[iukp]); ++jj) {
+		i = usub[iukp + UB_DESCRIPTOR + jj];
+		if ( csup[usub[iukp]] != stamp
+		     || (fc = cmap[xsup[usub[iukp]] + jj]) < m ) {
+		    rukp += klst - i;
+		    continue;
+		}
+		for ( ; i < klst; ++i, ++rukp)
+		    if ( (fr = rmap[i]) >= m )
+			z_add(&uval[rukp], &uval[rukp], &F[fr + fc * ldf]);
+	    }
+	    iukp += UB_DESCRIPTOR + SuperSize(usub[iukp]);
+	}
+    }
+}
+
+/*! \brief Factor the leaf subtrees of the process in dense fronts.
+ *
+ * <pre>
+ * nodeList[0 : nnodes-1] are the supernodes the caller factors, or all
+ * of them if nodeList is NULL; only subtrees of these are taken.
+ * On exit, done[k] = 1 for the supernodes factored here, whose Schur
+ * complement updates have been applied to the L and U blocks.  Tiny
+ * pivots are replaced and zero pivots reported in info as in
+ * pzgstrf2_trsm().  Returns the number of supernodes factored; 0 unless
+ * SUPERLU_MF (sp_ienv_dist(22)) is set and the grid is 1 x 1.
+ * </pre>
+ */
+int_t zleafFrontFactor(superlu_dist_options_t *options, int_t n,
+		       int_t nnodes, int_t *nodeList, double thresh,
+		       zLUstruct_t *LUstruct, gridinfo_t *grid,
+		       SuperLUStat_t *stat, int *info, int *done)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    zLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t nsupers, maxfront, maxsize = 0, nfront = 0, ndone = 0;
+    int_t *setree, *first, *nd, *sel, *rsup, *csup, *slist, *rmap, *cmap;
+    int_t *rlist, *clist, nbr_s, nbc_s;
+    int_t *ridx, *cidx, s, k, f, i, j, m, nbr, nbc, mr, mc, w, nsupr, nrow;
+    int_t ncol;
+    doublecomplex *F = NULL, *V, *Up, *lusup, *dj, temp;
+    doublecomplex one = {1.0, 0.0}, alpha = {-1.0, 0.0}, zero = {0.0, 0.0};
+
+    if ( n <= 0 || grid->nprow * grid->npcol != 1 ) return 0;
+    maxfront = (int_t) sp_ienv_dist(22, options) * 1024 / sizeof(doublecomplex);
+    if ( maxfront <= 0 ) return 0;
+    nsupers = supno[n-1] + 1;
+
+    setree = supernodal_etree(nsupers, LUstruct->etree, supno, xsup);
+    if ( !(first = intMalloc_dist(7 * nsupers + 6 * n)) )
+	ABORT("Malloc fails for first[].");
+    nd = first + nsupers;
+    sel = nd + nsupers;
+    rsup = sel + nsupers;
+    csup = rsup + nsupers;
+    slist = csup + nsupers;     /* 2 * nsupers */
+    rmap = slist + 2 * nsupers;
+    cmap = rmap + n;
+    rlist = cmap + n;
+    clist = rlist + n;
+    ridx = clist + n;
+    cidx = ridx + n;
+    for (j = 0; j < n; ++j) rmap[j] = cmap[j] = SLU_EMPTY;
+
+    /* The subtree of s is first[s] .. s if its nd[s] supernodes are
+       numbered in postorder; sel[] flags the supernodes the caller
+       factors. */
+    for (s = 0; s < nsupers; ++s) {
+	first[s] = s;
+	nd[s] = 1;
+	sel[s] = nodeList ? 0 : 1;
+	rsup[s] = csup[s] = SLU_EMPTY;
+    }
+    for (k = 0; nodeList && k < nnodes; ++k) sel[nodeList[k]] = 1;
+    for (s = 0; s < nsupers; ++s)
+	if ( setree[s] < nsupers ) {
+	    first[setree[s]] = SUPERLU_MIN(first[setree[s]], first[s]);
+	    nd[setree[s]] += nd[s];
+	}
+    for (s = 0; s < nsupers; ++s) {
+	if ( !sel[s] ) continue;
+	for (k = first[s]; k < s && sel[k]; ++k) ;
+	if ( k < s || nd[s] != s - first[s] + 1 ) sel[s] = 0;
+    }
+
+    /* Take the largest subtrees of at least two supernodes whose front
+       fits, top down; sel[s] = 2 for their roots. */
+    for (s = nsupers - 1; s >= 0; --s) {
+	if ( setree[s] < nsupers && sel[setree[s]] >= 2 ) {
+	    sel[s] = 3; /* in a taken subtree */
+	    continue;
+	}
+	if ( !sel[s] || first[s] == s ) continue;
+	m = xsup[s+1] - xsup[first[s]];
+	if ( m * m > maxfront ) continue;
+	zfrontBorder(first[s], s, s, 0, xsup, Llu->Lrowind_bc_ptr,
+		     Llu->Ufstnz_br_ptr, rmap, cmap, NULL, NULL, &nbr, &nbc);
+	if ( (m + nbr) * (m + nbc) > maxfront ) continue;
+	sel[s] = 2;
+	maxsize = SUPERLU_MAX(maxsize, (m + nbr) * (m + nbc));
+    }
+    for (j = 0; j < n; ++j) rmap[j] = cmap[j] = SLU_EMPTY;
+    SUPERLU_FREE(setree);
+
+    /* The front, the update of a supernode, and its U panel. */
+    if ( maxsize && !(F = doublecomplexMalloc_dist(3 * maxsize)) )
+	ABORT("Malloc fails for F[].");
+    V = F + maxsize;
+    Up = V + maxsize;
+
+    for (s = 0; s < nsupers; ++s) {
+	if ( sel[s] != 2 ) continue;
+	f = first[s];
+
+	/* The front: the columns of the subtree, then the rows (columns)
+	   outside it. */
+	m = xsup[s+1] - xsup[f];
+	for (j = xsup[f]; j < xsup[s+1]; ++j) rmap[j] = cmap[j] = j - xsup[f];
+	zfrontBorder(f, s, SLU_EMPTY, m, xsup, Llu->Lrowind_bc_ptr,
+		     Llu->Ufstnz_br_ptr, rmap, cmap, rlist, clist, &nbr, &nbc);
+	mr = m + nbr;
+	mc = m + nbc;
+	for (j = 0; j < mr * mc; ++j) F[j] = zero;
+
+	for (k = f; k <= s; ++k) {
+	    w = SuperSize(k);
+	    zfrontPanel(k, 0, F, mr, xsup, rmap, cmap, Llu, ridx, cidx, Up,
+			&ncol);
+	    lusup = Llu->Lnzval_bc_ptr[k];
+	    nsupr = Llu->Lrowind_bc_ptr[k][1];
+	    nrow = nsupr - w;
+
+	    /* Diagonal block, as in pzgstrf2_trsm(). */
+	    for (j = 0; j < w; ++j) {
+		dj = &lusup[j + j * nsupr];
+		if ( options->ReplaceTinyPivot == YES
+		     && slud_z_abs1(dj) < thresh ) {
+		    dj->r = dj->r < 0 ? -thresh : thresh;
+		    dj->i = 0.0;
+		    ++(stat->TinyPivots);
+		}
+		if ( dj->r == 0.0 && dj->i == 0.0 ) {
+		    *info = xsup[k] + j + 1;
+		} else {
+		    slud_z_div(&temp, &one, dj);
+		    superlu_zscal(w - j - 1, temp, dj + 1, 1);
+		}
+		if ( j < w - 1 )
+		    superlu_zger(w - j - 1, w - j - 1, alpha, dj + 1, 1,
+				 dj + nsupr, nsupr, dj + nsupr + 1, nsupr);
+	    }
+
+	    /* L and U panels, and the update into the front. */
+	    if ( nrow )
+		superlu_ztrsm("R", "U", "N", "N", nrow, w, one, lusup, nsupr,
+			      lusup + w, nsupr);
+	    if ( ncol ) {
+		superlu_ztrsm("L", "L", "N", "U", w, ncol, one, lusup, nsupr,
+			      Up, w);
+		zfrontPanel(k, 1, F, mr, xsup, rmap, cmap, Llu, ridx, cidx,
+			    Up, &ncol);
+	    }
+	    if ( nrow && ncol ) {
+		superlu_zgemm("N", "N", nrow, ncol, w, one, lusup + w, nsupr,
+			      Up, w, zero, V, nrow);
+		for (j = 0; j < ncol; ++j) {
+		    dj = &F[cidx[j] * mr];
+		    for (i = 0; i < nrow; ++i)
+			z_sub(&dj[ridx[w + i]], &dj[ridx[w + i]],
+			      &V[i + j * nrow]);
+		}
+	    }
+	    stat->ops[FACT] += 4. * (2. / 3. * w * w * w
+				      + (flops_t) w * w * (nrow + ncol)
+				      + 2. * nrow * ncol * w);
+	    done[k] = 1;
+	}
+
+	/* Extend-add: the L blocks of the block columns, and the U blocks
+	   of the block rows, the front reaches. */
+	for (j = 0, nbr_s = 0; j < nbr; ++j)
+	    if ( rsup[k = supno[rlist[j]]] != s ) {
+		rsup[k] = s;
+		slist[nbr_s++] = k;
+	    }
+	for (j = 0, nbc_s = nbr_s; j < nbc; ++j)
+	    if ( csup[k = supno[clist[j]]] != s ) {
+		csup[k] = s;
+		slist[nbc_s++] = k;
+	    }
+	for (j = 0; j < nbr_s; ++j)
+	    zfrontExtendAdd(slist[j], SLU_EMPTY, s, F, mr, m, xsup, rmap, cmap,
+			    rsup, csup, Llu);
+	for ( ; j < nbc_s; ++j)
+	    zfrontExtendAdd(SLU_EMPTY, slist[j], s, F, mr, m, xsup, rmap, cmap,
+			    rsup, csup, Llu);
+
+	for (j = xsup[f]; j < xsup[s+1]; ++j) rmap[j] = cmap[j] = SLU_EMPTY;
+	for (j = 0; j < nbr; ++j) rmap[rlist[j]] = SLU_EMPTY;
+	for (j = 0; j < nbc; ++j) cmap[clist[j]] = SLU_EMPTY;
+	++nfront;
+	ndone += s - f + 1;
+    }
+
+    if ( maxsize ) SUPERLU_FREE(F);
+    SUPERLU_FREE(first);
+#if ( PRNTlevel>=1 )
+    if ( nfront )
+	printf(".. zleafFrontFactor(): " IFMT " fronts, " IFMT " supernodes\n",
+	       nfront, ndone);
+#endif
+    return ndone;
+} /* zleafFrontFactor */
@@ -13,6 +13,7 @@ at the top-level directory.
 /*! @file
  * \brief Preprocessing routines for the 3D factorization/solve codes:
  *        - Gather {A,B} from 3D grid to 2D process layer 0
+ *        - Scatter A from 3D grid to the L and U blocks of all layers
  *        - Scatter B (solution) from 2D process layer 0 to 3D grid
  *
  * <pre>
@@ -68,6 +69,8 @@ void zGatherNRformat_loc3d
 	/* A3d is output. Compute counts from scratch */
 	A3d = SUPERLU_MALLOC(sizeof(NRformat_loc3d));
 	A3d->num_procs_to_send = SLU_EMPTY; // No X(2d) -> X(3d) comm. schedule yet
+	A3d->route = NULL; // No A(3d) -> L/U comm. schedule yet
+	A3d->A2d_stale = 0;
 	A2d = SUPERLU_MALLOC(sizeof(NRformat_loc));
 
 	// find number of nnzs
@@ -178,6 +181,7 @@ void zGatherNRformat_loc3d
 	   Only need to gather A2d matrix; the previous 2D matrix
 	   was overwritten by equilibration, perm_r and perm_c.  */
 	NRformat_loc *A2d = A3d->A_nfmt;
+	A3d->A2d_stale = 0;
 	row_counts_int = A3d->row_counts_int;
 	row_disp       = A3d->row_disp;
 	nnz_counts_int = A3d->nnz_counts_int;
@@ -283,9 +287,14 @@ void zGatherNRformat_loc3d
 /*
  * Gather {A,B} from 3D grid to 2D process on all layers
  *     Input:  {A, B, ldb} are distributed on 3D process grid
- *     Output: {A2d, B2d} are distributed 2D process grid replicated on all layers
+ *     Output: A2d is distributed on 2D process layer 0 for the preprocessing;
+ *             on the other layers A2d has the same rows but no nonzeros,
+ *             the L and U blocks are loaded by zScatter_A3d().
+ *             B2d is distributed 2D process grid replicated on all layers.
  *             output is in the returned A3d->{} structure.
  *             see supermatrix.h for nrformat_loc3d{} structure.
+ *     With Fact = SamePattern or SamePattern_SameRowPerm only the values
+ *     are gathered again; with Fact = FACTORED A2d is left as it is.
  */
 void zGatherNRformat_loc3d_allgrid
 (
@@ -312,6 +321,8 @@ void zGatherNRformat_loc3d_allgrid
 	/* A3d is output. Compute counts from scratch */
 	A3d = SUPERLU_MALLOC(sizeof(NRformat_loc3d));
 	A3d->num_procs_to_send = SLU_EMPTY; // No X(2d) -> X(3d) comm. schedule yet
+	A3d->route = NULL; // No A(3d) -> L/U comm. schedule yet
+	A3d->A2d_stale = 0;
 	A2d = SUPERLU_MALLOC(sizeof(NRformat_loc));
 
 	// find number of nnzs
@@ -349,21 +360,27 @@ void zGatherNRformat_loc3d_allgrid
 		b_counts_int[i] = nrhs1 * row_counts[i];
 	    }
 
+	/* Only layer 0 holds the nonzeros of A2d. */
+	if ( grid3d->zscp.Iam == 0 ) {
 		A2d->colind = intMalloc_dist(nnz_disp[grid3d->npdep]);
 		A2d->nzval = doublecomplexMalloc_dist(nnz_disp[grid3d->npdep]);
-		A2d->rowptr = intMalloc_dist((row_disp[grid3d->npdep] + 1));
-		A2d->rowptr[0] = 0;
+	} else {
+		A2d->colind = NULL;
+		A2d->nzval = NULL;
+	}
+		A2d->rowptr = intCalloc_dist((row_disp[grid3d->npdep] + 1));
 
-	MPI_Allgatherv(A->nzval, A->nnz_loc, SuperLU_MPI_DOUBLE_COMPLEX, A2d->nzval,
+	MPI_Gatherv(A->nzval, A->nnz_loc, SuperLU_MPI_DOUBLE_COMPLEX, A2d->nzval,
 		    nnz_counts_int, nnz_disp,
-		    SuperLU_MPI_DOUBLE_COMPLEX, grid3d->zscp.comm);
-	MPI_Allgatherv(A->colind, A->nnz_loc, mpi_int_t, A2d->colind,
+		    SuperLU_MPI_DOUBLE_COMPLEX, 0, grid3d->zscp.comm);
+	MPI_Gatherv(A->colind, A->nnz_loc, mpi_int_t, A2d->colind,
 		    nnz_counts_int, nnz_disp,
-		    mpi_int_t, grid3d->zscp.comm);
-	MPI_Allgatherv(&A->rowptr[1], A->m_loc, mpi_int_t, &A2d->rowptr[1],
+		    mpi_int_t, 0, grid3d->zscp.comm);
+	MPI_Gatherv(&A->rowptr[1], A->m_loc, mpi_int_t, &A2d->rowptr[1],
 		    row_counts_int, row_disp,
-		    mpi_int_t, grid3d->zscp.comm);
+		    mpi_int_t, 0, grid3d->zscp.comm);
 
+	if ( grid3d->zscp.Iam == 0 ) {
 	for (int i = 0; i < grid3d->npdep; i++)
 		{
 		for (int j = row_disp[i] + 1; j < row_disp[i + 1] + 1; j++)
@@ -373,10 +390,15 @@ void zGatherNRformat_loc3d_allgrid
 			}
 		}
 	A2d->nnz_loc = nnz_disp[grid3d->npdep];
+	} else {
+	A2d->nnz_loc = 0;
+	}
 	A2d->m_loc = row_disp[grid3d->npdep];
 
 	if (grid3d->rankorder == 1) { // XY-major
+		/* The layers hold consecutive rows; A2d starts at layer 0's. */
 		A2d->fst_row = A->fst_row;
+		MPI_Bcast(&A2d->fst_row, 1, mpi_int_t, 0, grid3d->zscp.comm);
 	} else { // Z-major
 		gridinfo_t *grid2d = &(grid3d->grid2d);
 		int procs2d = grid2d->nprow * grid2d->npcol;
@@ -416,21 +438,23 @@ void zGatherNRformat_loc3d_allgrid
 	   Only need to gather A2d matrix; the previous 2D matrix
 	   was overwritten by equilibration, perm_r and perm_c.  */
 	NRformat_loc *A2d = A3d->A_nfmt;
+	A3d->A2d_stale = 0;
 	row_counts_int = A3d->row_counts_int;
 	row_disp       = A3d->row_disp;
 	nnz_counts_int = A3d->nnz_counts_int;
 	nnz_disp       = A3d->nnz_disp;
 
-	MPI_Allgatherv(A->nzval, A->nnz_loc, SuperLU_MPI_DOUBLE_COMPLEX, A2d->nzval,
+	MPI_Gatherv(A->nzval, A->nnz_loc, SuperLU_MPI_DOUBLE_COMPLEX, A2d->nzval,
 		    nnz_counts_int, nnz_disp,
-		    SuperLU_MPI_DOUBLE_COMPLEX, grid3d->zscp.comm);
-	MPI_Allgatherv(A->colind, A->nnz_loc, mpi_int_t, A2d->colind,
+		    SuperLU_MPI_DOUBLE_COMPLEX, 0, grid3d->zscp.comm);
+	MPI_Gatherv(A->colind, A->nnz_loc, mpi_int_t, A2d->colind,
 		    nnz_counts_int, nnz_disp,
-		    mpi_int_t, grid3d->zscp.comm);
-	MPI_Allgatherv(&A->rowptr[1], A->m_loc, mpi_int_t, &A2d->rowptr[1],
+		    mpi_int_t, 0, grid3d->zscp.comm);
+	MPI_Gatherv(&A->rowptr[1], A->m_loc, mpi_int_t, &A2d->rowptr[1],
 		    row_counts_int, row_disp,
-		    mpi_int_t, grid3d->zscp.comm);
+		    mpi_int_t, 0, grid3d->zscp.comm);
 
+	if ( grid3d->zscp.Iam == 0 ) {
 	A2d->rowptr[0] = 0;
 	for (int i = 0; i < grid3d->npdep; i++)
 	{
@@ -441,10 +465,13 @@ void zGatherNRformat_loc3d_allgrid
 		}
 	}
 	A2d->nnz_loc = nnz_disp[grid3d->npdep];
+	}
 	A2d->m_loc = row_disp[grid3d->npdep];
 
 	if (grid3d->rankorder == 1) { // XY-major
+		/* The layers hold consecutive rows; A2d starts at layer 0's. */
 		A2d->fst_row = A->fst_row;
+		MPI_Bcast(&A2d->fst_row, 1, mpi_int_t, 0, grid3d->zscp.comm);
 	} else { // Z-major
 		gridinfo_t *grid2d = &(grid3d->grid2d);
 		int procs2d = grid2d->nprow * grid2d->npcol;
@@ -467,6 +494,8 @@ void zGatherNRformat_loc3d_allgrid
     } /* SamePattern or SamePattern_SameRowPerm */
 
     A3d->m_loc = A->m_loc;
+    A3d->A_nfmt3d = A; /* save the pointer to the original A
+			  stored on 3D process grid.  */
     A3d->B3d = (doublecomplex *) B; /* save the pointer to the original B
 				    stored on 3D process grid.  */
     A3d->ldb = ldb;
@@ -510,6 +539,77 @@ void zGatherNRformat_loc3d_allgrid
 
 } /* zGatherNRformat_loc3d_allgrid */
 
+/*
+ * Scatter A from 3D grid to the processes of all layers that load it
+ * into their L and U blocks
+ *     Input:  A3d->A_nfmt3d is distributed on 3D process grid
+ *     Output: {colptr, rowind, a} hold the nonzeros of Pc*Pr*diag(R)*A*diag(C)*Pc'
+ *             in the block rows and columns of my process on my layer, for
+ *             the supernodes whose values my layer keeps (IN_GRID_AIJ).
+ *             colptr and rowind belong to A3d->route; the caller frees a.
+ *     The route is built by superlu_route_A3d() and reused if
+ *     Fact = SamePattern_SameRowPerm, when only the values are sent.
+ */
+int_t zScatter_A3d(int_t n, NRformat_loc3d *A3d, fact_t Fact,
+		   zScalePermstruct_t *ScalePermstruct, Glu_persist_t *Glu_persist,
+		   int_t *supernode2treeMap, gridinfo3d_t *grid3d,
+		   int_t *colptr[], int_t *rowind[], doublecomplex *a[])
+{
+    NRformat_loc *A = A3d->A_nfmt3d;
+    A3dRoute_t *route = A3d->route;
+    DiagScale_t DiagScale = ScalePermstruct->DiagScale;
+    int rowequ = (DiagScale == ROW) || (DiagScale == BOTH);
+    int colequ = (DiagScale == COL) || (DiagScale == BOTH);
+    double *R = ScalePermstruct->R, *C = ScalePermstruct->C;
+    doublecomplex *nzval = (doublecomplex *) A->nzval, *sbuf = NULL, *rbuf = NULL;
+    doublecomplex aij;
+    int_t i, j, irow, fst_row;
+
+    /* My first row in the row order of A2d, to which perm_r and R refer. */
+    if ( grid3d->rankorder == 1 ) // XY-major
+	fst_row = A->fst_row;
+    else // Z-major
+	fst_row = A3d->A_nfmt->fst_row + A3d->row_disp[grid3d->zscp.Iam];
+
+    if ( Fact != SamePattern_SameRowPerm || !route ) {
+	if ( route ) superlu_free_route_A3d(route);
+	route = A3d->route = superlu_route_A3d(n, A, fst_row,
+			ScalePermstruct->perm_r, ScalePermstruct->perm_c,
+			Glu_persist->supno, supernode2treeMap, grid3d);
+    }
+
+    /* Scale the values and load them in the order of the destinations. */
+    if ( route->nsend && !(sbuf = doublecomplexMalloc_dist(route->nsend)) )
+	ABORT("Malloc fails for sbuf[].");
+    for (i = 0; i < A->m_loc; ++i) {
+	irow = i + fst_row;
+	for (j = A->rowptr[i]; j < A->rowptr[i+1]; ++j) {
+	    aij = nzval[j];
+	    if ( rowequ ) zd_mult(&aij, &aij, R[irow]);
+	    if ( colequ ) zd_mult(&aij, &aij, C[A->colind[j]]);
+	    sbuf[route->send_pos[j]] = aij;
+	}
+    }
+
+    *a = NULL;
+    if ( route->nrecv ) {
+	if ( !(rbuf = doublecomplexMalloc_dist(route->nrecv)) )
+	    ABORT("Malloc fails for rbuf[].");
+	if ( !(*a = doublecomplexMalloc_dist(route->nrecv)) )
+	    ABORT("Malloc fails for a[].");
+    }
+    MPI_Alltoallv(sbuf, route->send_counts, route->send_disp, SuperLU_MPI_DOUBLE_COMPLEX,
+		  rbuf, route->recv_counts, route->recv_disp, SuperLU_MPI_DOUBLE_COMPLEX,
+		  grid3d->comm);
+    for (i = 0; i < route->nrecv; ++i) (*a)[route->recv_pos[i]] = rbuf[i];
+
+    if ( route->nsend ) SUPERLU_FREE(sbuf);
+    if ( route->nrecv ) SUPERLU_FREE(rbuf);
+    *colptr = route->xa;
+    *rowind = route->asub;
+    return 0;
+} /* zScatter_A3d */
+
 /*
  * Scatter B (solution) from 2D process layer 0 to 3D grid
  *   Output: X3d <- A^{-1} B2d
@@ -23,6 +23,7 @@ at the top-level directory.
  */
 #include <math.h>
 #include "superlu_zdefs.h"
+#include "dcomplex_simd.h"
 
 void
 zscatter_l_1 (int ib,
@@ -175,12 +176,7 @@ zscatter_l (
     for (jj = 0; jj < nsupc; ++jj) {
         segsize = klst - usub[iukp + jj];
         if (segsize) {
-#if (_OPENMP>=201307)
-#pragma omp simd
-#endif
-            for (i = 0; i < temp_nbrow; ++i) {
-                z_sub(&nzval[indirect2[i]], &nzval[indirect2[i]], &tempv[i]);
-            }
+            zsimd_scatter_sub(temp_nbrow, indirect2, tempv, nzval);
             tempv += nbrow;
         }
         nzval += ldv;
@@ -211,7 +207,7 @@ zscatter_u (int ib,
     // TAU_STATIC_TIMER_START("SCATTER_U");
     // TAU_STATIC_TIMER_START("SCATTER_UB");
 
-    int_t jj, i, fnz, rel;
+    int_t jj, fnz;
     int segsize;
     doublecomplex *ucol;
     int_t ilst = FstBlockC (ib + 1);
@@ -243,24 +239,7 @@ zscatter_u (int ib,
         if (segsize) {          /* Nonzero segment in U(k,j). */
             ucol = &Unzval_br_ptr[lib][ruip_lib];
 
-            // printf("========Entering loop=========\n");
-#if (_OPENMP>=201307)
-#pragma omp simd
-#endif
-            for (i = 0; i < temp_nbrow; ++i) {
-                rel = lsub[lptr + i] - fnz;
-                // printf("%d %d %d %d %d \n",lptr,i,fnz,temp_nbrow,nbrow );
-                // printf("hello   ucol[%d] %d %d : \n",rel,lsub[lptr + i],fnz);
-                z_sub(&ucol[rel], &ucol[rel], &tempv[i]);
-
-#ifdef PI_DEBUG
-                double zz = 0.0;
-                if (!(*(long *) &zz == *(long *) &tempv[i]))
-                    printf ("(%d, %0.3e, %0.3e ) ", rel, ucol[rel] + tempv[i],
-                            ucol[rel]);
-                //printing triplets (location??, old value, new value ) if none of them is zero
-#endif
-            } /* for i = 0:temp_nbropw */
+            zsimd_scatter_sub_rel(temp_nbrow, &lsub[lptr], fnz, tempv, ucol);
             tempv += nbrow; /* Jump LDA to next column */
 #ifdef PI_DEBUG
             // printf("\n");
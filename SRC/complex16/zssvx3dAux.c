@@ -118,7 +118,7 @@ void zscalePrecomputed(SuperMatrix *A, zScalePermstruct_t *ScalePermstruct) {
 }
 
 void zscaleFromScratch(
-    SuperMatrix *A, zScalePermstruct_t *ScalePermstruct,
+    superlu_dist_options_t *options, SuperMatrix *A, zScalePermstruct_t *ScalePermstruct,
     gridinfo_t *grid, int *rowequ, int *colequ, int *iinfo)
 {
     NRformat_loc *Astore = (NRformat_loc *)A->Store;
@@ -133,8 +133,12 @@ void zscaleFromScratch(
     // int_t iinfo;
     char equed[1];
     int iam = grid->iam;
+    int nruiz = sp_ienv_dist(18, options);
 
-    pzgsequ(A, R, C, &rowcnd, &colcnd, &amax, iinfo, grid);
+    if (nruiz > 0)
+        pzgsequ_ruiz(A, R, C, nruiz, &rowcnd, &colcnd, &amax, iinfo, grid);
+    else
+        pzgsequ(A, R, C, &rowcnd, &colcnd, &amax, iinfo, grid);
 
     if (*iinfo > 0) {
 #if (PRNTlevel >= 1)
@@ -159,7 +163,7 @@ void zscaleFromScratch(
 #endif
 }
 
-void zscaleMatrixDiagonally(fact_t Fact, zScalePermstruct_t *ScalePermstruct,
+void zscaleMatrixDiagonally(superlu_dist_options_t *options, fact_t Fact, zScalePermstruct_t *ScalePermstruct,
                            SuperMatrix *A, SuperLUStat_t *stat, gridinfo_t *grid,
                             int *rowequ, int *colequ, int *iinfo)
 {
@@ -174,7 +178,7 @@ void zscaleMatrixDiagonally(fact_t Fact, zScalePermstruct_t *ScalePermstruct,
     if (Fact == SamePattern_SameRowPerm) {
         zscalePrecomputed(A, ScalePermstruct);
     } else {
-        zscaleFromScratch(A, ScalePermstruct, grid, rowequ, colequ, iinfo);
+        zscaleFromScratch(options, A, ScalePermstruct, grid, rowequ, colequ, iinfo);
     }
 
     stat->utime[EQUIL] = SuperLU_timer_() - t_start;
@@ -580,6 +584,42 @@ double zcomputeA_Norm(int notran, SuperMatrix *A, gridinfo_t *grid) {
     return anorm;
 }
 
+/**
+ * @brief Computes the norm of A as zcomputeA_Norm() does on layer 0, from the
+ *        input A on the 3D process grid; for when A2d is not gathered.
+ * @param notran A flag which determines the norm type to be calculated.
+ * @param scale Whether A2d would be scaled by ScalePermstruct (Equil).
+ * @param A The matrix on the 2D grid, for its dimensions.
+ * @param A3dstore The local part of A on the 3D process grid.
+ * @param ScalePermstruct The scalings, replicated on all layers.
+ * @param grid3d The 3D process grid; the call is collective over it.
+ * @return Returns the computed norm of the matrix A.
+ */
+double zcomputeA3d_Norm(int notran, int scale, SuperMatrix *A,
+                      NRformat_loc *A3dstore,
+                      zScalePermstruct_t *ScalePermstruct,
+                      gridinfo3d_t *grid3d)
+{
+    NRformat_loc Astore = *A3dstore;
+    SuperMatrix A3 = *A;
+    gridinfo_t grid;
+    double anorm;
+
+    A3.Store = &Astore;
+    if ( scale && ScalePermstruct->DiagScale != NOEQUIL ) {
+        if ( !(Astore.nzval = doublecomplexMalloc_dist(SUPERLU_MAX(1, Astore.nnz_loc))) )
+            ABORT("Malloc fails for Astore.nzval[].");
+        memcpy(Astore.nzval, A3dstore->nzval, Astore.nnz_loc * sizeof(doublecomplex));
+        zscalePrecomputed(&A3, ScalePermstruct);
+    }
+    grid.comm = grid3d->comm;
+    grid.iam = grid3d->iam;
+    anorm = zcomputeA_Norm(notran, &A3, &grid);
+    if ( Astore.nzval != A3dstore->nzval ) SUPERLU_FREE(Astore.nzval);
+
+    return anorm;
+}
+
 void zallocScalePermstruct_RC(zScalePermstruct_t * ScalePermstruct, int_t m, int_t n) {
     /* Allocate storage if not done so before. */
 	switch (ScalePermstruct->DiagScale) {
@@ -585,7 +585,7 @@ ztrf3Dpartition_t* zinitTrf3DpartitionLUstructgrid0(int_t n, superlu_dist_option
         /*update treelist with weight and depth*/
         getSCUweight(nsupers, treeList, xsup,
             LUstruct->Llu->Lrowind_bc_ptr, LUstruct->Llu->Ufstnz_br_ptr,
-            grid3d);
+            grid3d, &LUstruct->costmodel);
         int_t * scuWeight = intCalloc_dist(nsupers);
         for (int_t k = 0; k < nsupers ; ++k)
         {
@@ -602,7 +602,7 @@ ztrf3Dpartition_t* zinitTrf3DpartitionLUstructgrid0(int_t n, superlu_dist_option
         }
         SUPERLU_FREE(scuWeight);
     }
-    calcTreeWeight(nsupers, setree, treeList, xsup);
+    calcTreeWeight(nsupers, setree, treeList, xsup, &LUstruct->costmodel);
 
     if (grid3d->zscp.Iam){
         SUPERLU_FREE(xsup);
@@ -788,9 +788,9 @@ ztrf3Dpartition_t* zinitTrf3Dpartition_allgrid(int_t n, superlu_dist_options_t *
     /*update treelist with weight and depth*/
     getSCUweight_allgrid(nsupers, treeList, xsup,
         LUstruct->Llu->Lrowind_bc_ptr, LUstruct->Llu->Ufstnz_br_ptr,
-        grid3d);
+        grid3d, &LUstruct->costmodel);
 
-    calcTreeWeight(nsupers, setree, treeList, xsup);
+    calcTreeWeight(nsupers, setree, treeList, xsup, &LUstruct->costmodel);
 
     gEtreeInfo_t gEtreeInfo;
     gEtreeInfo.setree = setree;
@@ -967,9 +967,9 @@ ztrf3Dpartition_t* zinitTrf3Dpartition(int_t nsupers,
     /*update treelist with weight and depth*/
     getSCUweight(nsupers, treeList, xsup,
 		  LUstruct->Llu->Lrowind_bc_ptr, LUstruct->Llu->Ufstnz_br_ptr,
-		  grid3d);
+		  grid3d, &LUstruct->costmodel);
 
-    calcTreeWeight(nsupers, setree, treeList, xsup);
+    calcTreeWeight(nsupers, setree, treeList, xsup, &LUstruct->costmodel);
 
     gEtreeInfo_t gEtreeInfo;
     gEtreeInfo.setree = setree;
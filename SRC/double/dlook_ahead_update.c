@@ -37,9 +37,9 @@ for (jj = 0; jj < nub; ++jj) assert(perm_u[jj] == jj); /* Sherry */
 #endif
 
 #ifdef ISORT
-while (j < nub && iperm_u[j] <= k0 + num_look_aheads)
+while (j < nub && iperm_u[j] <= look_end)
 #else
-while (j < nub && perm_u[2 * j] <= k0 + num_look_aheads)
+while (j < nub && perm_u[2 * j] <= look_end)
 #endif
 {
     double zero = 0.0;
@@ -251,7 +251,7 @@ while (j < nub && perm_u[2 * j] <= k0 + num_look_aheads)
             msgcnt[1] = 0;
         }
 
-        scp = &grid->rscp;      /* The scope of process row. */
+        scp = msg_crit[kk] ? &rscp_hi : &grid->rscp; /* The scope of process row. */
         for (pj = 0; pj < Pc; ++pj) {
             if (ToSendR[lk][pj] != SLU_EMPTY) {
 #if ( PROFlevel>=1 )
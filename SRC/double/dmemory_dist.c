@@ -24,7 +24,7 @@ at the top-level directory.
 
 
 /* Variables external to this file */
-extern SuperLU_LU_stack_t stack;
+extern SUPERLU_THREAD_LOCAL SuperLU_LU_stack_t stack;
 
 
 void *duser_malloc_dist(int_t bytes, int_t which_end)
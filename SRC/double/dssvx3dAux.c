@@ -118,7 +118,7 @@ void dscalePrecomputed(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct) {
 }
 
 void dscaleFromScratch(
-    SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
+    superlu_dist_options_t *options, SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
     gridinfo_t *grid, int *rowequ, int *colequ, int *iinfo)
 {
     NRformat_loc *Astore = (NRformat_loc *)A->Store;
@@ -133,8 +133,12 @@ void dscaleFromScratch(
     // int_t iinfo;
     char equed[1];
     int iam = grid->iam;
+    int nruiz = sp_ienv_dist(18, options);
 
-    pdgsequ(A, R, C, &rowcnd, &colcnd, &amax, iinfo, grid);
+    if (nruiz > 0)
+        pdgsequ_ruiz(A, R, C, nruiz, &rowcnd, &colcnd, &amax, iinfo, grid);
+    else
+        pdgsequ(A, R, C, &rowcnd, &colcnd, &amax, iinfo, grid);
 
     if (*iinfo > 0) {
 #if (PRNTlevel >= 1)
@@ -159,7 +163,7 @@ void dscaleFromScratch(
 #endif
 }
 
-void dscaleMatrixDiagonally(fact_t Fact, dScalePermstruct_t *ScalePermstruct,
+void dscaleMatrixDiagonally(superlu_dist_options_t *options, fact_t Fact, dScalePermstruct_t *ScalePermstruct,
                            SuperMatrix *A, SuperLUStat_t *stat, gridinfo_t *grid,
                             int *rowequ, int *colequ, int *iinfo)
 {
@@ -174,7 +178,7 @@ void dscaleMatrixDiagonally(fact_t Fact, dScalePermstruct_t *ScalePermstruct,
     if (Fact == SamePattern_SameRowPerm) {
         dscalePrecomputed(A, ScalePermstruct);
     } else {
-        dscaleFromScratch(A, ScalePermstruct, grid, rowequ, colequ, iinfo);
+        dscaleFromScratch(options, A, ScalePermstruct, grid, rowequ, colequ, iinfo);
     }
 
     stat->utime[EQUIL] = SuperLU_timer_() - t_start;
@@ -583,6 +587,42 @@ double dcomputeA_Norm(int notran, SuperMatrix *A, gridinfo_t *grid) {
     return anorm;
 }
 
+/**
+ * @brief Computes the norm of A as dcomputeA_Norm() does on layer 0, from the
+ *        input A on the 3D process grid; for when A2d is not gathered.
+ * @param notran A flag which determines the norm type to be calculated.
+ * @param scale Whether A2d would be scaled by ScalePermstruct (Equil).
+ * @param A The matrix on the 2D grid, for its dimensions.
+ * @param A3dstore The local part of A on the 3D process grid.
+ * @param ScalePermstruct The scalings, replicated on all layers.
+ * @param grid3d The 3D process grid; the call is collective over it.
+ * @return Returns the computed norm of the matrix A.
+ */
+double dcomputeA3d_Norm(int notran, int scale, SuperMatrix *A,
+                      NRformat_loc *A3dstore,
+                      dScalePermstruct_t *ScalePermstruct,
+                      gridinfo3d_t *grid3d)
+{
+    NRformat_loc Astore = *A3dstore;
+    SuperMatrix A3 = *A;
+    gridinfo_t grid;
+    double anorm;
+
+    A3.Store = &Astore;
+    if ( scale && ScalePermstruct->DiagScale != NOEQUIL ) {
+        if ( !(Astore.nzval = doubleMalloc_dist(SUPERLU_MAX(1, Astore.nnz_loc))) )
+            ABORT("Malloc fails for Astore.nzval[].");
+        memcpy(Astore.nzval, A3dstore->nzval, Astore.nnz_loc * sizeof(double));
+        dscalePrecomputed(&A3, ScalePermstruct);
+    }
+    grid.comm = grid3d->comm;
+    grid.iam = grid3d->iam;
+    anorm = dcomputeA_Norm(notran, &A3, &grid);
+    if ( Astore.nzval != A3dstore->nzval ) SUPERLU_FREE(Astore.nzval);
+
+    return anorm;
+}
+
 void dallocScalePermstruct_RC(dScalePermstruct_t * ScalePermstruct, int_t m, int_t n) {
     /* Allocate storage if not done so before. */
 	switch (ScalePermstruct->DiagScale) {
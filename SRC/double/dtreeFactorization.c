@@ -340,11 +340,21 @@ int_t dsparseTreeFactor_ASYNC(
     int * factored_U = factStat->factored_U;
     int * IbcastPanel_L = factStat->IbcastPanel_L;
     int * IbcastPanel_U = factStat->IbcastPanel_U;
+    int * frontDone = factStat->frontDone;
     int_t* xsup = LUstruct->Glu_persist->xsup;
 
     int_t numLAMax = getNumLookAhead(options);
     int_t numLA = numLAMax;
 
+    /* The supernodes factored in leaf fronts are skipped below. */
+    for (int_t k0 = 0; k0 < nnodes; ++k0)
+    {
+        int_t k = perm_c_supno[k0];
+        if (frontDone[k])
+            factored_D[k] = factored_L[k] = factored_U[k] =
+            IbcastPanel_L[k] = IbcastPanel_U[k] = 1;
+    }
+
 #if ( PRNTlevel>=2 )
     // Sherry print
     printf("sforest: nNodes %d, numlvl %d\n", (int) nnodes, (int) maxTopoLevel);
@@ -364,6 +374,7 @@ int_t dsparseTreeFactor_ASYNC(
     {
         int_t k = perm_c_supno[k0];   // direct computation no perm_c_supno
         int_t offset = k0;
+        if (frontDone[k]) continue;
         /* k-th diagonal factorization */
         /*Now factor and broadcast diagonal block*/
 
@@ -469,6 +480,10 @@ int_t dsparseTreeFactor_ASYNC(
 
             double tsch = SuperLU_timer_();
 
+            /* updated in its front */
+            if (frontDone[k])
+                msgss[offset]->msgcnt[0] = msgss[offset]->msgcnt[2] = 0;
+
             int_t LU_nonempty = dSchurComplementSetupGPU(k,
 							 msgss[offset], packLUInfo,
 							 myIperm, gIperm_c_supno,
@@ -548,7 +563,7 @@ int_t dsparseTreeFactor_ASYNC(
 		    gEtreeInfo->numChildLeft[k_parent]--;
                     if (gEtreeInfo->numChildLeft[k_parent] == 0) {
                         int_t k0_parent =  myIperm[k_parent];
-                        if (k0_parent > 0)
+                        if (k0_parent > 0 && !factored_D[k_parent])
 			{
                             /* code */
                             assert(k0_parent < nnodes);
@@ -82,6 +82,55 @@ at the top-level directory.
 </pre>
 */
 
+/*! \brief The first zero of v[0 : n-1] over all processes, plus 1.
+ *
+ * <pre>
+ * Each process holds the block of the global vector starting at index
+ * fst; returns 0 if there is no zero.  Collective over comm.
+ * </pre>
+ */
+static int_t dfirst_zero(double *v, int_t n, int_t fst, int_t nglobal,
+			 MPI_Comm comm)
+{
+    int_t j, loc = nglobal, first;
+
+    for (j = 0; j < n; ++j)
+	if ( v[j] == 0. ) { loc = fst + j; break; }
+    MPI_Allreduce(&loc, &first, 1, mpi_int_t, MPI_MIN, comm);
+    return ( first < nglobal ? first + 1 : 0 );
+}
+
+/*! \brief Replicate the local rows r[fst_row : fst_row+m_loc-1] of R. */
+static void dgather_r(double *r, int_t fst_row, int_t m_loc, gridinfo_t *grid)
+{
+    int *r_sizes, *displs;
+    double *loc_r;
+    int_t i, j, procs;
+
+    procs = grid->nprow * grid->npcol;
+    if ( !(r_sizes = SUPERLU_MALLOC(2 * procs * sizeof(int))))
+      ABORT("Malloc fails for r_sizes[].");
+    displs = r_sizes + procs;
+    if ( !(loc_r = doubleMalloc_dist(m_loc)))
+      ABORT("Malloc fails for loc_r[].");
+    j = fst_row;
+    for (i = 0; i < m_loc; ++i) loc_r[i] = r[j++];
+
+    /* First gather the size of each piece. */
+    MPI_Allgather(&m_loc, 1, MPI_INT, r_sizes, 1, MPI_INT, grid->comm);
+
+    /* Set up the displacements for allgatherv */
+    displs[0] = 0;
+    for (i = 1; i < procs; ++i) displs[i] = displs[i-1] + r_sizes[i-1];
+
+    /* Now gather the actual data */
+    MPI_Allgatherv(loc_r, m_loc, MPI_DOUBLE, r, r_sizes, displs,
+                MPI_DOUBLE, grid->comm);
+
+    SUPERLU_FREE(r_sizes);
+    SUPERLU_FREE(loc_r);
+}
+
 void
 pdgsequ(SuperMatrix *A, double *r, double *c, double *rowcnd,
 	double *colcnd, double *amax, int *info, gridinfo_t *grid)
@@ -90,14 +139,11 @@ pdgsequ(SuperMatrix *A, double *r, double *c, double *rowcnd,
     /* Local variables */
     NRformat_loc *Astore;
     double *Aval;
-    int_t i, j, irow, jcol, m_loc;
+    int_t i, j, irow, jcol, m_loc, fst_row;
     double rcmin, rcmax;
     double bignum, smlnum;
     double tempmax, tempmin;
-    double *loc_max;
-    int *r_sizes, *displs;
-    double *loc_r;
-    int_t  procs;
+    superlu_colmap_t cm;
 
     /* Test the input parameters. */
     *info = 0;
@@ -121,30 +167,26 @@ pdgsequ(SuperMatrix *A, double *r, double *c, double *rowcnd,
     Astore = A->Store;
     Aval = Astore->nzval;
     m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
 
     /* Get machine constants. */
     smlnum = dmach_dist("S");
     bignum = 1. / smlnum;
 
-    /* Compute row scale factors. */
-    for (i = 0; i < A->nrow; ++i) r[i] = 0.;
-
-    /* Find the maximum element in each row. */
-    irow = Astore->fst_row;
+    /* Compute row scale factors: find the maximum element in each
+       local row, and the maximum and minimum of these. */
+    rcmin = bignum;
+    rcmax = 0.;
+    irow = fst_row;
     for (i = 0; i < m_loc; ++i) {
+	r[irow] = 0.;
 	for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j)
 	    r[irow] = SUPERLU_MAX( r[irow], fabs(Aval[j]) );
+	rcmax = SUPERLU_MAX(rcmax, r[irow]);
+	rcmin = SUPERLU_MIN(rcmin, r[irow]);
 	++irow;
     }
 
-    /* Find the maximum and minimum scale factors. */
-    rcmin = bignum;
-    rcmax = 0.;
-    for (i = Astore->fst_row; i < Astore->fst_row + m_loc; ++i) {
-	rcmax = SUPERLU_MAX(rcmax, r[i]);
-	rcmin = SUPERLU_MIN(rcmin, r[i]);
-    }
-
     /* Get the global MAX and MIN for R */
     tempmax = rcmax;
     tempmin = rcmin;
@@ -157,25 +199,26 @@ pdgsequ(SuperMatrix *A, double *r, double *c, double *rowcnd,
 
     if (rcmin == 0.) {
 	/* Find the first zero scale factor and return an error code. */
-	for (i = 0; i < A->nrow; ++i)
-	    if (r[i] == 0.) {
-		*info = i + 1;
-		return;
-	    }
+	*info = dfirst_zero(&r[fst_row], m_loc, fst_row, A->nrow, grid->comm);
+	return;
     } else {
 	/* Invert the scale factors. */
-	for (i = 0; i < A->nrow; ++i)
+	for (i = fst_row; i < fst_row + m_loc; ++i)
 	    r[i] = 1. / SUPERLU_MIN( SUPERLU_MAX( r[i], smlnum ), bignum );
 	/* Compute ROWCND = min(R(I)) / max(R(I)) */
 	*rowcnd = SUPERLU_MAX( rcmin, smlnum ) / SUPERLU_MIN( rcmax, bignum );
     }
 
-    /* Compute column scale factors */
-    for (j = 0; j < A->ncol; ++j) c[j] = 0.;
+    /* Compute column scale factors.  Each column is reduced on its owner
+       from the processes whose rows touch it, see colreduce.c, instead
+       of by an all-reduce of length A->ncol. */
+    superlu_colmap_init(&cm, A->ncol, Astore->nnz_loc, Astore->colind,
+			grid->comm);
+    for (i = 0; i < cm.nsend; ++i) c[cm.cols[i]] = 0.;
 
     /* Find the maximum element in each column, assuming the row
        scalings computed above. */
-    irow = Astore->fst_row;
+    irow = fst_row;
     for (i = 0; i < m_loc; ++i) {
         for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j) {
 	    jcol = Astore->colind[j];
@@ -183,62 +226,192 @@ pdgsequ(SuperMatrix *A, double *r, double *c, double *rowcnd,
 	}
 	++irow;
     }
+    superlu_colmap_reduce(&cm, c, MPI_DOUBLE, MPI_MAX);
 
-    /* Find the global maximum for c[j] */
-    if ( !(loc_max = doubleMalloc_dist(A->ncol)))
-      ABORT("Malloc fails for loc_max[].");
-    for (j = 0; j < A->ncol; ++j) loc_max[j] = c[j];
-    MPI_Allreduce(loc_max, c, A->ncol, MPI_DOUBLE, MPI_MAX, grid->comm);
-    SUPERLU_FREE(loc_max);
-
-    /* Find the maximum and minimum scale factors. */
+    /* Find the maximum and minimum scale factors of my columns. */
     rcmin = bignum;
     rcmax = 0.;
-    for (j = 0; j < A->ncol; ++j) {
+    for (j = cm.fst_col; j < cm.fst_col + cm.ncol_loc; ++j) {
 	rcmax = SUPERLU_MAX(rcmax, c[j]);
 	rcmin = SUPERLU_MIN(rcmin, c[j]);
     }
+    tempmax = rcmax;
+    tempmin = rcmin;
+    MPI_Allreduce( &tempmax, &rcmax,
+		1, MPI_DOUBLE, MPI_MAX, grid->comm);
+    MPI_Allreduce( &tempmin, &rcmin,
+		1, MPI_DOUBLE, MPI_MIN, grid->comm);
 
     if (rcmin == 0.) {
 	/* Find the first zero scale factor and return an error code. */
-	for (j = 0; j < A->ncol; ++j)
-	    if ( c[j] == 0. ) {
-		*info = A->nrow + j + 1;
-		return;
-	    }
+	*info = A->nrow + dfirst_zero(&c[cm.fst_col], cm.ncol_loc, cm.fst_col,
+				      A->ncol, grid->comm);
+	superlu_colmap_free(&cm);
+	return;
     } else {
 	/* Invert the scale factors. */
-	for (j = 0; j < A->ncol; ++j)
+	for (j = cm.fst_col; j < cm.fst_col + cm.ncol_loc; ++j)
 	    c[j] = 1. / SUPERLU_MIN( SUPERLU_MAX( c[j], smlnum ), bignum);
 	/* Compute COLCND = min(C(J)) / max(C(J)) */
 	*colcnd = SUPERLU_MAX( rcmin, smlnum ) / SUPERLU_MIN( rcmax, bignum );
     }
 
-    /* gather R from each process to get the global R.  */
+    /* Gather C and R from each process to get the global C and R. */
+    superlu_colmap_allgather(&cm, c, MPI_DOUBLE);
+    superlu_colmap_free(&cm);
+    dgather_r(r, fst_row, m_loc, grid);
 
-    procs = grid->nprow * grid->npcol;
-    if ( !(r_sizes = SUPERLU_MALLOC(2 * procs * sizeof(int))))
-      ABORT("Malloc fails for r_sizes[].");
-    displs = r_sizes + procs;
-    if ( !(loc_r = doubleMalloc_dist(m_loc)))
-      ABORT("Malloc fails for loc_r[].");
-    j = Astore->fst_row;
-    for (i = 0; i < m_loc; ++i) loc_r[i] = r[j++];
+    return;
 
-    /* First gather the size of each piece. */
-    MPI_Allgather(&m_loc, 1, MPI_INT, r_sizes, 1, MPI_INT, grid->comm);
+} /* pdgsequ */
 
-    /* Set up the displacements for allgatherv */
-    displs[0] = 0;
-    for (i = 1; i < procs; ++i) displs[i] = displs[i-1] + r_sizes[i-1];
+/*! \brief
 
-    /* Now gather the actual data */
-    MPI_Allgatherv(loc_r, m_loc, MPI_DOUBLE, r, r_sizes, displs,
-                MPI_DOUBLE, grid->comm);
+ <pre>
+    Purpose
+    =======
 
-    SUPERLU_FREE(r_sizes);
-    SUPERLU_FREE(loc_r);
+    PDGSEQU_RUIZ computes row and column scalings of an M-by-N sparse
+    matrix A by NITER sweeps of Ruiz's iterative equilibration.  Each sweep
+    divides every row and every column of B(i,j) = R(i)*A(i,j)*C(j) by the
+    square root of its largest absolute value, so that these all tend to 1
+    together.  Unlike the one-pass scaling of PDGSEQU, it keeps a symmetric
+    matrix symmetric.
 
-    return;
+    The other arguments are those of PDGSEQU.  ROWCND and COLCND are the
+    ratios of the smallest to the largest R(i) and C(j), and AMAX is the
+    absolute value of the largest element of A, so that PDLAQGS decides
+    whether to scale as it does after PDGSEQU.
 
-} /* pdgsequ */
+    NITER   (input) int
+            The number of sweeps, at least 1.
+    =====================================================================
+</pre>
+*/
+
+void
+pdgsequ_ruiz(SuperMatrix *A, double *r, double *c, int niter,
+	     double *rowcnd, double *colcnd, double *amax, int *info,
+	     gridinfo_t *grid)
+{
+    /* Local variables */
+    NRformat_loc *Astore;
+    double *Aval;
+    int_t i, j, irow, jcol, m_loc, fst_row;
+    double rcmin, rcmax, ccmin, ccmax, aij;
+    double tempmax, tempmin;
+    double *rmax, *cmax;
+    superlu_colmap_t cm;
+    int it;
+
+    /* Test the input parameters. */
+    *info = 0;
+    if ( A->nrow < 0 || A->ncol < 0 ||
+	 A->Stype != SLU_NR_loc || A->Dtype != SLU_D || A->Mtype != SLU_GE )
+	*info = -1;
+    else if ( niter < 1 )
+	*info = -4;
+    if (*info != 0) {
+	i = -(*info);
+	pxerr_dist("pdgsequ_ruiz", grid, i);
+	return;
+    }
+
+    /* Quick return if possible */
+    if ( A->nrow == 0 || A->ncol == 0 ) {
+	*rowcnd = 1.;
+	*colcnd = 1.;
+	*amax = 0.;
+	return;
+    }
+
+    Astore = A->Store;
+    Aval = Astore->nzval;
+    m_loc = Astore->m_loc;
+    fst_row = Astore->fst_row;
+
+    superlu_colmap_init(&cm, A->ncol, Astore->nnz_loc, Astore->colind,
+			grid->comm);
+    if ( !(rmax = doubleMalloc_dist(m_loc + A->ncol)) )
+	ABORT("Malloc fails for rmax[].");
+    cmax = rmax + m_loc;
+    for (i = fst_row; i < fst_row + m_loc; ++i) r[i] = 1.;
+    for (i = 0; i < cm.nsend; ++i) c[cm.cols[i]] = 1.;
+    for (j = cm.fst_col; j < cm.fst_col + cm.ncol_loc; ++j) c[j] = 1.;
+
+    for (it = 0; it < niter; ++it) {
+	/* The row and column maxima of the current diag(R)*A*diag(C). */
+	for (i = 0; i < cm.nsend; ++i) cmax[cm.cols[i]] = 0.;
+	irow = fst_row;
+	for (i = 0; i < m_loc; ++i) {
+	    rmax[i] = 0.;
+	    for (j = Astore->rowptr[i]; j < Astore->rowptr[i+1]; ++j) {
+		jcol = Astore->colind[j];
+		aij = fabs(Aval[j]) * r[irow] * c[jcol];
+		rmax[i] = SUPERLU_MAX( rmax[i], aij );
+		cmax[jcol] = SUPERLU_MAX( cmax[jcol], aij );
+	    }
+	    ++irow;
+	}
+	superlu_colmap_reduce(&cm, cmax, MPI_DOUBLE, MPI_MAX);
+
+	if ( it == 0 ) {
+	    /* These are the maxima of A; any zero row or column? */
+	    rcmin = ccmin = 1.;
+	    tempmax = 0.;
+	    for (i = 0; i < m_loc; ++i) {
+		tempmax = SUPERLU_MAX(tempmax, rmax[i]);
+		rcmin = SUPERLU_MIN(rcmin, rmax[i]);
+	    }
+	    for (j = cm.fst_col; j < cm.fst_col + cm.ncol_loc; ++j)
+		ccmin = SUPERLU_MIN(ccmin, cmax[j]);
+	    MPI_Allreduce( &tempmax, amax, 1, MPI_DOUBLE, MPI_MAX, grid->comm);
+	    tempmin = SUPERLU_MIN(rcmin, ccmin);
+	    MPI_Allreduce( &tempmin, &rcmin, 1, MPI_DOUBLE, MPI_MIN, grid->comm);
+	    if ( rcmin == 0. ) {
+		*info = dfirst_zero(rmax, m_loc, fst_row, A->nrow, grid->comm);
+		if ( *info == 0 )
+		    *info = A->nrow + dfirst_zero(&cmax[cm.fst_col],
+				cm.ncol_loc, cm.fst_col, A->ncol, grid->comm);
+		break;
+	    }
+	}
+
+	/* Divide by the square roots of the maxima. */
+	irow = fst_row;
+	for (i = 0; i < m_loc; ++i) r[irow++] /= sqrt(rmax[i]);
+	for (j = cm.fst_col; j < cm.fst_col + cm.ncol_loc; ++j)
+	    if ( cmax[j] > 0. ) c[j] /= sqrt(cmax[j]);
+	superlu_colmap_return(&cm, c, MPI_DOUBLE);
+    }
+    SUPERLU_FREE(rmax);
+
+    if ( *info == 0 ) {
+	/* Compute ROWCND and COLCND as the spread of R and C. */
+	rcmin = ccmin = dmach_dist("O");
+	rcmax = ccmax = 0.;
+	for (i = fst_row; i < fst_row + m_loc; ++i) {
+	    rcmax = SUPERLU_MAX(rcmax, r[i]);
+	    rcmin = SUPERLU_MIN(rcmin, r[i]);
+	}
+	for (j = cm.fst_col; j < cm.fst_col + cm.ncol_loc; ++j) {
+	    ccmax = SUPERLU_MAX(ccmax, c[j]);
+	    ccmin = SUPERLU_MIN(ccmin, c[j]);
+	}
+	tempmax = rcmax;
+	MPI_Allreduce( &tempmax, &rcmax, 1, MPI_DOUBLE, MPI_MAX, grid->comm);
+	tempmin = rcmin;
+	MPI_Allreduce( &tempmin, &rcmin, 1, MPI_DOUBLE, MPI_MIN, grid->comm);
+	tempmax = ccmax;
+	MPI_Allreduce( &tempmax, &ccmax, 1, MPI_DOUBLE, MPI_MAX, grid->comm);
+	tempmin = ccmin;
+	MPI_Allreduce( &tempmin, &ccmin, 1, MPI_DOUBLE, MPI_MIN, grid->comm);
+	*rowcnd = rcmin / rcmax;
+	*colcnd = ccmin / ccmax;
+
+	superlu_colmap_allgather(&cm, c, MPI_DOUBLE);
+	dgather_r(r, fst_row, m_loc, grid);
+    }
+    superlu_colmap_free(&cm);
+
+} /* pdgsequ_ruiz */
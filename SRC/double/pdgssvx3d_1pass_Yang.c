@@ -887,7 +887,7 @@ void pdgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 		   ------------------------------------------------------------ */
 		if (Equil)
 		{
-			dscaleMatrixDiagonally(Fact, ScalePermstruct,
+			dscaleMatrixDiagonally(options, Fact, ScalePermstruct,
 								  A, stat, grid, &rowequ, &colequ, &iinfo);
 			if (iinfo < 0)
 				return; // return if error
@@ -1151,7 +1151,7 @@ void pdgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 					trf3Dpartition=LUstruct->trf3Dpart;
 				}
 
-				dist_mem_use = pddistribute3d_Yang(options, n, A, ScalePermstruct,
+				dist_mem_use = pddistribute3d_Yang(options, n, A, A3d, ScalePermstruct,
 											Glu_freeable, LUstruct, grid3d);					
 					
 				if(Fact != SamePattern_SameRowPerm){
@@ -1743,10 +1743,10 @@ if (get_acc_solve()){
 			}			
 			if (get_new3dsolve()){
 				pdgstrs3d_newsolve (options, n, LUstruct,ScalePermstruct, trf3Dpartition, grid3d, X,
-				m_loc, fst_row, ldb, nrhs,SOLVEstruct, stat, info);
+				m_loc, fst_row, ldb, nrhs, 0, SOLVEstruct, stat, info);
 			}else{
 				pdgstrs3d (options, n, LUstruct,ScalePermstruct, trf3Dpartition, grid3d, X,
-				m_loc, fst_row, ldb, nrhs,SOLVEstruct, stat, info);
+				m_loc, fst_row, ldb, nrhs, 0, SOLVEstruct, stat, info);
 			}
 			if (options->IterRefine)
 				{
@@ -889,7 +889,7 @@ void pdgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 		   ------------------------------------------------------------ */
 		if (Equil)
 		{
-			dscaleMatrixDiagonally(Fact, ScalePermstruct,
+			dscaleMatrixDiagonally(options, Fact, ScalePermstruct,
 								  A, stat, grid, &rowequ, &colequ, &iinfo);
 			if (iinfo < 0)
 				return; // return if error
@@ -1777,10 +1777,10 @@ if (get_acc_solve()){
 			}			
 			if (get_new3dsolve()){
 				pdgstrs3d_newsolve (options, n, LUstruct,ScalePermstruct, trf3Dpartition, grid3d, X,
-				m_loc, fst_row, ldb, nrhs,SOLVEstruct, stat, info);
+				m_loc, fst_row, ldb, nrhs, 0, SOLVEstruct, stat, info);
 			}else{
 				pdgstrs3d (options, n, LUstruct,ScalePermstruct, trf3Dpartition, grid3d, X,
-				m_loc, fst_row, ldb, nrhs,SOLVEstruct, stat, info);
+				m_loc, fst_row, ldb, nrhs, 0, SOLVEstruct, stat, info);
 			}
 			if (options->IterRefine)
 				{
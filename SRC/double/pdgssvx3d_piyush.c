@@ -892,7 +892,7 @@ void pdgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 		   ------------------------------------------------------------ */
 		if (Equil)
 		{
-			dscaleMatrixDiagonally(Fact, ScalePermstruct,
+			dscaleMatrixDiagonally(options, Fact, ScalePermstruct,
 								  A, stat, grid, &rowequ, &colequ, &iinfo);
 			if (iinfo < 0)
 				return; // return if error
@@ -1034,7 +1034,7 @@ void pdgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 				permCol_SymbolicFact3d(options, n, &GA, perm_c, etree,
 									   Glu_persist, Glu_freeable, stat,
 									   &symb_mem_usage,
-									   grid3d);
+									   grid3d, &LUstruct->costmodel);
 
 				} /* end serial symbolic factorization */
 				else
@@ -1130,7 +1130,7 @@ void pdgssvx3d(superlu_dist_options_t *options, SuperMatrix *A,
 				distribution routine. */
 			t = SuperLU_timer_();
 
-			dist_mem_use = pddistribute3d_Yang(options, n, A, ScalePermstruct,
+			dist_mem_use = pddistribute3d_Yang(options, n, A, A3d, ScalePermstruct,
 											Glu_freeable, LUstruct, grid3d);
 			stat->utime[DIST] = SuperLU_timer_() - t;
 
@@ -1723,10 +1723,10 @@ if (get_acc_solve()){
 			}			
 			if (get_new3dsolve()){
 				pdgstrs3d_newsolve (options, n, LUstruct,ScalePermstruct, trf3Dpartition, grid3d, X,
-				m_loc, fst_row, ldb, nrhs,SOLVEstruct, stat, info);
+				m_loc, fst_row, ldb, nrhs, 0, SOLVEstruct, stat, info);
 			}else{
 				pdgstrs3d (options, n, LUstruct,ScalePermstruct, trf3Dpartition, grid3d, X,
-				m_loc, fst_row, ldb, nrhs,SOLVEstruct, stat, info);
+				m_loc, fst_row, ldb, nrhs, 0, SOLVEstruct, stat, info);
 			}
 			if (options->IterRefine)
 				{
@@ -1274,6 +1274,7 @@ pdgstrs(superlu_dist_options_t *options, int_t n,
 	pxerr_dist("PDGSTRS", grid, -*info);
 	return;
     }
+    SUPERLU_PROF_BEGIN(stat, "solve");
 
     /*
      * Initialization.
@@ -1286,6 +1287,17 @@ pdgstrs(superlu_dist_options_t *options, int_t n,
     xsup = Glu_persist->xsup;
     supno = Glu_persist->supno;
     nsupers = supno[n-1] + 1;
+    if ( !Llu->LBtree_ptr ) { /* first solve after the factorization */
+	int *supernodeMask = int32Malloc_dist(nsupers);
+	for (int js = 0; js < nsupers; ++js) supernodeMask[js] = 1;
+	dtrs_compute_communication_structure(options, n, LUstruct,
+				ScalePermstruct, supernodeMask, grid, stat);
+	SUPERLU_FREE(supernodeMask);
+	LBtree_ptr = Llu->LBtree_ptr;
+	LRtree_ptr = Llu->LRtree_ptr;
+	UBtree_ptr = Llu->UBtree_ptr;
+	URtree_ptr = Llu->URtree_ptr;
+    }
     Lrowind_bc_ptr = Llu->Lrowind_bc_ptr;
     Lnzval_bc_ptr = Llu->Lnzval_bc_ptr;
     Linv_bc_ptr = Llu->Linv_bc_ptr;
@@ -1435,6 +1447,8 @@ pdgstrs(superlu_dist_options_t *options, int_t n,
     dDumpLblocks(iam, nsupers, grid, Glu_persist, Llu);
 #endif
 
+    SUPERLU_PROF_BEGIN(stat, "lsolve");
+
     /*---------------------------------------------------
      * Forward solve Ly = b.
      *---------------------------------------------------*/
@@ -2462,6 +2476,9 @@ t1 = SuperLU_timer_();
 #endif
 
 
+	SUPERLU_PROF_END(stat, "lsolve");
+	SUPERLU_PROF_BEGIN(stat, "usolve");
+
 	/*---------------------------------------------------
 	 * Back solve Ux = y.
 	 *
@@ -3167,6 +3184,8 @@ for (lk=0;lk<nsupers_j;++lk){
 	}
 #endif
 
+    SUPERLU_PROF_END(stat, "usolve");
+    SUPERLU_PROF_END(stat, "solve");
     stat->utime[SOLVE] = SuperLU_timer_() - t1_sol;
 
 #if ( DEBUGlevel>=1 )
@@ -342,6 +342,8 @@ typedef struct {
     Glu_persist_t *Glu_persist;
     dLocalLU_t *Llu;
     dtrf3Dpartition_t *trf3Dpart;
+    superlu_workspace_t *work; /* optional, reused across factorizations */
+    superlu_costmodel_t costmodel; /* see superlu_costmodel_setup() */
     char dt;
 } dLUstruct_t;
 
@@ -551,6 +553,8 @@ extern void    dlaqgs_dist (SuperMatrix *, double *, double *, double,
 			    double, double, char *);
 extern void    pdgsequ (SuperMatrix *, double *, double *, double *,
 			double *, double *, int *, gridinfo_t *);
+extern void    pdgsequ_ruiz (SuperMatrix *, double *, double *, int,
+			     double *, double *, double *, int *, gridinfo_t *);
 extern double  pdlangs (char *, SuperMatrix *, gridinfo_t *);
 extern void    pdlaqgs (SuperMatrix *, double *, double *, double,
 			double, double, char *);
@@ -575,6 +579,10 @@ extern void  pdgssvx_ABglobal(superlu_dist_options_t *, SuperMatrix *,
 extern float pddistribute(superlu_dist_options_t *, int_t, SuperMatrix *,
 			 dScalePermstruct_t *, Glu_freeable_t *,
 			 dLUstruct_t *, gridinfo_t *);
+extern void  dload_A_to_L(int_t, int_t *, double *, int_t *, int_t *,
+			  int_t *, int_t *, double *, Glu_persist_t *, gridinfo_t *);
+extern int_t pdcheck_LU_pattern(SuperMatrix *, dScalePermstruct_t *,
+			       dLUstruct_t *, gridinfo_t *);
 extern float pddistribute_allgrid(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 	     dScalePermstruct_t *ScalePermstruct,
 	     Glu_freeable_t *Glu_freeable, dLUstruct_t *LUstruct,
@@ -640,6 +648,9 @@ extern void pdgstrf2_trsm(superlu_dist_options_t * options, int_t k0, int_t k,
 			  SuperLUStat_t *, int *info);
 extern void pdgstrs2_omp(int_t k0, int_t k, Glu_persist_t *, gridinfo_t *,
 			 dLocalLU_t *, Ublock_info_t *, SuperLUStat_t *);
+extern int_t dleafFrontFactor(superlu_dist_options_t *, int_t, int_t,
+			      int_t *, double, dLUstruct_t *, gridinfo_t *,
+			      SuperLUStat_t *, int *, int *);
 extern int_t pdReDistribute_B_to_X(double *B, int_t m_loc, int nrhs, int_t ldb,
 				   int_t fst_row, int_t *ilsum, double *x,
 				   dScalePermstruct_t *, Glu_persist_t *,
@@ -868,6 +879,20 @@ pdReDistribute3d_X_to_B (int_t n, double *B, int_t m_loc, int_t ldb,
                        dScalePermstruct_t * ScalePermstruct,
                        Glu_persist_t * Glu_persist, gridinfo3d_t * grid3d,
                        dSOLVEstruct_t * SOLVEstruct);
+extern int_t
+pdReDistribute3d_B3d_to_X (int_t nsupers, double *B, int_t m_loc, int nrhs,
+                       int_t ldb, int_t fst_row, double *x, int_t * ilsum,
+                       dScalePermstruct_t * ScalePermstruct,
+                       Glu_persist_t * Glu_persist,
+                       dtrf3Dpartition_t * trf3Dpartition,
+                       gridinfo3d_t * grid3d);
+extern int_t
+pdReDistribute3d_X_to_B3d (double *B, int_t m_loc, int_t ldb, int nrhs,
+                       double *x, int_t * ilsum,
+                       dScalePermstruct_t * ScalePermstruct,
+                       Glu_persist_t * Glu_persist,
+                       dtrf3Dpartition_t * trf3Dpartition,
+                       gridinfo3d_t * grid3d);
 
 extern void
 pdgstrs3d (superlu_dist_options_t *, int_t n, dLUstruct_t * LUstruct,
@@ -983,13 +1008,16 @@ extern int  dread_binary(FILE *, int_t *, int_t *, int_t *,
 extern void validateInput_pdgssvx3d(superlu_dist_options_t *, SuperMatrix *A,
        int ldb, int nrhs, gridinfo3d_t *, int *info);
 extern void dallocScalePermstruct_RC(dScalePermstruct_t *, int_t m, int_t n);
-extern void dscaleMatrixDiagonally(fact_t Fact, dScalePermstruct_t *, SuperMatrix *,
+extern void dscaleMatrixDiagonally(superlu_dist_options_t *, fact_t Fact, dScalePermstruct_t *, SuperMatrix *,
        	    		SuperLUStat_t *, gridinfo_t *, int *rowequ, int *colequ, int *iinfo);
 extern void dperform_row_permutation(superlu_dist_options_t *, fact_t Fact,
            dScalePermstruct_t *, dLUstruct_t *LUstruct, int_t m, int_t n,
 	       gridinfo_t *, SuperMatrix *A, SuperMatrix *GA, SuperLUStat_t *,
 	       int job, int Equil, int *rowequ, int *colequ, int *iinfo);
+extern void dscalePrecomputed(SuperMatrix *, dScalePermstruct_t *);
 extern double dcomputeA_Norm(int notran, SuperMatrix *, gridinfo_t *);
+extern double dcomputeA3d_Norm(int notran, int scale, SuperMatrix *,
+       NRformat_loc *, dScalePermstruct_t *, gridinfo3d_t *);
 extern int dtrs_compute_communication_structure(superlu_dist_options_t *options,
        int_t n, dLUstruct_t *, dScalePermstruct_t * ScalePermstruct,
        int* supernodeMask, gridinfo_t *, SuperLUStat_t *);
@@ -1115,6 +1143,10 @@ extern void dGatherNRformat_loc3d_allgrid(fact_t Fact, NRformat_loc *A, double *
 				   int ldb, int nrhs, gridinfo3d_t *grid3d,
 				   NRformat_loc3d **);
 extern int dScatter_B3d(NRformat_loc3d *A3d, gridinfo3d_t *grid3d);
+extern int_t dScatter_A3d(int_t n, NRformat_loc3d *A3d, fact_t Fact,
+			  dScalePermstruct_t *, Glu_persist_t *, int_t *,
+			  gridinfo3d_t *, int_t *colptr[], int_t *rowind[],
+			  double *a[]);
 
 extern void pdgssvx3d (superlu_dist_options_t *, SuperMatrix *,
 		       dScalePermstruct_t *, double B[], int ldb, int nrhs,
@@ -1560,7 +1592,7 @@ dReDistribute_A(SuperMatrix *A, dScalePermstruct_t *ScalePermstruct,
                 double *a[]);
 extern float
 pddistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
-	     dScalePermstruct_t *ScalePermstruct,
+	     NRformat_loc3d *A3d, dScalePermstruct_t *ScalePermstruct,
 	     Glu_freeable_t *Glu_freeable, dLUstruct_t *LUstruct,
 	     gridinfo3d_t *grid3d);
 
@@ -141,6 +141,7 @@ typedef MPI_C_DOUBLE_COMPLEX  SuperLU_MPI_DOUBLE_COMPLEX;
 #include "supermatrix.h"
 #include "util_dist.h"
 #include "psymbfact.h"
+#include "superlu_prof.h"
 
 #define ISORT     /* NOTE: qsort() has bug on Mac */
 
@@ -716,6 +717,109 @@ typedef struct {
  * num_lookaheads (int) (only for SuperLU_DIST)
  *        Specifies the number of levels in the look-ahead factorization
  *
+ * superlu_mem_budget (int) (only for SuperLU_DIST)
+ *        Per-process memory budget in MB for the numerical factorization;
+ *        0 means no budget.  When set, the look-ahead depth (and, in
+ *        GPU builds, superlu_max_buffer_size) is chosen after symbolic
+ *        factorization so that the busiest process fits, for that
+ *        driver call only; see superlu_plan_memory().  Only the 2D
+ *        drivers p[sdz]gssvx() plan; the 3D drivers ignore the budget.
+ *
+ * superlu_propmap (int) (only for SuperLU_DIST)
+ *        Whether to renumber the supernodes after serial symbolic
+ *        factorization so that the subtrees of the elimination tree are
+ *        mapped proportionally onto subsets of the 2D process grid
+ *        (1), or to keep the postorder (0, default); see superlu_propmap().
+ *
+ * superlu_lookahead_adapt (int) (only for SuperLU_DIST)
+ *        Whether the look-ahead window of the factorization is fixed to
+ *        num_lookaheads (0, default), or resized during the factorization
+ *        between 1 and num_lookaheads from the measured wait and compute
+ *        times (1), also logging each change (2); see
+ *        superlu_lookahead_step().
+ *
+ * superlu_msg_priority (int) (only for SuperLU_DIST)
+ *        Order in which the factorization posts the panel messages of the
+ *        look-ahead window: supernode order (0, default); decreasing
+ *        weight of the critical path through the supernode (1); as 1, and
+ *        the panels on the critical path use a communicator of their own
+ *        (2); see supernodal_critical_path().
+ *
+ * superlu_progress (int) (only for SuperLU_DIST)
+ *        Whether the factorization runs a thread that polls the MPI
+ *        progress engine while the other threads compute: no (0, default),
+ *        or yes with the given pause in microseconds between two polls.
+ *        Needs MPI_THREAD_MULTIPLE; see superlu_progress_start().
+ *
+ * superlu_rhs3d (int) (only for SuperLU_DIST)
+ *        Whether the 3D solve of pdgssvx3d takes B in its distribution on
+ *        the 3D process grid and returns X in place (1), instead of
+ *        gathering B on layer 0 and scattering X back (0, default).
+ *        Ignored with iterative refinement or Trans != NOTRANS;
+ *        see pdgstrs3d().
+ *
+ * superlu_ruiz (int) (only for SuperLU_DIST)
+ *        Number of sweeps of the iterative Ruiz equilibration computing R
+ *        and C when Equil = YES, in place of the one-pass scaling of
+ *        pdgsequ (0, default); see pdgsequ_ruiz().
+ *
+ * superlu_costmodel (int) (only for SuperLU_DIST)
+ *        Whether the supernodal etree weights are the times predicted by
+ *        a table of kernel rates calibrated on this machine (1), instead
+ *        of flop counts (0, default); see costmodel.c.
+ *
+ * superlu_amalg (int) (only for SuperLU_DIST)
+ *        Percentage of explicit zeros allowed in a supernode formed by
+ *        merging a supernode with its parent after the serial symbolic
+ *        factorization, when the cost model predicts a speedup
+ *        (0 = no amalgamation, default); see superlu_amalgamate().
+ *
+ * superlu_split (int) (only for SuperLU_DIST)
+ *        Whether wide supernodes are split after the serial symbolic
+ *        factorization into the pieces the cost model predicts fastest on
+ *        the 2D process grid (1), or kept as symbfact() cut them at
+ *        maxsuper (0, default); see superlu_split_supernodes().
+ *
+ * superlu_mf (int) (only for SuperLU_DIST)
+ *        Size in kilobytes of the dense fronts in which the leaf subtrees
+ *        are factored multifrontally on a 1 x 1 (layer) grid (0 = all
+ *        supernodal, default); see dleafFrontFactor().
+ *
+ * superlu_dense (int) (only for SuperLU_DIST)
+ *        A row or column of A with more than
+ *        max(16, superlu_dense * sqrt(n)) entries is dense; the dense
+ *        rows and columns are left out of the column ordering and
+ *        ordered last (0 = no detection, default); see
+ *        get_perm_c_dense_dist().
+ *
+ * superlu_blocks (int) (only for SuperLU_DIST)
+ *        Whether the blocks of A decoupled from each other, after the
+ *        dense rows and columns are withheld, are found and ordered each
+ *        on its own (1), or A is ordered as a whole (0, default); see
+ *        get_perm_c_dense_dist().  Only the ordering changes; the blocks
+ *        are still factored by the whole process grid.
+ *
+ * superlu_subset (int) (only for SuperLU_DIST)
+ *        Whether Fact = SamePattern keeps the previous L and U structure,
+ *        and the row permutation, when A fits in them (1), or always
+ *        repeats the row permutation and symbolic factorization (0,
+ *        default).  It takes effect when LUstruct still holds the
+ *        previous factors on entry; see pdgssvx().  There is no
+ *        environment variable for it, since the caller must then skip
+ *        xDestroy_LU() between the calls.
+ *
+ * superlu_cpu_batch (int) (only for SuperLU_DIST)
+ *        Whether the C++ CPU factorization of a 1 x 1 grid factors the
+ *        supernodes of each etree level together, one per thread (1), or
+ *        one after the other with a parallel loop inside each (0,
+ *        default); see sparseTreeFactorBatchCPU_impl.hpp.
+ *
+ * ReadEnv (yes_no_t) (only for SuperLU_DIST)
+ *        Specifies whether the SUPERLU_* environment variables may override
+ *        the tuning fields above (see sp_ienv_dist()).  Set to NO when
+ *        independent solves with different settings run concurrently in
+ *        one process, so that each call only depends on its own options.
+ *
  * lookahead_etree (yes_no_t) (only for SuperLU_DIST)
  *        Specifies whether to use the elimination tree computed from the
  *        serial symbolic factorization to perform scheduling.
@@ -763,6 +867,22 @@ typedef struct {
     int superlu_max_buffer_size; /* max. buffer size on GPU; see sp_ienv(8) */
     int superlu_num_gpu_streams; /* number of GPU streams; see sp_ienv(9) */
     int superlu_acc_offload; /* whether to offload work to GPU; see sp_ienv(10) */
+    int superlu_mem_budget; /* per-process memory budget in MB; see sp_ienv(12) */
+    int superlu_propmap; /* proportional subtree mapping; see sp_ienv(13) */
+    int superlu_lookahead_adapt; /* adaptive look-ahead window; see sp_ienv(14) */
+    int superlu_msg_priority; /* critical-path message order; see sp_ienv(15) */
+    int superlu_progress; /* MPI progress thread poll interval; see sp_ienv(16) */
+    int superlu_rhs3d;    /* B and X stay on the 3D grid; see sp_ienv(17) */
+    int superlu_ruiz;     /* Ruiz equilibration sweeps; see sp_ienv(18) */
+    int superlu_costmodel; /* calibrated etree weights; see sp_ienv(19) */
+    int superlu_amalg;    /* supernode amalgamation fill in %; see sp_ienv(20) */
+    int superlu_split;    /* grid-aware supernode splitting; see sp_ienv(21) */
+    int superlu_mf;       /* leaf front size in KB; see sp_ienv(22) */
+    int superlu_dense;    /* dense row/column threshold; see sp_ienv(23) */
+    int superlu_blocks;   /* order decoupled blocks apart; see sp_ienv(24) */
+    int superlu_subset;   /* SamePattern keeps L/U if A fits; see sp_ienv(25) */
+    int superlu_cpu_batch; /* level-batched CPU factorization; sp_ienv(26) */
+    yes_no_t      ReadEnv;  /* let environment variables override the above */
     int batchCount;     /* number of systems in the batched interface 
 			   0 : not to use batch interface (default)    */
     yes_no_t      SymPattern;      /* symmetric factorization          */
@@ -775,8 +895,100 @@ typedef struct {
     float total;
     int expansions;
     int64_t nnzL, nnzU;
+    /* Per-process estimates in bytes, set by superlu_plan_memory(). */
+    float L_loc, U_loc;  /* local L and U factors, values and indices */
+    float lookahead;     /* look-ahead receive buffers, all levels */
+    float schur;         /* bigU/bigV and L panel buffers for Schur update */
+    float budget;        /* the budget planned against, 0 if none */
 } superlu_dist_mem_usage_t;
 
+/*
+ *-- Workspace that the factorization routines can reuse across calls.
+ *
+ * Attach one to LUstruct->work to keep the large factorization buffers
+ * (look-ahead receive buffers, bigU/bigV, scatter maps, ...) alive
+ * between repeated calls of the drivers, instead of allocating and
+ * freeing them in every call.  Each slot grows to the high-water mark
+ * of its requests; superlu_workspace_trim() cuts the idle slots back to
+ * their peak since the previous trim.  Only the buffers of the 2D
+ * p?gstrf are covered; see WorkspaceSlot_t.
+ */
+typedef struct {
+    void   *buf[WS_NSLOTS];    /* one buffer per slot */
+    size_t size[WS_NSLOTS];    /* bytes currently allocated */
+    size_t peak[WS_NSLOTS];    /* largest request since the last trim */
+    int    in_use[WS_NSLOTS];  /* buffer is handed out */
+    int    ncalls;             /* number of successful reuses */
+} superlu_workspace_t;
+
+/*
+ *-- State of the adaptive look-ahead window; see superlu_lookahead_step().
+ *
+ * The window is resized from the time spent waiting for panels versus
+ * the time spent computing, summed over the grid.  The sums of one
+ * interval are reduced with a non-blocking allreduce that is completed
+ * one interval later, so every process changes the window at the same
+ * step without an extra synchronization.
+ */
+typedef struct {
+    int    level;      /* 0: fixed window; 1: adaptive; 2: also log */
+    int    maxla;      /* upper bound, the buffers are sized for it */
+    int    la;         /* current window */
+    int    interval;   /* steps between two decisions */
+    int    nsteps;     /* steps in the current interval */
+    double wait, busy; /* seconds in the current interval */
+    double sbuf[2], rbuf[2]; /* in-flight reduction */
+    MPI_Request req;
+    MPI_Comm comm;
+    int    iam;
+    int    ndecisions; /* number of window changes */
+    int    lamin, lamax;
+    double lasum;      /* sum of the window over the steps */
+    int_t  totsteps;
+} superlu_lookahead_t;
+
+/*
+ *-- MPI progress thread of the factorization; see superlu_progress_start().
+ */
+typedef struct {
+    int    active;       /* the thread is running */
+    int    stop;         /* set by the owner to end the thread */
+    int    interval_us;  /* pause between two polls */
+    MPI_Comm comm;       /* private, never carries a message */
+    void   *thread;      /* pthread_t */
+    long   npolls;
+} superlu_progress_t;
+
+/*
+ *-- Column exchange of a row-distributed matrix; see superlu_colmap_init().
+ */
+typedef struct {
+    MPI_Comm comm;
+    int_t  ncol;
+    int_t  fst_col, ncol_loc; /* the block of columns I own */
+    int_t  nsend, *cols;      /* the columns my rows touch, increasing */
+    int_t  nrecv, *recv_cols; /* the columns of my block sent to me */
+    int    *send_counts, *send_disp, *recv_counts, *recv_disp;
+    double *buf;
+} superlu_colmap_t;
+
+/*
+ *-- Kernel rates of the cost model; see superlu_costmodel_setup().
+ */
+#define SUPERLU_CM_NB 6  /* block sizes 8, 16, ..., 256 */
+typedef struct {
+    int    active;       /* the etree weights use the table */
+    int    calibrated;   /* the table is measured, else default rates */
+    int    wf;           /* etree weight of estimateWeight(), from WF:
+                            0 default, 1 One, 2 Ns, 3 NsDep, 4 NsDep2 */
+    double gemm[SUPERLU_CM_NB][SUPERLU_CM_NB]; /* flop/s of C(b_i x b_i)
+                                                  -= A(b_i x b_k) B */
+    double trsm[SUPERLU_CM_NB];    /* flop/s of a b x b triangle on b cols */
+    double scatter[SUPERLU_CM_NB]; /* entries/s of scattering a b x b block */
+    double latency;      /* seconds per message */
+    double bandwidth;    /* bytes per second; 0 on one process */
+} superlu_costmodel_t;
+
 /*-- Auxiliary data type used in PxGSTRS/PxGSTRS1. */
 typedef struct {
     int_t lbnum;  /* Row block number (local).      */
@@ -934,6 +1146,7 @@ typedef struct
     int* IbcastPanel_U;  /*I bcast and recv placed for the k-th U panel*/
     //int* numChildLeft; /* (NOT USED in this structure) number of children left to be factored*/
     int* gpuLUreduced;   /*New for GPU acceleration*/
+    int* frontDone;      /* factored in a leaf front; see dleafFrontFactor() */
 } factStat_t;
 
 typedef struct
@@ -1099,6 +1312,8 @@ extern void   sp_colorder (superlu_dist_options_t*, SuperMatrix*, int_t*, int_t*
 extern int    sp_symetree_dist(int_t *, int_t *, int_t *, int_t, int_t *);
 extern int    sp_coletree_dist (int_t *, int_t *, int_t *, int_t, int_t, int_t *);
 extern void   get_perm_c_dist(int_t, int_t, SuperMatrix *, int_t *);
+extern int_t  get_perm_c_dense_dist(superlu_dist_options_t *, int_t, int_t,
+				    SuperMatrix *, int_t *);
 extern void   get_perm_c_batch(superlu_dist_options_t *options,	int batchCount,
 			       handle_t  *SparseMatrix_handles, int **CpivPtr);
 extern void   at_plus_a_dist(const int_t, const int_t, int_t *, int_t *,
@@ -1146,11 +1361,64 @@ extern int_t estimate_bigu_size (int_t, int_t **, Glu_persist_t *,
 extern double SuperLU_timer_ (void);
 extern void   superlu_abort_and_exit_dist(char *);
 extern int    sp_ienv_dist (int, superlu_dist_options_t *);
+extern char   *superlu_getenv_dist (const char *, superlu_dist_options_t *);
+extern int    superlu_solve_rhs3d (superlu_dist_options_t *);
+extern void   superlu_prof_init (superlu_dist_options_t *, SuperLUStat_t *);
 extern void   ifill_dist (int_t *, int_t, int_t);
 extern void   super_stats_dist (int_t, int_t *);
 extern void  get_diag_procs(int_t, Glu_persist_t *, gridinfo_t *, int_t *,
 			    int_t **, int_t **);
 extern int_t QuerySpace_dist(int_t, int_t, Glu_freeable_t *, superlu_dist_mem_usage_t *);
+extern int    superlu_plan_memory(superlu_dist_options_t *, int_t, int,
+                                  Glu_persist_t *, Glu_freeable_t *,
+                                  gridinfo_t *, superlu_dist_mem_usage_t *);
+extern int    superlu_write_taskgraph(const char *, int_t, int, int,
+                                      Glu_persist_t *, Glu_freeable_t *,
+                                      int_t *, int_t *, int, int, int);
+extern int_t *superlu_propmap(int_t, int_t *, Glu_persist_t *,
+                              const superlu_costmodel_t *, int, int);
+extern void  superlu_propmap_apply(int_t, int_t *, int_t *, int_t *,
+                                   SuperMatrix *);
+extern void  superlu_lookahead_init(superlu_lookahead_t *,
+                                    superlu_dist_options_t *, int, int,
+                                    MPI_Comm);
+extern int   superlu_lookahead_step(superlu_lookahead_t *, int_t, double,
+                                    double);
+extern void  superlu_lookahead_finalize(superlu_lookahead_t *);
+extern int   superlu_window_order(int_t, int_t, int_t *, double *, int_t *);
+extern double *superlu_panel_priority(int_t, int_t *, Glu_persist_t *,
+				       const superlu_costmodel_t *, char *);
+extern void  superlu_progress_start(superlu_progress_t *,
+				    superlu_dist_options_t *, MPI_Comm);
+extern void  superlu_progress_stop(superlu_progress_t *);
+extern void  superlu_colmap_init(superlu_colmap_t *, int_t, int_t, int_t *,
+				 MPI_Comm);
+extern void  superlu_colmap_reduce(superlu_colmap_t *, void *, MPI_Datatype,
+				   MPI_Op);
+extern void  superlu_colmap_return(superlu_colmap_t *, void *, MPI_Datatype);
+extern void  superlu_colmap_allgather(superlu_colmap_t *, void *,
+				      MPI_Datatype);
+extern void  superlu_colmap_free(superlu_colmap_t *);
+extern void  superlu_costmodel_setup(superlu_dist_options_t *,
+				     superlu_costmodel_t *, MPI_Comm);
+extern int   superlu_costmodel_active(const superlu_costmodel_t *);
+extern double superlu_costmodel_schur(const superlu_costmodel_t *,
+				      double, double, double);
+extern double superlu_costmodel_supernode(const superlu_costmodel_t *,
+					  double, double, double);
+extern int_t superlu_amalgamate(superlu_dist_options_t *, int_t, int_t *,
+			       Glu_persist_t *, Glu_freeable_t *,
+			       const superlu_costmodel_t *, int);
+extern int_t superlu_split_supernodes(superlu_dist_options_t *, int_t,
+				      Glu_persist_t *, Glu_freeable_t *,
+				      const superlu_costmodel_t *,
+				      int, int, int);
+extern void  superlu_workspace_init(superlu_workspace_t *);
+extern void  *superlu_workspace_get(superlu_workspace_t *, WorkspaceSlot_t, size_t);
+extern void  superlu_workspace_put(superlu_workspace_t *, WorkspaceSlot_t, void *);
+extern void  superlu_workspace_trim(superlu_workspace_t *, size_t);
+extern void  superlu_workspace_free(superlu_workspace_t *);
+extern size_t superlu_workspace_bytes(superlu_workspace_t *);
 extern int   xerr_dist (char *, int *);
 extern void  pxerr_dist (char *, gridinfo_t *, int_t);
 extern void  PStatInit(SuperLUStat_t *);
@@ -1288,6 +1556,9 @@ extern void C_BcTree_Nullify(C_Tree* tree);
 extern yes_no_t C_BcTree_IsRoot(C_Tree* tree);
 extern void C_BcTree_forwardMessageSimple(C_Tree* tree, void* localBuffer, int msgSize);
 extern void C_BcTree_waitSendRequest(C_Tree* tree);
+extern void C_Tree_Build(char, int, int_t, int_t, int_t *, int_t *,
+			 gridinfo_t *, int, char, C_Tree *, int *, int *,
+			 int **);
 
 /*==== For 3D code ====*/
 typedef enum {
@@ -1305,10 +1576,15 @@ extern int_t zAllocBcast_gridID(int_t size, void** ptr, int_t gridID, gridinfo3d
 extern void permCol_SymbolicFact3d(superlu_dist_options_t *options, int n, SuperMatrix *GA, int_t *perm_c, int_t *etree, 
                            Glu_persist_t *Glu_persist, Glu_freeable_t *Glu_freeable, SuperLUStat_t *stat,
 						   superlu_dist_mem_usage_t*symb_mem_usage,
-						   gridinfo3d_t* grid3d);
+						   gridinfo3d_t* grid3d, const superlu_costmodel_t *cm);
 extern SupernodeToGridMap_t* createSuperGridMap(int_t nsuper,int_t maxLvl, int_t *myTreeIdxs, 
     int_t *myZeroTrIdxs, int_t* gNodeCount, int_t** gNodeLists);
 extern int_t *createSupernode2TreeMap(int_t nsupers, int_t maxLvl, int_t *gNodeCount, int_t **gNodeLists);
+extern A3dRoute_t *superlu_route_A3d(int_t, NRformat_loc *, int_t, int_t *,
+				     int_t *, int_t *, int_t *, gridinfo3d_t *);
+extern A3dRoute_t *superlu_route_B3d(int_t, int_t, int_t *, int_t *, int_t *,
+				     int_t *, gridinfo3d_t *);
+extern void superlu_free_route_A3d(A3dRoute_t *);
 extern void allocBcastArray(void **array, int_t size, int root, MPI_Comm comm);
 extern void allocBcastLargeArray(void **array, int64_t size, int root, MPI_Comm comm);
 extern int_t* create_iperm_c_supno(int_t nsupers, superlu_dist_options_t *options, Glu_persist_t *Glu_persist, int_t *etree, int_t** Lrowind_bc_ptr, int_t** Ufstnz_br_ptr, gridinfo3d_t *grid3d);
@@ -1361,7 +1637,8 @@ extern treeList_t* setree2list(int_t nsuper, int_t* setree );
 extern int  free_treelist(int_t nsuper, treeList_t* treeList);
 
 // int_t calcTreeWeight(int_t nsupers, treeList_t* treeList, int_t* xsup);
-extern int_t calcTreeWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* xsup);
+extern int_t calcTreeWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* xsup,
+                            const superlu_costmodel_t *cm);
 extern int_t getDescendList(int_t k, int_t*dlist,  treeList_t* treeList);
 extern int_t getCommonAncestorList(int_t k, int_t* alist,  int_t* seTree, treeList_t* treeList);
 extern int_t getCommonAncsCount(int_t k, treeList_t* treeList);
@@ -1378,6 +1655,7 @@ extern int_t* getGlobal_iperm(int_t nsupers, int_t nperms, int_t** perms,
 			      int_t* nnodes);
 extern int_t log2i(int_t index);
 extern int_t *supernodal_etree(int_t nsuper, int_t * etree, int_t* supno, int_t *xsup);
+extern double *supernodal_critical_path(int_t nsupers, int_t *setree, treeList_t *treeList);
 extern int_t testSubtreeNodelist(int_t nsupers, int_t numList, int_t** nodeList, int_t* nodeCount);
 extern int_t testListPerm(int_t nodeCount, int_t* nodeList, int_t* permList, int_t* gTopLevel);
 
@@ -1446,11 +1724,11 @@ extern int_t getBigUSize(superlu_dist_options_t *, int_t nsupers,
 			 gridinfo_t *grid, int_t **Lrowind_bc_ptr);
 extern void getSCUweight(int_t nsupers, treeList_t* treeList, int_t* xsup,
 			 int_t** Lrowind_bc_ptr, int_t** Ufstnz_br_ptr,
-			 gridinfo3d_t * grid3d);
+			 gridinfo3d_t * grid3d, const superlu_costmodel_t *cm);
 
 extern void getSCUweight_allgrid(int_t nsupers, treeList_t* treeList, int_t* xsup,
 		  int_t** Lrowind_bc_ptr, int_t** Ufstnz_br_ptr,
-		  gridinfo3d_t * grid3d
+		  gridinfo3d_t * grid3d, const superlu_costmodel_t *cm
 		  );
 
 extern int Wait_LUDiagSend(int_t k, MPI_Request *U_diag_blk_send_req,
@@ -10,7 +10,7 @@
 /* #undef HAVE_HIP */
 
 /* Enable parmetis */
-#define HAVE_PARMETIS TRUE
+/* #undef HAVE_PARMETIS */
 
 /* Enable colamd */
 /* #undef HAVE_COLAMD */
@@ -89,4 +89,22 @@ typedef enum {
     NPHASES  /* total number of phases */
 } PhaseType;
 
+/*
+ * Buffers of the numerical factorization that can be kept alive across
+ * repeated calls through a superlu_workspace_t.
+ */
+typedef enum {
+    WS_LSUB_BUF,    /* look-ahead receive buffers for L indices */
+    WS_LVAL_BUF,    /* look-ahead receive buffers for L values */
+    WS_USUB_BUF,    /* look-ahead receive buffers for U indices */
+    WS_UVAL_BUF,    /* look-ahead receive buffers for U values */
+    WS_BIGU,        /* packed U panel for the Schur-complement GEMM */
+    WS_BIGV,        /* GEMM output buffer before scatter */
+    WS_INDIRECT,    /* per-thread row index maps for scatter */
+    WS_INDIRECT2,
+    WS_LOOKAHEAD_L, /* packed L panel of the look-ahead window */
+    WS_REMAIN_L,    /* packed L panel of the remaining blocks */
+    WS_NSLOTS       /* total number of workspace slots */
+} WorkspaceSlot_t;
+
 #endif /* __SUPERLU_ENUM_CONSTS */
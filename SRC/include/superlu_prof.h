@@ -0,0 +1,66 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Nestable region profiler with optional hardware counters
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * A region is opened with SUPERLU_PROF_BEGIN(stat, "name") and closed with
+ * SUPERLU_PROF_END(stat, "name") on the same thread.  Regions nest; each
+ * one is identified by its path from the outermost open region on that
+ * thread.  The drivers open one region per phase (equil, rowperm, colperm,
+ * symbfact, distribute, factor, solve, refine), so the factorization
+ * gives paths such as "factor/panel" and "factor/schur", and the
+ * triangular solve "solve/lsolve".  Time is taken from the time-stamp
+ * counter where available, and each thread keeps its own region table.
+ *
+ * The profiler state belongs to one SuperLUStat_t (stat->prof), so
+ * concurrent solves with different stat structures do not share it.  The
+ * drivers call superlu_prof_init() on entry, which reads, through
+ * superlu_getenv_dist() (i.e., only if options->ReadEnv is YES):
+ *   SUPERLU_PROFILE      = 0 (default) off; 1 timers; 2 timers and
+ *                          perf_event_open counters (Linux only):
+ *                          cycles, last-level cache misses, and retired
+ *                          instructions or the raw event below.
+ *   SUPERLU_PROFILE_RAW  = hex config of a raw PMU event used as third
+ *                          counter, e.g. an FP_ARITH event to count flops.
+ *   SUPERLU_PROFILE_FILE = file the JSON report is written to (default
+ *                          stdout).
+ *
+ * When disabled, stat->prof is NULL and a region costs one load and a
+ * not-taken branch.  superlu_prof_report() is collective over a
+ * communicator; it merges the threads of each process and prints
+ * min/avg/max over the processes as JSON.  PStatPrint() calls it, and
+ * PStatFree() releases the profiler.
+ * </pre>
+ */
+
+#ifndef __SUPERLU_PROF /* allow multiple inclusions */
+#define __SUPERLU_PROF
+
+#include <mpi.h>
+
+typedef struct superlu_prof superlu_prof_t;
+
+extern void superlu_prof_begin(superlu_prof_t *, const char *);
+extern void superlu_prof_end(superlu_prof_t *, const char *);
+extern void superlu_prof_report(SuperLUStat_t *, MPI_Comm);
+extern void superlu_prof_reset(SuperLUStat_t *);
+extern void superlu_prof_free(SuperLUStat_t *);
+
+#define SUPERLU_PROF_BEGIN(stat, name) \
+    do { if ( (stat)->prof ) superlu_prof_begin((stat)->prof, name); } while (0)
+#define SUPERLU_PROF_END(stat, name) \
+    do { if ( (stat)->prof ) superlu_prof_end((stat)->prof, name); } while (0)
+
+#endif /* __SUPERLU_PROF */
@@ -342,6 +342,8 @@ typedef struct {
     Glu_persist_t *Glu_persist;
     sLocalLU_t *Llu;
     strf3Dpartition_t *trf3Dpart;
+    superlu_workspace_t *work; /* optional, reused across factorizations */
+    superlu_costmodel_t costmodel; /* see superlu_costmodel_setup() */
     char dt;
 } sLUstruct_t;
 
@@ -551,6 +553,8 @@ extern void    slaqgs_dist (SuperMatrix *, float *, float *, float,
 			    float, float, char *);
 extern void    psgsequ (SuperMatrix *, float *, float *, float *,
 			float *, float *, int *, gridinfo_t *);
+extern void    psgsequ_ruiz (SuperMatrix *, float *, float *, int,
+			     float *, float *, float *, int *, gridinfo_t *);
 extern float  pslangs (char *, SuperMatrix *, gridinfo_t *);
 extern void    pslaqgs (SuperMatrix *, float *, float *, float,
 			float, float, char *);
@@ -575,6 +579,10 @@ extern void  psgssvx_ABglobal(superlu_dist_options_t *, SuperMatrix *,
 extern float psdistribute(superlu_dist_options_t *, int_t, SuperMatrix *,
 			 sScalePermstruct_t *, Glu_freeable_t *,
 			 sLUstruct_t *, gridinfo_t *);
+extern void  sload_A_to_L(int_t, int_t *, float *, int_t *, int_t *,
+			  int_t *, int_t *, float *, Glu_persist_t *, gridinfo_t *);
+extern int_t pscheck_LU_pattern(SuperMatrix *, sScalePermstruct_t *,
+			       sLUstruct_t *, gridinfo_t *);
 extern float psdistribute_allgrid(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 	     sScalePermstruct_t *ScalePermstruct,
 	     Glu_freeable_t *Glu_freeable, sLUstruct_t *LUstruct,
@@ -640,6 +648,9 @@ extern void psgstrf2_trsm(superlu_dist_options_t * options, int_t k0, int_t k,
 			  SuperLUStat_t *, int *info);
 extern void psgstrs2_omp(int_t k0, int_t k, Glu_persist_t *, gridinfo_t *,
 			 sLocalLU_t *, Ublock_info_t *, SuperLUStat_t *);
+extern int_t sleafFrontFactor(superlu_dist_options_t *, int_t, int_t,
+			      int_t *, double, sLUstruct_t *, gridinfo_t *,
+			      SuperLUStat_t *, int *, int *);
 extern int_t psReDistribute_B_to_X(float *B, int_t m_loc, int nrhs, int_t ldb,
 				   int_t fst_row, int_t *ilsum, float *x,
 				   sScalePermstruct_t *, Glu_persist_t *,
@@ -868,6 +879,20 @@ psReDistribute3d_X_to_B (int_t n, float *B, int_t m_loc, int_t ldb,
                        sScalePermstruct_t * ScalePermstruct,
                        Glu_persist_t * Glu_persist, gridinfo3d_t * grid3d,
                        sSOLVEstruct_t * SOLVEstruct);
+extern int_t
+psReDistribute3d_B3d_to_X (int_t nsupers, float *B, int_t m_loc, int nrhs,
+                       int_t ldb, int_t fst_row, float *x, int_t * ilsum,
+                       sScalePermstruct_t * ScalePermstruct,
+                       Glu_persist_t * Glu_persist,
+                       strf3Dpartition_t * trf3Dpartition,
+                       gridinfo3d_t * grid3d);
+extern int_t
+psReDistribute3d_X_to_B3d (float *B, int_t m_loc, int_t ldb, int nrhs,
+                       float *x, int_t * ilsum,
+                       sScalePermstruct_t * ScalePermstruct,
+                       Glu_persist_t * Glu_persist,
+                       strf3Dpartition_t * trf3Dpartition,
+                       gridinfo3d_t * grid3d);
 
 extern void
 psgstrs3d (superlu_dist_options_t *, int_t n, sLUstruct_t * LUstruct,
@@ -983,13 +1008,16 @@ extern int  sread_binary(FILE *, int_t *, int_t *, int_t *,
 extern void validateInput_psgssvx3d(superlu_dist_options_t *, SuperMatrix *A,
        int ldb, int nrhs, gridinfo3d_t *, int *info);
 extern void sallocScalePermstruct_RC(sScalePermstruct_t *, int_t m, int_t n);
-extern void sscaleMatrixDiagonally(fact_t Fact, sScalePermstruct_t *, SuperMatrix *,
+extern void sscaleMatrixDiagonally(superlu_dist_options_t *, fact_t Fact, sScalePermstruct_t *, SuperMatrix *,
        	    		SuperLUStat_t *, gridinfo_t *, int *rowequ, int *colequ, int *iinfo);
 extern void sperform_row_permutation(superlu_dist_options_t *, fact_t Fact,
            sScalePermstruct_t *, sLUstruct_t *LUstruct, int_t m, int_t n,
 	       gridinfo_t *, SuperMatrix *A, SuperMatrix *GA, SuperLUStat_t *,
 	       int job, int Equil, int *rowequ, int *colequ, int *iinfo);
+extern void sscalePrecomputed(SuperMatrix *, sScalePermstruct_t *);
 extern float scomputeA_Norm(int notran, SuperMatrix *, gridinfo_t *);
+extern float scomputeA3d_Norm(int notran, int scale, SuperMatrix *,
+       NRformat_loc *, sScalePermstruct_t *, gridinfo3d_t *);
 extern int strs_compute_communication_structure(superlu_dist_options_t *options,
        int_t n, sLUstruct_t *, sScalePermstruct_t * ScalePermstruct,
        int* supernodeMask, gridinfo_t *, SuperLUStat_t *);
@@ -1115,6 +1143,10 @@ extern void sGatherNRformat_loc3d_allgrid(fact_t Fact, NRformat_loc *A, float *B
 				   int ldb, int nrhs, gridinfo3d_t *grid3d,
 				   NRformat_loc3d **);
 extern int sScatter_B3d(NRformat_loc3d *A3d, gridinfo3d_t *grid3d);
+extern int_t sScatter_A3d(int_t n, NRformat_loc3d *A3d, fact_t Fact,
+			  sScalePermstruct_t *, Glu_persist_t *, int_t *,
+			  gridinfo3d_t *, int_t *colptr[], int_t *rowind[],
+			  float *a[]);
 
 extern void psgssvx3d (superlu_dist_options_t *, SuperMatrix *,
 		       sScalePermstruct_t *, float B[], int ldb, int nrhs,
@@ -1560,7 +1592,7 @@ sReDistribute_A(SuperMatrix *A, sScalePermstruct_t *ScalePermstruct,
                 float *a[]);
 extern float
 psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
-	     sScalePermstruct_t *ScalePermstruct,
+	     NRformat_loc3d *A3d, sScalePermstruct_t *ScalePermstruct,
 	     Glu_freeable_t *Glu_freeable, sLUstruct_t *LUstruct,
 	     gridinfo3d_t *grid3d);
 
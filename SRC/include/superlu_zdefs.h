@@ -342,6 +342,8 @@ typedef struct {
     Glu_persist_t *Glu_persist;
     zLocalLU_t *Llu;
     ztrf3Dpartition_t *trf3Dpart;
+    superlu_workspace_t *work; /* optional, reused across factorizations */
+    superlu_costmodel_t costmodel; /* see superlu_costmodel_setup() */
     char dt;
 } zLUstruct_t;
 
@@ -551,6 +553,8 @@ extern void    zlaqgs_dist (SuperMatrix *, double *, double *, double,
 			    double, double, char *);
 extern void    pzgsequ (SuperMatrix *, double *, double *, double *,
 			double *, double *, int *, gridinfo_t *);
+extern void    pzgsequ_ruiz (SuperMatrix *, double *, double *, int,
+			     double *, double *, double *, int *, gridinfo_t *);
 extern double  pzlangs (char *, SuperMatrix *, gridinfo_t *);
 extern void    pzlaqgs (SuperMatrix *, double *, double *, double,
 			double, double, char *);
@@ -575,6 +579,10 @@ extern void  pzgssvx_ABglobal(superlu_dist_options_t *, SuperMatrix *,
 extern float pzdistribute(superlu_dist_options_t *, int_t, SuperMatrix *,
 			 zScalePermstruct_t *, Glu_freeable_t *,
 			 zLUstruct_t *, gridinfo_t *);
+extern void  zload_A_to_L(int_t, int_t *, doublecomplex *, int_t *, int_t *,
+			  int_t *, int_t *, doublecomplex *, Glu_persist_t *, gridinfo_t *);
+extern int_t pzcheck_LU_pattern(SuperMatrix *, zScalePermstruct_t *,
+			       zLUstruct_t *, gridinfo_t *);
 extern float pzdistribute_allgrid(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 	     zScalePermstruct_t *ScalePermstruct,
 	     Glu_freeable_t *Glu_freeable, zLUstruct_t *LUstruct,
@@ -640,6 +648,9 @@ extern void pzgstrf2_trsm(superlu_dist_options_t * options, int_t k0, int_t k,
 			  SuperLUStat_t *, int *info);
 extern void pzgstrs2_omp(int_t k0, int_t k, Glu_persist_t *, gridinfo_t *,
 			 zLocalLU_t *, Ublock_info_t *, SuperLUStat_t *);
+extern int_t zleafFrontFactor(superlu_dist_options_t *, int_t, int_t,
+			      int_t *, double, zLUstruct_t *, gridinfo_t *,
+			      SuperLUStat_t *, int *, int *);
 extern int_t pzReDistribute_B_to_X(doublecomplex *B, int_t m_loc, int nrhs, int_t ldb,
 				   int_t fst_row, int_t *ilsum, doublecomplex *x,
 				   zScalePermstruct_t *, Glu_persist_t *,
@@ -868,6 +879,20 @@ pzReDistribute3d_X_to_B (int_t n, doublecomplex *B, int_t m_loc, int_t ldb,
                        zScalePermstruct_t * ScalePermstruct,
                        Glu_persist_t * Glu_persist, gridinfo3d_t * grid3d,
                        zSOLVEstruct_t * SOLVEstruct);
+extern int_t
+pzReDistribute3d_B3d_to_X (int_t nsupers, doublecomplex *B, int_t m_loc, int nrhs,
+                       int_t ldb, int_t fst_row, doublecomplex *x, int_t * ilsum,
+                       zScalePermstruct_t * ScalePermstruct,
+                       Glu_persist_t * Glu_persist,
+                       ztrf3Dpartition_t * trf3Dpartition,
+                       gridinfo3d_t * grid3d);
+extern int_t
+pzReDistribute3d_X_to_B3d (doublecomplex *B, int_t m_loc, int_t ldb, int nrhs,
+                       doublecomplex *x, int_t * ilsum,
+                       zScalePermstruct_t * ScalePermstruct,
+                       Glu_persist_t * Glu_persist,
+                       ztrf3Dpartition_t * trf3Dpartition,
+                       gridinfo3d_t * grid3d);
 
 extern void
 pzgstrs3d (superlu_dist_options_t *, int_t n, zLUstruct_t * LUstruct,
@@ -985,13 +1010,16 @@ extern int  zread_binary(FILE *, int_t *, int_t *, int_t *,
 extern void validateInput_pzgssvx3d(superlu_dist_options_t *, SuperMatrix *A,
        int ldb, int nrhs, gridinfo3d_t *, int *info);
 extern void zallocScalePermstruct_RC(zScalePermstruct_t *, int_t m, int_t n);
-extern void zscaleMatrixDiagonally(fact_t Fact, zScalePermstruct_t *, SuperMatrix *,
+extern void zscaleMatrixDiagonally(superlu_dist_options_t *, fact_t Fact, zScalePermstruct_t *, SuperMatrix *,
        	    		SuperLUStat_t *, gridinfo_t *, int *rowequ, int *colequ, int *iinfo);
 extern void zperform_row_permutation(superlu_dist_options_t *, fact_t Fact,
            zScalePermstruct_t *, zLUstruct_t *LUstruct, int_t m, int_t n,
 	       gridinfo_t *, SuperMatrix *A, SuperMatrix *GA, SuperLUStat_t *,
 	       int job, int Equil, int *rowequ, int *colequ, int *iinfo);
+extern void zscalePrecomputed(SuperMatrix *, zScalePermstruct_t *);
 extern double zcomputeA_Norm(int notran, SuperMatrix *, gridinfo_t *);
+extern double zcomputeA3d_Norm(int notran, int scale, SuperMatrix *,
+       NRformat_loc *, zScalePermstruct_t *, gridinfo3d_t *);
 extern int ztrs_compute_communication_structure(superlu_dist_options_t *options,
        int_t n, zLUstruct_t *, zScalePermstruct_t * ScalePermstruct,
        int* supernodeMask, gridinfo_t *, SuperLUStat_t *);
@@ -1117,6 +1145,10 @@ extern void zGatherNRformat_loc3d_allgrid(fact_t Fact, NRformat_loc *A, doubleco
 				   int ldb, int nrhs, gridinfo3d_t *grid3d,
 				   NRformat_loc3d **);
 extern int zScatter_B3d(NRformat_loc3d *A3d, gridinfo3d_t *grid3d);
+extern int_t zScatter_A3d(int_t n, NRformat_loc3d *A3d, fact_t Fact,
+			  zScalePermstruct_t *, Glu_persist_t *, int_t *,
+			  gridinfo3d_t *, int_t *colptr[], int_t *rowind[],
+			  doublecomplex *a[]);
 
 extern void pzgssvx3d (superlu_dist_options_t *, SuperMatrix *,
 		       zScalePermstruct_t *, doublecomplex B[], int ldb, int nrhs,
@@ -1562,7 +1594,7 @@ zReDistribute_A(SuperMatrix *A, zScalePermstruct_t *ScalePermstruct,
                 doublecomplex *a[]);
 extern float
 pzdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
-	     zScalePermstruct_t *ScalePermstruct,
+	     NRformat_loc3d *A3d, zScalePermstruct_t *ScalePermstruct,
 	     Glu_freeable_t *Glu_freeable, zLUstruct_t *LUstruct,
 	     gridinfo3d_t *grid3d);
 
@@ -188,11 +188,33 @@ typedef struct {
 } NRformat_loc;
 
 
+/* Routing of the nonzeros of A on the 3D process grid to the processes
+   that load them into their L and U blocks; see superlu_route_A3d().
+   The counts are indexed by the rank in the 3D grid.  The same structure
+   routes the rows of B to the 3D solve, see superlu_route_B3d(); then
+   xa and asub are NULL and recv_pos[i] is the row of received row i. */
+typedef struct
+{
+    int   *send_counts;
+    int   *send_disp;
+    int   *recv_counts;
+    int   *recv_disp;
+    int_t nsend;      // number of local nonzeros of A on the 3D grid
+    int_t *send_pos;  // position of local nonzero j in the send buffer
+    int_t nrecv;      // number of nonzeros received
+    int_t *xa;        // column pointers of the received nonzeros
+    int_t *asub;      // row indices of the received nonzeros
+    int_t *recv_pos;  // position in asub[] of received nonzero i
+} A3dRoute_t;
+
 /* Data structure for storing 3D matrix on layer 0 of the 2D process grid
    Only grid-0 has meanful values of these data structures.   */
 typedef struct NRformat_loc3d
 {
     NRformat_loc *A_nfmt; // Gathered A matrix on 2D grid-0 
+    NRformat_loc *A_nfmt3d; // on the entire 3D process grid
+    A3dRoute_t *route;    // cached routing of A_nfmt3d to the L/U blocks
+    int A2d_stale;        // A_nfmt lacks the values of the last A
     void *B3d;  // on the entire 3D process grid
     int  ldb;   // relative to 3D process grid
     int nrhs;
@@ -111,6 +111,7 @@ typedef struct {
     float   gpu_buffer;     /* monitor the buffer allocated on GPU (bytes) */
     int_t MaxActiveBTrees;
     int_t MaxActiveRTrees;
+    struct superlu_prof *prof; /* region profiler, NULL if off; see superlu_prof.h */
 
 #ifdef GPU_ACC  /*-- For GPU --*/
     double ScatterMOPCounter;
@@ -161,6 +162,20 @@ typedef struct {
 				   */
 #endif	  
 
+/* Storage class for library state that must stay private to the calling
+   thread, so that independent solves can run concurrently in one process. */
+#if defined(__cplusplus) && __cplusplus >= 201103L
+#define SUPERLU_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define SUPERLU_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define SUPERLU_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define SUPERLU_THREAD_LOCAL __declspec(thread)
+#else
+#define SUPERLU_THREAD_LOCAL
+#endif
+
 /* Macros to manipulate stack */
 #define SuperLU_StackFull(x)         ( x + stack.used >= stack.size )
 #define SuperLU_NotDoubleAlign(addr) ( (long)addr & 7 )
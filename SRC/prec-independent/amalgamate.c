@@ -0,0 +1,259 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Amalgamate supernodes after the symbolic factorization
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The supernodes of symbfact() are fundamental apart from the relaxed
+ * leaves, so a chain of narrow supernodes stays a chain of small GEMMs.
+ * superlu_amalgamate() merges a supernode into its parent when the parent
+ * is the next supernode, treating the explicit zeros of the merged block
+ * as nonzeros, if the cost model of costmodel.c predicts the merged
+ * supernode to be faster than the two, and the added zeros are within
+ * SUPERLU_AMALG (sp_ienv_dist(20)) percent of its entries.
+ *
+ * A merge is made only if it creates no fill outside the merged
+ * supernode: the rows of the child's L below the parent must be in the
+ * parent's L, and the columns of the child's U beyond the parent in the
+ * parent's U.  Then the merged L is the parent's, and the merged U has
+ * the parent's columns, each segment starting at the child's row if it
+ * has one.
+ * </pre>
+ */
+
+#include "superlu_defs.h"
+
+/*! \brief Stored entries of a supernode of ns columns with nbelow rows
+ * of L below it, and U segments starting at uhead[0 : nu-1] and ending
+ * at row last. */
+static double amalg_size(int_t ns, int_t nbelow, int_t nu, int_t *uhead,
+			 int_t last)
+{
+    double s = (double) ns * (ns + nbelow);
+    int_t i;
+
+    for (i = 0; i < nu; ++i) s += last - uhead[i] + 1;
+    return s;
+}
+
+/*! \brief Merge supernodes of the serial symbolic factorization.
+ *
+ * <pre>
+ * On exit, Glu_persist (xsup, supno) and Glu_freeable (lsub, xlsub,
+ * usub, xusub, nnzLU) describe the amalgamated supernodes; etree is
+ * unchanged.  Every process computes the same result.  Returns the
+ * number of merges.
+ * The times are predicted with the rates of cm, or the default rates if
+ * cm is NULL.
+ * </pre>
+ */
+int_t superlu_amalgamate(superlu_dist_options_t *options, int_t n,
+			 int_t *etree, Glu_persist_t *Glu_persist,
+			 Glu_freeable_t *Glu_freeable,
+			 const superlu_costmodel_t *cm, int iam)
+{
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *lsub = Glu_freeable->lsub, *xlsub = Glu_freeable->xlsub;
+    int_t *usub = Glu_freeable->usub, *xusub = Glu_freeable->xusub;
+    int_t nsuper, maxsup, *setree, *ustart, *ucol, *uhead, *mark;
+    int_t *gcol, *ghead, *tcol, *thead, *gfirst, *rmark, *newlsub;
+    int_t b, g, i, j, k, p, q, fnz, nmerge = 0, ngroup, gn, tn, nu;
+    int_t glast, gns, gbelow, ns, nbelow, last, pos, nnzl;
+    double tol, t_old = 0., t_new = 0., s_old = 0., s_new = 0.;
+    double tg, tp, tm, sg, sp, sm;
+
+    tol = sp_ienv_dist(20, options) / 100.;
+    nsuper = n > 0 ? supno[n-1] + 1 : 0;
+    if ( tol <= 0. || nsuper < 2 ) return 0;
+    maxsup = sp_ienv_dist(3, options);
+    setree = supernodal_etree(nsuper, etree, supno, xsup);
+
+    /* The U segments by block row: the columns in increasing order, and
+       the first row of each segment. */
+    if ( !(ustart = intCalloc_dist(nsuper + 1)) )
+	ABORT("Calloc fails for ustart[].");
+    nu = xusub[n];
+    for (i = 0; i < nu; ++i) ++ustart[supno[usub[i]] + 1];
+    for (k = 0; k < nsuper; ++k) ustart[k+1] += ustart[k];
+    if ( !(ucol = intMalloc_dist(2 * nu + 5 * n + 2 * nsuper + 2)) )
+	ABORT("Malloc fails for ucol[].");
+    uhead = ucol + nu;
+    gcol = uhead + nu;
+    ghead = gcol + n;
+    tcol = ghead + n;
+    thead = tcol + n;
+    rmark = thead + n;          /* row marker */
+    mark = rmark + n;           /* nsuper + 1 */
+    gfirst = mark + nsuper + 1; /* first old block of each group */
+    for (j = 0; j < n; ++j)
+	for (i = xusub[j]; i < xusub[j+1]; ++i) {
+	    k = supno[usub[i]];
+	    pos = ustart[k]++;
+	    ucol[pos] = j;
+	    uhead[pos] = usub[i];
+	}
+    for (k = nsuper; k > 0; --k) ustart[k] = ustart[k-1];
+    ustart[0] = 0;
+    for (i = 0; i < n; ++i) rmark[i] = SLU_EMPTY;
+
+#define NBELOW(b) (xlsub[xsup[b]+1] - xlsub[xsup[b]] - SuperSize(b))
+#define USIZE(b)  (ustart[b+1] - ustart[b])
+    for (b = 0; b < nsuper; ++b) {
+	t_old += superlu_costmodel_supernode(cm, SuperSize(b), NBELOW(b),
+					     USIZE(b));
+	s_old += amalg_size(SuperSize(b), NBELOW(b), USIZE(b),
+			    &uhead[ustart[b]], xsup[b+1] - 1);
+    }
+
+    /* Grow a group of consecutive blocks from its first block while the
+       next one is the parent of its last one and the merge pays. */
+    ngroup = 0;
+    for (b = 0; b < nsuper; b = q) {
+	gfirst[ngroup++] = b;
+	glast = b;
+	gns = SuperSize(b);
+	gbelow = NBELOW(b);
+	gn = USIZE(b);
+	for (i = 0; i < gn; ++i) {
+	    gcol[i] = ucol[ustart[b] + i];
+	    ghead[i] = uhead[ustart[b] + i];
+	}
+	tg = superlu_costmodel_supernode(cm, gns, gbelow, gn);
+	sg = amalg_size(gns, gbelow, gn, ghead, xsup[b+1] - 1);
+
+	for (q = b + 1; q < nsuper; ++q) {
+	    p = q;
+	    ns = SuperSize(p);
+	    nbelow = NBELOW(p);
+	    last = xsup[p+1] - 1;
+	    if ( setree[glast] != p || gns + ns > maxsup ) break;
+	    nu = USIZE(p);
+	    tp = superlu_costmodel_supernode(cm, ns, nbelow, nu);
+	    sp = amalg_size(ns, nbelow, nu, &uhead[ustart[p]], last);
+
+	    /* L: the rows of the group below p are in p's L. */
+	    for (i = xlsub[xsup[p]]; i < xlsub[xsup[p]+1]; ++i)
+		rmark[lsub[i]] = p;
+	    for (i = xlsub[xsup[glast]]; i < xlsub[xsup[glast]+1]; ++i)
+		if ( lsub[i] > last && rmark[lsub[i]] != p ) break;
+	    if ( i < xlsub[xsup[glast]+1] ) break;
+
+	    /* U: the columns of the group beyond p are in p's U. */
+	    for (i = 0; i < gn && gcol[i] <= last; ++i) ;
+	    for (tn = 0, j = ustart[p]; j < ustart[p+1]; ++j, ++tn) {
+		tcol[tn] = ucol[j];
+		thead[tn] = uhead[j];
+		if ( i < gn && gcol[i] == ucol[j] ) thead[tn] = ghead[i++];
+	    }
+	    if ( i < gn ) break;
+
+	    tm = superlu_costmodel_supernode(cm, gns + ns, nbelow, tn);
+	    sm = amalg_size(gns + ns, nbelow, tn, thead, last);
+	    if ( tm > tg + tp || sm - sg - sp > tol * sm ) break;
+
+	    /* Merge p into the group. */
+	    ++nmerge;
+	    glast = p;
+	    gns += ns;
+	    gn = tn;
+	    for (i = 0; i < tn; ++i) {
+		gcol[i] = tcol[i];
+		ghead[i] = thead[i];
+	    }
+	    tg = tm;
+	    sg = sm;
+	}
+	t_new += tg;
+	s_new += sg;
+    }
+#undef NBELOW
+#undef USIZE
+    gfirst[ngroup] = nsuper;
+    SUPERLU_FREE(setree);
+    SUPERLU_FREE(ustart);
+
+    if ( nmerge == 0 ) {
+	SUPERLU_FREE(ucol);
+	return 0;
+    }
+
+    /* The new L subscripts: the rows of the group's diagonal block, then
+       those of its last block below it. */
+    for (g = 0, nnzl = 0; g < ngroup; ++g) {
+	b = gfirst[g+1] - 1;
+	nnzl += xsup[gfirst[g+1]] - xsup[gfirst[g]]
+	        + xlsub[xsup[b]+1] - xlsub[xsup[b]] - SuperSize(b);
+    }
+    if ( !(newlsub = intMalloc_dist(nnzl)) )
+	ABORT("Malloc fails for newlsub[].");
+    for (g = 0, pos = 0; g < ngroup; ++g) {
+	b = gfirst[g+1] - 1;
+	last = xsup[b+1] - 1;
+	k = pos;
+	for (j = xsup[gfirst[g]]; j <= last; ++j) newlsub[pos++] = j;
+	for (i = xlsub[xsup[b]]; i < xlsub[xsup[b]+1]; ++i)
+	    if ( lsub[i] > last ) newlsub[pos++] = lsub[i];
+	for (j = xsup[gfirst[g]]; j <= last; ++j) xlsub[j] = k;
+	mark[g] = pos;
+    }
+    for (g = 0; g < ngroup; ++g) {
+	/* The columns of group g other than the first point to its end. */
+	for (j = xsup[gfirst[g]] + 1; j < xsup[gfirst[g+1]]; ++j)
+	    xlsub[j] = mark[g];
+    }
+    xlsub[n] = nnzl;
+    SUPERLU_FREE(lsub);
+    Glu_freeable->lsub = newlsub;
+    Glu_freeable->nzlmax = nnzl;
+
+    /* The new partition. */
+    for (g = 0; g < ngroup; ++g) {
+	for (b = gfirst[g]; b < gfirst[g+1]; ++b) mark[b] = g;
+    }
+    for (j = 0; j < n; ++j) supno[j] = mark[supno[j]];
+    supno[n] = ngroup - 1;
+    for (g = 0; g <= ngroup; ++g) xsup[g] = xsup[gfirst[g]];
+
+    /* The new U segments: one per group and column, from the first row;
+       those within the column's own group are in the diagonal block. */
+    for (g = 0; g < ngroup; ++g) mark[g] = SLU_EMPTY;
+    for (j = 0, pos = 0; j < n; ++j) {
+	i = xusub[j];
+	xusub[j] = pos;
+	k = pos;
+	for ( ; i < xusub[j+1]; ++i) {
+	    fnz = usub[i];
+	    g = supno[fnz];
+	    if ( g == supno[j] ) continue;
+	    if ( mark[g] >= k ) {
+		usub[mark[g]] = SUPERLU_MIN(usub[mark[g]], fnz);
+	    } else {
+		mark[g] = pos;
+		usub[pos++] = fnz;
+	    }
+	}
+    }
+    xusub[n] = pos;
+    SUPERLU_FREE(ucol);
+
+    Glu_freeable->nnzLU += (int64_t) (s_new - s_old);
+    if ( !iam && options->PrintStat == YES ) {
+	printf("\tAmalgamation: " IFMT " merges, supers " IFMT " -> " IFMT
+	       ", fill %+.0f (%+.1f%%), predicted %.3e -> %.3e s (%.2fx)\n",
+	       nmerge, nsuper, ngroup, s_new - s_old,
+	       100. * (s_new - s_old) / s_old, t_old, t_new, t_old / t_new);
+	fflush(stdout);
+    }
+    return nmerge;
+} /* superlu_amalgamate */
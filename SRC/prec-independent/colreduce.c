@@ -0,0 +1,194 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Reduce per-column values of a row-distributed matrix on the
+ * owners of the columns
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The column scale factors and the one-norm of an NRformat_loc matrix
+ * need one value per column, combined over all processes whose rows
+ * touch the column.  Instead of an all-reduce of length ncol, the columns
+ * are owned in contiguous blocks, and each process sends only the columns
+ * its rows touch, as (column, value) pairs, to their owners.  The owners
+ * may return the reduced values the same way, so that each process gets
+ * the columns it touches, or all-gather their blocks when every process
+ * needs all of them.  The pattern (which columns go where) is set up once
+ * by superlu_colmap_init() and reused by the reductions.
+ * </pre>
+ */
+
+#include "superlu_defs.h"
+
+/*! \brief First column owned by process p. */
+static int_t colmap_fst(int_t ncol, int procs, int p)
+{
+    int_t q = ncol / procs, rem = ncol % procs;
+    return p * q + SUPERLU_MIN(p, rem);
+}
+
+/*! \brief val[j], where val is float or double according to type. */
+static double colmap_get(void *val, MPI_Datatype type, int_t j)
+{
+    return type == MPI_FLOAT ? ((float *) val)[j] : ((double *) val)[j];
+}
+
+static void colmap_set(void *val, MPI_Datatype type, int_t j, double v)
+{
+    if ( type == MPI_FLOAT ) ((float *) val)[j] = v;
+    else ((double *) val)[j] = v;
+}
+
+/*! \brief Set up the column exchange of the local rows of A.
+ *
+ * <pre>
+ * colind[0 : nnz_loc-1] are the column indices of the local nonzeros.
+ * Collective over comm.
+ * </pre>
+ */
+void superlu_colmap_init(superlu_colmap_t *cm, int_t ncol, int_t nnz_loc,
+			 int_t *colind, MPI_Comm comm)
+{
+    int iam, procs, p;
+    int_t i, j, pos, *mark;
+
+    MPI_Comm_size(comm, &procs);
+    MPI_Comm_rank(comm, &iam);
+    cm->comm = comm;
+    cm->ncol = ncol;
+    cm->fst_col = colmap_fst(ncol, procs, iam);
+    cm->ncol_loc = colmap_fst(ncol, procs, iam + 1) - cm->fst_col;
+
+    if ( !(cm->send_counts = int32Calloc_dist(4 * procs)) )
+	ABORT("Calloc fails for cm->send_counts[].");
+    cm->send_disp = cm->send_counts + procs;
+    cm->recv_counts = cm->send_disp + procs;
+    cm->recv_disp = cm->recv_counts + procs;
+
+    /* The touched columns, in increasing order, hence by owner. */
+    if ( !(mark = intCalloc_dist(ncol)) )
+	ABORT("Calloc fails for mark[].");
+    for (i = 0; i < nnz_loc; ++i) mark[colind[i]] = 1;
+    for (j = 0, cm->nsend = 0; j < ncol; ++j) cm->nsend += mark[j];
+    cm->cols = NULL;
+    if ( cm->nsend && !(cm->cols = intMalloc_dist(cm->nsend)) )
+	ABORT("Malloc fails for cm->cols[].");
+    for (j = 0, pos = 0, p = 0; j < ncol; ++j) {
+	if ( !mark[j] ) continue;
+	while ( j >= colmap_fst(ncol, procs, p + 1) ) ++p;
+	cm->cols[pos++] = j;
+	++cm->send_counts[p];
+    }
+    SUPERLU_FREE(mark);
+
+    MPI_Alltoall(cm->send_counts, 1, MPI_INT, cm->recv_counts, 1, MPI_INT,
+		 comm);
+    cm->nrecv = 0;
+    for (p = 0, pos = 0; p < procs; ++p) {
+	cm->send_disp[p] = pos;
+	pos += cm->send_counts[p];
+	cm->recv_disp[p] = cm->nrecv;
+	cm->nrecv += cm->recv_counts[p];
+    }
+    cm->recv_cols = NULL;
+    if ( cm->nrecv && !(cm->recv_cols = intMalloc_dist(cm->nrecv)) )
+	ABORT("Malloc fails for cm->recv_cols[].");
+    MPI_Alltoallv(cm->cols, cm->send_counts, cm->send_disp, mpi_int_t,
+		  cm->recv_cols, cm->recv_counts, cm->recv_disp, mpi_int_t,
+		  comm);
+
+    pos = cm->nsend + cm->nrecv;
+    cm->buf = NULL;
+    if ( pos && !(cm->buf = SUPERLU_MALLOC(pos * sizeof(double))) )
+	ABORT("Malloc fails for cm->buf[].");
+}
+
+/*! \brief Reduce val[] on the owners of the columns.
+ *
+ * <pre>
+ * val[] is float or double, as given by type (MPI_FLOAT or MPI_DOUBLE);
+ * the values travel in double.
+ * On entry, val[j] is the local value of each touched column j.
+ * On exit, val[fst_col : fst_col+ncol_loc-1] are the values reduced with
+ * op (MPI_MAX or MPI_SUM) over all processes; the columns nobody touches
+ * are 0, so the values must be nonnegative with MPI_MAX.
+ * The other entries of val[] are left alone.  Collective.
+ * </pre>
+ */
+void superlu_colmap_reduce(superlu_colmap_t *cm, void *val,
+			   MPI_Datatype type, MPI_Op op)
+{
+    double *sbuf = cm->buf, *rbuf = cm->buf + cm->nsend, v;
+    int_t i, j;
+
+    for (i = 0; i < cm->nsend; ++i)
+	sbuf[i] = colmap_get(val, type, cm->cols[i]);
+    MPI_Alltoallv(sbuf, cm->send_counts, cm->send_disp, MPI_DOUBLE,
+		  rbuf, cm->recv_counts, cm->recv_disp, MPI_DOUBLE, cm->comm);
+
+    for (j = cm->fst_col; j < cm->fst_col + cm->ncol_loc; ++j)
+	colmap_set(val, type, j, 0.);
+    for (i = 0; i < cm->nrecv; ++i) {
+	j = cm->recv_cols[i];
+	v = colmap_get(val, type, j);
+	v = op == MPI_SUM ? v + rbuf[i] : SUPERLU_MAX(v, rbuf[i]);
+	colmap_set(val, type, j, v);
+    }
+}
+
+/*! \brief Return the owners' values to the processes touching the columns.
+ *
+ * <pre>
+ * The reverse of superlu_colmap_reduce(): val[j] of each touched column j
+ * is set from its owner.  Collective.
+ * </pre>
+ */
+void superlu_colmap_return(superlu_colmap_t *cm, void *val, MPI_Datatype type)
+{
+    double *sbuf = cm->buf, *rbuf = cm->buf + cm->nsend;
+    int_t i;
+
+    for (i = 0; i < cm->nrecv; ++i)
+	rbuf[i] = colmap_get(val, type, cm->recv_cols[i]);
+    MPI_Alltoallv(rbuf, cm->recv_counts, cm->recv_disp, MPI_DOUBLE,
+		  sbuf, cm->send_counts, cm->send_disp, MPI_DOUBLE, cm->comm);
+    for (i = 0; i < cm->nsend; ++i) colmap_set(val, type, cm->cols[i], sbuf[i]);
+}
+
+/*! \brief Replicate the owners' blocks of val[0 : ncol-1] on all processes. */
+void superlu_colmap_allgather(superlu_colmap_t *cm, void *val,
+			      MPI_Datatype type)
+{
+    int procs, p, *counts, *displs;
+
+    MPI_Comm_size(cm->comm, &procs);
+    if ( !(counts = int32Malloc_dist(2 * procs)) )
+	ABORT("Malloc fails for counts[].");
+    displs = counts + procs;
+    for (p = 0; p < procs; ++p) {
+	displs[p] = colmap_fst(cm->ncol, procs, p);
+	counts[p] = colmap_fst(cm->ncol, procs, p + 1) - displs[p];
+    }
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, val, counts, displs,
+		   type, cm->comm);
+    SUPERLU_FREE(counts);
+}
+
+/*! \brief Free the storage of superlu_colmap_init(). */
+void superlu_colmap_free(superlu_colmap_t *cm)
+{
+    SUPERLU_FREE(cm->send_counts);
+    if ( cm->nsend ) SUPERLU_FREE(cm->cols);
+    if ( cm->nrecv ) SUPERLU_FREE(cm->recv_cols);
+    if ( cm->buf ) SUPERLU_FREE(cm->buf);
+}
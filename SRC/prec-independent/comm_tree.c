@@ -325,3 +325,116 @@ void C_RdTree_Create_nv(C_Tree* tree, MPI_Comm comm, int* ranks, int rank_cnt, i
         }			
 	}
 	
+
+/*! \brief Build one family of broadcast or reduction trees of the solve.
+ *
+ * <pre>
+ * type = 'B': tree lk spans the process column of block column
+ *     jb = mycol + lk*npcol and is built over grid->cscp;
+ * type = 'R': tree lk spans the process row of block row
+ *     ib = myrow + lk*nprow and is built over grid->rscp.
+ * ext[lk] is the block this process holds in tree lk that orders it among
+ * the other processes: its smallest block number if minfirst = 1, its
+ * largest if minfirst = 0, SLU_EMPTY if it takes no part in the tree.
+ * The owner of the diagonal block comes first and is the root.
+ *
+ * Instead of exchanging the block lists of every tree with two
+ * collectives per tree, the extremes of all trees are gathered at once
+ * (in chunks bounding the buffer), the rank lists are sorted for all
+ * trees in parallel, then the trees are created.  needrecv and needsend,
+ * if not NULL, return per tree the counts of C_BcTree_Create_nv() and
+ * C_RdTree_Create_nv().  If plist is not NULL, plist[lk][p] is set to YES
+ * for every process p of tree lk other than the root, on the root.
+ * </pre>
+ */
+#define TREE_GATHER_MAX (1 << 22) /* gather buffer, in int_t */
+
+void C_Tree_Build(char type, int minfirst, int_t nsupers, int_t nloc,
+		  int_t *ext, int_t *xsup, gridinfo_t *grid, int tag,
+		  char precision, C_Tree *trees, int *needrecv, int *needsend,
+		  int **plist)
+{
+    int iam = grid->iam;
+    int myrow = MYROW(iam, grid), mycol = MYCOL(iam, grid);
+    int np = type == 'B' ? grid->nprow : grid->npcol;
+    int me = type == 'B' ? myrow : mycol;
+    MPI_Comm comm = type == 'B' ? grid->cscp.comm : grid->rscp.comm;
+    int_t chunk = SUPERLU_MAX(1, SUPERLU_MIN(nloc, TREE_GATHER_MAX / np));
+    int_t *extall, c0;
+    int *ranks, *cnt;
+
+    for (int_t lk = 0; lk < nloc; ++lk) {
+	if ( needrecv ) needrecv[lk] = 0;
+	if ( needsend ) needsend[lk] = 0;
+    }
+    if ( nloc <= 0 ) return;
+
+    if ( !(extall = intMalloc_dist(chunk * np)) )
+	ABORT("Malloc fails for extall[].");
+    if ( !(ranks = SUPERLU_MALLOC(chunk * np * sizeof(int)))
+	 || !(cnt = SUPERLU_MALLOC(chunk * sizeof(int))) )
+	ABORT("Malloc fails for ranks[].");
+
+    for (c0 = 0; c0 < nloc; c0 += chunk) {
+	int_t nc = SUPERLU_MIN(chunk, nloc - c0);
+
+	/* extall[p*nc + i] is ext[c0+i] of process p. */
+	MPI_Allgather(&ext[c0], nc, mpi_int_t, extall, nc, mpi_int_t, comm);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+	for (int_t i = 0; i < nc; ++i) {
+	    int_t blk = type == 'B' ? mycol + (c0 + i) * grid->npcol
+				    : myrow + (c0 + i) * grid->nprow;
+	    int *r = &ranks[i * np];
+	    int n = 0;
+
+	    cnt[i] = 0;
+	    if ( blk >= nsupers || extall[me * nc + i] == SLU_EMPTY ) continue;
+	    for (int p = 0; p < np; ++p) { /* insertion sort on the extremes */
+		int_t e = extall[p * nc + i];
+		int j;
+		if ( e == SLU_EMPTY ) continue;
+		for (j = n; j > 0; --j) {
+		    int_t f = extall[r[j-1] * nc + i];
+		    if ( minfirst ? f < e : f > e ) break;
+		    r[j] = r[j-1];
+		}
+		r[j] = p;
+		++n;
+	    }
+	    assert( extall[r[0] * nc + i] == blk ); /* the root */
+	    cnt[i] = n;
+	}
+
+	for (int_t i = 0; i < nc; ++i) {
+	    int_t lk = c0 + i;
+	    int_t blk = type == 'B' ? mycol + lk * grid->npcol
+				    : myrow + lk * grid->nprow;
+	    int *r = &ranks[i * np];
+	    int n = cnt[i], nrecv = 0, nsend = 0;
+
+	    if ( n <= 1 ) continue;
+	    if ( plist && r[0] == me )
+		for (int j = 1; j < n; ++j) plist[lk][r[j]] = YES;
+	    for (int j = 0; j < n; ++j) /* global ranks */
+		r[j] = type == 'B' ? PNUM(r[j], mycol, grid)
+				   : PNUM(myrow, r[j], grid);
+	    if ( type == 'B' )
+		C_BcTree_Create_nv(&trees[lk], grid->comm, r, n,
+				   xsup[blk+1] - xsup[blk], precision, &nrecv);
+	    else
+		C_RdTree_Create_nv(&trees[lk], grid->comm, r, n,
+				   xsup[blk+1] - xsup[blk], precision,
+				   &nrecv, &nsend);
+	    trees[lk].tag_ = tag;
+	    if ( needrecv ) needrecv[lk] = nrecv;
+	    if ( needsend ) needsend[lk] = nsend;
+	}
+    }
+
+    SUPERLU_FREE(cnt);
+    SUPERLU_FREE(ranks);
+    SUPERLU_FREE(extall);
+}
@@ -0,0 +1,328 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Machine-calibrated cost model of the supernode kernels
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The etree weights of estimateWeight() and getSCUweight() count flops,
+ * but the small GEMMs, TRSMs and scatters of the leaves run far below
+ * the rate of the large ones near the root, so the weights favour the
+ * wrong subtrees when the forest is partitioned.  With SUPERLU_COSTMODEL
+ * (sp_ienv_dist(19)) set, process 0 times the kernels of this build on
+ * this machine over a grid of block sizes, and the weights become the
+ * predicted times interpolated in that table.  Without calibration the
+ * predictions use default rates, e.g. for superlu_amalgamate().
+ *
+ * The table lives in the LUstruct of the solver, so solvers on other
+ * communicators keep their own, and is broadcast, so that every process
+ * computes the same weights.  If the environment variable
+ * SUPERLU_COSTMODEL_FILE names a file (read only with options->ReadEnv,
+ * see superlu_getenv_dist()), the table is read from it, or written to
+ * it after calibration.
+ * </pre>
+ */
+
+#include <math.h>
+#include "superlu_ddefs.h"
+
+#define CM_NB     SUPERLU_CM_NB
+#define CM_BMAX   256
+#define CM_TMIN   2.0e-3 /* seconds timed per kernel and shape */
+
+static double cm_bsize(int i) { return (double) (8 << i); }
+
+/*! \brief Rates of a typical core, half of the peak at block size 32. */
+static void cm_default(superlu_costmodel_t *tb)
+{
+    double ei, ek;
+    int i, k;
+
+    for (i = 0; i < CM_NB; ++i) {
+	ei = cm_bsize(i) / (cm_bsize(i) + 32.);
+	for (k = 0; k < CM_NB; ++k) {
+	    ek = cm_bsize(k) / (cm_bsize(k) + 32.);
+	    tb->gemm[i][k] = 1.0e10 * ei * ek;
+	}
+	tb->trsm[i] = 5.0e9 * ei;
+	tb->scatter[i] = 2.0e8;
+    }
+    tb->latency = 0.;
+    tb->bandwidth = 0.;
+}
+
+/*! \brief Map the WF variable to superlu_costmodel_t.wf. */
+static int cm_weight(const char *wf)
+{
+    if ( !wf ) return 0;
+    if ( strcmp(wf, "One") == 0 ) return 1;
+    if ( strcmp(wf, "Ns") == 0 ) return 2;
+    if ( strcmp(wf, "NsDep") == 0 ) return 3;
+    if ( strcmp(wf, "NsDep2") == 0 ) return 4;
+    return 0;
+}
+
+/*! \brief Time a ping-pong between processes 0 and 1 of comm. */
+static double cm_pingpong(char *buf, int bytes, int reps, MPI_Comm comm)
+{
+    int iam, r;
+    double t;
+
+    MPI_Comm_rank(comm, &iam);
+    MPI_Barrier(comm);
+    t = SuperLU_timer_();
+    for (r = 0; r < reps; ++r) {
+	if ( iam == 0 ) {
+	    MPI_Send(buf, bytes, MPI_BYTE, 1, 0, comm);
+	    MPI_Recv(buf, bytes, MPI_BYTE, 1, 0, comm, MPI_STATUS_IGNORE);
+	} else if ( iam == 1 ) {
+	    MPI_Recv(buf, bytes, MPI_BYTE, 0, 0, comm, MPI_STATUS_IGNORE);
+	    MPI_Send(buf, bytes, MPI_BYTE, 0, 0, comm);
+	}
+    }
+    return (SuperLU_timer_() - t) / (2. * reps);
+}
+
+/*! \brief Benchmark the kernels on this process. */
+static void cm_calibrate(superlu_costmodel_t *tb)
+{
+    int ld = CM_BMAX, i, j, k, b, reps, r, c;
+    int *rowmap, *colmap;
+    double *A, *B, *C, t, e, flops;
+
+    if ( !(A = doubleMalloc_dist(3 * ld * ld + 2 * ld)) )
+	ABORT("Malloc fails for A[].");
+    B = A + ld * ld;
+    C = B + ld * ld;
+    for (i = 0; i < 3 * ld * ld; ++i)
+	A[i] = 1.0e-3 * ((i * 7919) % 1000) / 1000.;
+    if ( !(rowmap = int32Malloc_dist(2 * ld)) )
+	ABORT("Malloc fails for rowmap[].");
+    colmap = rowmap + ld;
+
+    for (i = 0; i < CM_NB; ++i) {
+	b = (int) cm_bsize(i);
+	for (k = 0; k < CM_NB; ++k) {
+	    j = (int) cm_bsize(k);
+	    flops = 2. * b * b * j;
+	    reps = 0;
+	    t = SuperLU_timer_();
+	    do {
+		superlu_dgemm("N", "N", b, b, j, -1.0, A, ld, B, ld,
+			      1.0, C, ld);
+		++reps;
+	    } while ( (e = SuperLU_timer_() - t) < CM_TMIN );
+	    tb->gemm[i][k] = flops * reps / e;
+	}
+
+	flops = (double) b * b * b;
+	reps = 0;
+	t = SuperLU_timer_();
+	do {
+	    superlu_dtrsm("L", "L", "N", "U", b, b, 1.0, A, ld, C, ld);
+	    ++reps;
+	} while ( (e = SuperLU_timer_() - t) < CM_TMIN );
+	tb->trsm[i] = flops * reps / e;
+
+	/* Scatter into every other row and column, as into a sparse
+	   destination block. */
+	for (r = 0; r < b; ++r) rowmap[r] = 2 * r % ld;
+	for (c = 0; c < b; ++c) colmap[c] = (2 * c % ld) * ld;
+	reps = 0;
+	t = SuperLU_timer_();
+	do {
+	    for (c = 0; c < b; ++c)
+		for (r = 0; r < b; ++r)
+		    C[rowmap[r] + colmap[c]] -= B[r + c * ld];
+	    ++reps;
+	} while ( (e = SuperLU_timer_() - t) < CM_TMIN );
+	tb->scatter[i] = (double) b * b * reps / e;
+    }
+
+    SUPERLU_FREE(rowmap);
+    SUPERLU_FREE(A);
+}
+
+static int cm_read(superlu_costmodel_t *tb, char *file)
+{
+    FILE *fp = fopen(file, "r");
+    int i, k, ok = 1;
+
+    if ( !fp ) return 0;
+    for (i = 0; i < CM_NB; ++i)
+	for (k = 0; k < CM_NB; ++k)
+	    ok &= fscanf(fp, "%lf", &tb->gemm[i][k]) == 1;
+    for (i = 0; i < CM_NB; ++i) ok &= fscanf(fp, "%lf", &tb->trsm[i]) == 1;
+    for (i = 0; i < CM_NB; ++i) ok &= fscanf(fp, "%lf", &tb->scatter[i]) == 1;
+    ok &= fscanf(fp, "%lf %lf", &tb->latency, &tb->bandwidth) == 2;
+    fclose(fp);
+    return ok;
+}
+
+static void cm_write(superlu_costmodel_t *tb, char *file)
+{
+    FILE *fp = fopen(file, "w");
+    int i, k;
+
+    if ( !fp ) {
+	fprintf(stderr, "Cannot write the cost model to %s\n", file);
+	return;
+    }
+    for (i = 0; i < CM_NB; ++i) {
+	for (k = 0; k < CM_NB; ++k) fprintf(fp, " %.6e", tb->gemm[i][k]);
+	fprintf(fp, "\n");
+    }
+    for (i = 0; i < CM_NB; ++i) fprintf(fp, " %.6e", tb->trsm[i]);
+    fprintf(fp, "\n");
+    for (i = 0; i < CM_NB; ++i) fprintf(fp, " %.6e", tb->scatter[i]);
+    fprintf(fp, "\n%.6e %.6e\n", tb->latency, tb->bandwidth);
+    fclose(fp);
+}
+
+/*! \brief Turn the calibrated cost model of cm on or off.
+ *
+ * <pre>
+ * cm is the costmodel of the LUstruct, zero after xLUstructInit(); it
+ * receives the default rates if it has none.  With
+ * sp_ienv_dist(19, options) = 0, the etree weights are the flop
+ * formulas again; no communication.  Otherwise collective over comm:
+ * unless cm already holds a measured table, process 0 reads it from
+ * SUPERLU_COSTMODEL_FILE or calibrates, and every process receives it.
+ * </pre>
+ */
+void superlu_costmodel_setup(superlu_dist_options_t *options,
+			     superlu_costmodel_t *cm, MPI_Comm comm)
+{
+    char *file, *buf;
+    int iam, procs, have;
+    double t0, t1;
+
+    if ( !cm->calibrated ) cm_default(cm);
+    cm->active = sp_ienv_dist(19, options) > 0;
+    cm->wf = cm_weight(superlu_getenv_dist("WF", options));
+    if ( !cm->active || cm->calibrated ) return;
+
+    file = superlu_getenv_dist("SUPERLU_COSTMODEL_FILE", options);
+    MPI_Comm_rank(comm, &iam);
+    MPI_Comm_size(comm, &procs);
+    have = !iam && file && cm_read(cm, file);
+    MPI_Bcast(&have, 1, MPI_INT, 0, comm);
+
+    if ( !have ) {
+	cm->latency = 0.;
+	cm->bandwidth = 0.;
+	if ( procs > 1 ) {
+	    if ( !(buf = SUPERLU_MALLOC(1 << 20)) )
+		ABORT("Malloc fails for buf[].");
+	    t0 = cm_pingpong(buf, 8, 100, comm);
+	    t1 = cm_pingpong(buf, 1 << 20, 10, comm);
+	    cm->latency = t0;
+	    cm->bandwidth = (1 << 20) / SUPERLU_MAX(t1 - t0, 1.0e-9);
+	    SUPERLU_FREE(buf);
+	}
+	if ( !iam ) {
+	    cm_calibrate(cm);
+	    if ( file ) cm_write(cm, file);
+	}
+    }
+    MPI_Bcast(cm, sizeof(superlu_costmodel_t), MPI_BYTE, 0, comm);
+    cm->calibrated = 1;
+
+#if ( PRNTlevel>=1 )
+    if ( !iam )
+	printf(".. cost model: GEMM %.2e .. %.2e flop/s, latency %.2e s,"
+	       " bandwidth %.2e B/s\n", cm->gemm[0][0],
+	       cm->gemm[CM_NB-1][CM_NB-1], cm->latency, cm->bandwidth);
+#endif
+}
+
+/*! \brief Whether the etree weights use the calibrated cost model cm. */
+int superlu_costmodel_active(const superlu_costmodel_t *cm)
+{
+    return cm && cm->active;
+}
+
+/*! \brief Fractional index of block size x in the table, clamped. */
+static double cm_pos(double x)
+{
+    double p = log2(SUPERLU_MAX(x, 1.) / cm_bsize(0));
+    return SUPERLU_MIN(SUPERLU_MAX(p, 0.), CM_NB - 1.);
+}
+
+/*! \brief Interpolate the rate v[] at fractional index p. */
+static double cm_interp(const double *v, double p)
+{
+    int i = (int) p;
+    if ( i >= CM_NB - 1 ) return v[CM_NB - 1];
+    return v[i] + (p - i) * (v[i+1] - v[i]);
+}
+
+/*! \brief Predicted seconds of the update C(m x n) -= A(m x k) B(k x n)
+ * and of scattering it into the destination blocks. */
+static double cm_schur(const superlu_costmodel_t *tb,
+		       double m, double n, double k)
+{
+    double row[CM_NB], pm, pk;
+    int i;
+
+    if ( m <= 0. || n <= 0. || k <= 0. ) return 0.;
+    pm = cm_pos(sqrt(m * n));
+    pk = cm_pos(k);
+    for (i = 0; i < CM_NB; ++i) row[i] = cm_interp(tb->gemm[i], pk);
+    return 2. * m * n * k / cm_interp(row, pm)
+	   + m * n / cm_interp(tb->scatter, pm);
+}
+
+/*! \brief cm_schur() with the rates of cm, or with the default ones if cm
+ * is NULL or was never set up. */
+double superlu_costmodel_schur(const superlu_costmodel_t *cm,
+			       double m, double n, double k)
+{
+    superlu_costmodel_t def;
+
+    if ( !cm || cm->gemm[0][0] <= 0. ) {
+	cm_default(&def);
+	cm = &def;
+    }
+    return cm_schur(cm, m, n, k);
+}
+
+/*! \brief Predicted seconds to eliminate a supernode.
+ *
+ * <pre>
+ * ns columns, with nrow rows of L below the diagonal block and ncol
+ * columns of U to its right: the diagonal block, the two panel solves,
+ * the panel broadcasts and the Schur complement update.  The rates are
+ * those of cm, or the default ones if cm is NULL or was never set up.
+ * </pre>
+ */
+double superlu_costmodel_supernode(const superlu_costmodel_t *cm,
+				   double ns, double nrow, double ncol)
+{
+    const superlu_costmodel_t *tb = cm;
+    superlu_costmodel_t def;
+    double t, ps;
+
+    if ( ns <= 0. ) return 0.;
+    if ( !tb || tb->gemm[0][0] <= 0. ) {
+	cm_default(&def);
+	tb = &def;
+    }
+    ps = cm_pos(ns);
+    t = 2. / 3. * ns * ns * ns / cm_interp(tb->trsm, ps);
+    t += ns * ns * (nrow + ncol) / cm_interp(tb->trsm, ps);
+    if ( tb->bandwidth > 0. )
+	t += 2. * tb->latency
+	     + sizeof(double) * ns * (nrow + ncol) / tb->bandwidth;
+    return t + cm_schur(tb, nrow, ncol, ns);
+}
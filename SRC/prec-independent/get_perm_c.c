@@ -603,3 +603,237 @@ get_perm_c_dist(int_t pnum, int_t ispec, SuperMatrix *A, int_t *perm_c)
     CHECK_MALLOC((int) pnum, "Exit get_perm_c_dist()");
 #endif
 } /* end get_perm_c_dist */
+
+/*! \brief Order the square matrix A by ispec as GET_PERM_C_DIST does,
+ * each of the blocks of A decoupled from the others on its own.
+ *
+ * <pre>
+ * The blocks are the connected components of the graph of A'+A.  They are
+ * numbered one after the other, so that each is one tree of the etree,
+ * and the fill-reducing ordering of one block cannot be disturbed by the
+ * others.  Returns the number of blocks; the largest has *maxblk nodes.
+ * </pre>
+ */
+static int_t
+get_perm_c_blocks(int_t pnum, int_t ispec, SuperMatrix *A, int_t *perm_c,
+		  int_t *maxblk)
+{
+    NCformat *Astore = A->Store, Bstore;
+    SuperMatrix B;
+    int_t *colptr = Astore->colptr, *rowind = Astore->rowind;
+    int_t n = A->ncol, *root, *blk, *bptr, *bcol, *bnum, *bperm, i, j, p, r;
+    int_t s, b;
+    int_t nb, nbn, nnz;
+
+    *maxblk = n;
+    if ( n == 0 ) return 0;
+    if ( !(root = intMalloc_dist(6 * n + 1)) ) ABORT("Malloc fails for root[].");
+    blk = root + n;
+    bcol = blk + n;
+    bnum = bcol + n;
+    bperm = bnum + n;
+    bptr = bperm + n;   /* n + 1 */
+
+    /* Union-find on the entries of A; root[] holds the trees. */
+    for (j = 0; j < n; ++j) root[j] = j;
+    for (j = 0; j < n; ++j)
+	for (p = colptr[j]; p < colptr[j+1]; ++p) {
+	    for (r = rowind[p]; root[r] != r; r = root[r]) root[r] = root[root[r]];
+	    for (s = j; root[s] != s; s = root[s]) root[s] = root[root[s]];
+	    if ( r != s ) root[SUPERLU_MAX(r, s)] = SUPERLU_MIN(r, s);
+	}
+
+    /* The blocks, numbered by their first node, and their columns. */
+    for (j = 0, nb = 0; j < n; ++j) {
+	for (r = j; root[r] != r; r = root[r]) ;
+	blk[j] = r == j ? nb++ : blk[r];
+    }
+    if ( nb < 2 ) {
+	SUPERLU_FREE(root);
+	get_perm_c_dist(pnum, ispec, A, perm_c);
+	return nb;
+    }
+    for (b = 0; b <= nb; ++b) bptr[b] = 0;
+    for (j = 0; j < n; ++j) ++bptr[blk[j] + 1];
+    for (b = 0, *maxblk = 0; b < nb; ++b) {
+	*maxblk = SUPERLU_MAX(*maxblk, bptr[b+1]);
+	bptr[b+1] += bptr[b];
+    }
+    for (j = 0; j < n; ++j) {
+	bnum[j] = bptr[blk[j]]++;
+	bcol[bnum[j]] = j;
+    }
+    for (b = nb; b > 0; --b) bptr[b] = bptr[b-1];
+    bptr[0] = 0;
+
+    /* Order each block; a block of one or two nodes keeps its order. */
+    if ( !(Bstore.colptr = intMalloc_dist(*maxblk + 1)) )
+	ABORT("Malloc fails for Bstore.colptr[].");
+    if ( !(Bstore.rowind = intMalloc_dist(SUPERLU_MAX(Astore->nnz, 1))) )
+	ABORT("Malloc fails for Bstore.rowind[].");
+    Bstore.nzval = NULL;
+    B.Stype = SLU_NC;
+    B.Dtype = A->Dtype;
+    B.Mtype = A->Mtype;
+    B.Store = &Bstore;
+    for (b = 0; b < nb; ++b) {
+	nbn = bptr[b+1] - bptr[b];
+	if ( nbn <= 2 ) {
+	    for (i = bptr[b]; i < bptr[b+1]; ++i) perm_c[bcol[i]] = i;
+	    continue;
+	}
+	for (i = 0, nnz = 0; i < nbn; ++i) {
+	    j = bcol[bptr[b] + i];
+	    Bstore.colptr[i] = nnz;
+	    for (p = colptr[j]; p < colptr[j+1]; ++p)
+		Bstore.rowind[nnz++] = bnum[rowind[p]] - bptr[b];
+	}
+	Bstore.colptr[nbn] = nnz;
+	Bstore.nnz = nnz;
+	B.nrow = B.ncol = nbn;
+	get_perm_c_dist(pnum, ispec, &B, bperm);
+	for (i = 0; i < nbn; ++i)
+	    perm_c[bcol[bptr[b] + i]] = bptr[b] + bperm[i];
+    }
+
+    SUPERLU_FREE(Bstore.colptr);
+    SUPERLU_FREE(Bstore.rowind);
+    SUPERLU_FREE(root);
+    return nb;
+} /* end get_perm_c_blocks */
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ * =======
+ *
+ * GET_PERM_C_DENSE_DIST obtains the column permutation of GET_PERM_C_DIST
+ * with the dense rows and columns of A ordered last, and each block of A
+ * decoupled from the others ordered on its own.
+ *
+ * A few nearly dense rows or columns, such as global constraints or
+ * Lagrange multipliers, couple all the other unknowns in A'+A or A'*A.
+ * The fill-reducing orderings then do badly, and the supernodes near the
+ * root become huge.  Node j is dense if row j or column j of A has more
+ * than max(16, sp_ienv_dist(23) * sqrt(n)) entries.  The k dense nodes
+ * are withheld, the rest of A is ordered by ispec as in GET_PERM_C_DIST,
+ * and the dense nodes are numbered last.  Since the factorization is of
+ * Pc*A*Pc', they form a k x k border whose Schur complement is factored
+ * in the last supernodes.
+ *
+ * If sp_ienv_dist(24) is set, the rest of A is split into its decoupled
+ * blocks, the connected components of its graph, which often appear once
+ * the dense border is withheld.  Each block is ordered by ispec on its own
+ * and numbered contiguously, so that it is one tree of the etree; the 3D
+ * factorization then assigns whole blocks to the layers of the process
+ * grid as far as the load balance allows (see getGreedyLoadBalForests()).
+ * This is an ordering only: on a 2D grid the blocks are still distributed
+ * and factored together by the whole grid, not on sub-communicators.
+ *
+ * Arguments
+ * =========
+ *
+ * options (input) superlu_dist_options_t*
+ *         sp_ienv_dist(23, options) is the density threshold, and
+ *         sp_ienv_dist(24, options) enables the block detection; with both
+ *         0, the ordering is that of GET_PERM_C_DIST.
+ *
+ * pnum, ispec, A, perm_c
+ *         As in GET_PERM_C_DIST.  A must be square.
+ *
+ * Return value
+ * ============
+ *
+ * The number of dense rows and columns ordered last.
+ * </pre>
+ */
+int_t
+get_perm_c_dense_dist(superlu_dist_options_t *options, int_t pnum,
+		      int_t ispec, SuperMatrix *A, int_t *perm_c)
+{
+    NCformat *Astore = A->Store, Sstore;
+    SuperMatrix S;
+    int_t *colptr = Astore->colptr, *rowind = Astore->rowind;
+    int_t n = A->ncol, *cnt, *snum, *sperm, i, j, p, k = 0, ns, nnz;
+    int_t thresh = 0, nb = 0, maxblk;
+    int dense = sp_ienv_dist(23, options), blocks = sp_ienv_dist(24, options) > 0;
+
+    if ( A->nrow != n || ispec == NATURAL || (dense <= 0 && !blocks) ) {
+	get_perm_c_dist(pnum, ispec, A, perm_c);
+	return 0;
+    }
+
+    /* Node j is dense if row j or column j has more than thresh
+       entries; snum[j] is its number in the sparse part, or SLU_EMPTY. */
+    if ( !(cnt = intCalloc_dist(3 * n)) ) ABORT("Calloc fails for cnt[].");
+    snum = cnt + n;
+    sperm = snum + n;
+    if ( dense > 0 ) {
+	thresh = SUPERLU_MAX(16, (int_t) (dense * sqrt((double) n)));
+	for (j = 0; j < n; ++j)
+	    for (p = colptr[j]; p < colptr[j+1]; ++p) ++cnt[rowind[p]];
+	for (j = 0, ns = 0; j < n; ++j)
+	    if ( cnt[j] > thresh || colptr[j+1] - colptr[j] > thresh )
+		snum[j] = SLU_EMPTY;
+	    else
+		snum[j] = ns++;
+	k = n - ns;
+	if ( 2 * k > n ) k = 0;
+    }
+
+    if ( k == 0 ) {
+	if ( blocks )
+	    nb = get_perm_c_blocks(pnum, ispec, A, perm_c, &maxblk);
+	else
+	    get_perm_c_dist(pnum, ispec, A, perm_c);
+    } else {
+	/* The sparse part S. */
+	for (j = 0, nnz = 0; j < n; ++j)
+	    if ( snum[j] != SLU_EMPTY )
+		for (p = colptr[j]; p < colptr[j+1]; ++p)
+		    if ( snum[rowind[p]] != SLU_EMPTY ) ++nnz;
+	Sstore.nnz = nnz;
+	Sstore.nzval = NULL;
+	if ( !(Sstore.colptr = intMalloc_dist(ns + 1)) )
+	    ABORT("Malloc fails for Sstore.colptr[].");
+	if ( !(Sstore.rowind = intMalloc_dist(SUPERLU_MAX(nnz, 1))) )
+	    ABORT("Malloc fails for Sstore.rowind[].");
+	for (j = 0, nnz = 0; j < n; ++j) {
+	    if ( snum[j] == SLU_EMPTY ) continue;
+	    Sstore.colptr[snum[j]] = nnz;
+	    for (p = colptr[j]; p < colptr[j+1]; ++p)
+		if ( (i = snum[rowind[p]]) != SLU_EMPTY )
+		    Sstore.rowind[nnz++] = i;
+	}
+	Sstore.colptr[ns] = nnz;
+	S.Stype = SLU_NC;
+	S.Dtype = A->Dtype;
+	S.Mtype = A->Mtype;
+	S.nrow = S.ncol = ns;
+	S.Store = &Sstore;
+
+	if ( blocks )
+	    nb = get_perm_c_blocks(pnum, ispec, &S, sperm, &maxblk);
+	else
+	    get_perm_c_dist(pnum, ispec, &S, sperm);
+
+	for (j = 0, i = ns; j < n; ++j)
+	    perm_c[j] = snum[j] == SLU_EMPTY ? i++ : sperm[snum[j]];
+
+	SUPERLU_FREE(Sstore.colptr);
+	SUPERLU_FREE(Sstore.rowind);
+    }
+    SUPERLU_FREE(cnt);
+
+    if ( !pnum && options->PrintStat == YES ) {
+	if ( k )
+	    printf("\tDense rows/columns: " IFMT " ordered last (> " IFMT
+		   " entries)\n", k, thresh);
+	if ( nb > 1 )
+	    printf("\tDecoupled blocks: " IFMT ", largest " IFMT
+		   " of " IFMT " nodes\n", nb, maxblk, n - k);
+	fflush(stdout);
+    }
+    return k;
+} /* end get_perm_c_dense_dist */
@@ -0,0 +1,188 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Adaptive look-ahead window of the numerical factorization, and
+ * the priority order of the panels in the window
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The factorization calls superlu_lookahead_step() once per step with the
+ * time it spent waiting for panels and the time it spent computing.  At
+ * the end of every interval the sums are reduced over the grid; when the
+ * fraction of waiting is high the window is doubled, when it is low the
+ * window is shrunk, always between 1 and the bound the buffers were
+ * allocated for (num_lookaheads, possibly lowered by the memory budget in
+ * superlu_plan_memory()).
+ *
+ * superlu_window_order() gives the order in which the panels admitted to
+ * the window are factored and their messages posted, so that the panels
+ * on the critical path of the etree are not queued behind the others.
+ * </pre>
+ */
+
+#include "superlu_defs.h"
+
+#define LA_WAIT_HI 0.20 /* grow the window above this fraction of waiting */
+#define LA_WAIT_LO 0.05 /* shrink it below this fraction */
+
+/*! \brief Set up the window controller.
+ *
+ * <pre>
+ * maxla is the largest window the caller can hold, interval the number of
+ * steps between two decisions.  All processes of comm must call
+ * superlu_lookahead_step() the same number of times.
+ * </pre>
+ */
+void superlu_lookahead_init(superlu_lookahead_t *la,
+			    superlu_dist_options_t *options, int maxla,
+			    int interval, MPI_Comm comm)
+{
+    la->level = SUPERLU_MAX(sp_ienv_dist(14, options), 0);
+    la->maxla = SUPERLU_MAX(0, maxla);
+    if ( la->maxla <= 1 ) la->level = 0;  /* nothing to adapt */
+    la->la = la->level ? (la->maxla + 1) / 2 : la->maxla;
+    la->interval = SUPERLU_MAX(1, interval);
+    la->nsteps = 0;
+    la->wait = la->busy = 0.0;
+    la->req = MPI_REQUEST_NULL;
+    la->comm = comm;
+    MPI_Comm_rank(comm, &la->iam);
+    la->ndecisions = 0;
+    la->lamin = la->lamax = la->la;
+    la->lasum = 0.0;
+    la->totsteps = 0;
+}
+
+/*! \brief Account one step and return the window for the next one.
+ *
+ * <pre>
+ * wait is the time step k0 was blocked on the receipt of its panels,
+ * busy the rest of the step.
+ * </pre>
+ */
+int superlu_lookahead_step(superlu_lookahead_t *la, int_t k0, double wait,
+			   double busy)
+{
+    if ( !la->level ) return la->la;
+
+    la->wait += wait;
+    la->busy += busy;
+    la->lasum += la->la;
+    ++la->totsteps;
+    if ( ++la->nsteps < la->interval ) return la->la;
+
+    if ( la->req != MPI_REQUEST_NULL ) { /* decide on the last interval */
+	double tot, f;
+	int old = la->la;
+
+	MPI_Wait(&la->req, MPI_STATUS_IGNORE);
+	tot = la->rbuf[0] + la->rbuf[1];
+	f = tot > 0.0 ? la->rbuf[0] / tot : 0.0;
+	if ( f > LA_WAIT_HI )
+	    la->la = SUPERLU_MIN(la->maxla, 2 * la->la);
+	else if ( f < LA_WAIT_LO )
+	    la->la = SUPERLU_MAX(1, la->la - SUPERLU_MAX(1, la->la / 4));
+	if ( la->la != old ) {
+	    ++la->ndecisions;
+	    la->lamin = SUPERLU_MIN(la->lamin, la->la);
+	    la->lamax = SUPERLU_MAX(la->lamax, la->la);
+	    if ( la->level >= 2 && !la->iam )
+		printf(".. look-ahead: step " IFMT ", wait %5.1f%%, "
+		       "window %d -> %d\n", k0, 100.0 * f, old, la->la);
+	}
+    }
+
+    la->sbuf[0] = la->wait;
+    la->sbuf[1] = la->busy;
+    MPI_Iallreduce(la->sbuf, la->rbuf, 2, MPI_DOUBLE, MPI_SUM, la->comm,
+		   &la->req);
+    la->nsteps = 0;
+    la->wait = la->busy = 0.0;
+    return la->la;
+}
+
+/*! \brief Complete the pending reduction and report the window range. */
+void superlu_lookahead_finalize(superlu_lookahead_t *la)
+{
+    if ( la->req != MPI_REQUEST_NULL ) MPI_Wait(&la->req, MPI_STATUS_IGNORE);
+    if ( la->level >= 2 && !la->iam && la->totsteps ) {
+	printf(".. look-ahead window: min %d, avg %.1f, max %d of %d, "
+	       "%d changes\n", la->lamin, la->lasum / la->totsteps,
+	       la->lamax, la->maxla, la->ndecisions);
+	fflush(stdout);
+    }
+}
+
+/*! \brief Order the window positions kk1..kk2 by decreasing priority.
+ *
+ * <pre>
+ * prio[k] is the priority of supernode k, e.g. the critical path of
+ * supernodal_critical_path(); perm_c_supno maps a position to a
+ * supernode.  With prio == NULL the natural order is kept.  Ties keep
+ * the natural order, so every process gets the same order.  Returns the
+ * number of positions written to order[].
+ * </pre>
+ */
+int superlu_window_order(int_t kk1, int_t kk2, int_t *perm_c_supno,
+			 double *prio, int_t *order)
+{
+    int_t j, kk0, n = 0;
+
+    for (kk0 = kk1; kk0 <= kk2; ++kk0) {
+	if ( prio ) { /* insertion sort; the window is short */
+	    double p = prio[perm_c_supno[kk0]];
+	    for (j = n; j > 0 && prio[perm_c_supno[order[j-1]]] < p; --j)
+		order[j] = order[j-1];
+	    order[j] = kk0;
+	} else {
+	    order[n] = kk0;
+	}
+	++n;
+    }
+    return n;
+}
+
+/*! \brief Critical-path priorities of the panel messages.
+ *
+ * <pre>
+ * Returns prio[k], the weight of the heaviest leaf-to-root chain of the
+ * supernodal etree through supernode k (see supernodal_critical_path()),
+ * for superlu_window_order().  If crit is not NULL, crit[k] is set to 1
+ * for the supernodes within MSG_CRIT_FRAC of the critical path, whose
+ * messages may use a communicator of their own.  The weights are those
+ * of calcTreeWeight() with the cost model cm.  The caller frees prio.
+ * </pre>
+ */
+#define MSG_CRIT_FRAC 0.9
+
+double *superlu_panel_priority(int_t nsupers, int_t *etree,
+			       Glu_persist_t *Glu_persist,
+			       const superlu_costmodel_t *cm, char *crit)
+{
+    int_t *xsup = Glu_persist->xsup, *setree, k;
+    treeList_t *treeList;
+    double *prio, cmax = 0.0;
+
+    setree = supernodal_etree(nsupers, etree, Glu_persist->supno, xsup);
+    treeList = setree2list(nsupers, setree);
+    calcTreeWeight(nsupers, setree, treeList, xsup, cm);
+    prio = supernodal_critical_path(nsupers, setree, treeList);
+    free_treelist(nsupers, treeList);
+    SUPERLU_FREE(setree);
+
+    if ( crit ) {
+	for (k = 0; k < nsupers; ++k) cmax = SUPERLU_MAX(cmax, prio[k]);
+	for (k = 0; k < nsupers; ++k) crit[k] = prio[k] >= MSG_CRIT_FRAC * cmax;
+    }
+    return prio;
+}
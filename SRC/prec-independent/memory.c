@@ -24,11 +24,11 @@ at the top-level directory.
 #include "superlu_ddefs.h"
 
 /*
- * Global variables
+ * State of the serial symbolic factorization, private to each thread
  */
-SuperLU_ExpHeader *expanders=NULL; /* Array of pointers to 4 types of memory */
-SuperLU_LU_stack_t stack;
-int_t no_expand;
+SUPERLU_THREAD_LOCAL SuperLU_ExpHeader *expanders=NULL; /* Array of pointers to 4 types of memory */
+SUPERLU_THREAD_LOCAL SuperLU_LU_stack_t stack;
+SUPERLU_THREAD_LOCAL int_t no_expand;
 
 
 /*
@@ -612,7 +612,6 @@ int_t QuerySpace_dist(int_t n, int_t lsub_size, Glu_freeable_t *Glu_freeable,
 /************************************************************************/
 {
     register int_t iword = sizeof(int_t);
-    extern int_t no_expand;
 
     /* For the adjacency graphs of L and U. */
     /*mem_usage->for_lu = (float)( (4*n + 3) * iword +
@@ -629,6 +628,207 @@ int_t QuerySpace_dist(int_t n, int_t lsub_size, Glu_freeable_t *Glu_freeable,
     return 0;
 } /* QUERYSPACE_DIST */
 
+/*! \brief Plan the per-process memory of the numerical factorization.
+ *
+ * <pre>
+ * Called collectively on the 2D grid after serial symbolic
+ * factorization and before distribution.  From the supernodal graphs
+ * in Glu_persist/Glu_freeable it counts the entries of L and U this
+ * process will own under the block-cyclic map, and sizes the buffers
+ * pxgstrf() allocates on top of them: the look-ahead receive buffers
+ * (Llu->bufmax[0:3] per level) and the bigU/bigV and L panel buffers
+ * used for the Schur-complement update.
+ *
+ * With a budget (sp_ienv_dist(12), in MB per process) the look-ahead
+ * depth options->num_lookaheads is lowered until the busiest process
+ * fits.  In GPU builds options->superlu_max_buffer_size, which sizes the
+ * GEMM staging buffers, is also capped by the memory left over; CPU
+ * builds never read that field and leave it alone.  The caller restores
+ * both fields after the factorization.
+ * The per-process estimates of the busiest process are returned in
+ * mem_usage->{L_loc, U_loc, lookahead, schur, budget}.
+ *
+ * The plan is for one 2D grid.  The 3D drivers replicate the ancestor
+ * supernodes on every layer and do not call it.
+ *
+ * Return value:
+ *    0 : the plan fits, or no budget is set;
+ *  > 0 : nothing fits even without look-ahead; the value is the
+ *        number of MB the busiest process needs.  Process 0 prints
+ *        the breakdown.
+ * </pre>
+ */
+int superlu_plan_memory(superlu_dist_options_t *options, int_t n, int dsize,
+			Glu_persist_t *Glu_persist, Glu_freeable_t *Glu_freeable,
+			gridinfo_t *grid, superlu_dist_mem_usage_t *mem_usage)
+{
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *xlsub = Glu_freeable->xlsub, *lsub = Glu_freeable->lsub;
+    int_t *xusub = Glu_freeable->xusub, *usub = Glu_freeable->usub;
+    int_t nsupers = supno[n-1] + 1;
+    int iam = grid->iam, nprocs = grid->nprow * grid->npcol;
+    int myrow = MYROW(iam, grid), mycol = MYCOL(iam, grid);
+    int_t nrbu = CEILING(nsupers, grid->nprow);
+    int_t i, j, jb, gb, lb, irow, fsupc, nsupc, len, nrbl, seg;
+    int_t *marker, *Urb_len, *Urb_idx, *Urb_ncols, *Urb_ldu;
+    int_t mybuf[6], buf[6]; /* bufmax[0:3], max_row_size, max_ldu */
+    int_t max_ncols, ncols = 0;
+    double fixed[4], maxfixed[4]; /* L_loc, U_loc, schur, sum */
+    double L_loc = 0., U_loc = 0., level, schur, need, budget;
+    int la, ldt = sp_ienv_dist(3, options), num_threads = 1;
+#if ( PRNTlevel>=1 )
+    int la0;
+#endif
+    int iword = sizeof(int_t);
+
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    if ( !(marker = intMalloc_dist(nsupers + 4 * nrbu)) )
+	ABORT("Malloc fails for marker[].");
+    Urb_len = marker + nsupers;   /* values in block row */
+    Urb_idx = Urb_len + nrbu;     /* index[] length of block row */
+    Urb_ncols = Urb_idx + nrbu;   /* nonzero columns in block row */
+    Urb_ldu = Urb_ncols + nrbu;   /* longest segment in block row */
+    for (i = 0; i < nsupers + 4 * nrbu; ++i) marker[i] = 0;
+    for (i = 0; i < 6; ++i) mybuf[i] = 0;
+
+    for (jb = 0; jb < nsupers; ++jb) {
+	if ( mycol != PCOL(jb, grid) ) continue;
+	fsupc = FstBlockC(jb);
+	nsupc = SuperSize(jb);
+
+	/* L(:,jb): rows I own, grouped into row blocks. */
+	len = nrbl = 0;
+	for (i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i) {
+	    gb = BlockNum(lsub[i]);
+	    if ( myrow != PROW(gb, grid) ) continue;
+	    ++len;
+	    if ( marker[gb] <= jb ) { marker[gb] = jb + 1; ++nrbl; }
+	}
+	if ( nrbl ) {
+	    j = BC_HEADER + nrbl * LB_DESCRIPTOR + len;
+	    L_loc += (double) j * iword + (double) len * nsupc * dsize;
+	    mybuf[0] = SUPERLU_MAX(mybuf[0], j);
+	    mybuf[1] = SUPERLU_MAX(mybuf[1], len * nsupc);
+	    mybuf[4] = SUPERLU_MAX(mybuf[4], len);
+	}
+	if ( myrow == PROW(jb, grid) && options->DiagInv == YES )
+	    L_loc += 2. * nsupc * nsupc * dsize; /* Linv and Uinv */
+
+	/* U(:,jb): segments in block rows I own; usub[] only holds
+	   the first nonzero of each segment. */
+	for (j = fsupc; j < fsupc + nsupc; ++j) {
+	    for (i = xusub[j]; i < xusub[j+1]; ++i) {
+		irow = usub[i];
+		gb = BlockNum(irow);
+		if ( myrow != PROW(gb, grid) ) continue;
+		lb = LBi(gb, grid);
+		seg = FstBlockC(gb+1) - irow;
+		Urb_len[lb] += seg;
+		Urb_ldu[lb] = SUPERLU_MAX(Urb_ldu[lb], seg);
+		++Urb_ncols[lb];
+		if ( marker[gb] <= jb + nsupers ) { /* first see U(gb,jb) */
+		    marker[gb] = jb + nsupers + 1;
+		    Urb_idx[lb] += UB_DESCRIPTOR + nsupc;
+		}
+	    }
+	}
+    }
+
+    for (lb = 0; lb < nrbu; ++lb) {
+	if ( !Urb_idx[lb] ) continue;
+	j = BR_HEADER + Urb_idx[lb];
+	U_loc += (double) j * iword + (double) Urb_len[lb] * dsize;
+	mybuf[2] = SUPERLU_MAX(mybuf[2], j);
+	mybuf[3] = SUPERLU_MAX(mybuf[3], Urb_len[lb]);
+	mybuf[5] = SUPERLU_MAX(mybuf[5], Urb_ldu[lb]);
+	ncols = SUPERLU_MAX(ncols, Urb_ncols[lb]);
+    }
+    SUPERLU_FREE(marker);
+
+    /* Receive buffers must hold any process's panel; bigU/bigV follow
+       estimate_bigu_size() and pxgstrf(). */
+    MPI_Allreduce(mybuf, buf, 4, mpi_int_t, MPI_MAX, grid->comm);
+    MPI_Allreduce(&mybuf[4], &buf[4], 1, mpi_int_t, MPI_MAX, grid->rscp.comm);
+    MPI_Allreduce(&mybuf[5], &buf[5], 1, mpi_int_t, MPI_MAX, grid->cscp.comm);
+    MPI_Allreduce(&ncols, &max_ncols, 1, mpi_int_t, MPI_MAX, grid->cscp.comm);
+
+    /* Per look-ahead level: L and U receive buffers, lookAhead_L_buff. */
+    level = (double) (buf[0] + buf[2]) * iword
+	  + (double) (buf[1] + buf[3] + (double) ldt * ldt) * dsize;
+    /* bigU, bigV, Remain_L_buff and the per-supernode work arrays. */
+    schur = (double) buf[5] * max_ncols * dsize
+	  + (double) SUPERLU_MAX(buf[4] * max_ncols,
+				 (ldt * ldt + 64 / dsize) * num_threads) * dsize
+	  + (double) buf[1] * dsize
+	  + (double) ldt * ldt * (2. * dsize + iword);
+
+    fixed[0] = L_loc;
+    fixed[1] = U_loc;
+    fixed[2] = schur;
+    fixed[3] = L_loc + U_loc + schur;
+    MPI_Allreduce(fixed, maxfixed, 4, MPI_DOUBLE, MPI_MAX, grid->comm);
+
+    /* Deepest look-ahead window that fits the busiest process. */
+    budget = 1.0e6 * sp_ienv_dist(12, options);
+    la = SUPERLU_MAX(0, options->num_lookaheads);
+#if ( PRNTlevel>=1 )
+    la0 = la;
+#endif
+    need = maxfixed[3] + (la + 1) * level;
+    if ( budget > 0. ) {
+	while ( la > 0 && need > budget ) {
+	    --la;
+	    need = maxfixed[3] + (la + 1) * level;
+	}
+    }
+
+    mem_usage->L_loc = maxfixed[0];
+    mem_usage->U_loc = maxfixed[1];
+    mem_usage->lookahead = (la + 1) * level;
+    mem_usage->schur = maxfixed[2];
+    mem_usage->budget = budget;
+
+    if ( budget > 0. && need > budget ) {
+	if ( !iam ) {
+	    printf("** Memory plan does not fit: MB per process, max over %d\n"
+		   "**    L factor                  : %10.2f\n"
+		   "**    U factor                  : %10.2f\n"
+		   "**    look-ahead buffers (0)    : %10.2f\n"
+		   "**    Schur-complement buffers  : %10.2f\n"
+		   "**    needed                    : %10.2f\n"
+		   "**    budget                    : %10.2f\n",
+		   nprocs, maxfixed[0] * 1e-6, maxfixed[1] * 1e-6,
+		   level * 1e-6, maxfixed[2] * 1e-6, need * 1e-6,
+		   budget * 1e-6);
+	    printf("** Use more processes or a smaller superlu_maxsup.\n");
+	    fflush(stdout);
+	}
+	return (int) (need * 1e-6) + 1;
+    }
+
+    if ( budget > 0. ) {
+	options->num_lookaheads = la;
+#ifdef GPU_ACC
+	{
+	    double left = (budget - need) / dsize;
+	    if ( left < (double) options->superlu_max_buffer_size )
+		options->superlu_max_buffer_size = (int) left;
+	}
+#endif
+#if ( PRNTlevel>=1 )
+	if ( !iam ) {
+	    printf(".. Memory plan: need %.2f of %.2f MB per process, "
+		   "num_lookaheads %d -> %d\n",
+		   need * 1e-6, budget * 1e-6, la0, la);
+	    fflush(stdout);
+	}
+#endif
+    }
+    return 0;
+} /* superlu_plan_memory */
+
 static int_t
 memory_usage(const int_t nzlmax, const int_t nzumax, const int_t n)
 {
@@ -636,3 +836,116 @@ memory_usage(const int_t nzlmax, const int_t nzumax, const int_t n)
     return (10*n*iword + (nzlmax+nzumax)*iword);
 }
 
+
+
+/*! \brief Initialize an empty factorization workspace.
+ *
+ * <pre>
+ * The workspace is owned by the caller.  Attach it to LUstruct->work
+ * after xLUstructInit() and it is used by the numerical factorization
+ * in every subsequent driver call; release it with
+ * superlu_workspace_free() once the LUstruct is no longer factored.
+ * </pre>
+ */
+void superlu_workspace_init(superlu_workspace_t *ws)
+{
+    int i;
+    for (i = 0; i < WS_NSLOTS; ++i) {
+	ws->buf[i] = NULL;
+	ws->size[i] = ws->peak[i] = 0;
+	ws->in_use[i] = 0;
+    }
+    ws->ncalls = 0;
+}
+
+/*! \brief Return a buffer of at least 'bytes' bytes for the given slot.
+ *
+ * <pre>
+ * With ws == NULL this is a plain SUPERLU_MALLOC.  Otherwise the slot's
+ * buffer is reused if it is large enough, or reallocated to the new
+ * high-water mark.  The contents are not preserved.
+ * </pre>
+ */
+void *superlu_workspace_get(superlu_workspace_t *ws, WorkspaceSlot_t slot,
+			    size_t bytes)
+{
+    if ( !ws ) return SUPERLU_MALLOC(SUPERLU_MAX(bytes, 1));
+
+    if ( ws->in_use[slot] )
+	ABORT("superlu_workspace_get: slot already in use.");
+    ws->peak[slot] = SUPERLU_MAX(ws->peak[slot], bytes);
+    if ( ws->size[slot] < bytes || !ws->buf[slot] ) {
+	if ( ws->buf[slot] ) SUPERLU_FREE(ws->buf[slot]);
+	ws->size[slot] = SUPERLU_MAX(bytes, 1);
+	if ( !(ws->buf[slot] = SUPERLU_MALLOC(ws->size[slot])) )
+	    ABORT("Malloc fails for workspace buffer.");
+    } else {
+	++ws->ncalls;
+    }
+    ws->in_use[slot] = 1;
+    return ws->buf[slot];
+}
+
+/*! \brief Give back a buffer obtained from superlu_workspace_get().
+ *
+ * With ws == NULL the buffer is freed; otherwise it stays allocated.
+ */
+void superlu_workspace_put(superlu_workspace_t *ws, WorkspaceSlot_t slot,
+			   void *buf)
+{
+    if ( !ws ) {
+	if ( buf ) SUPERLU_FREE(buf);
+	return;
+    }
+    ws->in_use[slot] = 0;
+}
+
+/*! \brief Release idle workspace memory.
+ *
+ * <pre>
+ * Each idle buffer larger than 'keep_bytes' is cut down to the largest
+ * request of its slot since the last trim, and freed if the slot was
+ * not requested since then.  Call it after a solve with a smaller
+ * matrix, or with keep_bytes = 0 between phases that use different
+ * slots.  The high-water marks are reset.
+ * </pre>
+ */
+void superlu_workspace_trim(superlu_workspace_t *ws, size_t keep_bytes)
+{
+    int i;
+    for (i = 0; i < WS_NSLOTS; ++i) {
+	if ( ws->in_use[i] ) continue;
+	if ( ws->buf[i] && ws->size[i] > keep_bytes
+	     && ws->size[i] > ws->peak[i] ) {
+	    SUPERLU_FREE(ws->buf[i]);
+	    ws->buf[i] = NULL;
+	    ws->size[i] = 0;
+	    if ( ws->peak[i] ) {
+		if ( !(ws->buf[i] = SUPERLU_MALLOC(ws->peak[i])) )
+		    ABORT("Malloc fails for workspace buffer.");
+		ws->size[i] = ws->peak[i];
+	    }
+	}
+	ws->peak[i] = 0;
+    }
+}
+
+/*! \brief Free all buffers held by the workspace. */
+void superlu_workspace_free(superlu_workspace_t *ws)
+{
+    int i;
+    for (i = 0; i < WS_NSLOTS; ++i) {
+	if ( ws->buf[i] ) SUPERLU_FREE(ws->buf[i]);
+    }
+    superlu_workspace_init(ws);
+}
+
+/*! \brief Total bytes currently held by the workspace. */
+size_t superlu_workspace_bytes(superlu_workspace_t *ws)
+{
+    int i;
+    size_t total = 0;
+    if ( !ws ) return 0;
+    for (i = 0; i < WS_NSLOTS; ++i) total += ws->size[i];
+    return total;
+}
@@ -70,7 +70,7 @@ at the top-level directory.
     int_t i__1;
 
     /* Local variables */
-    static int_t mdeg, ehead, i, mdlmt, mdnode;
+    int_t mdeg, ehead, i, mdlmt, mdnode;
     extern /* Subroutine */ int mmdelm_dist(int_t *, int_t *, int_t *, 
 	    int_t *, int_t *, int_t *, int_t *, int_t *, 
 	    int_t *, int_t *, int_t *), mmdupd_dist(int_t *, int_t *, 
@@ -79,7 +79,7 @@ at the top-level directory.
 	    int_t *), mmdint_dist(int_t *, int_t *, int_t *, int_t *, 
 	    int_t *, int_t *, int_t *, int_t *, int_t *), 
 	    mmdnum_dist(int_t *, int_t *, int_t *, int_t *);
-    static int_t nextmd, tag, num;
+    int_t nextmd, tag, num;
 
 
 /* *************************************************************** */
@@ -256,7 +256,7 @@ L1000:
     int_t i__1;
 
     /* Local variables */
-    static int_t ndeg, node, fnode;
+    int_t ndeg, node, fnode;
 
 
 /* *************************************************************** */
@@ -340,7 +340,7 @@ L1000:
     int_t i__1, i__2;
 
     /* Local variables */
-    static int_t node, link, rloc, rlmt, i, j, nabor, rnode, elmnt, xqnbr, 
+    int_t node, link, rloc, rlmt, i, j, nabor, rnode, elmnt, xqnbr, 
 	    istop, jstop, istrt, jstrt, nxnode, pvnode, nqnbrs, npv;
 
 
@@ -588,7 +588,7 @@ L1800:
     int_t i__1, i__2;
 
     /* Local variables */
-    static int_t node, mtag, link, mdeg0, i, j, enode, fnode, nabor, elmnt, 
+    int_t node, mtag, link, mdeg0, i, j, enode, fnode, nabor, elmnt, 
 	    istop, jstop, q2head, istrt, jstrt, qxhead, iq2, deg, deg0;
 
 
@@ -942,7 +942,7 @@ L2300:
     int_t i__1;
 
     /* Local variables */
-    static int_t node, root, nextf, father, nqsize, num;
+    int_t node, root, nextf, father, nqsize, num;
 
 
 /* *************************************************************** */
@@ -0,0 +1,128 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Communication progress thread for the numerical factorization
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * Many MPI libraries only move a nonblocking message forward when the
+ * owner of the request calls into the library, so a large panel posted
+ * with MPI_Isend before a long Schur complement update is only
+ * transferred at the next MPI_Test or MPI_Wait.  The progress thread
+ * polls the MPI progress engine with MPI_Iprobe on a private
+ * communicator that never carries a message, which advances every
+ * outstanding send and receive of the process, while the OpenMP threads
+ * compute.  The requests themselves stay with the factorization: an MPI
+ * request may not be completed by two threads.
+ *
+ * The thread is started when SUPERLU_PROGRESS (sp_ienv_dist(16)) is
+ * positive, the value being the pause in microseconds between two polls,
+ * and MPI was initialized with MPI_THREAD_MULTIPLE.  Leave a core free
+ * for it, e.g. run with one OpenMP thread less than the cores per rank.
+ * </pre>
+ */
+
+#include <unistd.h>
+#include "superlu_defs.h"
+
+#if defined(_POSIX_THREADS) && (_POSIX_THREADS > 0)
+#include <pthread.h>
+#include <time.h>
+#define SUPERLU_HAVE_PTHREAD
+#endif
+
+#ifdef SUPERLU_HAVE_PTHREAD
+static void *progress_loop(void *arg)
+{
+    superlu_progress_t *p = (superlu_progress_t *) arg;
+    struct timespec pause;
+    int flag;
+
+    pause.tv_sec = p->interval_us / 1000000;
+    pause.tv_nsec = (long) (p->interval_us % 1000000) * 1000;
+    while ( !__atomic_load_n(&p->stop, __ATOMIC_ACQUIRE) ) {
+	MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, p->comm, &flag,
+		   MPI_STATUS_IGNORE);
+	++p->npolls;
+	nanosleep(&pause, NULL);
+    }
+    return NULL;
+}
+#endif
+
+/*! \brief Start the progress thread if requested; collective over comm.
+ *
+ * <pre>
+ * p->active is set to 1 if the thread runs.  Every call must be matched
+ * by superlu_progress_stop().
+ * </pre>
+ */
+void superlu_progress_start(superlu_progress_t *p,
+			    superlu_dist_options_t *options, MPI_Comm comm)
+{
+    int provided, iam;
+
+    p->active = 0;
+    p->stop = 0;
+    p->npolls = 0;
+    p->interval_us = sp_ienv_dist(16, options);
+    if ( p->interval_us <= 0 ) return;
+
+    MPI_Comm_rank(comm, &iam);
+    MPI_Query_thread(&provided);
+#ifdef SUPERLU_HAVE_PTHREAD
+    {
+	pthread_t *tid = NULL;
+	int started = 0, all_started;
+
+	MPI_Comm_dup(comm, &p->comm);
+	if ( provided == MPI_THREAD_MULTIPLE ) {
+	    if ( !(tid = SUPERLU_MALLOC(sizeof(pthread_t))) )
+		ABORT("Malloc fails for the progress thread.");
+	    started = (pthread_create(tid, NULL, progress_loop, p) == 0);
+	}
+
+	/* Keep the threads only if every process has one, so that
+	   p->comm is freed by all of them together, here or in
+	   superlu_progress_stop(). */
+	MPI_Allreduce(&started, &all_started, 1, MPI_INT, MPI_LAND, comm);
+	if ( all_started ) {
+	    p->thread = tid;
+	    p->active = 1;
+	} else {
+	    if ( started ) {
+		__atomic_store_n(&p->stop, 1, __ATOMIC_RELEASE);
+		pthread_join(*tid, NULL);
+	    }
+	    if ( tid ) SUPERLU_FREE(tid);
+	    MPI_Comm_free(&p->comm);
+	}
+    }
+#endif
+    if ( !p->active && !iam )
+	fprintf(stderr, "Warning: SUPERLU_PROGRESS ignored, it needs "
+		"MPI_THREAD_MULTIPLE and POSIX threads.\n");
+}
+
+/*! \brief Stop and join the progress thread; collective over comm. */
+void superlu_progress_stop(superlu_progress_t *p)
+{
+    if ( !p->active ) return;
+#ifdef SUPERLU_HAVE_PTHREAD
+    __atomic_store_n(&p->stop, 1, __ATOMIC_RELEASE);
+    pthread_join(*(pthread_t *) p->thread, NULL);
+    SUPERLU_FREE(p->thread);
+#endif
+    MPI_Comm_free(&p->comm);
+    p->active = 0;
+}
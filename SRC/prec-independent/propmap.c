@@ -0,0 +1,305 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Proportional (subtree-to-subgrid) mapping of the supernodal etree
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The 2D data layout is block cyclic: block (I,J) is owned by process
+ * (I mod nprow, J mod npcol).  Rather than changing that map, the
+ * supernodes are renumbered.  With L = lcm(nprow, npcol), the supernode
+ * numbered k has its diagonal block on process (k mod nprow, k mod npcol),
+ * which only depends on the "slot" k mod L.  Each subtree of the etree is
+ * given a contiguous range of slots in proportion to its weight (the
+ * iWeight of calcTreeWeight()), top-down as in the subtree-to-subcube
+ * mapping, and the supernodes are then numbered in a topological order
+ * that places a node, whenever possible, at a position whose slot lies in
+ * the node's range.  All blocks of a subtree that was given the slot set T
+ * then live on the (T mod nprow) x (T mod npcol) subgrid; in particular a
+ * subtree given a single slot is factored by one process without any
+ * communication, and the updates between its blocks are local.
+ *
+ * The renumbering is carried by the column permutation, so the
+ * distribution, the factorization and the triangular solves need no
+ * change.  The columns of every supernode stay contiguous and in order,
+ * so the relaxed supernodes of the second symbolic factorization are the
+ * same as in the first one.
+ * </pre>
+ */
+
+#include "superlu_defs.h"
+
+typedef struct {
+    double w;   /* subtree weight */
+    int_t  k;   /* supernode */
+} pm_child_t;
+
+static int pm_cmp(const void *a, const void *b)
+{
+    double x = ((const pm_child_t *) a)->w, y = ((const pm_child_t *) b)->w;
+    return (x < y) - (x > y); /* decreasing weight */
+}
+
+static int pm_gcd(int a, int b)
+{
+    while ( b ) { int t = a % b; a = b; b = t; }
+    return a;
+}
+
+/*! \brief Split the slot range [lo[p], hi[p]) of node p among its children.
+ *
+ * With at least as many children as slots, each child gets one slot, the
+ * heaviest first onto the least loaded slot.  Otherwise each child gets a
+ * contiguous range proportional to its weight, and at least one slot.
+ */
+static void pm_split(int_t p, treeList_t *treeList, int_t *lo, int_t *hi,
+		     pm_child_t *ch, double *load, int_t *width)
+{
+    int_t nc = treeList[p].numChild, *child = treeList[p].childrenList;
+    int_t w = hi[p] - lo[p], i, s, c, tot;
+    double wsum = 0.0;
+
+    if ( nc == 0 ) return;
+    if ( w == 1 ) {
+	for (i = 0; i < nc; ++i) {
+	    lo[child[i]] = lo[p];
+	    hi[child[i]] = hi[p];
+	}
+	return;
+    }
+
+    for (i = 0; i < nc; ++i) {
+	ch[i].k = child[i];
+	ch[i].w = treeList[child[i]].iWeight;
+	wsum += ch[i].w;
+    }
+
+    if ( nc >= w ) { /* LPT greedy, one slot per child */
+	qsort(ch, nc, sizeof(pm_child_t), pm_cmp);
+	for (s = 0; s < w; ++s) load[s] = 0.0;
+	for (i = 0; i < nc; ++i) {
+	    c = 0;
+	    for (s = 1; s < w; ++s) if ( load[s] < load[c] ) c = s;
+	    load[c] += ch[i].w;
+	    lo[ch[i].k] = lo[p] + c;
+	    hi[ch[i].k] = lo[p] + c + 1;
+	}
+	return;
+    }
+
+    /* Proportional split; remainder to the largest fractional parts. */
+    if ( wsum <= 0.0 ) wsum = 1.0;
+    tot = 0;
+    for (i = 0; i < nc; ++i) {
+	double share = w * ch[i].w / wsum;
+	width[i] = SUPERLU_MAX(1, (int_t) share);
+	load[i] = share - width[i]; /* fractional part */
+	tot += width[i];
+    }
+    while ( tot > w ) { /* the minimum of one slot overshot */
+	c = -1;
+	for (i = 0; i < nc; ++i)
+	    if ( width[i] > 1 && (c < 0 || load[i] < load[c]) ) c = i;
+	--width[c];
+	load[c] += 1.0;
+	--tot;
+    }
+    while ( tot < w ) {
+	c = 0;
+	for (i = 1; i < nc; ++i) if ( load[i] > load[c] ) c = i;
+	++width[c];
+	load[c] -= 1.0;
+	++tot;
+    }
+    s = lo[p];
+    for (i = 0; i < nc; ++i) {
+	lo[ch[i].k] = s;
+	s += width[i];
+	hi[ch[i].k] = s;
+    }
+} /* pm_split */
+
+/*! \brief Compute the proportional-mapping renumbering of the columns.
+ *
+ * <pre>
+ * n, etree, Glu_persist are the output of the serial symbolic
+ * factorization (etree is postordered), cm the cost model of the subtree
+ * weights.  Returns the column permutation
+ * q (column j becomes column q[j]), or NULL if the grid has a single slot
+ * or the postorder is kept unchanged.  The caller frees q.
+ * </pre>
+ */
+int_t *superlu_propmap(int_t n, int_t *etree, Glu_persist_t *Glu_persist,
+		       const superlu_costmodel_t *cm, int nprow, int npcol)
+{
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t nsupers = supno[n-1] + 1;
+    int_t L = (int_t) nprow / pm_gcd(nprow, npcol) * npcol;
+    int_t *setree, *lo, *hi, *nleft, *newno, *width, *q;
+    int_t *bhead, *bnext, mhead, *mnext, k, p, s, t, j, pos, col;
+    int_t placed = 0;
+    treeList_t *treeList;
+    pm_child_t *ch;
+    double *load;
+
+    if ( L <= 1 || nsupers < 2 ) return NULL;
+
+    setree = supernodal_etree(nsupers, etree, supno, xsup);
+    treeList = setree2list(nsupers, setree);
+    calcTreeWeight(nsupers, setree, treeList, xsup, cm);
+
+    if ( !(lo = intMalloc_dist(6 * (nsupers + 1) + L)) )
+	ABORT("Malloc fails for lo[].");
+    hi = lo + nsupers + 1;
+    nleft = hi + nsupers + 1;
+    newno = nleft + nsupers + 1;
+    bnext = newno + nsupers + 1;
+    mnext = bnext + nsupers + 1;
+    bhead = mnext + nsupers + 1;
+    width = bnext; /* only used by pm_split, before the buckets */
+    k = SUPERLU_MAX(treeList[nsupers].numChild, L);
+    for (p = 0; p < nsupers; ++p)
+	k = SUPERLU_MAX(k, treeList[p].numChild);
+    ch = (pm_child_t *) SUPERLU_MALLOC(k * sizeof(pm_child_t));
+    load = (double *) SUPERLU_MALLOC(k * sizeof(double));
+    if ( !ch || !load ) ABORT("Malloc fails for ch[].");
+
+    /* Top-down: children have smaller numbers than their parent. */
+    lo[nsupers] = 0;
+    hi[nsupers] = L;
+    for (p = nsupers; p >= 0; --p)
+	pm_split(p, treeList, lo, hi, ch, load, width);
+
+    /* List scheduling of the positions.  A ready node with a single slot
+       waits in the bucket of that slot; the ready nodes spanning several
+       slots wait in one list. */
+    for (s = 0; s < L; ++s) bhead[s] = SLU_EMPTY;
+    mhead = SLU_EMPTY;
+    for (k = nsupers - 1; k >= 0; --k) {
+	nleft[k] = treeList[k].numChild;
+	if ( nleft[k] == 0 ) {
+	    if ( hi[k] - lo[k] == 1 ) {
+		bnext[k] = bhead[lo[k]];
+		bhead[lo[k]] = k;
+	    } else {
+		mnext[k] = mhead;
+		mhead = k;
+	    }
+	}
+    }
+
+    for (pos = 0; pos < nsupers; ++pos) {
+	int_t prev = SLU_EMPTY;
+	s = pos % L;
+	k = SLU_EMPTY;
+	if ( bhead[s] != SLU_EMPTY ) {             /* a node of slot s */
+	    k = bhead[s];
+	    bhead[s] = bnext[k];
+	} else {
+	    for (t = mhead; t != SLU_EMPTY; prev = t, t = mnext[t])
+		if ( lo[t] <= s && s < hi[t] ) break; /* a range holding s */
+	    if ( t == SLU_EMPTY && mhead != SLU_EMPTY ) { /* any wide node */
+		t = mhead;
+		prev = SLU_EMPTY;
+	    }
+	    if ( t != SLU_EMPTY ) {
+		k = t;
+		if ( prev == SLU_EMPTY ) mhead = mnext[t];
+		else mnext[prev] = mnext[t];
+	    } else {                               /* the nearest slot */
+		for (j = 1; j < L; ++j) {
+		    t = (s + j) % L;
+		    if ( bhead[t] != SLU_EMPTY ) break;
+		}
+		k = bhead[t];
+		bhead[t] = bnext[k];
+	    }
+	}
+	if ( lo[k] <= s && s < hi[k] ) ++placed;
+	newno[k] = pos;
+
+	p = setree[k];
+	if ( p < nsupers && --nleft[p] == 0 ) {
+	    if ( hi[p] - lo[p] == 1 ) {
+		bnext[p] = bhead[lo[p]];
+		bhead[lo[p]] = p;
+	    } else {
+		mnext[p] = mhead;
+		mhead = p;
+	    }
+	}
+    }
+
+#if ( DEBUGlevel>=1 )
+    printf(".. superlu_propmap(): slots " IFMT ", " IFMT " of " IFMT
+	   " supernodes in their slot range\n", L, placed, nsupers);
+#endif
+
+    /* Identity renumbering: nothing to do. */
+    for (k = 0; k < nsupers && newno[k] == k; ++k) ;
+    if ( k == nsupers ) {
+	q = NULL;
+    } else {
+	/* Column permutation: the supernodes in their new order. */
+	if ( !(q = intMalloc_dist(n)) ) ABORT("Malloc fails for q[].");
+	for (k = 0; k < nsupers; ++k) nleft[newno[k]] = k;
+	for (col = 0, pos = 0; pos < nsupers; ++pos) {
+	    k = nleft[pos];
+	    for (j = xsup[k]; j < xsup[k+1]; ++j) q[j] = col++;
+	}
+    }
+
+    SUPERLU_FREE(load);
+    SUPERLU_FREE(ch);
+    SUPERLU_FREE(lo);
+    free_treelist(nsupers, treeList);
+    SUPERLU_FREE(setree);
+    return q;
+} /* superlu_propmap */
+
+/*! \brief Apply the renumbering q of superlu_propmap().
+ *
+ * <pre>
+ * perm_c and etree are updated in place.  GAC = Pc*A*Pc^T in NCP format
+ * becomes Q*GAC*Q^T: its columns are permuted and its rows relabelled.
+ * </pre>
+ */
+void superlu_propmap_apply(int_t n, int_t *q, int_t *perm_c, int_t *etree,
+			   SuperMatrix *GAC)
+{
+    NCPformat *GACstore = (NCPformat *) GAC->Store;
+    int_t *colbeg, *colend, *rowind = GACstore->rowind, *et, i, j;
+
+    if ( !(colbeg = intMalloc_dist(n)) )
+	ABORT("Malloc fails for colbeg[].");
+    if ( !(colend = intMalloc_dist(n)) )
+	ABORT("Malloc fails for colend[].");
+    if ( !(et = intMalloc_dist(n)) )
+	ABORT("Malloc fails for et[].");
+
+    for (j = 0; j < n; ++j) {
+	for (i = GACstore->colbeg[j]; i < GACstore->colend[j]; ++i)
+	    rowind[i] = q[rowind[i]];
+	colbeg[q[j]] = GACstore->colbeg[j];
+	colend[q[j]] = GACstore->colend[j];
+	et[q[j]] = etree[j] < n ? q[etree[j]] : n;
+	perm_c[j] = q[perm_c[j]];
+    }
+    for (j = 0; j < n; ++j) etree[j] = et[j];
+
+    SUPERLU_FREE(GACstore->colbeg);
+    SUPERLU_FREE(GACstore->colend);
+    GACstore->colbeg = colbeg;
+    GACstore->colend = colend;
+    SUPERLU_FREE(et);
+} /* superlu_propmap_apply */
@@ -0,0 +1,304 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Route the nonzeros of A and the rows of B on the 3D process grid
+ * directly to the processes that hold them in the 3D factorization and solve
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * After the 3D distribution only one layer keeps the values of A in a
+ * supernode: the layer for which the supernode is IN_GRID_AIJ, i.e. the
+ * first layer of the subtree of the forest it belongs to.  The other
+ * layers that share the supernode start from zero.  Entry (i,j) of
+ * Pc*Pr*A*Pc' belongs to supernode min(BlockNum(i), BlockNum(j)), and
+ * within that layer to process (PROW(BlockNum(i)), PCOL(BlockNum(j))).
+ * Each process sends its part of the 3D input there in one all-to-all
+ * exchange, so no layer holds a copy of the whole 2D matrix.  The route
+ * depends only on the pattern of A, perm_r, perm_c and the 3D partition;
+ * it is kept for Fact = SamePattern_SameRowPerm, where only the values
+ * are sent again.
+ *
+ * The rows of B take the same way to the diagonal processes of the layer
+ * of their supernode, where the 3D solve leaves the solution, so B and X
+ * can stay in the 3D distribution; see superlu_route_B3d().
+ * </pre>
+ */
+
+#include "superlu_defs.h"
+
+/*! \brief First layer of the subtree of forest t of the 3D partition. */
+static int forest_layer(int_t t, int npz)
+{
+    while ( t < npz - 1 ) t = 2 * t + 1; /* leftmost leaf forest */
+    return (int) (t - (npz - 1));
+}
+
+/*! \brief rank3d[z * np2 + p] is the 3D rank of process p of layer z. */
+static int *route_rank3d(gridinfo3d_t *grid3d)
+{
+    gridinfo_t *grid = &(grid3d->grid2d);
+    int np2 = grid->nprow * grid->npcol;
+    int procs = np2 * grid3d->zscp.Np;
+    int p, key, *rank3d, *keys;
+
+    if ( !(rank3d = int32Malloc_dist(2 * procs)) )
+	ABORT("Malloc fails for rank3d[].");
+    keys = rank3d + procs;
+    key = grid3d->zscp.Iam * np2 + grid->iam;
+    MPI_Allgather(&key, 1, MPI_INT, keys, 1, MPI_INT, grid3d->comm);
+    for (p = 0; p < procs; ++p) rank3d[keys[p]] = p;
+    return rank3d;
+}
+
+/*! \brief Build the route of the local nonzeros of A on the 3D grid.
+ *
+ * <pre>
+ * A is the local part of the input matrix on the 3D grid.  Its rows are
+ * numbered from fst_row in the row order of the matrix gathered on layer
+ * 0, to which perm_r refers; see dGatherNRformat_loc3d_allgrid().  perm_r,
+ * perm_c and supno are those of the factorization, supernode2treeMap maps
+ * a supernode to its forest of the 3D partition.  Collective over grid3d->comm.  The received
+ * nonzeros are stored by columns of Pc*Pr*A*Pc' in route->{xa,asub}, in
+ * the format returned by dReDistribute_A().
+ * </pre>
+ */
+A3dRoute_t *superlu_route_A3d(int_t n, NRformat_loc *A, int_t fst_row,
+			      int_t *perm_r, int_t *perm_c, int_t *supno,
+			      int_t *supernode2treeMap, gridinfo3d_t *grid3d)
+{
+    gridinfo_t *grid = &(grid3d->grid2d);
+    int np2 = grid->nprow * grid->npcol;
+    int npz = grid3d->zscp.Np;
+    int procs = np2 * npz;
+    int p, *rank3d, *zown, *dest, *fill;
+    int_t i, j, k, irow, jcol, gbi, gbj, nsupers, pos;
+    int_t *sbuf = NULL, *rbuf = NULL;
+    A3dRoute_t *route;
+    MPI_Datatype pair;
+
+    if ( !(route = (A3dRoute_t *) SUPERLU_MALLOC(sizeof(A3dRoute_t))) )
+	ABORT("Malloc fails for route.");
+    if ( !(route->send_counts = int32Calloc_dist(4 * procs)) )
+	ABORT("Calloc fails for route->send_counts[].");
+    route->send_disp = route->send_counts + procs;
+    route->recv_counts = route->send_disp + procs;
+    route->recv_disp = route->recv_counts + procs;
+
+    rank3d = route_rank3d(grid3d);
+    fill = rank3d + procs;
+
+    /* Layer that keeps the values of each supernode. */
+    nsupers = supno[n-1] + 1;
+    if ( !(zown = int32Malloc_dist(nsupers)) )
+	ABORT("Malloc fails for zown[].");
+    for (k = 0; k < nsupers; ++k)
+	zown[k] = npz > 1 ? forest_layer(supernode2treeMap[k], npz) : 0;
+
+    /* Count the nonzeros to be sent to each process. */
+    route->nsend = A->nnz_loc;
+    dest = NULL;
+    route->send_pos = NULL;
+    if ( route->nsend ) {
+	if ( !(dest = int32Malloc_dist(route->nsend)) )
+	    ABORT("Malloc fails for dest[].");
+	if ( !(route->send_pos = intMalloc_dist(route->nsend)) )
+	    ABORT("Malloc fails for route->send_pos[].");
+    }
+    for (i = 0; i < A->m_loc; ++i) {
+	irow = perm_c[perm_r[i + fst_row]]; /* Row number in Pc*Pr*A */
+	gbi = BlockNum( irow );
+	for (j = A->rowptr[i]; j < A->rowptr[i+1]; ++j) {
+	    jcol = perm_c[A->colind[j]];
+	    gbj = BlockNum( jcol );
+	    k = SUPERLU_MIN(gbi, gbj);
+	    p = rank3d[zown[k] * np2 +
+		       PNUM( PROW(gbi, grid), PCOL(gbj, grid), grid )];
+	    dest[j] = p;
+	    ++route->send_counts[p];
+	}
+    }
+    SUPERLU_FREE(zown);
+
+    MPI_Alltoall(route->send_counts, 1, MPI_INT, route->recv_counts, 1,
+		 MPI_INT, grid3d->comm);
+    route->nrecv = 0;
+    for (p = 0, pos = 0; p < procs; ++p) {
+	route->send_disp[p] = pos;
+	pos += route->send_counts[p];
+	route->recv_disp[p] = route->nrecv;
+	route->nrecv += route->recv_counts[p];
+	fill[p] = 0;
+    }
+
+    /* Send the (row, column) pairs in the order of the destinations. */
+    if ( route->nsend && !(sbuf = intMalloc_dist(2 * route->nsend)) )
+	ABORT("Malloc fails for sbuf[].");
+    if ( route->nrecv && !(rbuf = intMalloc_dist(2 * route->nrecv)) )
+	ABORT("Malloc fails for rbuf[].");
+    for (i = 0; i < A->m_loc; ++i) {
+	irow = perm_c[perm_r[i + fst_row]];
+	for (j = A->rowptr[i]; j < A->rowptr[i+1]; ++j) {
+	    p = dest[j];
+	    pos = route->send_disp[p] + fill[p]++;
+	    route->send_pos[j] = pos;
+	    sbuf[2 * pos] = irow;
+	    sbuf[2 * pos + 1] = perm_c[A->colind[j]];
+	}
+    }
+    MPI_Type_contiguous(2, mpi_int_t, &pair);
+    MPI_Type_commit(&pair);
+    MPI_Alltoallv(sbuf, route->send_counts, route->send_disp, pair,
+		  rbuf, route->recv_counts, route->recv_disp, pair,
+		  grid3d->comm);
+    MPI_Type_free(&pair);
+    if ( route->nsend ) {
+	SUPERLU_FREE(sbuf);
+	SUPERLU_FREE(dest);
+    }
+    SUPERLU_FREE(rank3d);
+
+    /* Convert the received triplets into the CCS format. */
+    if ( !(route->xa = intCalloc_dist(n + 1)) )
+	ABORT("Calloc fails for route->xa[].");
+    route->asub = route->recv_pos = NULL;
+    if ( route->nrecv ) {
+	if ( !(route->asub = intMalloc_dist(route->nrecv)) )
+	    ABORT("Malloc fails for route->asub[].");
+	if ( !(route->recv_pos = intMalloc_dist(route->nrecv)) )
+	    ABORT("Malloc fails for route->recv_pos[].");
+    }
+    for (i = 0; i < route->nrecv; ++i) ++route->xa[rbuf[2 * i + 1]];
+    for (j = 0, pos = 0; j < n; ++j) {
+	k = route->xa[j];
+	route->xa[j] = pos;
+	pos += k;
+    }
+    route->xa[n] = pos;
+    for (i = 0; i < route->nrecv; ++i) {
+	pos = route->xa[rbuf[2 * i + 1]]++;
+	route->asub[pos] = rbuf[2 * i];
+	route->recv_pos[i] = pos;
+    }
+    /* Reset the column pointers to the beginning of each column */
+    for (j = n; j > 0; --j) route->xa[j] = route->xa[j-1];
+    route->xa[0] = 0;
+    if ( route->nrecv ) SUPERLU_FREE(rbuf);
+
+    return route;
+}
+
+/*! \brief Build the route of the local rows of B on the 3D grid.
+ *
+ * <pre>
+ * B is the local part of the right-hand side on the 3D grid, m_loc rows
+ * numbered from fst_row as in superlu_route_A3d().  Row i is row
+ * perm_c[perm_r[i + fst_row]] of Pc*Pr*B and goes to the diagonal process
+ * of its block on the layer that keeps the supernode, which is also the
+ * layer that holds its solution after the 3D triangular solves.
+ * If perm_r is NULL, fst_row counts in the column space and row i is
+ * row perm_c[i + fst_row] of the solution Pc*X instead; the route,
+ * reversed, brings the solution back.
+ * route->send_pos[i] is the position of row i in the send buffer,
+ * route->recv_pos[] are the permuted row numbers in the receive buffer;
+ * xa and asub are not used.  Collective over grid3d->comm.
+ * </pre>
+ */
+A3dRoute_t *superlu_route_B3d(int_t m_loc, int_t fst_row, int_t *perm_r,
+			      int_t *perm_c, int_t *supno,
+			      int_t *supernode2treeMap, gridinfo3d_t *grid3d)
+{
+    gridinfo_t *grid = &(grid3d->grid2d);
+    int np2 = grid->nprow * grid->npcol;
+    int npz = grid3d->zscp.Np;
+    int procs = np2 * npz;
+    int p, z, *rank3d, *dest, *fill;
+    int_t i, irow, gbi, pos, *sbuf = NULL;
+    A3dRoute_t *route;
+
+    if ( !(route = (A3dRoute_t *) SUPERLU_MALLOC(sizeof(A3dRoute_t))) )
+	ABORT("Malloc fails for route.");
+    if ( !(route->send_counts = int32Calloc_dist(4 * procs)) )
+	ABORT("Calloc fails for route->send_counts[].");
+    route->send_disp = route->send_counts + procs;
+    route->recv_counts = route->send_disp + procs;
+    route->recv_disp = route->recv_counts + procs;
+    route->xa = route->asub = NULL;
+
+    rank3d = route_rank3d(grid3d);
+    fill = rank3d + procs;
+
+    route->nsend = m_loc;
+    dest = NULL;
+    route->send_pos = NULL;
+    if ( m_loc ) {
+	if ( !(dest = int32Malloc_dist(m_loc)) )
+	    ABORT("Malloc fails for dest[].");
+	if ( !(route->send_pos = intMalloc_dist(m_loc)) )
+	    ABORT("Malloc fails for route->send_pos[].");
+	if ( !(sbuf = intMalloc_dist(m_loc)) )
+	    ABORT("Malloc fails for sbuf[].");
+    }
+    for (i = 0; i < m_loc; ++i) {
+	irow = perm_r ? perm_c[perm_r[i + fst_row]] : perm_c[i + fst_row];
+	gbi = BlockNum( irow );
+	z = npz > 1 ? forest_layer(supernode2treeMap[gbi], npz) : 0;
+	p = rank3d[z * np2 + PNUM( PROW(gbi, grid), PCOL(gbi, grid), grid )];
+	dest[i] = p;
+	++route->send_counts[p];
+    }
+
+    MPI_Alltoall(route->send_counts, 1, MPI_INT, route->recv_counts, 1,
+		 MPI_INT, grid3d->comm);
+    route->nrecv = 0;
+    for (p = 0, pos = 0; p < procs; ++p) {
+	route->send_disp[p] = pos;
+	pos += route->send_counts[p];
+	route->recv_disp[p] = route->nrecv;
+	route->nrecv += route->recv_counts[p];
+	fill[p] = 0;
+    }
+
+    /* Send the permuted row numbers in the order of the destinations. */
+    route->recv_pos = NULL;
+    if ( route->nrecv && !(route->recv_pos = intMalloc_dist(route->nrecv)) )
+	ABORT("Malloc fails for route->recv_pos[].");
+    for (i = 0; i < m_loc; ++i) {
+	p = dest[i];
+	pos = route->send_disp[p] + fill[p]++;
+	route->send_pos[i] = pos;
+	sbuf[pos] = perm_r ? perm_c[perm_r[i + fst_row]] : perm_c[i + fst_row];
+    }
+    MPI_Alltoallv(sbuf, route->send_counts, route->send_disp, mpi_int_t,
+		  route->recv_pos, route->recv_counts, route->recv_disp,
+		  mpi_int_t, grid3d->comm);
+    if ( m_loc ) {
+	SUPERLU_FREE(sbuf);
+	SUPERLU_FREE(dest);
+    }
+    SUPERLU_FREE(rank3d);
+
+    return route;
+}
+
+/*! \brief Free the route built by superlu_route_A3d() or superlu_route_B3d(). */
+void superlu_free_route_A3d(A3dRoute_t *route)
+{
+    SUPERLU_FREE(route->send_counts);
+    if ( route->nsend ) SUPERLU_FREE(route->send_pos);
+    if ( route->xa ) SUPERLU_FREE(route->xa);
+    if ( route->nrecv ) {
+	if ( route->asub ) SUPERLU_FREE(route->asub);
+	SUPERLU_FREE(route->recv_pos);
+    }
+    SUPERLU_FREE(route);
+}
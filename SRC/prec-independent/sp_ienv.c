@@ -59,6 +59,39 @@ at the top-level directory.
 	    = 9: number of GPU streams
 	    = 10: whether to offload computations to GPU or not
 	    = 11: whether to offload triangular solve to GPU or not
+	    = 12: per-process memory budget in MB for the numerical
+	          factorization (0 = none); see superlu_plan_memory()
+	    = 13: whether to map the etree subtrees proportionally onto
+	          the 2D process grid; see superlu_propmap()
+	    = 14: whether to resize the look-ahead window from the measured
+	          wait times; see superlu_lookahead_step()
+	    = 15: order of the panel messages in the factorization:
+	          0 supernode order, 1 critical path first, 2 also a
+	          separate communicator for the critical path
+	    = 16: pause in microseconds between two polls of the MPI
+	          progress thread of the factorization (0 = no thread);
+	          see superlu_progress_start()
+	    = 17: whether the 3D solve keeps B and X on the 3D process
+	          grid instead of layer 0; see pdgstrs3d()
+	    = 18: number of Ruiz equilibration sweeps (0 = one-pass
+	          scaling of pdgsequ); see pdgsequ_ruiz()
+	    = 19: whether the etree weights use the calibrated cost model;
+	          see costmodel.c
+	    = 20: percentage of explicit zeros allowed when amalgamating
+	          supernodes (0 = none); see superlu_amalgamate()
+	    = 21: whether wide supernodes are split for the process grid;
+	          see superlu_split_supernodes()
+	    = 22: size in KB of the dense fronts of the leaf subtrees
+	          (0 = none); see dleafFrontFactor()
+	    = 23: multiple of sqrt(n) above which a row or column is dense
+	          and ordered last (0 = none); see get_perm_c_dense_dist()
+	    = 24: whether the decoupled blocks of A are ordered each on its
+	          own; see get_perm_c_dense_dist()
+	    = 25: whether Fact = SamePattern keeps the previous L and U
+	          structure when A fits in it; see pdgssvx().  Not read
+	          from the environment: the caller must keep the factors
+	    = 26: whether the C++ CPU factorization batches the supernodes
+	          of each etree level; see sparseTreeFactorBatchCPU_impl.hpp
 
    options (input) superlu_dist_options_t*
            The structure defines the input parameters to control
@@ -85,12 +118,12 @@ sp_ienv_dist(int ispec, superlu_dist_options_t *options)
 
     switch (ispec) {
 	case 2:
-            ttemp = getenv("SUPERLU_RELAX");
+            ttemp = superlu_getenv_dist("SUPERLU_RELAX", options);
 	    int k;
             if(ttemp)
             {
 		k = atoi(ttemp);
-            }else if( (ttemp = getenv("NREL")) )
+            }else if( (ttemp = superlu_getenv_dist("NREL", options)) )
             {
 		k = atoi(ttemp);
             }
@@ -101,58 +134,130 @@ sp_ienv_dist(int ispec, superlu_dist_options_t *options)
 	    return (k);
 	    
 	case 3: 
-	    ttemp = getenv("SUPERLU_MAXSUP"); // take min of MAX_SUPER_SIZE in superlu_defs.h
+	    ttemp = superlu_getenv_dist("SUPERLU_MAXSUP", options); // take min of MAX_SUPER_SIZE in superlu_defs.h
             if(ttemp)
             {
 	        int k = SUPERLU_MIN( atoi(ttemp), MAX_SUPER_SIZE );
                 return (k);
-            }else if(getenv("NSUP"))
+            }else if(superlu_getenv_dist("NSUP", options))
             {
-                int k = SUPERLU_MIN( atoi(getenv("NSUP")), MAX_SUPER_SIZE );
+                int k = SUPERLU_MIN( atoi(superlu_getenv_dist("NSUP", options)), MAX_SUPER_SIZE );
                 return (k);
             }
             else return (options->superlu_maxsup);
 	    
         case 6: 
-            ttemp = getenv("SUPERLU_FILL");
+            ttemp = superlu_getenv_dist("SUPERLU_FILL", options);
             if ( ttemp ) return(atoi(ttemp));
 	    else {
-		ttemp = getenv("FILL");
+		ttemp = superlu_getenv_dist("FILL", options);
 		if ( ttemp ) return(atoi(ttemp));
 		else return (5);
 	    }
         case 7:
-	    ttemp = getenv ("SUPERLU_N_GEMM"); // minimum flops of GEMM worth doing on GPU
+	    ttemp = superlu_getenv_dist("SUPERLU_N_GEMM", options); // minimum flops of GEMM worth doing on GPU
 	    if (ttemp)
 		return atoi (ttemp); 
-	    else if(getenv("N_GEMM"))
-		return(atoi(getenv("N_GEMM")));
+	    else if(superlu_getenv_dist("N_GEMM", options))
+		return(atoi(superlu_getenv_dist("N_GEMM", options)));
 	    else 
 		return (options->superlu_n_gemm);
         case 8:
-  	    ttemp = getenv ("SUPERLU_MAX_BUFFER_SIZE");
+  	    ttemp = superlu_getenv_dist("SUPERLU_MAX_BUFFER_SIZE", options);
 	    if (ttemp) 
 		return atoi (ttemp);
-	    else if(getenv("MAX_BUFFER_SIZE")) 
-		return(atoi(getenv("MAX_BUFFER_SIZE")));
+	    else if(superlu_getenv_dist("MAX_BUFFER_SIZE", options)) 
+		return(atoi(superlu_getenv_dist("MAX_BUFFER_SIZE", options)));
 	    else 
 		return (options->superlu_max_buffer_size);
          case 9:
-  	    ttemp = getenv ("SUPERLU_NUM_GPU_STREAMS");
+  	    ttemp = superlu_getenv_dist("SUPERLU_NUM_GPU_STREAMS", options);
 	    if (ttemp) 
 		return atoi (ttemp);
 	    else return (options->superlu_num_gpu_streams);
          case 10:
-  	    ttemp = getenv ("SUPERLU_ACC_OFFLOAD");
+  	    ttemp = superlu_getenv_dist("SUPERLU_ACC_OFFLOAD", options);
 	    if (ttemp) 
 		return atoi (ttemp);
 	    else return (options->superlu_acc_offload);
          case 11:
-	    ttemp = getenv ("SUPERLU_ACC_SOLVE");
+	    ttemp = superlu_getenv_dist("SUPERLU_ACC_SOLVE", options);
             if (ttemp)
                 return atoi (ttemp);
             else
                 return 0;  // default
+         case 12:
+	    ttemp = superlu_getenv_dist("SUPERLU_MEM_BUDGET", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_mem_budget);
+         case 13:
+	    ttemp = superlu_getenv_dist("SUPERLU_PROPMAP", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_propmap);
+         case 14:
+	    ttemp = superlu_getenv_dist("SUPERLU_LOOKAHEAD_ADAPT", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_lookahead_adapt);
+         case 15:
+	    ttemp = superlu_getenv_dist("SUPERLU_MSG_PRIORITY", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_msg_priority);
+         case 16:
+	    ttemp = superlu_getenv_dist("SUPERLU_PROGRESS", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_progress);
+         case 17:
+	    ttemp = superlu_getenv_dist("SUPERLU_RHS3D", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_rhs3d);
+         case 18:
+	    ttemp = superlu_getenv_dist("SUPERLU_RUIZ", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_ruiz);
+         case 19:
+	    ttemp = superlu_getenv_dist("SUPERLU_COSTMODEL", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_costmodel);
+         case 20:
+	    ttemp = superlu_getenv_dist("SUPERLU_AMALG", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_amalg);
+         case 21:
+	    ttemp = superlu_getenv_dist("SUPERLU_SPLIT", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_split);
+         case 22:
+	    ttemp = superlu_getenv_dist("SUPERLU_MF", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_mf);
+         case 23:
+	    ttemp = superlu_getenv_dist("SUPERLU_DENSE", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_dense);
+         case 24:
+	    ttemp = superlu_getenv_dist("SUPERLU_BLOCKS", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_blocks);
+         case 25:
+	    return (options->superlu_subset);
+         case 26:
+	    ttemp = superlu_getenv_dist("SUPERLU_CPU_BATCH", options);
+	    if (ttemp)
+		return atoi (ttemp);
+	    else return (options->superlu_cpu_batch);
     }
 
     /* Invalid value for ISPEC */
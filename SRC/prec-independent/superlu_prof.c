@@ -0,0 +1,517 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Nestable region profiler with optional hardware counters
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The profiler state lives in the superlu_prof_t of one SuperLUStat_t,
+ * created by superlu_prof_init() and released by PStatFree().  Each
+ * thread of the team that runs the driver owns a table of regions,
+ * created on its first SUPERLU_PROF_BEGIN and indexed by its OpenMP
+ * thread number, so that superlu_prof_report() can merge them.  A region
+ * is keyed by its parent region and its name, so the same name under
+ * different parents gives different paths.  Only begin/end of the owning
+ * thread touch a table, hence no locking on the hot path.
+ * </pre>
+ */
+
+#include "superlu_defs.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROF_HAVE_TSC
+#else
+#include <time.h>
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define PROF_HAVE_PERF
+#endif
+
+#define PROF_MAX_REGIONS 256  /* regions per thread */
+#define PROF_MAX_DEPTH   32   /* nesting depth per thread */
+#define PROF_MAX_PATH    256  /* length of "a/b/c" */
+#define PROF_NCTR        3    /* hardware counters */
+#define PROF_NVAL        (2 + PROF_NCTR) /* calls, seconds, counters */
+#define PROF_DROPPED     (-2) /* region not recorded, table full */
+
+typedef struct {
+    const char *name;
+    int        parent;        /* index in the same table, or -1 */
+    double     calls;
+    unsigned long long ticks;
+    unsigned long long ctr[PROF_NCTR];
+} prof_region_t;
+
+typedef struct {
+    prof_region_t reg[PROF_MAX_REGIONS];
+    int  nreg;
+    int  depth;               /* may exceed PROF_MAX_DEPTH */
+    int  stack[PROF_MAX_DEPTH];
+    unsigned long long t0[PROF_MAX_DEPTH];
+    unsigned long long c0[PROF_MAX_DEPTH][PROF_NCTR];
+    int  fd[PROF_NCTR];       /* perf events; fd[0] leads the group */
+    int  truncated;
+} prof_thread_t;
+
+struct superlu_prof {
+    int    level;             /* 1: timers; 2: timers + counters */
+    int    raw;               /* third counter is a raw PMU event */
+    unsigned long long raw_config;
+    char   *file;             /* JSON report file, or NULL for stdout */
+    unsigned long long tick0; /* tick and wall clock at superlu_prof_init */
+    double wall0;
+    int    nthreads;
+    prof_thread_t **thr;      /* thr[omp_get_thread_num()], NULL until used */
+};
+
+static const char *prof_ctr_name[PROF_NCTR] =
+    {"cycles", "llc_misses", "instructions"};
+
+static inline unsigned long long prof_ticks(void)
+{
+#ifdef PROF_HAVE_TSC
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/*! \brief Ticks per second, calibrated against the wall clock since the
+ * profiler was switched on.
+ */
+static double prof_tick_rate(superlu_prof_t *p)
+{
+#ifdef PROF_HAVE_TSC
+    double dt = SuperLU_timer_() - p->wall0;
+    if ( dt <= 0.0 ) return 1.0e9;
+    return (double) (p->tick0 ? prof_ticks() - p->tick0 : 0) / dt;
+#else
+    return 1.0e9;
+#endif
+}
+
+/*! \brief Switch the profiler of stat on if SUPERLU_PROFILE > 0.
+ *
+ * Called by the drivers on entry.  The variables are read through
+ * superlu_getenv_dist(), so options->ReadEnv = NO leaves the profiler off.
+ * A stat whose profiler is already on keeps accumulating.
+ */
+void superlu_prof_init(superlu_dist_options_t *options, SuperLUStat_t *stat)
+{
+    superlu_prof_t *p;
+    char *ttemp;
+    int level;
+
+    if ( stat->prof ) return;
+    ttemp = superlu_getenv_dist("SUPERLU_PROFILE", options);
+    level = ttemp ? atoi(ttemp) : 0;
+    if ( level <= 0 ) return;
+#ifndef PROF_HAVE_PERF
+    if ( level > 1 ) level = 1;
+#endif
+
+    if ( !(p = (superlu_prof_t *) SUPERLU_MALLOC(sizeof(superlu_prof_t))) )
+	ABORT("Malloc fails for superlu_prof_t.");
+    memset(p, 0, sizeof(superlu_prof_t));
+    p->level = level;
+    if ( (ttemp = superlu_getenv_dist("SUPERLU_PROFILE_RAW", options)) ) {
+	p->raw = 1;
+	p->raw_config = strtoull(ttemp, NULL, 16);
+    }
+    if ( (ttemp = superlu_getenv_dist("SUPERLU_PROFILE_FILE", options)) ) {
+	if ( !(p->file = (char *) SUPERLU_MALLOC(strlen(ttemp) + 1)) )
+	    ABORT("Malloc fails for superlu_prof_t::file.");
+	strcpy(p->file, ttemp);
+    }
+#ifdef _OPENMP
+    p->nthreads = omp_get_max_threads();
+#else
+    p->nthreads = 1;
+#endif
+    if ( !(p->thr = (prof_thread_t **)
+	   SUPERLU_MALLOC(p->nthreads * sizeof(prof_thread_t *))) )
+	ABORT("Malloc fails for superlu_prof_t::thr[].");
+    memset(p->thr, 0, p->nthreads * sizeof(prof_thread_t *));
+    p->wall0 = SuperLU_timer_();
+    p->tick0 = prof_ticks();
+    stat->prof = p;
+}
+
+/*! \brief Release the profiler of stat; called by PStatFree(). */
+void superlu_prof_free(SuperLUStat_t *stat)
+{
+    superlu_prof_t *p = stat->prof;
+    int i;
+#ifdef PROF_HAVE_PERF
+    int c;
+#endif
+
+    if ( !p ) return;
+    for (i = 0; i < p->nthreads; ++i) {
+	if ( !p->thr[i] ) continue;
+#ifdef PROF_HAVE_PERF
+	if ( p->thr[i]->fd[0] >= 0 )
+	    for (c = 0; c < PROF_NCTR; ++c) close(p->thr[i]->fd[c]);
+#endif
+	SUPERLU_FREE(p->thr[i]);
+    }
+    SUPERLU_FREE(p->thr);
+    if ( p->file ) SUPERLU_FREE(p->file);
+    SUPERLU_FREE(p);
+    stat->prof = NULL;
+}
+
+#ifdef PROF_HAVE_PERF
+/*! \brief Open the counter group of the calling thread; on failure (no
+ * PMU access, e.g. perf_event_paranoid) the thread runs without counters.
+ */
+static void prof_open_counters(superlu_prof_t *p, prof_thread_t *t)
+{
+    static const unsigned long long cfg[PROF_NCTR] =
+	{PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES,
+	 PERF_COUNT_HW_INSTRUCTIONS};
+    struct perf_event_attr attr;
+    int i;
+
+    for (i = 0; i < PROF_NCTR; ++i) {
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = cfg[i];
+	if ( i == PROF_NCTR - 1 && p->raw ) {
+	    attr.type = PERF_TYPE_RAW;
+	    attr.config = p->raw_config;
+	}
+	attr.read_format = PERF_FORMAT_GROUP;
+	attr.disabled = (i == 0);
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	t->fd[i] = (int) syscall(__NR_perf_event_open, &attr, 0, -1,
+				 i ? t->fd[0] : -1, 0);
+	if ( t->fd[i] < 0 ) {
+	    while ( i-- > 0 ) close(t->fd[i]);
+	    t->fd[0] = -1;
+	    return;
+	}
+    }
+    ioctl(t->fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(t->fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+#endif
+
+static inline void prof_read_counters(prof_thread_t *t, unsigned long long *c)
+{
+    int i;
+#ifdef PROF_HAVE_PERF
+    unsigned long long buf[1 + PROF_NCTR];
+    if ( t->fd[0] >= 0 && read(t->fd[0], buf, sizeof(buf)) == sizeof(buf) ) {
+	for (i = 0; i < PROF_NCTR; ++i) c[i] = buf[1 + i];
+	return;
+    }
+#endif
+    for (i = 0; i < PROF_NCTR; ++i) c[i] = 0;
+}
+
+/* Table of the calling thread, or NULL if it is not in the team the
+   profiler was sized for. */
+static prof_thread_t *prof_thread(superlu_prof_t *p)
+{
+    prof_thread_t *t;
+#ifdef _OPENMP
+    int tid = omp_get_thread_num();
+#else
+    int tid = 0;
+#endif
+
+    if ( tid >= p->nthreads ) return NULL;
+    if ( !(t = p->thr[tid]) ) {
+	if ( !(t = (prof_thread_t *) SUPERLU_MALLOC(sizeof(prof_thread_t))) )
+	    ABORT("Malloc fails for prof_thread_t.");
+	memset(t, 0, sizeof(prof_thread_t));
+	t->fd[0] = -1;
+#ifdef PROF_HAVE_PERF
+	if ( p->level >= 2 ) prof_open_counters(p, t);
+#endif
+	p->thr[tid] = t;
+    }
+    return t;
+}
+
+/*! \brief Open region name (a string that outlives the program run,
+ * normally a literal) on the calling thread.
+ */
+void superlu_prof_begin(superlu_prof_t *p, const char *name)
+{
+    prof_thread_t *t;
+    int d, r, parent;
+
+    if ( !(t = prof_thread(p)) ) return;
+    d = t->depth++;
+    if ( d >= PROF_MAX_DEPTH ) {
+	t->truncated = 1;
+	return;
+    }
+
+    parent = d ? t->stack[d-1] : -1;
+    r = PROF_DROPPED;
+    if ( parent != PROF_DROPPED ) {
+	for (r = t->nreg - 1; r >= 0; --r)
+	    if ( t->reg[r].parent == parent && (t->reg[r].name == name
+					 || !strcmp(t->reg[r].name, name)) )
+		break;
+	if ( r < 0 ) {
+	    if ( t->nreg < PROF_MAX_REGIONS ) {
+		r = t->nreg++;
+		t->reg[r].name = name;
+		t->reg[r].parent = parent;
+	    } else {
+		r = PROF_DROPPED;
+		t->truncated = 1;
+	    }
+	}
+    }
+    t->stack[d] = r;
+    if ( p->level >= 2 ) prof_read_counters(t, t->c0[d]);
+    t->t0[d] = prof_ticks();
+}
+
+/*! \brief Close the innermost open region of the calling thread. */
+void superlu_prof_end(superlu_prof_t *p, const char *name)
+{
+    unsigned long long t1 = prof_ticks(), c1[PROF_NCTR];
+    prof_thread_t *t = prof_thread(p);
+    prof_region_t *reg;
+    int d, i;
+
+    if ( !t || t->depth == 0 ) return;
+    d = --t->depth;
+    if ( d >= PROF_MAX_DEPTH || t->stack[d] == PROF_DROPPED ) return;
+
+    reg = &t->reg[t->stack[d]];
+#if ( DEBUGlevel>=1 )
+    if ( strcmp(reg->name, name) )
+	fprintf(stderr, "superlu_prof_end(%s) closes region %s\n",
+		name, reg->name);
+#endif
+    reg->calls += 1.0;
+    reg->ticks += t1 - t->t0[d];
+    if ( p->level >= 2 ) {
+	prof_read_counters(t, c1);
+	for (i = 0; i < PROF_NCTR; ++i) reg->ctr[i] += c1[i] - t->c0[d][i];
+    }
+}
+
+/*! \brief Zero the accumulated values of all threads. */
+void superlu_prof_reset(SuperLUStat_t *stat)
+{
+    prof_thread_t *t;
+    int i, r;
+
+    if ( !stat->prof ) return;
+    for (i = 0; i < stat->prof->nthreads; ++i)
+	if ( (t = stat->prof->thr[i]) )
+	for (r = 0; r < t->nreg; ++r) {
+	    t->reg[r].calls = 0.0;
+	    t->reg[r].ticks = 0;
+	    memset(t->reg[r].ctr, 0, sizeof(t->reg[r].ctr));
+	}
+}
+
+/* Write the path of region r of table t into buf; return its length. */
+static int prof_path(prof_thread_t *t, int r, char *buf)
+{
+    int len = 0, n;
+    if ( t->reg[r].parent >= 0 ) {
+	len = prof_path(t, t->reg[r].parent, buf);
+	if ( len < PROF_MAX_PATH - 1 ) buf[len++] = '/';
+    }
+    n = SUPERLU_MIN((int) strlen(t->reg[r].name), PROF_MAX_PATH - 1 - len);
+    memcpy(&buf[len], t->reg[r].name, n);
+    buf[len + n] = '\0';
+    return len + n;
+}
+
+static int prof_cmp_path(const void *a, const void *b)
+{
+    return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+/* Split a blob of NUL-terminated strings into ptr[]; return the count. */
+static int prof_split(char *blob, int len, char **ptr)
+{
+    int i, n = 0;
+    for (i = 0; i < len; i += strlen(&blob[i]) + 1) {
+	if ( ptr ) ptr[n] = &blob[i];
+	++n;
+    }
+    return n;
+}
+
+static void prof_put_stat(FILE *fp, const char *key, double mn, double sum,
+			  double mx, int nprocs, int last)
+{
+    fprintf(fp, "\"%s\": {\"min\": %.6g, \"avg\": %.6g, \"max\": %.6g}%s",
+	    key, mn, sum / nprocs, mx, last ? "" : ", ");
+}
+
+/*! \brief Collective over comm: merge the threads of each process and
+ * write min/avg/max over the processes that entered each region as JSON.
+ *
+ * A process's value for a region is the sum over its threads (calls,
+ * seconds and counters).  Regions opened on worker threads outside any
+ * region of that thread appear as top-level paths.
+ */
+void superlu_prof_report(SuperLUStat_t *stat, MPI_Comm comm)
+{
+    superlu_prof_t *p = stat->prof;
+    prof_thread_t *t;
+    char *lblob, *ublob = NULL, *allblob = NULL, **uptr, path[PROF_MAX_PATH];
+    double *lval, *val, *vmin, *vmax, *vsum, *have, *nhave, hz;
+    int iam, nprocs, ntot, nloc, llen, ulen, nuniq, i, j, k, r, trunc, anytrunc;
+    int *lens = NULL, *displs = NULL;
+    FILE *fp;
+
+    if ( !p ) return;
+    MPI_Comm_rank(comm, &iam);
+    MPI_Comm_size(comm, &nprocs);
+    hz = prof_tick_rate(p);
+
+    /* Merge the thread tables of this process by path. */
+    ntot = 0;
+    trunc = 0;
+    for (k = 0; k < p->nthreads; ++k) {
+	if ( !(t = p->thr[k]) ) continue;
+	ntot += t->nreg;
+	trunc |= t->truncated;
+    }
+    lblob = (char *) SUPERLU_MALLOC(SUPERLU_MAX(1, ntot) * PROF_MAX_PATH);
+    lval = (double *) SUPERLU_MALLOC(SUPERLU_MAX(1, ntot) * PROF_NVAL * sizeof(double));
+    memset(lval, 0, SUPERLU_MAX(1, ntot) * PROF_NVAL * sizeof(double));
+    nloc = llen = 0;
+    for (k = 0; k < p->nthreads; ++k) {
+	if ( !(t = p->thr[k]) ) continue;
+	for (r = 0; r < t->nreg; ++r) {
+	    int len = prof_path(t, r, path);
+	    for (i = 0, j = 0; i < nloc; ++i, j += strlen(&lblob[j]) + 1)
+		if ( !strcmp(&lblob[j], path) ) break;
+	    if ( i == nloc ) {
+		memcpy(&lblob[llen], path, len + 1);
+		llen += len + 1;
+		++nloc;
+	    }
+	    lval[i*PROF_NVAL] += t->reg[r].calls;
+	    lval[i*PROF_NVAL + 1] += t->reg[r].ticks / hz;
+	    for (j = 0; j < PROF_NCTR; ++j)
+		lval[i*PROF_NVAL + 2 + j] += t->reg[r].ctr[j];
+	}
+    }
+
+    /* Union of the paths over the processes, sorted, built on rank 0. */
+    if ( !iam ) {
+	lens = (int *) SUPERLU_MALLOC(2 * nprocs * sizeof(int));
+	displs = lens + nprocs;
+    }
+    MPI_Gather(&llen, 1, MPI_INT, lens, 1, MPI_INT, 0, comm);
+    if ( !iam ) {
+	for (i = 0, k = 0; i < nprocs; ++i) { displs[i] = k; k += lens[i]; }
+	allblob = (char *) SUPERLU_MALLOC(SUPERLU_MAX(1, k));
+	ulen = k;
+    }
+    MPI_Gatherv(lblob, llen, MPI_CHAR, allblob, lens, displs, MPI_CHAR,
+		0, comm);
+    if ( !iam ) {
+	int nall = prof_split(allblob, ulen, NULL);
+	char **aptr = (char **) SUPERLU_MALLOC(SUPERLU_MAX(1, nall) * sizeof(char *));
+	prof_split(allblob, ulen, aptr);
+	qsort(aptr, nall, sizeof(char *), prof_cmp_path);
+	ublob = (char *) SUPERLU_MALLOC(SUPERLU_MAX(1, ulen));
+	for (i = 0, ulen = 0; i < nall; ++i) {
+	    if ( i && !strcmp(aptr[i], aptr[i-1]) ) continue;
+	    k = strlen(aptr[i]) + 1;
+	    memcpy(&ublob[ulen], aptr[i], k);
+	    ulen += k;
+	}
+	SUPERLU_FREE(aptr);
+	SUPERLU_FREE(allblob);
+	SUPERLU_FREE(lens);
+    }
+    MPI_Bcast(&ulen, 1, MPI_INT, 0, comm);
+    if ( iam ) ublob = (char *) SUPERLU_MALLOC(SUPERLU_MAX(1, ulen));
+    MPI_Bcast(ublob, ulen, MPI_CHAR, 0, comm);
+    nuniq = prof_split(ublob, ulen, NULL);
+    uptr = (char **) SUPERLU_MALLOC(SUPERLU_MAX(1, nuniq) * sizeof(char *));
+    prof_split(ublob, ulen, uptr);
+
+    /* Reduce min/max/sum over the processes that have the region. */
+    val = (double *) SUPERLU_MALLOC(5 * SUPERLU_MAX(1, nuniq) * PROF_NVAL * sizeof(double));
+    vmin = val + nuniq * PROF_NVAL;
+    vmax = vmin + nuniq * PROF_NVAL;
+    vsum = vmax + nuniq * PROF_NVAL;
+    have = vsum + nuniq * PROF_NVAL;
+    nhave = have + nuniq;
+    for (i = 0; i < nuniq; ++i) {
+	for (k = 0, j = 0; j < nloc; k += strlen(&lblob[k]) + 1, ++j)
+	    if ( !strcmp(&lblob[k], uptr[i]) ) break;
+	have[i] = (j < nloc);
+	for (r = 0; r < PROF_NVAL; ++r)
+	    val[i*PROF_NVAL + r] = have[i] ? lval[j*PROF_NVAL + r] : 0.0;
+    }
+    MPI_Reduce(val, vsum, nuniq * PROF_NVAL, MPI_DOUBLE, MPI_SUM, 0, comm);
+    MPI_Reduce(val, vmax, nuniq * PROF_NVAL, MPI_DOUBLE, MPI_MAX, 0, comm);
+    for (i = 0; i < nuniq; ++i)
+	if ( !have[i] )
+	    for (r = 0; r < PROF_NVAL; ++r) val[i*PROF_NVAL + r] = 1.0e300;
+    MPI_Reduce(val, vmin, nuniq * PROF_NVAL, MPI_DOUBLE, MPI_MIN, 0, comm);
+    MPI_Reduce(have, nhave, nuniq, MPI_DOUBLE, MPI_SUM, 0, comm);
+    MPI_Reduce(&trunc, &anytrunc, 1, MPI_INT, MPI_MAX, 0, comm);
+
+    if ( !iam ) {
+	fp = p->file ? fopen(p->file, "w") : stdout;
+	if ( !fp ) fp = stdout;
+	fprintf(fp, "{\n  \"nprocs\": %d,\n  \"tick_rate_hz\": %.6g,\n"
+		"  \"truncated\": %s,\n  \"regions\": [\n",
+		nprocs, hz, anytrunc ? "true" : "false");
+	for (i = 0; i < nuniq; ++i) {
+	    int np = (int) nhave[i];
+	    double *mn = &vmin[i*PROF_NVAL], *mx = &vmax[i*PROF_NVAL],
+		   *sm = &vsum[i*PROF_NVAL];
+	    fprintf(fp, "    {\"path\": \"%s\", \"procs\": %d, ", uptr[i], np);
+	    prof_put_stat(fp, "calls", mn[0], sm[0], mx[0], np, 0);
+	    prof_put_stat(fp, "seconds", mn[1], sm[1], mx[1], np,
+			  p->level < 2);
+	    if ( p->level >= 2 )
+		for (j = 0; j < PROF_NCTR; ++j)
+		    prof_put_stat(fp, (j == PROF_NCTR - 1 && p->raw) ? "raw"
+				  : prof_ctr_name[j], mn[2+j], sm[2+j],
+				  mx[2+j], np, j == PROF_NCTR - 1);
+	    fprintf(fp, "}%s\n", i < nuniq - 1 ? "," : "");
+	}
+	fprintf(fp, "  ]\n}\n");
+	if ( fp != stdout ) fclose(fp);
+	else fflush(stdout);
+    }
+
+    SUPERLU_FREE(val);
+    SUPERLU_FREE(uptr);
+    SUPERLU_FREE(ublob);
+    SUPERLU_FREE(lval);
+    SUPERLU_FREE(lblob);
+}
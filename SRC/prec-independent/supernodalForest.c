@@ -96,7 +96,7 @@ sForest_t**  getNestDissForests( int_t maxLvl, int_t nsupers, int_t*setree, tree
 	return sForests;
 }
 
-static int_t* sortPtr;
+static SUPERLU_THREAD_LOCAL int_t* sortPtr;   /* key array of the running qsort */
 
 static  int cmpfuncInd (const void * a, const void * b)
 {
@@ -120,7 +120,7 @@ int_t* getSortIndex(int_t n, int_t* A)
 }
 
 
-static double* sortPtrDouble;
+static SUPERLU_THREAD_LOCAL double* sortPtrDouble;
 
 static  int cmpfuncIndDouble (const void * a, const void * b)
 {
@@ -125,18 +125,21 @@ int  free_treelist(int_t nsuper, treeList_t* treeList)
     return 0;
 }
 
-int_t estimateWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* xsup)
+int_t estimateWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* xsup,
+		     const superlu_costmodel_t *cm)
 {
-	if (getenv("WF"))
+	int wf = cm ? cm->wf : 0; /* WF, read by superlu_costmodel_setup() */
+
+	if (wf)
 	{
-		if (strcmp(getenv("WF"), "One" ) == 0)
+		if (wf == 1)
 		{
 			for (int i = 0; i < nsupers; ++i)
 			{
 				treeList[i].weight = 1.0;
 			}
 		}
-		else if (strcmp(getenv("WF"), "Ns" ) == 0)
+		else if (wf == 2)
 		{
 			for (int i = 0; i < nsupers; ++i)
 			{
@@ -144,7 +147,7 @@ int_t estimateWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* x
 				treeList[i].weight = sz;
 			}
 		}
-		else if (strcmp(getenv("WF"), "NsDep" ) == 0)
+		else if (wf == 3)
 		{
 			for (int i = 0; i < nsupers; ++i)
 			{
@@ -153,7 +156,7 @@ int_t estimateWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* x
 				treeList[i].weight = sz * dep;
 			}
 		}
-		else if (strcmp(getenv("WF"), "NsDep2" ) == 0)
+		else /* wf == 4 */
 		{
 			for (int i = 0; i < nsupers; ++i)
 			{
@@ -164,23 +167,15 @@ int_t estimateWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* x
 			}
 
 		}
-		else
+	}
+	else if (superlu_costmodel_active(cm))
+	{
+		/* Predicted time, the depth bounding the panel sizes. */
+		for (int i = 0; i < nsupers; ++i)
 		{
-#if 0 		
-			// scuWeight has not been updated by getSCUweight as it's not called anymore
-			for (int i = 0; i < nsupers; ++i)
-			{
-				treeList[i].weight = treeList[i].scuWeight;
-
-			}
-#else 
-			for (int i = 0; i < nsupers; ++i)
-			{
-				double dep = 1.0 * treeList[i].depth ;
-				double sz = 1.0 *  SuperSize(i);
-				treeList[i].weight = sz * dep;
-			}
-#endif 	
+			double dep = 1.0 * treeList[i].depth ;
+			double sz = 1.0 *  SuperSize(i);
+			treeList[i].weight = superlu_costmodel_supernode(cm, sz, dep, dep);
 		}
 	}
 	else
@@ -207,7 +202,8 @@ int_t estimateWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* x
 } /* estimateWeight */
 
 
-int_t calcTreeWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* xsup)
+int_t calcTreeWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* xsup,
+		     const superlu_costmodel_t *cm)
 {
 
 	// initializing naive weight
@@ -245,7 +241,7 @@ int_t calcTreeWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* x
 	// 	// treeList[i].depth = 0;
 	// }
 
-	estimateWeight(nsupers, setree, treeList, xsup);
+	estimateWeight(nsupers, setree, treeList, xsup, cm);
 
 	for (int i = 0; i < nsupers; ++i)
 	{
@@ -264,6 +260,39 @@ int_t calcTreeWeight(int_t nsupers, int_t*setree, treeList_t* treeList, int_t* x
 
 } /* calcTreeWeight */
 
+/**
+ * Weight of the heaviest leaf-to-root chain through each supernode
+ * @param  nsupers  Number of supernodes
+ * @param  setree   Supernodal elimination tree
+ * @param  treeList Tree with the weights set by calcTreeWeight()
+ * @return          path[k], of size nsupers; the supernodes on the critical
+ *                  path of the etree have the largest value
+ */
+double *supernodal_critical_path(int_t nsupers, int_t *setree, treeList_t *treeList)
+{
+	double *path = doubleMalloc_dist(2 * nsupers + 1);
+	double *down = path + nsupers; /* heaviest chain below k, with k */
+	double *up = down;             /* reused: chain above k, with k */
+	if (!path) ABORT("Malloc fails for path[].");
+
+	for (int_t i = 0; i < nsupers; ++i) down[i] = 0.0;
+	for (int_t i = 0; i < nsupers; ++i) /* children come first */
+	{
+		down[i] += treeList[i].weight;
+		int_t p = setree[i];
+		if (p < nsupers) down[p] = SUPERLU_MAX(down[p], down[i]);
+	}
+	for (int_t i = 0; i < nsupers; ++i) path[i] = down[i];
+
+	for (int_t i = nsupers - 1; i >= 0; --i) /* parents come first */
+	{
+		int_t p = setree[i];
+		up[i] = treeList[i].weight + (p < nsupers ? up[p] : 0.0);
+		path[i] += up[i] - treeList[i].weight;
+	}
+	return path;
+} /* supernodal_critical_path */
+
 
 int_t printFileList(char* sname, int_t nnodes, int_t*dlist, int_t*setree)
 {
@@ -0,0 +1,227 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Split wide supernodes over the process grid
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * symbfact() cuts supernodes at maxsuper columns, whatever the grid.  A
+ * wide supernode near the root then has its diagonal block factored by
+ * one process, and its panels owned by one process row and column, while
+ * the other ranks wait.  superlu_split_supernodes() splits each supernode
+ * of at least twice the relaxation width into the number of pieces t for
+ * which the cost model predicts the smallest time on the Pr x Pc grid:
+ * piece i of width b_i is eliminated by the ranks owning its block row and
+ * column, with the trailing pieces distributed block-cyclically as
+ * block K+i, and the rows and columns outside the supernode spread evenly,
+ *
+ *     T(t) = sum_i superlu_costmodel_supernode(b_i, maxrow_i, maxcol_i),
+ *
+ * where maxrow_i (maxcol_i) is the largest share of a process row
+ * (column) of the rows (columns) updated by piece i.  Narrow pieces lose
+ * GEMM efficiency and pay a latency each, so supernodes with many rows
+ * below them, the leaves, keep their width.
+ * </pre>
+ */
+
+#include "superlu_defs.h"
+
+/*! \brief Predicted time to eliminate a supernode of w columns split into
+ * t pieces, the first one being block K of the Pr x Pc grid. */
+static double split_time(const superlu_costmodel_t *cm, int_t w, int_t t,
+			 int_t nbelow, int_t nu, int_t K,
+			 int nprow, int npcol, double *rsh, double *csh)
+{
+    double time = 0., mr, mc;
+    int_t i, i1, b, r, c;
+
+    for (i = 0; i < t; ++i) {
+	/* The shares of the rows and columns updated by piece i. */
+	for (r = 0; r < nprow; ++r) rsh[r] = (double) nbelow / nprow;
+	for (c = 0; c < npcol; ++c) csh[c] = (double) nu / npcol;
+	for (i1 = i + 1; i1 < t; ++i1) {
+	    b = w / t + (i1 < w % t);
+	    rsh[(K + i1) % nprow] += b;
+	    csh[(K + i1) % npcol] += b;
+	}
+	for (r = 0, mr = 0.; r < nprow; ++r) mr = SUPERLU_MAX(mr, rsh[r]);
+	for (c = 0, mc = 0.; c < npcol; ++c) mc = SUPERLU_MAX(mc, csh[c]);
+	b = w / t + (i < w % t);
+	time += superlu_costmodel_supernode(cm, b, mr, mc);
+    }
+    return time;
+}
+
+/*! \brief Split the supernodes of the serial symbolic factorization for
+ * an nprow x npcol process grid.
+ *
+ * <pre>
+ * On exit, Glu_persist (xsup, supno) and Glu_freeable (lsub, xlsub,
+ * usub, xusub) describe the split supernodes; the nonzero structure of
+ * L and U is unchanged.  Every process computes the same result.
+ * Returns the number of supernodes added.
+ * The times are predicted with the rates of cm, or the default rates if
+ * cm is NULL.
+ * </pre>
+ */
+int_t superlu_split_supernodes(superlu_dist_options_t *options, int_t n,
+			       Glu_persist_t *Glu_persist,
+			       Glu_freeable_t *Glu_freeable,
+			       const superlu_costmodel_t *cm,
+			       int nprow, int npcol, int iam)
+{
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *lsub = Glu_freeable->lsub, *xlsub = Glu_freeable->xlsub;
+    int_t *usub = Glu_freeable->usub, *xusub = Glu_freeable->xusub;
+    int_t nsuper, newnsuper, wmin, *nucnt, *npiece, *first, *newxsup;
+    int_t *newlsub, *newusub, s, i, j, k, t, tbest, w, nbelow, fs, ls;
+    int_t nnzl, nnzu, pos, fnz, a, lbeg, lend, nsplit = 0;
+    double *rsh, *csh, tt, tbest_t, t_old = 0., t_new = 0.;
+
+    nsuper = n > 0 ? supno[n-1] + 1 : 0;
+    if ( sp_ienv_dist(21, options) <= 0 || nprow * npcol == 1 || nsuper == 0 )
+	return 0;
+    wmin = SUPERLU_MAX(sp_ienv_dist(2, options), 1);
+
+    if ( !(nucnt = intCalloc_dist(3 * nsuper + 1)) )
+	ABORT("Calloc fails for nucnt[].");
+    npiece = nucnt + nsuper;
+    first = npiece + nsuper;    /* first new block of each old one */
+    if ( !(rsh = SUPERLU_MALLOC((nprow + npcol) * sizeof(double))) )
+	ABORT("Malloc fails for rsh[].");
+    csh = rsh + nprow;
+    for (i = 0; i < xusub[n]; ++i) ++nucnt[supno[usub[i]]];
+
+    /* Choose the number of pieces of each supernode, in order, so that
+       the block numbers, hence the owners, of the pieces are known. */
+    for (s = 0, newnsuper = 0; s < nsuper; ++s) {
+	w = SuperSize(s);
+	nbelow = xlsub[xsup[s]+1] - xlsub[xsup[s]] - w;
+	tbest = 1;
+	tbest_t = split_time(cm, w, 1, nbelow, nucnt[s], newnsuper, nprow, npcol,
+			     rsh, csh);
+	t_old += tbest_t;
+	for (t = 2; t <= w / wmin; ++t) {
+	    tt = split_time(cm, w, t, nbelow, nucnt[s], newnsuper, nprow, npcol,
+			    rsh, csh);
+	    if ( tt < tbest_t ) {
+		tbest = t;
+		tbest_t = tt;
+	    }
+	}
+	t_new += tbest_t;
+	npiece[s] = tbest;
+	first[s] = newnsuper;
+	newnsuper += tbest;
+	if ( tbest > 1 ) ++nsplit;
+    }
+    first[nsuper] = newnsuper;
+    SUPERLU_FREE(rsh);
+
+    if ( newnsuper == nsuper ) {
+	SUPERLU_FREE(nucnt);
+	return 0;
+    }
+
+    /* The new partition. */
+    if ( !(newxsup = intMalloc_dist(newnsuper + 1)) )
+	ABORT("Malloc fails for newxsup[].");
+    for (s = 0; s < nsuper; ++s) {
+	w = SuperSize(s);
+	t = npiece[s];
+	for (i = 0, a = xsup[s]; i < t; ++i) {
+	    newxsup[first[s] + i] = a;
+	    a += w / t + (i < w % t);
+	}
+    }
+    newxsup[newnsuper] = n;
+
+    /* The L subscripts of a piece: the rest of the diagonal block, then
+       the rows below the supernode. */
+    for (s = 0, nnzl = 0; s < nsuper; ++s) {
+	ls = xsup[s+1] - 1;
+	nbelow = xlsub[xsup[s]+1] - xlsub[xsup[s]] - SuperSize(s);
+	for (k = first[s]; k < first[s+1]; ++k)
+	    nnzl += ls - newxsup[k] + 1 + nbelow;
+    }
+    if ( !(newlsub = intMalloc_dist(nnzl)) )
+	ABORT("Malloc fails for newlsub[].");
+    for (s = 0, pos = 0; s < nsuper; ++s) {
+	fs = xsup[s];
+	ls = xsup[s+1] - 1;
+	lbeg = xlsub[fs] + SuperSize(s);
+	lend = xlsub[fs+1];
+	for (k = first[s]; k < first[s+1]; ++k) {
+	    xlsub[newxsup[k]] = pos;
+	    for (i = newxsup[k]; i <= ls; ++i) newlsub[pos++] = i;
+	    for (i = lbeg; i < lend; ++i) newlsub[pos++] = lsub[i];
+	    for (j = newxsup[k] + 1; j < newxsup[k+1]; ++j) xlsub[j] = pos;
+	}
+    }
+    xlsub[n] = nnzl;
+
+    /* The U segments: a segment in block s becomes one in each piece it
+       reaches, and the pieces of the column's own supernode before it get
+       dense segments. */
+    for (j = 0, nnzu = 0; j < n; ++j) {
+	s = supno[j];
+	for (k = first[s]; newxsup[k+1] <= j; ++k) ++nnzu;
+	for (i = xusub[j]; i < xusub[j+1]; ++i) {
+	    fnz = usub[i];
+	    s = supno[fnz];
+	    for (k = first[s+1] - 1; newxsup[k] > fnz; --k) ++nnzu;
+	    ++nnzu;
+	}
+    }
+    if ( !(newusub = intMalloc_dist(SUPERLU_MAX(nnzu, 1))) )
+	ABORT("Malloc fails for newusub[].");
+    for (j = 0, pos = 0, a = xusub[0]; j < n; ++j) {
+	ls = xusub[j+1];
+	xusub[j] = pos;
+	for (i = a; i < ls; ++i) {
+	    fnz = usub[i];
+	    s = supno[fnz];
+	    newusub[pos++] = fnz;
+	    for (k = first[s+1] - 1; newxsup[k] > fnz; --k)
+		newusub[pos++] = newxsup[k];
+	}
+	s = supno[j];
+	for (k = first[s]; newxsup[k+1] <= j; ++k) newusub[pos++] = newxsup[k];
+	a = ls;
+    }
+    xusub[n] = nnzu;
+    SUPERLU_FREE(lsub);
+    SUPERLU_FREE(usub);
+    Glu_freeable->lsub = newlsub;
+    Glu_freeable->nzlmax = nnzl;
+    Glu_freeable->usub = newusub;
+    Glu_freeable->nzumax = nnzu;
+
+    for (s = 0; s < nsuper; ++s) {
+	for (k = first[s]; k < first[s+1]; ++k)
+	    for (j = newxsup[k]; j < newxsup[k+1]; ++j) supno[j] = k;
+    }
+    supno[n] = newnsuper - 1;
+    for (k = 0; k <= newnsuper; ++k) xsup[k] = newxsup[k];
+    SUPERLU_FREE(newxsup);
+    SUPERLU_FREE(nucnt);
+
+    if ( !iam && options->PrintStat == YES ) {
+	printf("\tSupernode splitting: " IFMT " split, supers " IFMT " -> " IFMT
+	       " on %d x %d, predicted %.3e -> %.3e s (%.2fx)\n",
+	       nsplit, nsuper, newnsuper, nprow, npcol, t_old, t_new,
+	       t_old / t_new);
+	fflush(stdout);
+    }
+    return newnsuper - nsuper;
+} /* superlu_split_supernodes */
@@ -45,7 +45,7 @@ at the top-level directory.
 static void  relax_snode(int_t, int_t *, int_t, int_t *, int_t *);
 static int_t snode_dfs(SuperMatrix *, const int_t, const int_t, int_t *,
 		       int_t *,	Glu_persist_t *, Glu_freeable_t *);
-static int_t column_dfs(superlu_dist_options_t *, SuperMatrix *,
+static int_t column_dfs(superlu_dist_options_t *, const int_t, SuperMatrix *,
 			const int_t, int_t *, int_t *, int_t *,
 			int_t *, int_t *, int_t *, int_t *, int_t *,
 			Glu_persist_t *, Glu_freeable_t *);
@@ -94,7 +94,7 @@ int_t symbfact
     int_t m, n, min_mn, j, i, k, irep, nseg, pivrow, info;
     int_t *iwork, *perm_r, *segrep, *repfnz;
     int_t *xprune, *marker, *parent, *xplore;
-    int_t relax, *desc, *relax_end;
+    int_t relax, maxsuper, *desc, *relax_end;
     int_t nnzLU, nnzLSUB;
     int_t nnzL, nnzU;
 
@@ -123,6 +123,7 @@ int_t symbfact
     xprune = xplore + m;
     relax_end = xprune + n;
     relax = sp_ienv_dist(2, options);
+    maxsuper = sp_ienv_dist(3, options);
     ifill_dist(perm_r, m, SLU_EMPTY);
     ifill_dist(repfnz, m, SLU_EMPTY);
     ifill_dist(marker, m, SLU_EMPTY);
@@ -155,7 +156,7 @@ int_t symbfact
 	} else {
 	    /* Perform a symbolic factorization on column j, and detects
 	       whether column j starts a new supernode. */
-	    if ((info = column_dfs(options, A, j, perm_r, &nseg, segrep, repfnz,
+	    if ((info = column_dfs(options, maxsuper, A, j, perm_r, &nseg, segrep, repfnz,
 				   xprune, marker, parent, xplore,
 				   Glu_persist, Glu_freeable)) != 0)
 		return info;
@@ -460,6 +461,7 @@ static int_t column_dfs
 /************************************************************************/
 (
  superlu_dist_options_t *options,
+ const int_t maxsuper,  /* maximum supernode size (input) */
  SuperMatrix *A,        /* original matrix A permuted by columns (input) */
  const int_t jcol,      /* current column number (input) */
  int_t       *perm_r,   /* row permutation vector (input) */
@@ -487,7 +489,6 @@ static int_t column_dfs
     int_t     ito, ifrom, istop;	/* used to compress row subscripts */
     int_t     *xsup, *supno, *lsub, *xlsub;
     int_t     nzlmax;
-    static int_t first = 1, maxsuper;
     int_t     mem_error;
     
     /* Initializations */
@@ -504,10 +505,6 @@ static int_t column_dfs
     jcolm1   = jcol - 1;
     jsuper   = nsuper = supno[jcol];
     nextl    = xlsub[jcol];
-    if ( first ) {
-	maxsuper = sp_ienv_dist(3, options);
-	first = 0;
-    }
     
     *nseg = 0;
 
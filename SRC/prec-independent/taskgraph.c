@@ -0,0 +1,187 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+/*! @file
+ * \brief Export the supernodal task graph after symbolic factorization
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The graph is written as text, one record of four lines per supernode
+ * in elimination order:
+ *
+ *   n <n> nsupers <ns> dsize <bytes> complex <0|1> nprow <r> npcol <c> npdep <z>
+ *   s <k> <fstcol> <ncols> <parent> <tree> <panel_flops> <update_flops>
+ *     <L_bytes> <U_bytes>
+ *   l <nb> <blk> <rows> ...       off-diagonal row blocks of L(:,k)
+ *   u <nb> <blk> <nnz> ...        off-diagonal column blocks of U(k,:)
+ *   e <nb> <blk> ...              panels updated by the Schur complement
+ *                                 of k (the successors of k in the DAG)
+ *
+ * parent is the supernodal etree parent (-1 for a root), and tree is the
+ * index of the 3D forest holding k in the heap numbering of getGridTrees()
+ * (0 for the 2D algorithm).  The 2D owner of block (i,j) is process
+ * (i mod nprow, j mod npcol) of the layer(s) that own tree; see
+ * EXAMPLE/tasksim.c for a simulator that reads this file.
+ * </pre>
+ */
+
+#include "superlu_defs.h"
+
+typedef struct {
+    int_t blk;   /* supernode number */
+    int_t len;   /* rows (L) or nonzeros (U) */
+} tg_block_t;
+
+static int tg_cmp(const void *a, const void *b)
+{
+    int_t x = ((const tg_block_t *) a)->blk, y = ((const tg_block_t *) b)->blk;
+    return (x > y) - (x < y);
+}
+
+/*! \brief Write the task graph of the serial symbolic factorization.
+ *
+ * <pre>
+ * Glu_persist/Glu_freeable are the output of symbfact(); etree is the
+ * postordered column elimination tree.  supernode2treeMap may be NULL
+ * (2D), otherwise it maps each supernode to its forest as in
+ * dtrf3Dpartition_t.  is_complex selects the flop weights of complex
+ * arithmetic.  Returns 0 on success, -1 if the file cannot be written.
+ * </pre>
+ */
+int superlu_write_taskgraph(const char *fname, int_t n, int dsize,
+			    int is_complex, Glu_persist_t *Glu_persist,
+			    Glu_freeable_t *Glu_freeable, int_t *etree,
+			    int_t *supernode2treeMap, int nprow, int npcol,
+			    int npdep)
+{
+    int_t *xsup = Glu_persist->xsup, *supno = Glu_persist->supno;
+    int_t *xlsub = Glu_freeable->xlsub, *lsub = Glu_freeable->lsub;
+    int_t *xusub = Glu_freeable->xusub, *usub = Glu_freeable->usub;
+    int_t nsupers = supno[n-1] + 1;
+    int_t i, j, k, gb, jb, fsupc, nsupc, nl, nu, ne, last;
+    int_t *uptr, *ucnt, *mark, *pos, *succ;
+    tg_block_t *ublk, *lblk;
+    double fw = is_complex ? 4.0 : 1.0, w, mL, nnzU, maxU, maxL;
+    FILE *fp;
+
+    if ( !(fp = fopen(fname, "w")) ) {
+	fprintf(stderr, "Cannot open task graph file %s\n", fname);
+	return -1;
+    }
+
+    /* Transpose the column segments of U into block rows. */
+    if ( !(uptr = intCalloc_dist(2 * nsupers + 2)) )
+	ABORT("Malloc fails for uptr[].");
+    ucnt = uptr + nsupers + 1;
+    for (j = 0; j < n; ++j)
+	for (i = xusub[j]; i < xusub[j+1]; ++i) ++uptr[supno[usub[i]] + 1];
+    for (k = 0; k < nsupers; ++k) uptr[k+1] += uptr[k];
+    ublk = (tg_block_t *) SUPERLU_MALLOC(SUPERLU_MAX(uptr[nsupers], 1)
+					 * sizeof(tg_block_t));
+    if ( !ublk ) ABORT("Malloc fails for ublk[].");
+    for (j = 0; j < n; ++j) {
+	jb = supno[j];
+	for (i = xusub[j]; i < xusub[j+1]; ++i) {
+	    gb = supno[usub[i]];
+	    last = uptr[gb] + ucnt[gb] - 1;
+	    if ( ucnt[gb] && ublk[last].blk == jb ) { /* same U(gb,jb) */
+		ublk[last].len += xsup[gb+1] - usub[i];
+	    } else {
+		ublk[last+1].blk = jb;
+		ublk[last+1].len = xsup[gb+1] - usub[i];
+		++ucnt[gb];
+	    }
+	}
+    }
+
+    if ( !(mark = intMalloc_dist(3 * nsupers)) )
+	ABORT("Malloc fails for mark[].");
+    pos = mark + nsupers;
+    succ = pos + nsupers;
+    for (k = 0; k < nsupers; ++k) mark[k] = -1;
+    lblk = (tg_block_t *) SUPERLU_MALLOC(nsupers * sizeof(tg_block_t));
+    if ( !lblk ) ABORT("Malloc fails for lblk[].");
+
+    fprintf(fp, "# SuperLU_DIST task graph, version 1\n");
+    fprintf(fp, "n " IFMT " nsupers " IFMT " dsize %d complex %d "
+	    "nprow %d npcol %d npdep %d\n",
+	    n, nsupers, dsize, is_complex, nprow, npcol, npdep);
+
+    for (k = 0; k < nsupers; ++k) {
+	fsupc = xsup[k];
+	nsupc = xsup[k+1] - fsupc;
+
+	/* Row blocks of L(:,k) below the diagonal block. */
+	nl = 0;
+	for (i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i) {
+	    gb = supno[lsub[i]];
+	    if ( gb == k ) continue;
+	    if ( mark[gb] != k ) {
+		mark[gb] = k;
+		pos[gb] = nl;
+		lblk[nl].blk = gb;
+		lblk[nl++].len = 0;
+	    }
+	    ++lblk[pos[gb]].len;
+	}
+	qsort(lblk, nl, sizeof(tg_block_t), tg_cmp);
+	nu = ucnt[k];
+	qsort(&ublk[uptr[k]], nu, sizeof(tg_block_t), tg_cmp);
+
+	w = nsupc;
+	mL = nnzU = 0.;
+	for (i = 0; i < nl; ++i) mL += lblk[i].len;
+	for (i = 0; i < nu; ++i) nnzU += ublk[uptr[k] + i].len;
+	maxL = nl ? lblk[nl-1].blk : -1;
+	maxU = nu ? ublk[uptr[k] + nu - 1].blk : -1;
+
+	/* Block (i,j) of the update belongs to panel min(i,j). */
+	ne = 0;
+	for (i = 0, j = 0; i < nl || j < nu; ) {
+	    int_t bi = i < nl ? lblk[i].blk : nsupers;
+	    int_t bj = j < nu ? ublk[uptr[k] + j].blk : nsupers;
+	    if ( bi <= bj ) {
+		if ( bi <= maxU ) succ[ne++] = bi;
+		++i;
+		if ( bi == bj ) ++j;
+	    } else {
+		if ( bj <= maxL ) succ[ne++] = bj;
+		++j;
+	    }
+	}
+
+	j = etree[xsup[k+1] - 1];
+	fprintf(fp, "s " IFMT " " IFMT " " IFMT " " IFMT " " IFMT
+		" %.6e %.6e %.6e %.6e\n",
+		k, fsupc, nsupc, j < n ? supno[j] : -1,
+		supernode2treeMap ? supernode2treeMap[k] : 0,
+		fw * (2. / 3. * w * w * w + w * w * mL + w * nnzU),
+		fw * 2. * mL * nnzU,
+		(w + mL) * w * dsize, nnzU * dsize);
+	fprintf(fp, "l " IFMT, nl);
+	for (i = 0; i < nl; ++i)
+	    fprintf(fp, " " IFMT " " IFMT, lblk[i].blk, lblk[i].len);
+	fprintf(fp, "\nu " IFMT, nu);
+	for (i = 0; i < nu; ++i)
+	    fprintf(fp, " " IFMT " " IFMT, ublk[uptr[k] + i].blk,
+		    ublk[uptr[k] + i].len);
+	fprintf(fp, "\ne " IFMT, ne);
+	for (i = 0; i < ne; ++i) fprintf(fp, " " IFMT, succ[i]);
+	fprintf(fp, "\n");
+    }
+
+    SUPERLU_FREE(lblk);
+    SUPERLU_FREE(mark);
+    SUPERLU_FREE(ublk);
+    SUPERLU_FREE(uptr);
+    return fclose(fp) ? -1 : 0;
+} /* superlu_write_taskgraph */
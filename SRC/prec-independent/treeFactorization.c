@@ -82,6 +82,7 @@ int_t initFactStat(int nsupers, factStat_t* factStat)
     factStat->IbcastPanel_L = int32Malloc_dist(nsupers); //INT_T_ALLOC(nsupers);
     factStat->IbcastPanel_U = int32Malloc_dist(nsupers); //INT_T_ALLOC(nsupers);
     factStat->gpuLUreduced = int32Malloc_dist(nsupers); //INT_T_ALLOC(nsupers);
+    factStat->frontDone = int32Malloc_dist(nsupers);
 
     for (int i = 0; i < nsupers; ++i)
     {
@@ -93,6 +94,7 @@ int_t initFactStat(int nsupers, factStat_t* factStat)
         factStat->IbcastPanel_L[i] = 0;
         factStat->IbcastPanel_U[i] = 0;
         factStat->gpuLUreduced[i] = 0;
+        factStat->frontDone[i] = 0;
     }
     return 0;
 }
@@ -107,6 +109,7 @@ int freeFactStat(factStat_t* factStat)
     SUPERLU_FREE(factStat->IbcastPanel_L);
     SUPERLU_FREE(factStat->IbcastPanel_U);
     SUPERLU_FREE(factStat->gpuLUreduced);
+    SUPERLU_FREE(factStat->frontDone);
     return 0;
 }
 
@@ -186,12 +189,12 @@ int freePackLUInfo(packLUInfo_t* packLUInfo)  // sherry added
 int_t getNumLookAhead(superlu_dist_options_t *options)
 {
     int_t numLA;
-    if (getenv("SUPERLU_NUM_LOOKAHEADS"))
+    if (superlu_getenv_dist("SUPERLU_NUM_LOOKAHEADS", options))
     {
-        numLA = atoi(getenv("SUPERLU_NUM_LOOKAHEADS"));
-    }else if (getenv("NUM_LOOKAHEADS"))
+        numLA = atoi(superlu_getenv_dist("SUPERLU_NUM_LOOKAHEADS", options));
+    }else if (superlu_getenv_dist("NUM_LOOKAHEADS", options))
     {
-        numLA = atoi(getenv("NUM_LOOKAHEADS"));
+        numLA = atoi(superlu_getenv_dist("NUM_LOOKAHEADS", options));
     }
     else
     {
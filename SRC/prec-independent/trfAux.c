@@ -2304,7 +2304,7 @@ int_t Trs2_InitUblock_info(int_t klst, int_t nb,
 
 void getSCUweight(int_t nsupers, treeList_t* treeList, int_t* xsup,
 		  int_t** Lrowind_bc_ptr, int_t** Ufstnz_br_ptr,
-		  gridinfo3d_t * grid3d
+		  gridinfo3d_t * grid3d, const superlu_costmodel_t *cm
 		  )
 {
     gridinfo_t* grid = &(grid3d->grid2d);
@@ -2369,7 +2369,11 @@ void getSCUweight(int_t nsupers, treeList_t* treeList, int_t* xsup,
 
         treeList[k].scuWeight = 0.0;
         int_t ksupc = SuperSize(k);
-        treeList[k].scuWeight = 1.0 * ksupc * mylsize[k] * myusize[k];
+        if ( superlu_costmodel_active(cm) ) /* in ns, it is sent as int_t */
+            treeList[k].scuWeight = 1.0e9 * superlu_costmodel_schur(cm, mylsize[k],
+                                                myusize[k], ksupc);
+        else
+            treeList[k].scuWeight = 1.0 * ksupc * mylsize[k] * myusize[k];
     }
 
     SUPERLU_FREE(mylsize);
@@ -2381,7 +2385,7 @@ void getSCUweight(int_t nsupers, treeList_t* treeList, int_t* xsup,
 
 void getSCUweight_allgrid(int_t nsupers, treeList_t* treeList, int_t* xsup,
 		  int_t** Lrowind_bc_ptr, int_t** Ufstnz_br_ptr,
-		  gridinfo3d_t * grid3d
+		  gridinfo3d_t * grid3d, const superlu_costmodel_t *cm
 		  )
 {
     gridinfo_t* grid = &(grid3d->grid2d);
@@ -2492,7 +2496,11 @@ void getSCUweight_allgrid(int_t nsupers, treeList_t* treeList, int_t* xsup,
 
         treeList[k].scuWeight = 0.0;
         int_t ksupc = SuperSize(k);
-        treeList[k].scuWeight = 1.0 * ksupc * mylsize[k] * myusize[k];
+        if ( superlu_costmodel_active(cm) ) /* in ns, it is sent as int_t */
+            treeList[k].scuWeight = 1.0e9 * superlu_costmodel_schur(cm, mylsize[k],
+                                                myusize[k], ksupc);
+        else
+            treeList[k].scuWeight = 1.0 * ksupc * mylsize[k] * myusize[k];
     }
 
     SUPERLU_FREE(mylsize);
@@ -2542,11 +2550,12 @@ void applyRowPerm(int_t* colptr, int_t* rowind, int_t* perm_r, int_t n) {
  * @param Glu_freeable Pointer to the structure which tracks the space used to store L/U data structures.
  * @param stat Information on program execution.
  * @param grid3d The 3D process grid. 
+ * @param cm The cost model of amalgamation and splitting, or NULL.
  */
 void permCol_SymbolicFact3d(superlu_dist_options_t *options, int n, SuperMatrix *GA, int_t *perm_c, int_t *etree, 
                            Glu_persist_t *Glu_persist, Glu_freeable_t *Glu_freeable, SuperLUStat_t *stat,
 						   superlu_dist_mem_usage_t*symb_mem_usage,
-						   gridinfo3d_t* grid3d)
+						   gridinfo3d_t* grid3d, const superlu_costmodel_t *cm)
 {
     SuperMatrix GAC; /* Global A in NCP format */
     NCPformat *GACstore;
@@ -2583,6 +2592,12 @@ void permCol_SymbolicFact3d(superlu_dist_options_t *options, int n, SuperMatrix
 	iinfo = ilu_level_symbfact(options, &GAC, perm_c, etree, Glu_persist, Glu_freeable);
     } else {
 	iinfo = symbfact(options, iam, &GAC, perm_c, etree, Glu_persist, Glu_freeable);
+	if ( iinfo <= 0 && sp_ienv_dist(20, options) > 0 )
+	    superlu_amalgamate(options, n, etree, Glu_persist, Glu_freeable,
+			       cm, iam);
+	if ( iinfo <= 0 && sp_ienv_dist(21, options) > 0 )
+	    superlu_split_supernodes(options, n, Glu_persist, Glu_freeable, cm,
+				     grid3d->nprow, grid3d->npcol, iam);
     }
     
     stat->utime[SYMBFAC] = SuperLU_timer_() - t;
@@ -2768,7 +2783,7 @@ sForest_t **compute_sForests(int_t nsupers,  Glu_persist_t *Glu_persist, int_t *
     treeList_t *treeList = setree2list(nsupers, setree);
 
     // Calculation of tree weight
-    calcTreeWeight(nsupers, setree, treeList, Glu_persist->xsup);
+    calcTreeWeight(nsupers, setree, treeList, Glu_persist->xsup, NULL);
 
     // Calculation of maximum level
     int_t maxLvl = log2i(grid3d->zscp.Np) + 1;
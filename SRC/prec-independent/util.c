@@ -204,6 +204,32 @@ fixupL_dist(const int_t n, const int_t *perm_r,
     return lsub_size;
 } /* fixupL_dist */
 
+/*! \brief Return getenv(name), or NULL when options->ReadEnv == NO.
+ *
+ * The tuning variables of sp_ienv_dist() and the look-ahead depth are
+ * read through here, so a caller can make a solve depend on its own
+ * options structure only.  It lives here rather than in sp_ienv.c,
+ * which users may replace with their own sp_ienv_dist().
+ */
+char *
+superlu_getenv_dist(const char *name, superlu_dist_options_t *options)
+{
+    if ( options && options->ReadEnv == NO ) return NULL;
+    return getenv(name);
+}
+
+/*! \brief Whether the 3D solve takes B and returns X on the 3D grid.
+ *
+ * True when sp_ienv_dist(17) > 0, without iterative refinement and
+ * with Trans = NOTRANS; see p?gstrs3d().
+ */
+int
+superlu_solve_rhs3d(superlu_dist_options_t *options)
+{
+    return sp_ienv_dist(17, options) > 0
+	   && options->IterRefine == NOREFINE && options->Trans == NOTRANS;
+}
+
 /*! \brief Set the default values for the options argument.
  */
 void set_default_options_dist(superlu_dist_options_t *options)
@@ -233,6 +259,22 @@ void set_default_options_dist(superlu_dist_options_t *options)
     options->superlu_acc_offload = 1;
     options->superlu_n_gemm = 5000;
     options->superlu_max_buffer_size = 256000000;
+    options->superlu_mem_budget = 0;
+    options->superlu_propmap = 0;
+    options->superlu_lookahead_adapt = 0;
+    options->superlu_msg_priority = 0;
+    options->superlu_progress = 0;
+    options->superlu_rhs3d = 0;
+    options->superlu_ruiz = 0;
+    options->superlu_costmodel = 0;
+    options->superlu_amalg = 0;
+    options->superlu_split = 0;
+    options->superlu_mf = 0;
+    options->superlu_dense = 0;
+    options->superlu_blocks = 0;
+    options->superlu_subset = 0;
+    options->superlu_cpu_batch = 0;
+    options->ReadEnv = YES;
     options->superlu_num_gpu_streams = 8;
     options->batchCount = 0;
     options->SymPattern = NO;
@@ -269,12 +311,28 @@ void print_options_dist(superlu_dist_options_t *options)
     printf("**    lookahead_etree           : %4d\n", options->lookahead_etree);
     printf("**    Use_TensorCore            : %4d\n", options->Use_TensorCore);
     printf("**    Use 3D algorithm          : %4d\n", options->Algo3d);
+    printf("**    ReadEnv                   : %4d\n", options->ReadEnv);
     printf("** parameters that can be altered by environment variables:\n");
     printf("**    superlu_relax             : %4d\n", sp_ienv_dist(2, options));
     printf("**    superlu_maxsup            : %4d\n", sp_ienv_dist(3, options));
     printf("**    min GEMM m*k*n to use GPU : %d\n", sp_ienv_dist(7, options));
     printf("**    GPU buffer size           : %10d\n", sp_ienv_dist(8, options));
     printf("**    GPU streams               : %4d\n", sp_ienv_dist(9, options));
+    printf("**    memory budget (MB)        : %4d\n", sp_ienv_dist(12, options));
+    printf("**    proportional mapping      : %4d\n", sp_ienv_dist(13, options));
+    printf("**    adaptive look-ahead       : %4d\n", sp_ienv_dist(14, options));
+    printf("**    message priority          : %4d\n", sp_ienv_dist(15, options));
+    printf("**    progress thread (us)      : %4d\n", sp_ienv_dist(16, options));
+    printf("**    RHS on 3D grid            : %4d\n", sp_ienv_dist(17, options));
+    printf("**    Ruiz equilibration sweeps : %4d\n", sp_ienv_dist(18, options));
+    printf("**    Calibrated cost model     : %4d\n", sp_ienv_dist(19, options));
+    printf("**    amalgamation fill (%%)     : %4d\n", sp_ienv_dist(20, options));
+    printf("**    grid-aware splitting      : %4d\n", sp_ienv_dist(21, options));
+    printf("**    leaf front size (KB)      : %4d\n", sp_ienv_dist(22, options));
+    printf("**    dense row/col threshold   : %4d\n", sp_ienv_dist(23, options));
+    printf("**    decoupled block ordering  : %4d\n", sp_ienv_dist(24, options));
+    printf("**    SamePattern subset reuse  : %4d\n", sp_ienv_dist(25, options));
+    printf("**    level-batched CPU factor  : %4d\n", sp_ienv_dist(26, options));
     printf("**    estimated fill ratio      : %4d\n", sp_ienv_dist(6, options));
     printf("**************************************************\n");
 }
@@ -355,6 +413,7 @@ void PStatInit(SuperLUStat_t *stat)
     stat->TinyPivots = stat->RefineSteps = 0;
     stat->current_buffer = stat->peak_buffer = 0.0;
     stat->gpu_buffer = 0.0;
+    stat->prof = NULL;
 }
 
 void PStatClear(SuperLUStat_t *stat)
@@ -378,6 +437,8 @@ void PStatPrint(superlu_dist_options_t *options, SuperLUStat_t *stat, gridinfo_t
     int_t iam = grid->iam;
     flops_t factflop, solveflop;
 
+    superlu_prof_report(stat, grid->comm);
+
     if (options->PrintStat == NO)
         return;
 
@@ -546,6 +607,7 @@ void PStatFree(SuperLUStat_t *stat)
 {
     SUPERLU_FREE(stat->utime);
     SUPERLU_FREE(stat->ops);
+    superlu_prof_free(stat);
 }
 
 /*! \brief Fills an integer array with a given value.
@@ -602,11 +664,11 @@ void get_diag_procs(int_t n, Glu_persist_t *Glu_persist, gridinfo_t *grid,
 /*! \brief Get the statistics of the supernodes 
  */
 #define NBUCKS 10
-static int max_sup_size;
 
 void super_stats_dist(int_t nsuper, int_t *xsup)
 {
     register int nsup1 = 0;
+    int max_sup_size;
     int_t i, isize, whichb, bl, bh;
     int_t bucket[NBUCKS];
 
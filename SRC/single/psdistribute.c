@@ -325,6 +325,188 @@ sReDistribute_A(SuperMatrix *A, sScalePermstruct_t *ScalePermstruct,
     return 0;
 } /* sReDistribute_A */
 
+/*! \brief Load the entries of A in block column jb into L(:,jb).
+ *
+ * <pre>
+ * index[] holds the row subscripts of the local part of L(:,jb) and
+ * lusup[] (leading dimension index[1]) is overwritten; positions not
+ * present in A are set to zero, and entries of A outside the L pattern
+ * are ignored.  rowpos[] (size ldaspa) maps the local
+ * row number ilsum[lb] + irow - FstBlockC(gb) to a row of lusup[]; it
+ * must be SLU_EMPTY on entry and is restored on exit, so threads may
+ * load different block columns concurrently with private rowpos[].
+ * </pre>
+ */
+void
+sload_A_to_L(int_t jb, int_t *index, float *lusup, int_t *rowpos,
+	     int_t *ilsum, int_t *xa, int_t *asub, float *a,
+	     Glu_persist_t *Glu_persist, gridinfo_t *grid)
+{
+    int_t *xsup = Glu_persist->xsup;
+    int_t *supno = Glu_persist->supno;
+    int myrow = MYROW( grid->iam, grid );
+    int_t fsupc = FstBlockC( jb ), nsupc = SuperSize( jb );
+    int_t nrbl = index[0], len = index[1];
+    int_t next_lind, next_lval = 0;
+    int_t gb, lb, nbrow, irow, i, j, jj, k;
+    float zero = 0.0;
+
+    next_lind = BC_HEADER;
+    for (jj = 0; jj < nrbl; ++jj) {
+	gb = index[next_lind++];
+	nbrow = index[next_lind++];
+	lb = LBi( gb, grid );
+	for (k = 0; k < nbrow; ++k) {
+	    irow = index[next_lind++];
+	    rowpos[ilsum[lb] + irow - FstBlockC( gb )] = next_lval++;
+	}
+    }
+
+    for (i = 0; i < len * nsupc; ++i) lusup[i] = zero;
+    for (j = fsupc; j < fsupc + nsupc; ++j) {
+	for (i = xa[j]; i < xa[j+1]; ++i) {
+	    irow = asub[i];
+	    gb = BlockNum( irow );
+	    if ( gb >= jb && myrow == PROW( gb, grid ) ) {
+		lb = LBi( gb, grid );
+		k = rowpos[ilsum[lb] + irow - FstBlockC( gb )];
+		if ( k != SLU_EMPTY ) /* else outside the L pattern */
+		    lusup[k + (j - fsupc) * len] = a[i];
+	    }
+	}
+    }
+
+    next_lind = BC_HEADER;
+    for (jj = 0; jj < nrbl; ++jj) {
+	gb = index[next_lind++];
+	nbrow = index[next_lind++];
+	lb = LBi( gb, grid );
+	for (k = 0; k < nbrow; ++k) {
+	    irow = index[next_lind++];
+	    rowpos[ilsum[lb] + irow - FstBlockC( gb )] = SLU_EMPTY;
+	}
+    }
+} /* sload_A_to_L */
+
+/*! \brief Count the entries of A outside the existing L and U structure.
+ *
+ * <pre>
+ * A is permuted by the perm_r[] and perm_c[] of ScalePermstruct, as in
+ * pddistribute(), and each entry is looked up in the L and U blocks held
+ * by LUstruct.  Explicit zeros and fill of L and U hold new entries as
+ * well.  A is unchanged on exit.  Returns the number of entries of A,
+ * summed over the grid, that have no place in L or U; if it is zero,
+ * A can be factored with Fact = SamePattern_SameRowPerm.
+ * </pre>
+ */
+int_t
+pscheck_LU_pattern(SuperMatrix *A, sScalePermstruct_t *ScalePermstruct,
+		   sLUstruct_t *LUstruct, gridinfo_t *grid)
+{
+    Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
+    sLocalLU_t *Llu = LUstruct->Llu;
+    int_t *xsup = Glu_persist->xsup;
+    int_t *supno = Glu_persist->supno;
+    NRformat_loc *Astore = (NRformat_loc *) A->Store;
+    int_t *perm_c = ScalePermstruct->perm_c;
+    int_t *ilsum = Llu->ilsum;
+    int_t *colind, *xa, *asub, *index, *mark, *Urb_indptr, *Urb_nb;
+    int_t n = A->ncol, nnz_loc = Astore->nnz_loc;
+    int_t nsupers, nrbu, jb, ljb, lb, gb, fsupc, irow, i, j, k, jj, nmiss = 0;
+    int_t nmiss_tot;
+    float *a;
+    int iam = grid->iam;
+    int myrow = MYROW( iam, grid ), mycol = MYCOL( iam, grid );
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Enter pscheck_LU_pattern()");
+#endif
+    nsupers = supno[n-1] + 1;
+
+    /* Redistribute Pc*Pr*A*Pc^T, then restore the column indices. */
+    if ( !(colind = intMalloc_dist(SUPERLU_MAX(nnz_loc, 1))) )
+	ABORT("Malloc fails for colind[].");
+    for (i = 0; i < nnz_loc; ++i) {
+	colind[i] = Astore->colind[i];
+	Astore->colind[i] = perm_c[colind[i]];
+    }
+    xa = asub = NULL;
+    a = NULL;
+    sReDistribute_A(A, ScalePermstruct, NULL, xsup, supno, grid,
+		    &xa, &asub, &a);
+    for (i = 0; i < nnz_loc; ++i) Astore->colind[i] = colind[i];
+    SUPERLU_FREE(colind);
+
+    nrbu = CEILING( nsupers, grid->nprow ); /* No. of local block rows */
+    if ( !(mark = intMalloc_dist(Llu->ldalsum + 2 * nrbu + 1)) )
+	ABORT("Malloc fails for mark[].");
+    Urb_indptr = mark + Llu->ldalsum;
+    Urb_nb = Urb_indptr + nrbu;
+    for (i = 0; i < Llu->ldalsum; ++i) mark[i] = SLU_EMPTY;
+    for (lb = 0; lb < nrbu; ++lb) {
+	Urb_indptr[lb] = BR_HEADER;
+	Urb_nb[lb] = 0;
+    }
+
+    for (jb = mycol; jb < nsupers; jb += grid->npcol) {
+	ljb = LBj( jb, grid );
+	fsupc = FstBlockC( jb );
+
+	/* Mark the rows of L(:,jb). */
+	if ( (index = Llu->Lrowind_bc_ptr[ljb]) ) {
+	    for (jj = 0, k = BC_HEADER; jj < index[0]; ++jj) {
+		gb = index[k];
+		lb = LBi( gb, grid );
+		for (i = 0; i < index[k+1]; ++i)
+		    mark[ilsum[lb] + index[k+LB_DESCRIPTOR+i] - FstBlockC( gb )]
+			= jb;
+		k += LB_DESCRIPTOR + index[k+1];
+	    }
+	}
+
+	for (j = fsupc; j < FstBlockC( jb+1 ); ++j) {
+	    for (i = xa[j]; i < xa[j+1]; ++i) {
+		irow = asub[i];
+		gb = BlockNum( irow );
+		if ( myrow != PROW( gb, grid ) ) continue;
+		lb = LBi( gb, grid );
+		if ( gb >= jb ) { /* in L */
+		    if ( mark[ilsum[lb] + irow - FstBlockC( gb )] != jb )
+			++nmiss;
+		    continue;
+		}
+		/* In U: find block jb in block row gb, which lists its
+		   blocks in increasing order, then the column's first
+		   nonzero row. */
+		index = Llu->Ufstnz_br_ptr[lb];
+		if ( !index ) {
+		    ++nmiss;
+		    continue;
+		}
+		while ( Urb_nb[lb] < index[0] && (k = index[Urb_indptr[lb]]) < jb ) {
+		    Urb_indptr[lb] += UB_DESCRIPTOR + SuperSize( k );
+		    ++Urb_nb[lb];
+		}
+		if ( Urb_nb[lb] == index[0] || index[Urb_indptr[lb]] != jb
+		     || irow < index[Urb_indptr[lb] + UB_DESCRIPTOR + j - fsupc] )
+		    ++nmiss;
+	    }
+	}
+    }
+
+    SUPERLU_FREE(mark);
+    SUPERLU_FREE(xa);
+    if ( asub ) SUPERLU_FREE(asub);
+    if ( a ) SUPERLU_FREE(a);
+
+    MPI_Allreduce( &nmiss, &nmiss_tot, 1, mpi_int_t, MPI_SUM, grid->comm );
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC(iam, "Exit pscheck_LU_pattern()");
+#endif
+    return nmiss_tot;
+} /* pscheck_LU_pattern */
+
 float
 psdistribute(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 	     sScalePermstruct_t *ScalePermstruct,
@@ -547,8 +729,6 @@ psdistribute(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 	   L and U data structures.            */
 	ilsum = Llu->ilsum;
 	ldaspa = Llu->ldalsum;
-	if ( !(dense = floatCalloc_dist(ldaspa * sp_ienv_dist(3, options))) )
-	    ABORT("Calloc fails for SPA dense[].");
 	nrbu = CEILING( nsupers, grid->nprow ); /* No. of local block rows */
 	if ( !(Urb_length = intCalloc_dist(nrbu)) )
 	    ABORT("Calloc fails for Urb_length[].");
@@ -561,13 +741,16 @@ psdistribute(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 	Unzval_br_ptr = Llu->Unzval_br_ptr;
 	Unnz = Llu->Unnz;
 
-	mem_use += 2.0*nrbu*iword + ldaspa*sp_ienv_dist(3, options)*dword;
+	mem_use += 2.0*nrbu*iword;
 
 #if ( PROFlevel>=1 )
 	t = SuperLU_timer_();
 #endif
 
 	/* Initialize Uval to zero. */
+#ifdef _OPENMP
+#pragma omp parallel for private(i, index, uval, len) schedule(dynamic, 16)
+#endif
 	for (lb = 0; lb < nrbu; ++lb) {
 	    Urb_indptr[lb] = BR_HEADER; /* Skip header in U index[]. */
 	    index = Ufstnz_br_ptr[lb];
@@ -582,10 +765,10 @@ psdistribute(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 	    pc = PCOL( jb, grid );
 	    if ( mycol == pc ) { /* Block column jb in my process column */
 		fsupc = FstBlockC( jb );
-		nsupc = SuperSize( jb );
 
- 		/* Scatter A into SPA (for L), or into U directly. */
-		for (j = fsupc, dense_col = dense; j < FstBlockC(jb+1); ++j) {
+ 		/* Scatter the U part of A into U directly; L is loaded
+		   below, one block column per thread. */
+		for (j = fsupc; j < FstBlockC(jb+1); ++j) {
 		    for (i = xa[j]; i < xa[j+1]; ++i) {
 			irow = asub[i];
 			gb = BlockNum( irow );
@@ -612,53 +795,43 @@ psdistribute(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 				    len += fsupc1 - index[istart++];
 				/*assert(irow>=index[istart]);*/
 				uval[len + irow - index[istart]] = a[i];
-			    } else { /* in L; put in SPA first */
-  				irow = ilsum[lb] + irow - FstBlockC( gb );
-  				dense_col[irow] = a[i];
-  			    }
+			    }
   			}
 		    } /* for i ... */
-  		    dense_col += ldaspa;
 		} /* for j ... */
+	    } /* if mycol == pc */
+	} /* for jb ... */
 
 #if ( PROFlevel>=1 )
-		t_u += SuperLU_timer_() - t;
-		t = SuperLU_timer_();
+	t_u += SuperLU_timer_() - t;
+	t = SuperLU_timer_();
 #endif
 
-		/* Gather the values of A from SPA into Lnzval[]. */
-		ljb = LBj( jb, grid ); /* Local block number */
-		index = Lrowind_bc_ptr[ljb];
-		if ( index ) {
-		    nrbl = index[0];   /* Number of row blocks. */
-		    len = index[1];    /* LDA of lusup[]. */
-		    lusup = Lnzval_bc_ptr[ljb];
-		    next_lind = BC_HEADER;
-		    next_lval = 0;
-		    for (jj = 0; jj < nrbl; ++jj) {
-			gb = index[next_lind++];
-			len1 = index[next_lind++]; /* Rows in the block. */
-			lb = LBi( gb, grid );
-			for (bnnz = 0; bnnz < len1; ++bnnz) {
-			    irow = index[next_lind++]; /* Global index. */
-			    irow = ilsum[lb] + irow - FstBlockC( gb );
-			    k = next_lval++;
-			    for (j = 0, dense_col = dense; j < nsupc; ++j) {
-				lusup[k] = dense_col[irow];
-				dense_col[irow] = zero;
-				k += len;
-				dense_col += ldaspa;
-			    }
-			} /* for bnnz ... */
-		    } /* for jj ... */
-		} /* if index ... */
+	/* Load the values of A into the existing L block columns. */
+	k = CEILING( nsupers, grid->npcol ); /* Number of local block columns */
+#ifdef _OPENMP
+#pragma omp parallel private(i, jb, ljb)
+#endif
+	{
+	    int_t *rowpos;
+	    if ( !(rowpos = intMalloc_dist(ldaspa)) )
+		ABORT("Malloc fails for rowpos[].");
+	    for (i = 0; i < ldaspa; ++i) rowpos[i] = SLU_EMPTY;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+	    for (ljb = 0; ljb < k; ++ljb) {
+		jb = ljb * grid->npcol + mycol;
+		if ( jb < nsupers && Lrowind_bc_ptr[ljb] )
+		    sload_A_to_L(jb, Lrowind_bc_ptr[ljb], Lnzval_bc_ptr[ljb],
+				 rowpos, ilsum, xa, asub, a, Glu_persist, grid);
+	    }
+	    SUPERLU_FREE(rowpos);
+	}
 #if ( PROFlevel>=1 )
-		t_l += SuperLU_timer_() - t;
+	t_l += SuperLU_timer_() - t;
 #endif
-	    } /* if mycol == pc */
-	} /* for jb ... */
 
-	SUPERLU_FREE(dense);
 	SUPERLU_FREE(Urb_length);
 	SUPERLU_FREE(Urb_indptr);
 #if ( PROFlevel>=1 )
@@ -838,17 +1011,7 @@ psdistribute(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 
         mem_use -= 2.0*k * iword;
 
-	/* Auxiliary arrays used to set up L block data structures.
-	   They are freed on return.
-	   k is the number of local row blocks.   */
-	if ( !(Lrb_length = intCalloc_dist(k)) )
-	    ABORT("Calloc fails for Lrb_length[].");
-	if ( !(Lrb_number = intMalloc_dist(k)) )
-	    ABORT("Malloc fails for Lrb_number[].");
-	if ( !(Lrb_indptr = intMalloc_dist(k)) )
-	    ABORT("Malloc fails for Lrb_indptr[].");
-	if ( !(Lrb_valptr = intMalloc_dist(k)) )
-	    ABORT("Malloc fails for Lrb_valptr[].");
+	/* SPA for the U part of A; k is the number of local row blocks. */
 	if ( !(dense = floatCalloc_dist(ldaspa * sp_ienv_dist(3, options))) )
 	    ABORT("Calloc fails for SPA dense[].");
 
@@ -955,12 +1118,13 @@ psdistribute(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 		nsupc = SuperSize( jb );
 		ljb = LBj( jb, grid ); /* Local block number */
 
-		/* Scatter A into SPA. */
+		/* Scatter the U part of A into SPA; L is loaded from A
+		   directly when its block column is set up below. */
 		for (j = fsupc, dense_col = dense; j < FstBlockC(jb+1); ++j) {
 		    for (i = xa[j]; i < xa[j+1]; ++i) {
 			irow = asub[i];
 			gb = BlockNum( irow );
-			if ( myrow == PROW( gb, grid ) ) {
+			if ( gb < jb && myrow == PROW( gb, grid ) ) {
 			    lb = LBi( gb, grid );
 			    irow = ilsum[lb] + irow - FstBlockC( gb );
 			    dense_col[irow] = a[i];
@@ -1042,15 +1206,10 @@ psdistribute(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 		t = SuperLU_timer_();
 #endif
 		/*------------------------------------------------
-		 * SET UP L BLOCKS.
+		 * COUNT L BLOCKS AND MESSAGES FOR THE SOLVE.
 		 *------------------------------------------------*/
-
-		/* Count number of blocks and length of each block. */
-		nrbl = 0;
-		len = 0; /* Number of row subscripts I own. */
 		kseen = 0;
-		istart = xlsub[fsupc];
-		for (i = istart; i < xlsub[fsupc+1]; ++i) {
+		for (i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i) {
 		    irow = lsub[i];
 		    gb = BlockNum( irow ); /* Global block number */
 		    pr = PROW( gb, grid ); /* Process row owning this block */
@@ -1064,8 +1223,6 @@ psdistribute(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 			lb = LBi( gb, grid );  /* Local block number */
 			if (rb_marker[lb] <= jb) { /* First see this block */
 			    rb_marker[lb] = jb + 1;
-			    Lrb_length[lb] = 1;
-			    Lrb_number[nrbl++] = gb;
 			    if ( gb != jb ) /* Exclude diagonal block. */
 				++fmod[lb]; /* Mod. count for forward solve */
 			    if ( kseen == 0 && myrow != jbrow ) {
@@ -1075,9 +1232,60 @@ psdistribute(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 #if ( PRNTlevel>=1 )
 			    ++nLblocks;
 #endif
-			} else {
-			    ++Lrb_length[lb];
 			}
+		    }
+		} /* for i ... */
+	    } /* if mycol == pc */
+	} /* for jb ... */
+
+#if ( PROFlevel>=1 )
+	t = SuperLU_timer_();
+#endif
+	/*------------------------------------------------
+	 * SET UP L BLOCKS.
+	 * Block columns are independent: each thread builds its own
+	 * with private scratch arrays, and is the first to touch the
+	 * index[] and nzval[] it allocates.
+	 *------------------------------------------------*/
+	k = CEILING( nsupers, grid->npcol ); /* Number of local block columns */
+	nrbu = CEILING( nsupers, grid->nprow ); /* Number of local block rows */
+#ifdef _OPENMP
+#pragma omp parallel private(i, j, jb, jj, ljb, fsupc, nsupc, nrbl, len, \
+	len1, gb, lb, irow, istart, next_lind, next_lval, index, lusup, \
+	index_srt, idx_indx, idx_lusup, nbrow, uu, lloc, krow, \
+	Lrb_length, Lrb_number, Lrb_indptr)
+#endif
+	{
+	    int_t *rowpos, thr_bufmax[3] = {0, 0, 0};
+	    float thr_memTRS = 0.0;
+
+	    if ( !(Lrb_length = intCalloc_dist(3 * nrbu + ldaspa)) )
+		ABORT("Calloc fails for Lrb_length[].");
+	    Lrb_number = Lrb_length + nrbu;
+	    Lrb_indptr = Lrb_number + nrbu;
+	    rowpos = Lrb_indptr + nrbu;
+	    for (i = 0; i < ldaspa; ++i) rowpos[i] = SLU_EMPTY;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+	    for (ljb = 0; ljb < k; ++ljb) {
+		jb = ljb * grid->npcol + mycol; /* Global block number */
+		if ( jb >= nsupers ) continue;
+		fsupc = FstBlockC( jb );
+		nsupc = SuperSize( jb );
+
+		/* Count number of blocks and length of each block. */
+		nrbl = 0;
+		len = 0; /* Number of row subscripts I own. */
+		istart = xlsub[fsupc];
+		for (i = istart; i < xlsub[fsupc+1]; ++i) {
+		    gb = BlockNum( lsub[i] );
+		    if ( myrow == PROW( gb, grid ) ) {
+			lb = LBi( gb, grid );
+			if ( Lrb_length[lb] == 0 ) /* First see this block */
+			    Lrb_number[nrbl++] = gb;
+			++Lrb_length[lb];
 			++len;
 		    }
 		} /* for i ... */
@@ -1089,164 +1297,116 @@ psdistribute(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 		    len1 = len + BC_HEADER + nrbl * LB_DESCRIPTOR;
 		    if ( !(index = intMalloc_dist(len1)) )
 			ABORT("Malloc fails for index[]");
-		    // Lrowind_bc_offset[ljb]=len1;
-   		    // Lrowind_bc_cnt += Lrowind_bc_offset[ljb];
-
-		    if (!(lusup = (float*)SUPERLU_MALLOC(len*nsupc * sizeof(float))))
-			ABORT("Malloc fails for lusup[]");
-		    // Lnzval_bc_offset[ljb]=len*nsupc;
-     		// Lnzval_bc_cnt += Lnzval_bc_offset[ljb];
 		    if ( !(Lindval_loc_bc_ptr[ljb] = intCalloc_dist(nrbl*3)) )
 			ABORT("Malloc fails for Lindval_loc_bc_ptr[ljb][]");
-		    // Lindval_loc_bc_offset[ljb]=nrbl*3;
-    		// Lindval_loc_bc_cnt += Lindval_loc_bc_offset[ljb];
 
-		    myrow = MYROW( iam, grid );
 		    krow = PROW( jb, grid );
 		    if(myrow==krow){   /* diagonal block */
   		        if (!(Linv_bc_ptr[ljb] = (float*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(float))))
 			    ABORT("Malloc fails for Linv_bc_ptr[ljb][]");
-			// Linv_bc_offset[ljb]=nsupc*nsupc;
-			// Linv_bc_cnt += Linv_bc_offset[ljb];
-
 		        if (!(Uinv_bc_ptr[ljb] = (float*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(float))))
 			    ABORT("Malloc fails for Uinv_bc_ptr[ljb][]");
-			// Uinv_bc_offset[ljb]=nsupc*nsupc;
-			// Uinv_bc_cnt += Uinv_bc_offset[ljb];
 		    }else{
 			Linv_bc_ptr[ljb] = NULL;
-			// Linv_bc_offset[ljb] = -1;
 			Uinv_bc_ptr[ljb] = NULL;
-			// Uinv_bc_offset[ljb] = -1;
 		    }
 
-		    mybufmax[0] = SUPERLU_MAX( mybufmax[0], len1 );
-		    mybufmax[1] = SUPERLU_MAX( mybufmax[1], len*nsupc );
-		    mybufmax[4] = SUPERLU_MAX( mybufmax[4], len );
-	  	    memTRS += nrbl*3.0*iword + 2.0*nsupc*nsupc*dword;  //acount for Lindval_loc_bc_ptr[ljb],Linv_bc_ptr[ljb],Uinv_bc_ptr[ljb]
+		    thr_bufmax[0] = SUPERLU_MAX( thr_bufmax[0], len1 );
+		    thr_bufmax[1] = SUPERLU_MAX( thr_bufmax[1], len*nsupc );
+		    thr_bufmax[2] = SUPERLU_MAX( thr_bufmax[2], len );
+	  	    thr_memTRS += nrbl*3.0*iword + 2.0*nsupc*nsupc*dword;  //acount for Lindval_loc_bc_ptr[ljb],Linv_bc_ptr[ljb],Uinv_bc_ptr[ljb]
 		    index[0] = nrbl;  /* Number of row blocks */
 		    index[1] = len;   /* LDA of the nzval[] */
 		    next_lind = BC_HEADER;
 		    next_lval = 0;
-		    for (k = 0; k < nrbl; ++k) {
-			gb = Lrb_number[k];
+		    for (jj = 0; jj < nrbl; ++jj) {
+			gb = Lrb_number[jj];
 			lb = LBi( gb, grid );
 			len = Lrb_length[lb];
-			Lindval_loc_bc_ptr[ljb][k] = lb;
-			Lindval_loc_bc_ptr[ljb][k+nrbl] = next_lind;
-			Lindval_loc_bc_ptr[ljb][k+nrbl*2] = next_lval;
+			Lindval_loc_bc_ptr[ljb][jj] = lb;
+			Lindval_loc_bc_ptr[ljb][jj+nrbl] = next_lind;
+			Lindval_loc_bc_ptr[ljb][jj+nrbl*2] = next_lval;
 			Lrb_length[lb] = 0;  /* Reset vector of block length */
 			index[next_lind++] = gb; /* Descriptor */
 			index[next_lind++] = len;
 			Lrb_indptr[lb] = next_lind;
-			Lrb_valptr[lb] = next_lval;
 			next_lind += len;
 			next_lval += len;
 		    }
-		    /* Propagate the compressed row subscripts to Lindex[],
-                       and the initial values of A from SPA into Lnzval[]. */
+		    /* Propagate the compressed row subscripts to Lindex[]. */
 		    len = index[1];  /* LDA of lusup[] */
 		    for (i = istart; i < xlsub[fsupc+1]; ++i) {
 			irow = lsub[i];
 			gb = BlockNum( irow );
 			if ( myrow == PROW( gb, grid ) ) {
 			    lb = LBi( gb, grid );
-			    k = Lrb_indptr[lb]++; /* Random access a block */
-			    index[k] = irow;
-			    k = Lrb_valptr[lb]++;
-			    irow = ilsum[lb] + irow - FstBlockC( gb );
-			    for (j = 0, dense_col = dense; j < nsupc; ++j) {
-				lusup[k] = dense_col[irow];
-				dense_col[irow] = 0.0;
-				k += len;
-				dense_col += ldaspa;
-			    }
+			    index[Lrb_indptr[lb]++] = irow;
 			}
 		    } /* for i ... */
 
-		    Lrowind_bc_ptr[ljb] = index;
-		    Lnzval_bc_ptr[ljb] = lusup;
-
-			/* sort Lindval_loc_bc_ptr[ljb], Lrowind_bc_ptr[ljb]
-                           and Lnzval_bc_ptr[ljb] here.  */
-			if(nrbl>1){
-				krow = PROW( jb, grid );
-				if(myrow==krow){ /* skip the diagonal block */
-					uu=nrbl-2;
-					lloc = &Lindval_loc_bc_ptr[ljb][1];
-				}else{
-					uu=nrbl-1;
-					lloc = Lindval_loc_bc_ptr[ljb];
-				}
-				quickSortM(lloc,0,uu,nrbl,0,3);
+		    /* sort Lindval_loc_bc_ptr[ljb] and Lrowind_bc_ptr[ljb]
+		       here; Lnzval_bc_ptr[ljb] is loaded in sorted order. */
+		    if(nrbl>1){
+			if(myrow==krow){ /* skip the diagonal block */
+			    uu=nrbl-2;
+			    lloc = &Lindval_loc_bc_ptr[ljb][1];
+			}else{
+			    uu=nrbl-1;
+			    lloc = Lindval_loc_bc_ptr[ljb];
 			}
+			quickSortM(lloc,0,uu,nrbl,0,3);
+		    }
 
+		    if ( !(index_srt = intMalloc_dist(len1)) )
+			ABORT("Malloc fails for index_srt[]");
 
-			if ( !(index_srt = intMalloc_dist(len1)) )
-				ABORT("Malloc fails for index_srt[]");
-			if (!(lusup_srt = (float*)SUPERLU_MALLOC(len*nsupc * sizeof(float))))
-				ABORT("Malloc fails for lusup_srt[]");
-
-			idx_indx = BC_HEADER;
-			idx_lusup = 0;
-			for (jj=0;jj<BC_HEADER;jj++)
-				index_srt[jj] = index[jj];
-
-			for(i=0;i<nrbl;i++){
-				nbrow = index[Lindval_loc_bc_ptr[ljb][i+nrbl]+1];
-				for (jj=0;jj<LB_DESCRIPTOR+nbrow;jj++){
-					index_srt[idx_indx++] = index[Lindval_loc_bc_ptr[ljb][i+nrbl]+jj];
-				}
-
-				Lindval_loc_bc_ptr[ljb][i+nrbl] = idx_indx - LB_DESCRIPTOR - nbrow;
+		    idx_indx = BC_HEADER;
+		    idx_lusup = 0;
+		    for (jj=0;jj<BC_HEADER;jj++)
+			index_srt[jj] = index[jj];
 
-				for (jj=0;jj<nbrow;jj++){
-					k=idx_lusup;
-					k1=Lindval_loc_bc_ptr[ljb][i+nrbl*2]+jj;
-					for (j = 0; j < nsupc; ++j) {
-						lusup_srt[k] = lusup[k1];
-						k += len;
-						k1 += len;
-					}
-					idx_lusup++;
-				}
-				Lindval_loc_bc_ptr[ljb][i+nrbl*2] = idx_lusup - nbrow;
+		    for(i=0;i<nrbl;i++){
+			nbrow = index[Lindval_loc_bc_ptr[ljb][i+nrbl]+1];
+			for (jj=0;jj<LB_DESCRIPTOR+nbrow;jj++){
+			    index_srt[idx_indx++] = index[Lindval_loc_bc_ptr[ljb][i+nrbl]+jj];
 			}
+			Lindval_loc_bc_ptr[ljb][i+nrbl] = idx_indx - LB_DESCRIPTOR - nbrow;
+			idx_lusup += nbrow;
+			Lindval_loc_bc_ptr[ljb][i+nrbl*2] = idx_lusup - nbrow;
+		    }
+		    SUPERLU_FREE(index);
 
-			SUPERLU_FREE(lusup);
-			SUPERLU_FREE(index);
-
-			Lrowind_bc_ptr[ljb] = index_srt;
-			Lnzval_bc_ptr[ljb] = lusup_srt;
-
-			// if(ljb==0)
-			// for (jj=0;jj<nrbl*3;jj++){
-			// printf("iam %5d Lindval %5d\n",iam, Lindval_loc_bc_ptr[ljb][jj]);
-			// fflush(stdout);
-			// }
-			// for (jj=0;jj<nrbl;jj++){
-			// printf("iam %5d Lindval %5d\n",iam, index[Lindval_loc_bc_ptr[ljb][jj+nrbl]]);
-			// fflush(stdout);
+		    if ( !(lusup = floatMalloc_dist(len*nsupc)) )
+			ABORT("Malloc fails for lusup[]");
+		    sload_A_to_L(jb, index_srt, lusup, rowpos, ilsum,
+				 xa, asub, a, Glu_persist, grid);
 
-			// }
+		    Lrowind_bc_ptr[ljb] = index_srt;
+		    Lnzval_bc_ptr[ljb] = lusup;
 		} else {
 		    Lrowind_bc_ptr[ljb] = NULL;
 		    Lnzval_bc_ptr[ljb] = NULL;
 		    Linv_bc_ptr[ljb] = NULL;
-		    // Linv_bc_offset[ljb] = -1;
-    		// Lrowind_bc_offset[ljb]=-1;
-		    // Lindval_loc_bc_offset[ljb]=-1;
-		    // Lnzval_bc_offset[ljb]=-1;
 		    Uinv_bc_ptr[ljb] = NULL;
-		    // Uinv_bc_offset[ljb] = -1;
 		    Lindval_loc_bc_ptr[ljb] = NULL;
 		} /* if nrbl ... */
+	    } /* for ljb ... */
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+	    {
+		mybufmax[0] = SUPERLU_MAX( mybufmax[0], thr_bufmax[0] );
+		mybufmax[1] = SUPERLU_MAX( mybufmax[1], thr_bufmax[1] );
+		mybufmax[4] = SUPERLU_MAX( mybufmax[4], thr_bufmax[2] );
+		memTRS += thr_memTRS;
+	    }
+	    SUPERLU_FREE(Lrb_length);
+	} /* omp parallel */
 #if ( PROFlevel>=1 )
-		t_l += SuperLU_timer_() - t;
+	t_l += SuperLU_timer_() - t;
 #endif
-	    } /* if mycol == pc */
 
-	} /* for jb ... */
 
 #if 0
 	Linv_bc_cnt +=1; // safe guard
@@ -2287,10 +2447,6 @@ if ( !iam) printf(".. Construct Reduce tree for U: %.2f\t\n", t);
 	SUPERLU_FREE(Urb_fstnz);
 	SUPERLU_FREE(Urb_length);
 	SUPERLU_FREE(Urb_indptr);
-	SUPERLU_FREE(Lrb_length);
-	SUPERLU_FREE(Lrb_number);
-	SUPERLU_FREE(Lrb_indptr);
-	SUPERLU_FREE(Lrb_valptr);
 	SUPERLU_FREE(dense);
 
 	/* Find the maximum buffer size. */
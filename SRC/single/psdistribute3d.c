@@ -23,7 +23,7 @@ at the top-level directory.
 
 float
 psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
-	     sScalePermstruct_t *ScalePermstruct,
+	     NRformat_loc3d *A3d, sScalePermstruct_t *ScalePermstruct,
 	     Glu_freeable_t *Glu_freeable, sLUstruct_t *LUstruct,
 	     gridinfo3d_t *grid3d)
 /*
@@ -52,6 +52,12 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
  *	  The distributed input matrix A of dimension (A->nrow, A->ncol).
  *        A may be overwritten by diag(R)*A*diag(C)*Pc^T. The type of A can be:
  *        Stype = SLU_NR_loc; Dtype = SLU_S; Mtype = SLU_GE.
+ *        Not referenced if A3d is not NULL.
+ *
+ * A3d    (input/output) NRformat_loc3d*
+ *        If not NULL, the input matrix on the 3D process grid, which is
+ *        scattered directly to the layers that keep its values, see
+ *        sScatter_A3d(); the route is cached in A3d->route.
  *
  * ScalePermstruct (input) sScalePermstruct_t*
  *        The data structure to store the scaling and permutation vectors
@@ -231,8 +237,12 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
     t = SuperLU_timer_();
 #endif
 
-    sReDistribute_A(A, ScalePermstruct, Glu_freeable, xsup, supno,
-		      grid, &xa, &asub, &a);
+    if ( A3d )
+	sScatter_A3d(n, A3d, options->Fact, ScalePermstruct, Glu_persist,
+		     trf3Dpart->supernode2treeMap, grid3d, &xa, &asub, &a);
+    else
+	sReDistribute_A(A, ScalePermstruct, Glu_freeable, xsup, supno,
+			grid, &xa, &asub, &a);
 
 #if ( PROFlevel>=1 )
     t = SuperLU_timer_() - t;
@@ -249,8 +259,6 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 	   L and U data structures.            */
 	ilsum = Llu->ilsum;
 	ldaspa = Llu->ldalsum;
-	if ( !(dense = floatCalloc_dist(ldaspa * sp_ienv_dist(3,options))) )
-	    ABORT("Calloc fails for SPA dense[].");
 	nrbu = CEILING( nsupers, grid->nprow ); /* No. of local block rows */
 	if ( !(Urb_length = intCalloc_dist(nrbu)) )
 	    ABORT("Calloc fails for Urb_length[].");
@@ -263,13 +271,16 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 	Unzval_br_ptr = Llu->Unzval_br_ptr;
 	Unnz = Llu->Unnz;
 
-	mem_use += 2.0*nrbu*iword + ldaspa*sp_ienv_dist(3,options)*dword;
+	mem_use += 2.0*nrbu*iword;
 
 #if ( PROFlevel>=1 )
 	t = SuperLU_timer_();
 #endif
 
 	/* Initialize Uval to zero. */
+#ifdef _OPENMP
+#pragma omp parallel for private(i, index, uval, len) schedule(dynamic, 16)
+#endif
 	for (lb = 0; lb < nrbu; ++lb) {
 	    Urb_indptr[lb] = BR_HEADER; /* Skip header in U index[]. */
 	    index = Ufstnz_br_ptr[lb];
@@ -284,10 +295,10 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 	    pc = PCOL( jb, grid );
 	    if ( mycol == pc ) { /* Block column jb in my process column */
 		fsupc = FstBlockC( jb );
-		nsupc = SuperSize( jb );
 
- 		/* Scatter A into SPA (for L), or into U directly. */
-		for (j = fsupc, dense_col = dense; j < FstBlockC(jb+1); ++j) {
+ 		/* Scatter the U part of A into U directly; L is loaded
+		   below, one block column per thread. */
+		for (j = fsupc; j < FstBlockC(jb+1); ++j) {
 		    for (i = xa[j]; i < xa[j+1]; ++i) {
 			irow = asub[i];
 			gb = BlockNum( irow );
@@ -316,56 +327,46 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 						/*assert(irow>=index[istart]);*/
 						uval[len + irow - index[istart]] = a[i];
 					}
-			    } else { /* in L; put in SPA first */
-					irow = ilsum[lb] + irow - FstBlockC( gb );
-					dense_col[irow] = a[i];
-  			    }
+			    }
   			}
 		    } /* for i ... */
-  		    dense_col += ldaspa;
 		} /* for j ... */
+	    } /* if mycol == pc */
+	} /* for jb ... */
 
 #if ( PROFlevel>=1 )
-		t_u += SuperLU_timer_() - t;
-		t = SuperLU_timer_();
+	t_u += SuperLU_timer_() - t;
+	t = SuperLU_timer_();
 #endif
 
-		/* Gather the values of A from SPA into Lnzval[]. */
-		ljb = LBj( jb, grid ); /* Local block number */
-		index = Lrowind_bc_ptr[ljb];
-		if ( index ) {
-		    nrbl = index[0];   /* Number of row blocks. */
-		    len = index[1];    /* LDA of lusup[]. */
-		    lusup = Lnzval_bc_ptr[ljb];
-		    next_lind = BC_HEADER;
-		    next_lval = 0;
-		    for (jj = 0; jj < nrbl; ++jj) {
-			gb = index[next_lind++];
-			len1 = index[next_lind++]; /* Rows in the block. */
-			lb = LBi( gb, grid );
-			for (bnnz = 0; bnnz < len1; ++bnnz) {
-			    irow = index[next_lind++]; /* Global index. */
-			    irow = ilsum[lb] + irow - FstBlockC( gb );
-			    k = next_lval++;
-			    for (j = 0, dense_col = dense; j < nsupc; ++j) {
-				lusup[k] = dense_col[irow];
-				dense_col[irow] = zero;
-				k += len;
-				dense_col += ldaspa;
-			    }
-			} /* for bnnz ... */
-		    } /* for jj ... */
-		} /* if index ... */
+	/* Load the values of A into the existing L block columns. */
+	k = CEILING( nsupers, grid->npcol ); /* Number of local block columns */
+#ifdef _OPENMP
+#pragma omp parallel private(i, jb, ljb)
+#endif
+	{
+	    int_t *rowpos;
+	    if ( !(rowpos = intMalloc_dist(ldaspa)) )
+		ABORT("Malloc fails for rowpos[].");
+	    for (i = 0; i < ldaspa; ++i) rowpos[i] = SLU_EMPTY;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+	    for (ljb = 0; ljb < k; ++ljb) {
+		jb = ljb * grid->npcol + mycol;
+		if ( jb < nsupers && Lrowind_bc_ptr[ljb] )
+		    sload_A_to_L(jb, Lrowind_bc_ptr[ljb], Lnzval_bc_ptr[ljb],
+				 rowpos, ilsum, xa, asub, a, Glu_persist, grid);
+	    }
+	    SUPERLU_FREE(rowpos);
+	}
 #if ( PROFlevel>=1 )
-		t_l += SuperLU_timer_() - t;
+	t_l += SuperLU_timer_() - t;
 #endif
-	    } /* if mycol == pc */
-	} /* for jb ... */
 
-	SUPERLU_FREE(dense);
 	SUPERLU_FREE(Urb_length);
 	SUPERLU_FREE(Urb_indptr);
-	mem_use -= 2.0*nrbu*iword + ldaspa*sp_ienv_dist(3,options)*dword;
+	mem_use -= 2.0*nrbu*iword;
 
 #if ( PROFlevel>=1 )
 	if ( !iam ) printf(".. 2nd distribute time: L %.2f\tU %.2f\tu_blks %d\tnrbu %d\n",
@@ -538,17 +539,7 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 
         mem_use -= 2.0*k * iword;
 
-	/* Auxiliary arrays used to set up L block data structures.
-	   They are freed on return.
-	   k is the number of local row blocks.   */
-	if ( !(Lrb_length = intCalloc_dist(k)) )
-	    ABORT("Calloc fails for Lrb_length[].");
-	if ( !(Lrb_number = intMalloc_dist(k)) )
-	    ABORT("Malloc fails for Lrb_number[].");
-	if ( !(Lrb_indptr = intMalloc_dist(k)) )
-	    ABORT("Malloc fails for Lrb_indptr[].");
-	if ( !(Lrb_valptr = intMalloc_dist(k)) )
-	    ABORT("Malloc fails for Lrb_valptr[].");
+	/* SPA for the U part of A; k is the number of local row blocks. */
 	if ( !(dense = floatCalloc_dist(ldaspa * sp_ienv_dist(3,options))) )
 	    ABORT("Calloc fails for SPA dense[].");
 
@@ -629,12 +620,13 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 		nsupc = SuperSize( jb );
 		ljb = LBj( jb, grid ); /* Local block number */
 
-		/* Scatter A into SPA. */
+		/* Scatter the U part of A into SPA; L is loaded from A
+		   directly when its block column is set up below. */
 		for (j = fsupc, dense_col = dense; j < FstBlockC(jb+1); ++j) {
 		    for (i = xa[j]; i < xa[j+1]; ++i) {
 			irow = asub[i];
 			gb = BlockNum( irow );
-			if ( myrow == PROW( gb, grid ) ) {
+			if ( gb < jb && myrow == PROW( gb, grid ) ) {
 			    lb = LBi( gb, grid );
 			    irow = ilsum[lb] + irow - FstBlockC( gb );
 			    dense_col[irow] = a[i];
@@ -739,15 +731,10 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 		t = SuperLU_timer_();
 #endif
 		/*------------------------------------------------
-		 * SET UP L BLOCKS.
+		 * COUNT L BLOCKS AND MESSAGES FOR THE SOLVE.
 		 *------------------------------------------------*/
-
-		/* Count number of blocks and length of each block. */
-		nrbl = 0;
-		len = 0; /* Number of row subscripts I own. */
 		kseen = 0;
-		istart = xlsub[fsupc];
-		for (i = istart; i < xlsub[fsupc+1]; ++i) {
+		for (i = xlsub[fsupc]; i < xlsub[fsupc+1]; ++i) {
 		    irow = lsub[i];
 		    gb = BlockNum( irow ); /* Global block number */
 		    pr = PROW( gb, grid ); /* Process row owning this block */
@@ -761,8 +748,6 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 			lb = LBi( gb, grid );  /* Local block number */
 			if (rb_marker[lb] <= jb) { /* First see this block */
 			    rb_marker[lb] = jb + 1;
-			    Lrb_length[lb] = 1;
-			    Lrb_number[nrbl++] = gb;
 			    if ( gb != jb ) /* Exclude diagonal block. */
 				++fmod[lb]; /* Mod. count for forward solve */
 			    if ( kseen == 0 && myrow != jbrow ) {
@@ -772,186 +757,188 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 #if ( PRNTlevel>=1 )
 			    ++nLblocks;
 #endif
-			} else {
-			    ++Lrb_length[lb];
 			}
-			++len;
 		    }
 		} /* for i ... */
+	    } /* if mycol == pc */
+	} /* for jb ... */
 
+#if ( PROFlevel>=1 )
+	t = SuperLU_timer_();
+#endif
+	/*------------------------------------------------
+	 * SET UP L BLOCKS.
+	 * Block columns are independent: each thread builds its own
+	 * with private scratch arrays, and is the first to touch the
+	 * index[] and nzval[] it allocates.
+	 *------------------------------------------------*/
+	k = CEILING( nsupers, grid->npcol ); /* Number of local block columns */
+	nrbu = CEILING( nsupers, grid->nprow ); /* Number of local block rows */
+#ifdef _OPENMP
+#pragma omp parallel private(i, j, jb, jj, ljb, fsupc, nsupc, nrbl, len, \
+	len1, gb, lb, irow, istart, next_lind, next_lval, index, lusup, \
+	index_srt, idx_indx, idx_lusup, nbrow, uu, lloc, krow, \
+	Lrb_length, Lrb_number, Lrb_indptr)
+#endif
+	{
+	    int_t *rowpos, thr_bufmax[3] = {0, 0, 0};
+	    double thr_mem = 0.0, thr_memTRS = 0.0;
+
+	    if ( !(Lrb_length = intCalloc_dist(3 * nrbu + ldaspa)) )
+		ABORT("Calloc fails for Lrb_length[].");
+	    Lrb_number = Lrb_length + nrbu;
+	    Lrb_indptr = Lrb_number + nrbu;
+	    rowpos = Lrb_indptr + nrbu;
+	    for (i = 0; i < ldaspa; ++i) rowpos[i] = SLU_EMPTY;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+	    for (ljb = 0; ljb < k; ++ljb) {
+		jb = ljb * grid->npcol + mycol; /* Global block number */
+		if ( jb >= nsupers ) continue;
+		fsupc = FstBlockC( jb );
+		nsupc = SuperSize( jb );
 
-		if ( nrbl) { /* Do not ensure the blocks are sorted! */
-		    if(superGridMap[jb]!= NOT_IN_GRID){ // YL: added supernode mask here
-				/* Set up the initial pointers for each block in
-				index[] and nzval[]. */
-				/* Add room for descriptors */
-				len1 = len + BC_HEADER + nrbl * LB_DESCRIPTOR;
-				if ( !(index = intMalloc_dist(len1)) )
-				ABORT("Malloc fails for index[]");
-				if (!(lusup = (float*)SUPERLU_MALLOC(len*nsupc * sizeof(float))))
-				ABORT("Malloc fails for lusup[]");
-				if ( !(Lindval_loc_bc_ptr[ljb] = intCalloc_dist(nrbl*3)) )
-				ABORT("Malloc fails for Lindval_loc_bc_ptr[ljb][]");
-				myrow = MYROW( iam, grid );
-				krow = PROW( jb, grid );
-				if(myrow==krow){   /* diagonal block */
-					if (!(Linv_bc_ptr[ljb] = (float*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(float))))
-					ABORT("Malloc fails for Linv_bc_ptr[ljb][]");
-					if (!(Uinv_bc_ptr[ljb] = (float*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(float))))
-					ABORT("Malloc fails for Uinv_bc_ptr[ljb][]");
-				}else{
-					Linv_bc_ptr[ljb] = NULL;
-					Uinv_bc_ptr[ljb] = NULL;
-				}
-
-				mybufmax[0] = SUPERLU_MAX( mybufmax[0], len1 );
-				mybufmax[1] = SUPERLU_MAX( mybufmax[1], len*nsupc );
-				mybufmax[4] = SUPERLU_MAX( mybufmax[4], len );
-				mem_use += len*nsupc*dword + (len1)*iword;
-				memTRS += nrbl*3.0*iword + 2.0*nsupc*nsupc*dword;  //acount for Lindval_loc_bc_ptr[ljb],Linv_bc_ptr[ljb],Uinv_bc_ptr[ljb]
-				index[0] = nrbl;  /* Number of row blocks */
-				index[1] = len;   /* LDA of the nzval[] */
-				next_lind = BC_HEADER;
-				next_lval = 0;
-				for (k = 0; k < nrbl; ++k) {
-				gb = Lrb_number[k];
-				lb = LBi( gb, grid );
-				len = Lrb_length[lb];
-				Lindval_loc_bc_ptr[ljb][k] = lb;
-				Lindval_loc_bc_ptr[ljb][k+nrbl] = next_lind;
-				Lindval_loc_bc_ptr[ljb][k+nrbl*2] = next_lval;
-				Lrb_length[lb] = 0;  /* Reset vector of block length */
-				index[next_lind++] = gb; /* Descriptor */
-				index[next_lind++] = len;
-				Lrb_indptr[lb] = next_lind;
-				Lrb_valptr[lb] = next_lval;
-				next_lind += len;
-				next_lval += len;
-				}
-				/* Propagate the compressed row subscripts to Lindex[],
-						and the initial values of A from SPA into Lnzval[]. */
-				len = index[1];  /* LDA of lusup[] */
-				for (i = istart; i < xlsub[fsupc+1]; ++i) {
-				irow = lsub[i];
-				gb = BlockNum( irow );
-				if ( myrow == PROW( gb, grid ) ) {
-					lb = LBi( gb, grid );
-					k = Lrb_indptr[lb]++; /* Random access a block */
-					index[k] = irow;
-					k = Lrb_valptr[lb]++;
-					irow = ilsum[lb] + irow - FstBlockC( gb );
-					for (j = 0, dense_col = dense; j < nsupc; ++j) {
-					lusup[k] = dense_col[irow];
-					dense_col[irow] = zero;
-					k += len;
-					dense_col += ldaspa;
-					}
-				}
-				} /* for i ... */
-
-				Lrowind_bc_ptr[ljb] = index;
-				Lnzval_bc_ptr[ljb] = lusup;
-
-				/* sort Lindval_loc_bc_ptr[ljb], Lrowind_bc_ptr[ljb]
-							and Lnzval_bc_ptr[ljb] here.  */
-				if(nrbl>1){
-					krow = PROW( jb, grid );
-					if(myrow==krow){ /* skip the diagonal block */
-						uu=nrbl-2;
-						lloc = &Lindval_loc_bc_ptr[ljb][1];
-					}else{
-						uu=nrbl-1;
-						lloc = Lindval_loc_bc_ptr[ljb];
-					}
-					quickSortM(lloc,0,uu,nrbl,0,3);
-				}
-
-
-				if ( !(index_srt = intMalloc_dist(len1)) )
-					ABORT("Malloc fails for index_srt[]");
-				if (!(lusup_srt = (float*)SUPERLU_MALLOC(len*nsupc * sizeof(float))))
-					ABORT("Malloc fails for lusup_srt[]");
-
-				idx_indx = BC_HEADER;
-				idx_lusup = 0;
-				for (jj=0;jj<BC_HEADER;jj++)
-					index_srt[jj] = index[jj];
-
-				for(i=0;i<nrbl;i++){
-					nbrow = index[Lindval_loc_bc_ptr[ljb][i+nrbl]+1];
-					for (jj=0;jj<LB_DESCRIPTOR+nbrow;jj++){
-						index_srt[idx_indx++] = index[Lindval_loc_bc_ptr[ljb][i+nrbl]+jj];
-					}
-
-					Lindval_loc_bc_ptr[ljb][i+nrbl] = idx_indx - LB_DESCRIPTOR - nbrow;
-
-					for (jj=0;jj<nbrow;jj++){
-						k=idx_lusup;
-						k1=Lindval_loc_bc_ptr[ljb][i+nrbl*2]+jj;
-						for (j = 0; j < nsupc; ++j) {
-							lusup_srt[k] = lusup[k1];
-							k += len;
-							k1 += len;
-						}
-						idx_lusup++;
-					}
-					Lindval_loc_bc_ptr[ljb][i+nrbl*2] = idx_lusup - nbrow;
-				}
+		/* Count number of blocks and length of each block. */
+		nrbl = 0;
+		len = 0; /* Number of row subscripts I own. */
+		istart = xlsub[fsupc];
+		for (i = istart; i < xlsub[fsupc+1]; ++i) {
+		    gb = BlockNum( lsub[i] );
+		    if ( myrow == PROW( gb, grid ) ) {
+			lb = LBi( gb, grid );
+			if ( Lrb_length[lb] == 0 ) /* First see this block */
+			    Lrb_number[nrbl++] = gb;
+			++Lrb_length[lb];
+			++len;
+		    }
+		} /* for i ... */
 
-				SUPERLU_FREE(lusup);
-				SUPERLU_FREE(index);
+		if ( nrbl ) { /* Do not ensure the blocks are sorted! */
+		    /* Add room for descriptors */
+		    len1 = len + BC_HEADER + nrbl * LB_DESCRIPTOR;
+		    thr_bufmax[0] = SUPERLU_MAX( thr_bufmax[0], len1 );
+		    thr_bufmax[1] = SUPERLU_MAX( thr_bufmax[1], len*nsupc );
+		    thr_bufmax[2] = SUPERLU_MAX( thr_bufmax[2], len );
+		}
 
-				Lrowind_bc_ptr[ljb] = index_srt;
-				Lnzval_bc_ptr[ljb] = lusup_srt;
+		if ( nrbl && superGridMap[jb] != NOT_IN_GRID ) { // YL: supernode mask
+		    /* Set up the initial pointers for each block in
+		       index[] and nzval[]. */
+		    if ( !(index = intMalloc_dist(len1)) )
+			ABORT("Malloc fails for index[]");
+		    if ( !(Lindval_loc_bc_ptr[ljb] = intCalloc_dist(nrbl*3)) )
+			ABORT("Malloc fails for Lindval_loc_bc_ptr[ljb][]");
+
+		    krow = PROW( jb, grid );
+		    if(myrow==krow){   /* diagonal block */
+			if (!(Linv_bc_ptr[ljb] = (float*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(float))))
+			    ABORT("Malloc fails for Linv_bc_ptr[ljb][]");
+			if (!(Uinv_bc_ptr[ljb] = (float*)SUPERLU_MALLOC(nsupc*nsupc * sizeof(float))))
+			    ABORT("Malloc fails for Uinv_bc_ptr[ljb][]");
+		    }else{
+			Linv_bc_ptr[ljb] = NULL;
+			Uinv_bc_ptr[ljb] = NULL;
+		    }
 
-			}else{ //if(superGridMap[jb]!= NOT_IN_GRID)
+		    thr_mem += len*nsupc*dword + (len1)*iword;
+		    thr_memTRS += nrbl*3.0*iword + 2.0*nsupc*nsupc*dword;  //acount for Lindval_loc_bc_ptr[ljb],Linv_bc_ptr[ljb],Uinv_bc_ptr[ljb]
+		    index[0] = nrbl;  /* Number of row blocks */
+		    index[1] = len;   /* LDA of the nzval[] */
+		    next_lind = BC_HEADER;
+		    next_lval = 0;
+		    for (jj = 0; jj < nrbl; ++jj) {
+			gb = Lrb_number[jj];
+			lb = LBi( gb, grid );
+			len = Lrb_length[lb];
+			Lindval_loc_bc_ptr[ljb][jj] = lb;
+			Lindval_loc_bc_ptr[ljb][jj+nrbl] = next_lind;
+			Lindval_loc_bc_ptr[ljb][jj+nrbl*2] = next_lval;
+			Lrb_length[lb] = 0;  /* Reset vector of block length */
+			index[next_lind++] = gb; /* Descriptor */
+			index[next_lind++] = len;
+			Lrb_indptr[lb] = next_lind;
+			next_lind += len;
+			next_lval += len;
+		    }
+		    /* Propagate the compressed row subscripts to Lindex[]. */
+		    len = index[1];  /* LDA of lusup[] */
+		    for (i = istart; i < xlsub[fsupc+1]; ++i) {
+			irow = lsub[i];
+			gb = BlockNum( irow );
+			if ( myrow == PROW( gb, grid ) ) {
+			    lb = LBi( gb, grid );
+			    index[Lrb_indptr[lb]++] = irow;
+			}
+		    } /* for i ... */
 
-				/* Set up the initial pointers for each block in
-				index[] and nzval[]. */
-				/* Add room for descriptors */
-				len1 = len + BC_HEADER + nrbl * LB_DESCRIPTOR;
+		    /* sort Lindval_loc_bc_ptr[ljb] and Lrowind_bc_ptr[ljb]
+		       here; Lnzval_bc_ptr[ljb] is loaded in sorted order. */
+		    if(nrbl>1){
+			if(myrow==krow){ /* skip the diagonal block */
+			    uu=nrbl-2;
+			    lloc = &Lindval_loc_bc_ptr[ljb][1];
+			}else{
+			    uu=nrbl-1;
+			    lloc = Lindval_loc_bc_ptr[ljb];
+			}
+			quickSortM(lloc,0,uu,nrbl,0,3);
+		    }
 
-				myrow = MYROW( iam, grid );
-				krow = PROW( jb, grid );
+		    if ( !(index_srt = intMalloc_dist(len1)) )
+			ABORT("Malloc fails for index_srt[]");
 
-				mybufmax[0] = SUPERLU_MAX( mybufmax[0], len1 );
-				mybufmax[1] = SUPERLU_MAX( mybufmax[1], len*nsupc );
-				mybufmax[4] = SUPERLU_MAX( mybufmax[4], len );
+		    idx_indx = BC_HEADER;
+		    idx_lusup = 0;
+		    for (jj=0;jj<BC_HEADER;jj++)
+			index_srt[jj] = index[jj];
 
+		    for(i=0;i<nrbl;i++){
+			nbrow = index[Lindval_loc_bc_ptr[ljb][i+nrbl]+1];
+			for (jj=0;jj<LB_DESCRIPTOR+nbrow;jj++){
+			    index_srt[idx_indx++] = index[Lindval_loc_bc_ptr[ljb][i+nrbl]+jj];
+			}
+			Lindval_loc_bc_ptr[ljb][i+nrbl] = idx_indx - LB_DESCRIPTOR - nbrow;
+			idx_lusup += nbrow;
+			Lindval_loc_bc_ptr[ljb][i+nrbl*2] = idx_lusup - nbrow;
+		    }
+		    SUPERLU_FREE(index);
 
-				/* YL: need to zero out dense_col even if superGridMap[jb]== NOT_IN_GRID for this column. */
-				for (i = istart; i < xlsub[fsupc+1]; ++i) {
-				irow = lsub[i];
-				gb = BlockNum( irow );
-				if ( myrow == PROW( gb, grid ) ) {
-				    lb = LBi( gb, grid );
-				    irow = ilsum[lb] + irow - FstBlockC( gb );
-				    for (j = 0, dense_col = dense; j < nsupc; ++j) {
-					dense_col[irow] = zero;
-					dense_col += ldaspa;
-				    }
-				}
-				} /* for i ... */
+		    if ( !(lusup = floatMalloc_dist(len*nsupc)) )
+			ABORT("Malloc fails for lusup[]");
+		    sload_A_to_L(jb, index_srt, lusup, rowpos, ilsum,
+				 xa, asub, a, Glu_persist, grid);
 
-				Lrowind_bc_ptr[ljb] = NULL;
-				Lnzval_bc_ptr[ljb] = NULL;
-				Linv_bc_ptr[ljb] = NULL;
-				Uinv_bc_ptr[ljb] = NULL;
-				Lindval_loc_bc_ptr[ljb] = NULL;
-			}
+		    Lrowind_bc_ptr[ljb] = index_srt;
+		    Lnzval_bc_ptr[ljb] = lusup;
 		} else {
+		    for (jj = 0; jj < nrbl; ++jj) /* Reset vector of block length */
+			Lrb_length[LBi( Lrb_number[jj], grid )] = 0;
 		    Lrowind_bc_ptr[ljb] = NULL;
 		    Lnzval_bc_ptr[ljb] = NULL;
-			Linv_bc_ptr[ljb] = NULL;
-			Uinv_bc_ptr[ljb] = NULL;
-			Lindval_loc_bc_ptr[ljb] = NULL;
+		    Linv_bc_ptr[ljb] = NULL;
+		    Uinv_bc_ptr[ljb] = NULL;
+		    Lindval_loc_bc_ptr[ljb] = NULL;
 		} /* if nrbl ... */
+	    } /* for ljb ... */
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+	    {
+		mybufmax[0] = SUPERLU_MAX( mybufmax[0], thr_bufmax[0] );
+		mybufmax[1] = SUPERLU_MAX( mybufmax[1], thr_bufmax[1] );
+		mybufmax[4] = SUPERLU_MAX( mybufmax[4], thr_bufmax[2] );
+		mem_use += thr_mem;
+		memTRS += thr_memTRS;
+	    }
+	    SUPERLU_FREE(Lrb_length);
+	} /* omp parallel */
 #if ( PROFlevel>=1 )
-		t_l += SuperLU_timer_() - t;
+	t_l += SuperLU_timer_() - t;
 #endif
-	    } /* if mycol == pc */
 
-	} /* for jb ... */
 
 	/////////////////////////////////////////////////////////////////
 
@@ -1087,10 +1074,6 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 	SUPERLU_FREE(Urb_fstnz);
 	SUPERLU_FREE(Urb_length);
 	SUPERLU_FREE(Urb_indptr);
-	SUPERLU_FREE(Lrb_length);
-	SUPERLU_FREE(Lrb_number);
-	SUPERLU_FREE(Lrb_indptr);
-	SUPERLU_FREE(Lrb_valptr);
 	SUPERLU_FREE(dense);
 
 	k = CEILING( nsupers, grid->nprow ); /* Number of local block rows */
@@ -1113,11 +1096,11 @@ psdistribute3d_Yang(superlu_dist_options_t *options, int_t n, SuperMatrix *A,
 
     } /* else fact != SamePattern_SameRowPerm */
 
-    if ( xa[A->ncol] > 0 ) { /* may not have any entries on this process. */
-        SUPERLU_FREE(asub);
+    if ( xa[n] > 0 ) { /* may not have any entries on this process. */
+        if ( !A3d ) SUPERLU_FREE(asub);
         SUPERLU_FREE(a);
     }
-    SUPERLU_FREE(xa);
+    if ( !A3d ) SUPERLU_FREE(xa); /* else xa and asub are in A3d->route */
 
 #if ( DEBUGlevel>=1 )
     /* Memory allocated but not freed:
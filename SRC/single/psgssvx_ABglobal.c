@@ -504,12 +504,15 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
     float   *C, *R, *C1, *R1, amax, anorm, colcnd, rowcnd;
     float   *X, *b_col, *b_work, *x_col;
     double   t;
-    static superlu_dist_mem_usage_t num_mem_usage, symb_mem_usage;
+    superlu_dist_mem_usage_t num_mem_usage, symb_mem_usage;
 #if ( PRNTlevel>= 2 )
     double   dmin, dsum, dprod;
 #endif
 	LUstruct->dt = 's';
 
+    num_mem_usage.for_lu = num_mem_usage.total = 0.0;
+    symb_mem_usage.for_lu = symb_mem_usage.total = 0.0;
+
     /* Test input parameters. */
     *info = 0;
     Fact = options->Fact;
@@ -537,6 +540,9 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 	return;
     }
 
+    /* Region profiler, off unless SUPERLU_PROFILE > 0. */
+    superlu_prof_init(options, stat);
+
     /* Initialization */
     factored = (Fact == FACTORED);
     Equil = (!factored && options->Equil == YES);
@@ -599,6 +605,7 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 	CHECK_MALLOC(iam, "Enter equil");
 #endif
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "equil");
 
 	if ( Fact == SamePattern_SameRowPerm ) {
 	    /* Reuse R and C. */
@@ -689,6 +696,7 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 #endif
 	} /* if Fact ... */
 
+	SUPERLU_PROF_END(stat, "equil");
 	stat->utime[EQUIL] = SuperLU_timer_() - t;
 #if ( DEBUGlevel>=1 )
 	CHECK_MALLOC(iam, "Exit equil");
@@ -700,6 +708,7 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
        ------------------------------------------------------------*/
     if ( options->RowPerm != NO ) {
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "rowperm");
 
 	if ( Fact == SamePattern_SameRowPerm /* Reuse perm_r. */
 	    || options->RowPerm == MY_PERMR ) { /* Use my perm_r. */
@@ -819,6 +828,7 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 
         } /* else !factored */
 
+	SUPERLU_PROF_END(stat, "rowperm");
 	t = SuperLU_timer_() - t;
 	stat->utime[ROWPERM] = t;
 #if ( PRNTlevel>=1 )
@@ -844,6 +854,7 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
        ------------------------------------------------------------*/
     if ( !factored ) {
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "colperm");
 	/*
 	 * Get column permutation vector perm_c[], according to permc_spec:
 	 *   permc_spec = NATURAL:  natural ordering
@@ -869,6 +880,7 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 		irow = ACstore->rowind[i];
 		ACstore->rowind[i] = perm_c[irow];
 	    }
+	SUPERLU_PROF_END(stat, "colperm");
 	stat->utime[COLPERM] = SuperLU_timer_() - t;
 
 	/* Perform a symbolic factorization on matrix A and set up the
@@ -880,6 +892,7 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 		       sp_ienv_dist(2,options), sp_ienv_dist(3,options), sp_ienv_dist(6,options));
 #endif
 	    t = SuperLU_timer_();
+	    SUPERLU_PROF_BEGIN(stat, "symbfact");
 	    if ( !(Glu_freeable = (Glu_freeable_t *)
 		   SUPERLU_MALLOC(sizeof(Glu_freeable_t))) )
 		ABORT("Malloc fails for Glu_freeable.");
@@ -887,6 +900,7 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 	    iinfo = symbfact(options, iam, &AC, perm_c, etree,
 			     Glu_persist, Glu_freeable);
 
+	    SUPERLU_PROF_END(stat, "symbfact");
 	    stat->utime[SYMBFAC] = SuperLU_timer_() - t;
 
 	    if ( iinfo <= 0 ) {
@@ -917,7 +931,9 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 
 	/* Distribute the L and U factors onto the process grid. */
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "distribute");
 	dist_mem_use = sdistribute(options, n, &AC, Glu_freeable, LUstruct, grid);
+	SUPERLU_PROF_END(stat, "distribute");
 	stat->utime[DIST] = SuperLU_timer_() - t;
 
 	/* Flatten L metadata into one buffer. */
@@ -933,7 +949,9 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 
 	/* Perform numerical factorization in parallel. */
 	t = SuperLU_timer_();
+	SUPERLU_PROF_BEGIN(stat, "factor");
 	psgstrf(options, m, n, anorm, LUstruct, grid, stat, info);
+	SUPERLU_PROF_END(stat, "factor");
 	stat->utime[FACT] = SuperLU_timer_() - t;
 
 
@@ -1085,8 +1103,10 @@ psgssvx_ABglobal(superlu_dist_options_t *options, SuperMatrix *A,
 	if ( options->IterRefine ) {
 	    /* Improve the solution by iterative refinement. */
 	    t = SuperLU_timer_();
+	    SUPERLU_PROF_BEGIN(stat, "refine");
 	    psgsrfs_ABXglobal(options, n, &AC, anorm, LUstruct, grid, B, ldb,
 			      X, ldx, nrhs, berr, stat, info);
+	    SUPERLU_PROF_END(stat, "refine");
 	    stat->utime[REFINE] = SuperLU_timer_() - t;
 	}
 
@@ -343,6 +343,7 @@ int_t psgstrf3d(superlu_dist_options_t *options, int m, int n, float anorm,
             if (sforest) /* 2D factorization at individual subtree */
             {
                 double tilvl = SuperLU_timer_();
+                SUPERLU_PROF_BEGIN(stat, "subtree");
 #ifdef GPU_ACC
                 ssparseTreeFactor_ASYNC_GPU(
                     sforest,
@@ -352,14 +353,21 @@ int_t psgstrf3d(superlu_dist_options_t *options, int m, int n, float anorm,
                     sluGPU,  d2Hred,  HyP, LUstruct, grid3d, stat,
                     thresh,  SCT, tag_ub, info);
 #else
+                /* Factor its leaf subtrees in dense fronts first. */
+                int finfo = 0;
+                sleafFrontFactor(options, n, sforest->nNodes, sforest->nodeList,
+                                 thresh, LUstruct, &(grid3d->grid2d), stat,
+                                 &finfo, factStat.frontDone);
                 ssparseTreeFactor_ASYNC(sforest, comReqss,  &scuBufs, &packLUInfo,
 					msgss, LUvsbs, dFBufs, &factStat, &fNlists,
 					&gEtreeInfo, options, iperm_c_supno, ldt,
 					HyP, LUstruct, grid3d, stat,
 					thresh,  SCT, tag_ub, info );
+                if (finfo && !*info) *info = finfo;
 #endif
 
                 /*now reduce the updates*/
+                SUPERLU_PROF_END(stat, "subtree");
                 SCT->tFactor3D[ilvl] = SuperLU_timer_() - tilvl;
                 sForests[myTreeIdxs[ilvl]]->cost = SCT->tFactor3D[ilvl];
             }
@@ -373,8 +381,10 @@ int_t psgstrf3d(superlu_dist_options_t *options, int m, int n, float anorm,
                     SCT, stat );
 #else
 
+                SUPERLU_PROF_BEGIN(stat, "reduce");
                 sreduceAllAncestors3d( ilvl, myNodeCount, treePerm,
                                       LUvsb, LUstruct, grid3d, SCT );
+                SUPERLU_PROF_END(stat, "reduce");
 #endif
 
             }
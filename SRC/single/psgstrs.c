@@ -1052,6 +1052,7 @@ psgstrs(superlu_dist_options_t *options, int_t n,
 	pxerr_dist("PSGSTRS", grid, -*info);
 	return;
     }
+    SUPERLU_PROF_BEGIN(stat, "solve");
 
     /*
      * Initialization.
@@ -1064,6 +1065,17 @@ psgstrs(superlu_dist_options_t *options, int_t n,
     xsup = Glu_persist->xsup;
     supno = Glu_persist->supno;
     nsupers = supno[n-1] + 1;
+    if ( !Llu->LBtree_ptr ) { /* first solve after the factorization */
+	int *supernodeMask = int32Malloc_dist(nsupers);
+	for (int js = 0; js < nsupers; ++js) supernodeMask[js] = 1;
+	strs_compute_communication_structure(options, n, LUstruct,
+				ScalePermstruct, supernodeMask, grid, stat);
+	SUPERLU_FREE(supernodeMask);
+	LBtree_ptr = Llu->LBtree_ptr;
+	LRtree_ptr = Llu->LRtree_ptr;
+	UBtree_ptr = Llu->UBtree_ptr;
+	URtree_ptr = Llu->URtree_ptr;
+    }
     Lrowind_bc_ptr = Llu->Lrowind_bc_ptr;
     Lnzval_bc_ptr = Llu->Lnzval_bc_ptr;
     Linv_bc_ptr = Llu->Linv_bc_ptr;
@@ -1213,6 +1225,8 @@ psgstrs(superlu_dist_options_t *options, int_t n,
     sDumpLblocks(iam, nsupers, grid, Glu_persist, Llu);
 #endif
 
+    SUPERLU_PROF_BEGIN(stat, "lsolve");
+
     /*---------------------------------------------------
      * Forward solve Ly = b.
      *---------------------------------------------------*/
@@ -1933,6 +1947,9 @@ if (get_acc_solve()){  /* GPU trisolve*/
 #endif
 
 
+	SUPERLU_PROF_END(stat, "lsolve");
+	SUPERLU_PROF_BEGIN(stat, "usolve");
+
 	/*---------------------------------------------------
 	 * Back solve Ux = y.
 	 *
@@ -2638,6 +2655,8 @@ for (lk=0;lk<nsupers_j;++lk){
 	}
 #endif
 
+    SUPERLU_PROF_END(stat, "usolve");
+    SUPERLU_PROF_END(stat, "solve");
     stat->utime[SOLVE] = SuperLU_timer_() - t1_sol;
 
 #if ( DEBUGlevel>=1 )
@@ -157,10 +157,8 @@ int strs_compute_communication_structure(superlu_dist_options_t *options, int_t
     Glu_persist_t *Glu_persist = LUstruct->Glu_persist;
     int kr,kc,nlb,nub;
     int nsupers = Glu_persist->supno[n - 1] + 1;
-    int_t *rowcounts, *colcounts, **rowlists, **collists, *tmpglo;
     int_t  *lsub, *lloc;
-    int_t idx_i, lptr1_tmp, ib, jb, jj;
-    int   *displs, *recvcounts, count, nbg;
+    int_t idx_i, lptr1_tmp, ib, jb;
 
     kr = CEILING( nsupers, grid->nprow);/* Number of local block rows */
     kc = CEILING( nsupers, grid->npcol);/* Number of local block columns */
@@ -168,18 +166,11 @@ int strs_compute_communication_structure(superlu_dist_options_t *options, int_t
     int nprocs = grid->nprow * grid->npcol;
     int_t myrow = MYROW( iam, grid );
     int_t mycol = MYCOL( iam, grid );
-    int_t *ActiveFlag;
-    int *ranks;
-    superlu_scope_t *rscp = &grid->rscp;
-    superlu_scope_t *cscp = &grid->cscp;
-    int rank_cnt,rank_cnt_ref,Root;
-    int_t Iactive,gb,pr,pc,nb, idx_n;
 
 	C_Tree  *LBtree_ptr;       /* size ceil(NSUPERS/Pc)                */
 	C_Tree  *LRtree_ptr;		  /* size ceil(NSUPERS/Pr)                */
 	C_Tree  *UBtree_ptr;       /* size ceil(NSUPERS/Pc)                */
 	C_Tree  *URtree_ptr;		  /* size ceil(NSUPERS/Pr)                */
-	int msgsize;
 
     sLocalLU_t *Llu = LUstruct->Llu;
     int_t* xsup = Glu_persist->xsup;
@@ -227,104 +218,70 @@ int strs_compute_communication_structure(superlu_dist_options_t *options, int_t
     int *h_recv_cnt;
     int *h_recv_cnt_u;
 
-    /* Reconstruct the global L structure and compute the communication metadata */
-
-    if ( !(tmpglo = intCalloc_dist(nsupers)) )
-		ABORT("Calloc fails for tmpglo[].");
-    if (!(recvcounts = (int *) SUPERLU_MALLOC (SUPERLU_MAX (grid->npcol, grid->nprow) * sizeof(int))))
-        ABORT ("SUPERLU_MALLOC fails for recvcounts.");
-    if (!(displs = (int *) SUPERLU_MALLOC (SUPERLU_MAX (grid->npcol, grid->nprow) * sizeof(int))))
-        ABORT ("SUPERLU_MALLOC fails for displs.");
-
-
-    /* gather information about the global L structure */
-
-	if ( !(rowcounts = intCalloc_dist(kc)) )
-		ABORT("Calloc fails for rowcounts[].");
-	if ( !(colcounts = intCalloc_dist(kr)) )
-		ABORT("Calloc fails for colcounts[].");
-
-	if ( !(rowlists = (int_t**)SUPERLU_MALLOC(kc * sizeof(int_t*))) )
-		fprintf(stderr, "Malloc fails for rowlists[].");
-	if ( !(collists = (int_t**)SUPERLU_MALLOC(kr * sizeof(int_t*))) )
-		fprintf(stderr, "Malloc fails for collists[].");
+    /* Compute the communication metadata.  A process only needs, for
+       every tree it takes part in, the block that orders it among the
+       other processes of the tree: its first L block row (last U block
+       row) in a block column, its last L block column (first U block
+       column) in a block row.  These are gathered for all trees at once
+       in C_Tree_Build(). */
+
+    int_t *lbext, *ubext, *lrext, *urext;
+    int *needrecv, *needsend;
+
+    if ( !(lbext = intMalloc_dist(2 * (kc + kr))) )
+	ABORT("Malloc fails for lbext[].");
+    ubext = lbext + kc;
+    lrext = ubext + kc;
+    urext = lrext + kr;
+    if ( !(needrecv = int32Malloc_dist(2 * SUPERLU_MAX(kc, kr))) )
+	ABORT("Malloc fails for needrecv[].");
+    needsend = needrecv + SUPERLU_MAX(kc, kr);
+    for (int_t lk = 0; lk < 2 * (kc + kr); ++lk) lbext[lk] = SLU_EMPTY;
 
 	for (int_t lk = 0; lk < kc; ++lk) { /* for each local block column ... */
-		jb = mycol+lk*grid->npcol;  /* not sure */
-		if(jb<nsupers){
-            if(supernodeMask[jb]>0){
-                lsub = Llu->Lrowind_bc_ptr[lk];
-                lloc = Llu->Lindval_loc_bc_ptr[lk];
-                if(lsub){
-                    nlb = lsub[0];
-                    idx_i = nlb;
-                    for (int_t lb = 0; lb < nlb; ++lb){
-                        lptr1_tmp = lloc[lb+idx_i];
-                        ib = lsub[lptr1_tmp]; /* Global block number, row-wise. */
-                        if(supernodeMask[ib]>0){
-                            rowcounts[lk]++;
-                            int_t lib = LBi( ib, grid ); /* Local block number, row-wise. */
-                            colcounts[lib]++;
-                        }
-                    }
-                }
-            }
+		jb = mycol+lk*grid->npcol;
+		if ( jb >= nsupers || supernodeMask[jb] <= 0 ) continue;
+		lsub = Llu->Lrowind_bc_ptr[lk];
+		lloc = Llu->Lindval_loc_bc_ptr[lk];
+		if(lsub){
+		    nlb = lsub[0];
+		    idx_i = nlb;
+		    for (int_t lb = 0; lb < nlb; ++lb){
+			lptr1_tmp = lloc[lb+idx_i];
+			ib = lsub[lptr1_tmp]; /* Global block number, row-wise. */
+			if(supernodeMask[ib]>0){
+			    int_t lib = LBi( ib, grid ); /* Local block number, row-wise. */
+			    if ( lbext[lk] == SLU_EMPTY || ib < lbext[lk] ) lbext[lk] = ib;
+			    lrext[lib] = SUPERLU_MAX(lrext[lib], jb);
+			}
+		    }
 		}
-	}
-
-    for (int_t j=0; j<kc; j++){
-        if(rowcounts[j]>0){
-            if ( !(rowlists[j] = intCalloc_dist(rowcounts[j])) )
-                ABORT("Calloc fails for rowlists[j].");
-        }else{
-            rowlists[j] = NULL;
-        }
-        rowcounts[j]=0;
-    }
-    for (int_t i=0; i<kr; i++){
-        if(colcounts[i]>0){
-            if ( !(collists[i] = intCalloc_dist(colcounts[i])) )
-                ABORT("Calloc fails for collists[i].");
-        }else{
-            collists[i] = NULL;
-        }
-        colcounts[i]=0;
-    }
-
-	for (int_t lk = 0; lk < kc; ++lk) { /* for each local block column ... */
-		jb = mycol+lk*grid->npcol;  /* not sure */
-		if(jb<nsupers){
-            if(supernodeMask[jb]>0){
-                lsub = Llu->Lrowind_bc_ptr[lk];
-                lloc = Llu->Lindval_loc_bc_ptr[lk];
-                if(lsub){
-                    nlb = lsub[0];
-                    idx_i = nlb;
-                    for (int_t lb = 0; lb < nlb; ++lb){
-                        lptr1_tmp = lloc[lb+idx_i];
-                        ib = lsub[lptr1_tmp]; /* Global block number, row-wise. */
-                        if(supernodeMask[ib]>0){
-                            rowlists[lk][rowcounts[lk]++]=ib;
-                            int_t lib = LBi( ib, grid ); /* Local block number, row-wise. */
-                            collists[lib][colcounts[lib]++]=jb;
-                        }
-                    }
-                }
-            }
+		nub = Urbs[lk];      /* Number of U blocks in block column lk */
+		for (int_t ub = 0; ub < nub; ++ub){
+		    int_t lib = Ucb_indptr[lk][ub].lbnum; /* Local block number, row-wise. */
+		    ib = lib * grid->nprow + myrow;/* Global block number, row-wise. */
+		    if(supernodeMask[ib]>0){
+			ubext[lk] = SUPERLU_MAX(ubext[lk], ib);
+			if ( urext[lib] == SLU_EMPTY || jb < urext[lib] ) urext[lib] = jb;
+		    }
 		}
+		if ( myrow == PROW( jb, grid ) ) /* diagonal block stored in L */
+		    ubext[lk] = SUPERLU_MAX(ubext[lk], jb);
+	}
+	for (int_t lk = 0; lk < kr; ++lk) {
+		ib = myrow+lk*grid->nprow;
+		if ( ib < nsupers && supernodeMask[ib] > 0 && mycol == PCOL( ib, grid ) )
+		    urext[lk] = ib; /* diagonal block stored in L */
 	}
 
     /* broadcast tree for L*/
-
-	if ( !(ActiveFlag = intCalloc_dist(grid->nprow*2)) )
-		ABORT("Calloc fails for ActiveFlag[].");
-	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->nprow * sizeof(int))) )
-		ABORT("Malloc fails for ranks[].");
 	if ( !(LBtree_ptr = (C_Tree*)SUPERLU_MALLOC(kc * sizeof(C_Tree))) )
 		ABORT("Malloc fails for LBtree_ptr[].");
 	for (int_t lk = 0; lk <kc ; ++lk) {
 		C_BcTree_Nullify(&LBtree_ptr[lk]);
 	}
+	C_Tree_Build('B', 1, nsupers, kc, lbext, xsup, grid, BC_L, 's',
+		     LBtree_ptr, needrecv, NULL, NULL);
 
 #ifdef GPU_ACC
 #ifdef HAVE_NVSHMEM
@@ -335,114 +292,21 @@ int strs_compute_communication_structure(superlu_dist_options_t *options, int_t
     if ( !(h_nfrecvmod = (int*)SUPERLU_MALLOC( 4 * sizeof(int))) )
         ABORT("Malloc fails for h_nfrecvmod[].");
     h_nfrecvmod[3]=0;
-    //printf("(%d)k=%d\n",iam,k);
 	for (int i=0;i<kc;i++){
-        mystatus[i]=1;
+        mystatus[i] = needrecv[i] == 1 ? 0 : 1;
 	}
 #endif
 #endif
 
-	for (int_t lk = 0; lk < kc; ++lk) { /* for each local block column ... */
-		jb = mycol+lk*grid->npcol;  /* not sure */
-		if(jb<nsupers){
-            if(supernodeMask[jb]>0){
-                // printf("iam %5d jb %5d \n",iam, jb);
-                // fflush(stdout);
-                pc = PCOL( jb, grid );
-                count = rowcounts[lk];
-                MPI_Allgather(&count, 1, MPI_INT, recvcounts, 1, MPI_INT, cscp->comm);
-                displs[0] = 0;
-                nbg=0;
-                for(int i=0; i<grid->nprow; ++i)
-                {
-                    nbg +=recvcounts[i];
-                }
-                if(nbg>0){
-                    for(int i=0; i<grid->nprow-1; ++i)
-                    {
-                        displs[i+1] = displs[i] + recvcounts[i];
-                    }
-                    MPI_Allgatherv(rowlists[lk], count, mpi_int_t, tmpglo, recvcounts, displs, mpi_int_t, cscp->comm);
-                }
-                for (int_t j=0;j<grid->nprow;++j)ActiveFlag[j]=3*nsupers;
-                for (int_t j=0;j<grid->nprow;++j)ActiveFlag[j+grid->nprow]=j;
-                for (int_t j=0;j<grid->nprow;++j)ranks[j]=-1;
-
-                for (int_t i = 0; i < nbg; ++i) {
-                    gb = tmpglo[i];
-                    pr = PROW( gb, grid );
-                    ActiveFlag[pr]=SUPERLU_MIN(ActiveFlag[pr],gb);
-                } /* for i ... */
-
-                Root=-1;
-                Iactive = 0;
-                for (int_t j=0;j<grid->nprow;++j){
-                    if(ActiveFlag[j]!=3*nsupers){
-                    gb = ActiveFlag[j];
-                    pr = PROW( gb, grid );
-                    if(gb==jb)Root=pr;
-                    if(myrow==pr)Iactive=1;
-                    }
-                }
-
-                quickSortM(ActiveFlag,0,grid->nprow-1,grid->nprow,0,2);
-
-                if(Iactive==1){
-                    // printf("iam %5d jb %5d Root %5d \n",iam, jb,Root);
-                    // fflush(stdout);
-                    assert( Root>-1 );
-                    rank_cnt = 1;
-                    ranks[0]=Root;
-                    for (int_t j = 0; j < grid->nprow; ++j){
-                        if(ActiveFlag[j]!=3*nsupers && ActiveFlag[j+grid->nprow]!=Root){
-                            ranks[rank_cnt]=ActiveFlag[j+grid->nprow];
-                            ++rank_cnt;
-                        }
-                    }
-
-                    if(rank_cnt>1){
-
-                        for (int_t ii=0;ii<rank_cnt;ii++)   // use global ranks rather than local ranks
-                            ranks[ii] = PNUM( ranks[ii], pc, grid );
-
-                        msgsize = SuperSize( jb );
-                        int needrecv=0;
-                        C_BcTree_Create_nv(&LBtree_ptr[lk], grid->comm, ranks, rank_cnt, msgsize, 's',&needrecv);
-                        //C_BcTree_Create(&LBtree_ptr[ljb], grid->comm, ranks, rank_cnt, msgsize, 's');
-                        //printf("(%d) HOST create:ljb=%d,msg=%d,needrecv=%d\n",iam,ljb,mysendmsg_num,needrecv);
-                        #ifdef GPU_ACC
-                        #ifdef HAVE_NVSHMEM
-                        if (needrecv==1) {
-                            mystatus[lk]=0;
-                            //printf("(%d) Col %d need one msg %d\n",iam, ljb,mystatus[ljb]);
-                            //fflush(stdout);
-                        }
-                        #endif
-                        #endif
-                        LBtree_ptr[lk].tag_=BC_L;
-
-                        // printf("iam %5d btree rank_cnt %5d \n",iam,rank_cnt);
-                        // fflush(stdout);
-
-                    }
-                }
-            }
-        }
-    }
-	SUPERLU_FREE(ActiveFlag);
-	SUPERLU_FREE(ranks);
-
-
     /* reduction tree for L*/
 	if ( !(LRtree_ptr = (C_Tree*)SUPERLU_MALLOC(kr * sizeof(C_Tree))) )
 		ABORT("Malloc fails for LRtree_ptr[].");
-	if ( !(ActiveFlag = intCalloc_dist(grid->npcol*2)) )
-		ABORT("Calloc fails for ActiveFlag[].");
-	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->npcol * sizeof(int))) )
-		ABORT("Malloc fails for ranks[].");
 	for (int_t lk = 0; lk <kr ; ++lk) {
 		C_RdTree_Nullify(&LRtree_ptr[lk]);
 	}
+	C_Tree_Build('R', 0, nsupers, kr, lrext, xsup, grid, RD_L, 's',
+		     LRtree_ptr, needrecv, needsend, NULL);
+
 #ifdef GPU_ACC
 #ifdef HAVE_NVSHMEM
     if ( !(mystatusmod = (int*)SUPERLU_MALLOC(2*kr * sizeof(int))) )
@@ -452,194 +316,37 @@ int strs_compute_communication_structure(superlu_dist_options_t *options, int_t
 
 	int nfrecvmod=0;
 	for (int i=0;i<kr;i++){
-        h_recv_cnt[i]=0;
+        h_nfrecvmod[3] += needsend[i];
+        h_recv_cnt[i] = needrecv[i];
+        mystatusmod[i*2] = mystatusmod[i*2+1] = needrecv[i] ? 0 : 1;
+        nfrecvmod += needrecv[i];
 	}
-	for (int i=0;i<2*kr;i++) mystatusmod[i]=1;
 #endif
 #endif
 
-	for (int_t lk=0;lk<kr;++lk){
-		ib = myrow+lk*grid->nprow;  /* not sure */
-		if(ib<nsupers){
-            if(supernodeMask[ib]>0){
-                pr = PROW( ib, grid );
-
-                count = colcounts[lk];
-                MPI_Allgather(&count, 1, MPI_INT, recvcounts, 1, MPI_INT, rscp->comm);
-                displs[0] = 0;
-                nbg=0;
-                for(int i=0; i<grid->npcol; ++i)
-                {
-                    nbg +=recvcounts[i];
-                }
-                if(nbg>0){
-                    for(int i=0; i<grid->npcol-1; ++i)
-                    {
-                        displs[i+1] = displs[i] + recvcounts[i];
-                    }
-                    MPI_Allgatherv(collists[lk], count, mpi_int_t, tmpglo, recvcounts, displs, mpi_int_t, rscp->comm);
-                }
-                for (int_t j=0;j<grid->npcol;++j)ActiveFlag[j]=-3*nsupers;
-                for (int_t j=0;j<grid->npcol;++j)ActiveFlag[j+grid->npcol]=j;
-                for (int_t j=0;j<grid->npcol;++j)ranks[j]=-1;
-
-                for (int_t j = 0; j < nbg; ++j) {
-                    gb = tmpglo[j];
-                    pc = PCOL( gb, grid );
-                    ActiveFlag[pc]=SUPERLU_MAX(ActiveFlag[pc],gb);
-                } /* for j ... */
-
-                Root=-1;
-                Iactive = 0;
-
-                for (int_t j=0;j<grid->npcol;++j){
-                    if(ActiveFlag[j]!=-3*nsupers){
-                    jb = ActiveFlag[j];
-                    pc = PCOL( jb, grid );
-                    if(jb==ib)Root=pc;
-                    if(mycol==pc)Iactive=1;
-                    }
-                }
-
-                quickSortM(ActiveFlag,0,grid->npcol-1,grid->npcol,1,2);
-
-                if(Iactive==1){
-                    assert( Root>-1 );
-                    rank_cnt = 1;
-                    ranks[0]=Root;
-                    for (int_t j = 0; j < grid->npcol; ++j){
-                        if(ActiveFlag[j]!=-3*nsupers && ActiveFlag[j+grid->npcol]!=Root){
-                            ranks[rank_cnt]=ActiveFlag[j+grid->npcol];
-                            ++rank_cnt;
-                        }
-                    }
-                    if(rank_cnt>1){
-                        for (int_t ii=0;ii<rank_cnt;ii++)   // use global ranks rather than local ranks
-                            ranks[ii] = PNUM( pr, ranks[ii], grid );
-                        msgsize = SuperSize( ib );
-                        // C_RdTree_Create(&LRtree_ptr[lk], grid->comm, ranks, rank_cnt, msgsize, 's');
-
-                        int needrecvrd=0;
-                        int needsendrd=0;
-                        C_RdTree_Create_nv(&LRtree_ptr[lk], grid->comm, ranks, rank_cnt, msgsize, 's', &needrecvrd, &needsendrd);
-                        //C_RdTree_Create(&LRtree_ptr[lib], grid->comm, ranks, rank_cnt, msgsize, 's');
-                        #ifdef GPU_ACC
-                        #ifdef HAVE_NVSHMEM
-                        h_nfrecvmod[3]+=needsendrd;
-                        if (needrecvrd!=0) {
-                            mystatusmod[lk*2]=0;
-                            mystatusmod[lk*2+1]=0;
-                            h_recv_cnt[lk]=needrecvrd;
-                            //printf("(%d) on CPU, lib=%d, cnt=%d\n",iam,lib,LRtree_ptr[lib].destCnt_);
-                            nfrecvmod+=needrecvrd;
-                        }
-                        #endif
-                        #endif
-                        LRtree_ptr[lk].tag_=RD_L;
-                    }
-                }
-            }
-        }
-    }
-	SUPERLU_FREE(ActiveFlag);
-	SUPERLU_FREE(ranks);
-
-
-
-
-    for (int_t j=0; j<kc; j++){
-        if(rowlists[j]){
-            SUPERLU_FREE(rowlists[j]);
-        }
-    }
-    for (int_t i=0; i<kr; i++){
-        if(collists[i]){
-            SUPERLU_FREE(collists[i]);
+    /* update bsendx_plist with the supernode mask. Note that fsendx_plist doesn't require updates */
+    for (int_t lk=0;lk<kc;++lk){
+        jb = mycol+lk*grid->npcol;  /* not sure */
+        if(jb<nsupers){
+        int_t krow = PROW(jb, grid);
+        int_t kcol = PCOL(jb, grid);
+        if (myrow == krow && mycol == kcol){
+        for (int_t pr=0;pr<grid->nprow;++pr){
+            Llu->bsendx_plist[lk][pr]=  SLU_EMPTY;
         }
-    }
-    SUPERLU_FREE(rowcounts);
-    SUPERLU_FREE(colcounts);
-    SUPERLU_FREE(rowlists);
-    SUPERLU_FREE(collists);
-
-
-    /* gather information about the global U structure */
-
-	if ( !(rowcounts = intCalloc_dist(kc)) )
-		ABORT("Calloc fails for rowcounts[].");
-	if ( !(colcounts = intCalloc_dist(kr)) )
-		ABORT("Calloc fails for colcounts[].");
-
-	if ( !(rowlists = (int_t**)SUPERLU_MALLOC(kc * sizeof(int_t*))) )
-		fprintf(stderr, "Malloc fails for rowlists[].");
-	if ( !(collists = (int_t**)SUPERLU_MALLOC(kr * sizeof(int_t*))) )
-		fprintf(stderr, "Malloc fails for collists[].");
-
-	for (int_t lk = 0; lk < kc; ++lk) { /* for each local block column ... */
-		jb = mycol+lk*grid->npcol;  /* not sure */
-		if(jb<nsupers){
-            if(supernodeMask[jb]>0){
-                nub = Urbs[lk];      /* Number of U blocks in block column lk */
-                for (int_t ub = 0; ub < nub; ++ub){
-                    int_t lib = Ucb_indptr[lk][ub].lbnum; /* Local block number, row-wise. */
-                    ib = lib * grid->nprow + myrow;/* Global block number, row-wise. */
-                    if(supernodeMask[ib]>0){
-                        rowcounts[lk]++;
-                        colcounts[lib]++;
-                    }
-                }
-            }
-		}
-	}
-
-    for (int_t j=0; j<kc; j++){
-        if(rowcounts[j]>0){
-            if ( !(rowlists[j] = intCalloc_dist(rowcounts[j])) )
-                ABORT("Calloc fails for rowlists[j].");
-        }else{
-            rowlists[j] = NULL;
         }
-        rowcounts[j]=0;
-    }
-    for (int_t i=0; i<kr; i++){
-        if(colcounts[i]>0){
-            if ( !(collists[i] = intCalloc_dist(colcounts[i])) )
-                ABORT("Calloc fails for collists[i].");
-        }else{
-            collists[i] = NULL;
         }
-        colcounts[i]=0;
     }
 
-	for (int_t lk = 0; lk < kc; ++lk) { /* for each local block column ... */
-		jb = mycol+lk*grid->npcol;  /* not sure */
-		if(jb<nsupers){
-            if(supernodeMask[jb]>0){
-                nub = Urbs[lk];      /* Number of U blocks in block column lk */
-                for (int_t ub = 0; ub < nub; ++ub){
-                    int_t lib = Ucb_indptr[lk][ub].lbnum; /* Local block number, row-wise. */
-                    ib = lib * grid->nprow + myrow;/* Global block number, row-wise. */
-                    if(supernodeMask[ib]>0){
-                        rowlists[lk][rowcounts[lk]++]=ib;
-                        collists[lib][colcounts[lib]++]=jb;
-                    }
-                }
-            }
-		}
-	}
-
-
-
     /* broadcast tree for U*/
 	if ( !(UBtree_ptr = (C_Tree*)SUPERLU_MALLOC(kc * sizeof(C_Tree))) )
 		ABORT("Malloc fails for UBtree_ptr[].");
-	if ( !(ActiveFlag = intCalloc_dist(grid->nprow*2)) )
-		ABORT("Calloc fails for ActiveFlag[].");
-	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->nprow * sizeof(int))) )
-		ABORT("Malloc fails for ranks[].");
 	for (int_t lk = 0; lk <kc ; ++lk) {
 		C_BcTree_Nullify(&UBtree_ptr[lk]);
 	}
+	C_Tree_Build('B', 0, nsupers, kc, ubext, xsup, grid, BC_U, 's',
+		     UBtree_ptr, needrecv, NULL, Llu->bsendx_plist);
+
 #ifdef GPU_ACC
 #ifdef HAVE_NVSHMEM
 	if ( !(mystatus_u = (int*)SUPERLU_MALLOC(kc * sizeof(int))) )
@@ -651,122 +358,19 @@ int strs_compute_communication_structure(superlu_dist_options_t *options, int_t
     h_nfrecvmod_u[3]=0;
 
 	for (int i=0;i<kc;i++){
-		mystatus_u[i]=1;
+		mystatus_u[i] = needrecv[i] == 1 ? 0 : 1;
 	}
 #endif
 #endif
 
-
-    /* update bsendx_plist with the supernode mask. Note that fsendx_plist doesn't require updates */
-    for (int_t lk=0;lk<kc;++lk){
-        jb = mycol+lk*grid->npcol;  /* not sure */
-        if(jb<nsupers){
-        int_t krow = PROW(jb, grid);
-        int_t kcol = PCOL(jb, grid);
-        if (myrow == krow && mycol == kcol){
-        for (int_t pr=0;pr<grid->nprow;++pr){
-            Llu->bsendx_plist[lk][pr]=  SLU_EMPTY;
-        }
-        }
-        }
-    }
-
-	for (int_t lk = 0; lk < kc; ++lk) { /* for each local block column ... */
-		jb = mycol+lk*grid->npcol;  /* not sure */
-		if(jb<nsupers){
-            if(supernodeMask[jb]>0){
-                pc = PCOL( jb, grid );
-                count = rowcounts[lk];
-                MPI_Allgather(&count, 1, MPI_INT, recvcounts, 1, MPI_INT, cscp->comm);
-                displs[0] = 0;
-                nbg=0;
-                for(int i=0; i<grid->nprow; ++i)
-                {
-                    nbg +=recvcounts[i];
-                }
-                if(nbg>0){
-                    for(int i=0; i<grid->nprow-1; ++i)
-                    {
-                        displs[i+1] = displs[i] + recvcounts[i];
-                    }
-                    MPI_Allgatherv(rowlists[lk], count, mpi_int_t, tmpglo, recvcounts, displs, mpi_int_t, cscp->comm);
-                }
-
-                for (int_t j=0;j<grid->nprow;++j)ActiveFlag[j]=-3*nsupers;
-                for (int_t j=0;j<grid->nprow;++j)ActiveFlag[j+grid->nprow]=j;
-                for (int_t j=0;j<grid->nprow;++j)ranks[j]=-1;
-
-                for (int_t i = 0; i < nbg; ++i) {
-                    gb = tmpglo[i];
-                    pr = PROW( gb, grid );
-                    ActiveFlag[pr]=SUPERLU_MAX(ActiveFlag[pr],gb);
-                } /* for i ... */
-
-                pr = PROW( jb, grid ); // take care of diagonal node stored as L
-                ActiveFlag[pr]=SUPERLU_MAX(ActiveFlag[pr],jb);
-
-                Root=-1;
-                Iactive = 0;
-                for (int_t j=0;j<grid->nprow;++j){
-                    if(ActiveFlag[j]!=-3*nsupers){
-                    gb = ActiveFlag[j];
-                    pr = PROW( gb, grid );
-                    if(gb==jb)Root=pr;
-                    if(myrow==pr)Iactive=1;
-                    if(myrow!=pr && myrow == PROW(jb, grid)) /* update bsendx_plist with the supernode mask */
-                        Llu->bsendx_plist[lk][pr]=YES;
-                    }
-                }
-
-                quickSortM(ActiveFlag,0,grid->nprow-1,grid->nprow,1,2);
-
-                if(Iactive==1){
-                    assert( Root>-1 );
-                    rank_cnt = 1;
-                    ranks[0]=Root;
-                    for (int_t j = 0; j < grid->nprow; ++j){
-                        if(ActiveFlag[j]!=-3*nsupers && ActiveFlag[j+grid->nprow]!=Root){
-                            ranks[rank_cnt]=ActiveFlag[j+grid->nprow];
-                            ++rank_cnt;
-                        }
-                    }
-                    if(rank_cnt>1){
-                        for (int_t ii=0;ii<rank_cnt;ii++)   // use global ranks rather than local ranks
-                            ranks[ii] = PNUM( ranks[ii], pc, grid );
-                        msgsize = SuperSize( jb );
-                        // C_BcTree_Create(&UBtree_ptr[lk], grid->comm, ranks, rank_cnt, msgsize, 's');
-
-                        int needrecv=0;
-                        C_BcTree_Create_nv(&UBtree_ptr[lk], grid->comm, ranks, rank_cnt, msgsize, 's',&needrecv);
-                        //C_BcTree_Create(&UBtree_ptr[ljb], grid->comm, ranks, rank_cnt, msgsize, 's');
-                        #ifdef GPU_ACC
-                        #ifdef HAVE_NVSHMEM
-                        if (needrecv==1) {
-                            mystatus_u[lk]=0;
-                            //printf("(%d) Col %d need one msg %d\n",iam, ljb,mystatus[ljb]);
-                        }
-                        #endif
-                        #endif
-                        UBtree_ptr[lk].tag_=BC_U;
-                    }
-                }
-            }
-        }
-    }
-	SUPERLU_FREE(ActiveFlag);
-	SUPERLU_FREE(ranks);
-
-
     /* reduction tree for U*/
 	if ( !(URtree_ptr = (C_Tree*)SUPERLU_MALLOC(kr * sizeof(C_Tree))) )
 		ABORT("Malloc fails for URtree_ptr[].");
-	if ( !(ActiveFlag = intCalloc_dist(grid->npcol*2)) )
-		ABORT("Calloc fails for ActiveFlag[].");
-	if ( !(ranks = (int*)SUPERLU_MALLOC(grid->npcol * sizeof(int))) )
-		ABORT("Malloc fails for ranks[].");
 	for (int_t lk = 0; lk <kr ; ++lk) {
 		C_RdTree_Nullify(&URtree_ptr[lk]);
 	}
+	C_Tree_Build('R', 1, nsupers, kr, urext, xsup, grid, RD_U, 's',
+		     URtree_ptr, needrecv, needsend, NULL);
 
     #ifdef GPU_ACC
     #ifdef HAVE_NVSHMEM
@@ -777,118 +381,16 @@ int strs_compute_communication_structure(superlu_dist_options_t *options, int_t
 
     int nbrecvmod=0;
 	for (int i=0;i<kr;i++){
-        h_recv_cnt_u[i]=0;
+        h_nfrecvmod_u[3] += needsend[i];
+        h_recv_cnt_u[i] = needrecv[i];
+        mystatusmod_u[i*2] = mystatusmod_u[i*2+1] = needrecv[i] ? 0 : 1;
+        nbrecvmod += needrecv[i];
 	}
-	for (int i=0;i<2*kr;i++) mystatusmod_u[i]=1;
     #endif
     #endif
 
-	for (int_t lk=0;lk<kr;++lk){
-		ib = myrow+lk*grid->nprow;  /* not sure */
-		if(ib<nsupers){
-            if(supernodeMask[ib]>0){
-                pr = PROW( ib, grid );
-
-                count = colcounts[lk];
-                MPI_Allgather(&count, 1, MPI_INT, recvcounts, 1, MPI_INT, rscp->comm);
-                displs[0] = 0;
-                nbg=0;
-                for(int i=0; i<grid->npcol; ++i)
-                {
-                    nbg +=recvcounts[i];
-                }
-                if(nbg>0){
-                    for(int i=0; i<grid->npcol-1; ++i)
-                    {
-                        displs[i+1] = displs[i] + recvcounts[i];
-                    }
-                    MPI_Allgatherv(collists[lk], count, mpi_int_t, tmpglo, recvcounts, displs, mpi_int_t, rscp->comm);
-                }
-                for (int_t j=0;j<grid->npcol;++j)ActiveFlag[j]=3*nsupers;
-                for (int_t j=0;j<grid->npcol;++j)ActiveFlag[j+grid->npcol]=j;
-                for (int_t j=0;j<grid->npcol;++j)ranks[j]=-1;
-
-                for (int_t j = 0; j < nbg; ++j) {
-                    gb = tmpglo[j];
-                    pc = PCOL( gb, grid );
-                    ActiveFlag[pc]=SUPERLU_MIN(ActiveFlag[pc],gb);
-                } /* for j ... */
-                pc = PCOL( ib, grid ); // take care of diagonal node stored as L
-                ActiveFlag[pc]=SUPERLU_MIN(ActiveFlag[pc],ib);
-
-                Root=-1;
-                Iactive = 0;
-
-                for (int_t j=0;j<grid->npcol;++j){
-                    if(ActiveFlag[j]!=3*nsupers){
-                    jb = ActiveFlag[j];
-                    pc = PCOL( jb, grid );
-                    if(jb==ib)Root=pc;
-                    if(mycol==pc)Iactive=1;
-                    }
-                }
-
-                quickSortM(ActiveFlag,0,grid->npcol-1,grid->npcol,0,2);
-
-                if(Iactive==1){
-                    assert( Root>-1 );
-                    rank_cnt = 1;
-                    ranks[0]=Root;
-                    for (int_t j = 0; j < grid->npcol; ++j){
-                        if(ActiveFlag[j]!=3*nsupers && ActiveFlag[j+grid->npcol]!=Root){
-                            ranks[rank_cnt]=ActiveFlag[j+grid->npcol];
-                            ++rank_cnt;
-                        }
-                    }
-                    if(rank_cnt>1){
-                        for (int_t ii=0;ii<rank_cnt;ii++)   // use global ranks rather than local ranks
-                            ranks[ii] = PNUM( pr, ranks[ii], grid );
-                        msgsize = SuperSize( ib );
-                        // C_RdTree_Create(&URtree_ptr[lk], grid->comm, ranks, rank_cnt, msgsize, 's');
-
-                        int needrecvrd=0;
-                        int needsendrd=0;
-                        C_RdTree_Create_nv(&URtree_ptr[lk], grid->comm, ranks, rank_cnt, msgsize, 's', &needrecvrd,&needsendrd);
-                        //C_RdTree_Create(&URtree_ptr[lib], grid->comm, ranks, rank_cnt, msgsize, 's');
-                        #ifdef GPU_ACC
-                        #ifdef HAVE_NVSHMEM
-                        h_nfrecvmod_u[3] +=needsendrd;
-                        if (needrecvrd!=0) {
-                            mystatusmod_u[lk*2]=0;
-                            mystatusmod_u[lk*2+1]=0;
-                            h_recv_cnt_u[lk]=needrecvrd;
-                            //printf("(%d) on CPU, lib=%d, cnt=%d\n",iam,lib,LRtree_ptr[lib].destCnt_);
-                            nbrecvmod+=needrecvrd;
-                        }
-                        #endif
-                        #endif
-                        URtree_ptr[lk].tag_=RD_U;
-                    }
-                }
-            }
-        }
-    }
-	SUPERLU_FREE(ActiveFlag);
-	SUPERLU_FREE(ranks);
-
-    for (int_t j=0; j<kc; j++){
-        if(rowlists[j]){
-            SUPERLU_FREE(rowlists[j]);
-        }
-    }
-    for (int_t i=0; i<kr; i++){
-        if(collists[i]){
-            SUPERLU_FREE(collists[i]);
-        }
-    }
-    SUPERLU_FREE(rowcounts);
-    SUPERLU_FREE(colcounts);
-    SUPERLU_FREE(rowlists);
-    SUPERLU_FREE(collists);
-
-    SUPERLU_FREE(tmpglo);
-    SUPERLU_FREE(recvcounts);
-    SUPERLU_FREE(displs);
+    SUPERLU_FREE(needrecv);
+    SUPERLU_FREE(lbext);
 
 
 
@@ -6532,6 +6034,159 @@ psReDistribute3d_X_to_B (int_t n, float *B, int_t m_loc, int_t ldb,
 
 }                               /* psReDistribute_X_to_B */
 
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ *
+ *   Re-distribute B on the 3D process grid to X on the diagonal processes
+ *   of all the layers.  Row i of B goes to the layer that keeps its
+ *   supernode, see superlu_route_B3d(); the X blocks of the other layers
+ *   are zero.  This replaces the gather of B on layer 0, the B -> X
+ *   redistribution on layer 0 and the broadcast of X to the other layers.
+ *   m_loc and ldb refer to the 3D grid; fst_row is the row of B's first
+ *   row in the order of the matrix gathered on layer 0.
+ * </pre>
+ */
+int_t
+psReDistribute3d_B3d_to_X (int_t nsupers, float *B, int_t m_loc, int nrhs,
+                           int_t ldb, int_t fst_row, float *x, int_t * ilsum,
+                           sScalePermstruct_t * ScalePermstruct,
+                           Glu_persist_t * Glu_persist,
+                           strf3Dpartition_t * trf3Dpartition,
+                           gridinfo3d_t * grid3d)
+{
+    gridinfo_t * grid = &(grid3d->grid2d);
+    int_t *xsup = Glu_persist->xsup;
+    int_t *supno = Glu_persist->supno;
+    A3dRoute_t *route;
+    float *sbuf = NULL, *rbuf = NULL;
+    int_t i, irow, j, k, knsupc, l, lk, s;
+    int iam = grid->iam;
+    int myrow = MYROW (iam, grid), mycol = MYCOL (iam, grid);
+    MPI_Datatype row;
+
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC (iam, "Enter psReDistribute3d_B3d_to_X()");
+#endif
+
+    /* Headers and zero X-blocks on the diagonal processes of all layers. */
+    for (k = 0; k < nsupers; ++k) {
+        if (myrow == PROW (k, grid) && mycol == PCOL (k, grid)) {
+            knsupc = SuperSize (k);
+            lk = LBi (k, grid);
+            l = X_BLK (lk);
+            x[l - XK_H] = k;
+            for (i = 0; i < knsupc * nrhs; ++i) x[l + i] = 0.0;
+        }
+    }
+
+    route = superlu_route_B3d(m_loc, fst_row, ScalePermstruct->perm_r,
+                              ScalePermstruct->perm_c, supno,
+                              trf3Dpartition->supernode2treeMap, grid3d);
+
+    /* RHS is stored in row major in the buffers. */
+    if (route->nsend && !(sbuf = floatMalloc_dist (route->nsend * nrhs)))
+        ABORT ("Malloc fails for sbuf[].");
+    if (route->nrecv && !(rbuf = floatMalloc_dist (route->nrecv * nrhs)))
+        ABORT ("Malloc fails for rbuf[].");
+    for (i = 0; i < m_loc; ++i) {
+        s = route->send_pos[i] * nrhs;
+        for (j = 0; j < nrhs; ++j) sbuf[s + j] = B[i + j * ldb];
+    }
+    MPI_Type_contiguous (nrhs, MPI_FLOAT, &row);
+    MPI_Type_commit (&row);
+    MPI_Alltoallv (sbuf, route->send_counts, route->send_disp, row,
+                   rbuf, route->recv_counts, route->recv_disp, row,
+                   grid3d->comm);
+    MPI_Type_free (&row);
+
+    for (s = 0; s < route->nrecv; ++s) {
+        irow = route->recv_pos[s];  /* The permuted row index. */
+        k = BlockNum (irow);
+        knsupc = SuperSize (k);
+        l = X_BLK (LBi (k, grid));
+        irow -= FstBlockC (k);      /* Relative row number in X-block */
+        for (j = 0; j < nrhs; ++j)
+            x[l + irow + j * knsupc] = rbuf[s * nrhs + j];
+    }
+
+    if (route->nsend) SUPERLU_FREE (sbuf);
+    if (route->nrecv) SUPERLU_FREE (rbuf);
+    superlu_free_route_A3d (route);
+#if ( DEBUGlevel>=1 )
+    CHECK_MALLOC (iam, "Exit psReDistribute3d_B3d_to_X()");
+#endif
+    return 0;
+} /* psReDistribute3d_B3d_to_X */
+
+/*! \brief
+ *
+ * <pre>
+ * Purpose
+ *
+ *   Return the solution from the diagonal processes of the layer that
+ *   keeps each supernode to B on the 3D process grid.  X is in the column
+ *   space, where the rows of the 3D processes follow each other in rank
+ *   order as in sScatter_B3d(): row i of B receives row perm_c[i + x_fst_row]
+ *   of the permuted X.  This replaces the gather of X on layer 0, the
+ *   X -> B redistribution and the permutation by Pc' on layer 0 and the
+ *   scatter of B to the 3D grid.
+ * </pre>
+ */
+int_t
+psReDistribute3d_X_to_B3d (float *B, int_t m_loc, int_t ldb, int nrhs,
+                           float *x, int_t * ilsum,
+                           sScalePermstruct_t * ScalePermstruct,
+                           Glu_persist_t * Glu_persist,
+                           strf3Dpartition_t * trf3Dpartition,
+                           gridinfo3d_t * grid3d)
+{
+    gridinfo_t * grid = &(grid3d->grid2d);
+    int_t *xsup = Glu_persist->xsup;
+    int_t *supno = Glu_persist->supno;
+    A3dRoute_t *route;
+    float *sbuf = NULL, *rbuf = NULL;
+    int_t i, irow, j, k, knsupc, l, s, x_fst_row = 0;
+    MPI_Datatype row;
+
+    MPI_Exscan(&m_loc, &x_fst_row, 1, mpi_int_t, MPI_SUM, grid3d->comm);
+    if ( !grid3d->iam ) x_fst_row = 0;
+
+    /* Ask the owners for the rows of X, then reverse the route. */
+    route = superlu_route_B3d(m_loc, x_fst_row, NULL, ScalePermstruct->perm_c,
+                              supno, trf3Dpartition->supernode2treeMap, grid3d);
+
+    if (route->nrecv && !(sbuf = floatMalloc_dist (route->nrecv * nrhs)))
+        ABORT ("Malloc fails for sbuf[].");
+    if (route->nsend && !(rbuf = floatMalloc_dist (route->nsend * nrhs)))
+        ABORT ("Malloc fails for rbuf[].");
+    for (s = 0; s < route->nrecv; ++s) {
+        irow = route->recv_pos[s];
+        k = BlockNum (irow);
+        knsupc = SuperSize (k);
+        l = X_BLK (LBi (k, grid));
+        irow -= FstBlockC (k);
+        for (j = 0; j < nrhs; ++j)
+            sbuf[s * nrhs + j] = x[l + irow + j * knsupc];
+    }
+    MPI_Type_contiguous (nrhs, MPI_FLOAT, &row);
+    MPI_Type_commit (&row);
+    MPI_Alltoallv (sbuf, route->recv_counts, route->recv_disp, row,
+                   rbuf, route->send_counts, route->send_disp, row,
+                   grid3d->comm);
+    MPI_Type_free (&row);
+    for (i = 0; i < m_loc; ++i) {
+        s = route->send_pos[i] * nrhs;
+        for (j = 0; j < nrhs; ++j) B[i + j * ldb] = rbuf[s + j];
+    }
+
+    if (route->nrecv) SUPERLU_FREE (sbuf);
+    if (route->nsend) SUPERLU_FREE (rbuf);
+    superlu_free_route_A3d (route);
+    return 0;
+} /* psReDistribute3d_X_to_B3d */
+
 
 /*! \brief
  *
@@ -6577,6 +6232,14 @@ psReDistribute3d_X_to_B (int_t n, float *B, int_t m_loc, int_t ldb,
  *        On exit, the distributed solution matrix Y of the possibly
  *        equilibrated system if info = 0, where Y = Pc*diag(C)^(-1)*X,
  *        and X is the solution of the original system.
+ *        B is gathered on the 2D layers, with m_loc and fst_row of the
+ *        2D grid, and X is returned on layer 0.  When
+ *        superlu_solve_rhs3d(options) is true, B is instead on the 3D
+ *        process grid: m_loc is the number of local rows on the 3D grid
+ *        and fst_row the number of the first one in the row order of the
+ *        gathered matrix.  The rows go directly to the layers that solve
+ *        their supernodes, and X comes back in B in the row order of B,
+ *        i.e. already permuted by Pc'; see psReDistribute3d_B3d_to_X().
  *
  * m_loc  (input) int (local)
  *        The local row dimension of matrix B.
@@ -6676,6 +6339,7 @@ psgstrs3d (superlu_dist_options_t *options, int_t n, sLUstruct_t * LUstruct,
     Lnzval_bc_ptr = Llu->Lnzval_bc_ptr;
     nlb = CEILING (nsupers, Pr);    /* Number of local block rows. */
     int_t nub = CEILING (nsupers, Pc);
+    int rhs3d = superlu_solve_rhs3d(options); /* B and X on the 3D grid */
 
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC (iam, "Enter pdgstrs3d()");
@@ -6756,8 +6420,13 @@ psgstrs3d (superlu_dist_options_t *options, int_t n, sLUstruct_t * LUstruct,
     initTRStimer(&xtrsTimer, grid);
     double tx = SuperLU_timer_();
     /* Redistribute B into X on the diagonal processes. */
-    psReDistribute3d_B_to_X(B, m_loc, nrhs, ldb, fst_row, ilsum, x,
-                            ScalePermstruct, Glu_persist, grid3d, SOLVEstruct);
+    if (rhs3d)
+        psReDistribute3d_B3d_to_X(nsupers, B, m_loc, nrhs, ldb, fst_row, x,
+                                  ilsum, ScalePermstruct, Glu_persist, trf3Dpartition,
+                                  grid3d);
+    else
+        psReDistribute3d_B_to_X(B, m_loc, nrhs, ldb, fst_row, ilsum, x,
+                                ScalePermstruct, Glu_persist, grid3d, SOLVEstruct);
 
     xtrsTimer.t_pxReDistribute_B_to_X = SuperLU_timer_() - tx;
 
@@ -6765,7 +6434,7 @@ psgstrs3d (superlu_dist_options_t *options, int_t n, sLUstruct_t * LUstruct,
      * Forward solve Ly = b.
      *---------------------------------------------------*/
 
-    strs_B_init3d(nsupers, x, nrhs, LUstruct, grid3d);
+    if (!rhs3d) strs_B_init3d(nsupers, x, nrhs, LUstruct, grid3d);
 
     MPI_Barrier (grid3d->comm);
     tx = SuperLU_timer_();
@@ -6893,10 +6562,18 @@ psgstrs3d (superlu_dist_options_t *options, int_t n, sLUstruct_t * LUstruct,
     xtrsTimer.t_backwardSolve = SuperLU_timer_() - tx;
     MPI_Barrier (grid3d->comm);
     stat->utime[SOLVE] = SuperLU_timer_ () - tx_st;
-    strs_X_gather3d(x, nrhs, trf3Dpartition, LUstruct, grid3d, &xtrsTimer);
-    tx = SuperLU_timer_();
-    psReDistribute3d_X_to_B(n, B, m_loc, ldb, fst_row, nrhs, x, ilsum,
-                            ScalePermstruct, Glu_persist, grid3d, SOLVEstruct);
+    if (rhs3d) {
+        /* Each layer returns the supernodes it keeps. */
+        tx = SuperLU_timer_();
+        psReDistribute3d_X_to_B3d(B, m_loc, ldb, nrhs, x, ilsum,
+                                  ScalePermstruct, Glu_persist, trf3Dpartition,
+                                  grid3d);
+    } else {
+        strs_X_gather3d(x, nrhs, trf3Dpartition, LUstruct, grid3d, &xtrsTimer);
+        tx = SuperLU_timer_();
+        psReDistribute3d_X_to_B(n, B, m_loc, ldb, fst_row, nrhs, x, ilsum,
+                                ScalePermstruct, Glu_persist, grid3d, SOLVEstruct);
+    }
 
     xtrsTimer.t_pxReDistribute_X_to_B = SuperLU_timer_() - tx;
 
@@ -7003,6 +6680,7 @@ psgstrs3d_newsolve (superlu_dist_options_t *options, int_t n, sLUstruct_t * LUst
     Lnzval_bc_ptr = Llu->Lnzval_bc_ptr;
     nlb = CEILING (nsupers, Pr);    /* Number of local block rows. */
     int_t nub = CEILING (nsupers, Pc);
+    int rhs3d = superlu_solve_rhs3d(options); /* B and X on the 3D grid */
 
 #if ( DEBUGlevel>=1 )
     CHECK_MALLOC (iam, "Enter pdgstrs3d_newsolve()");
@@ -7087,8 +6765,13 @@ if ( !(get_new3dsolvetreecomm() && get_acc_solve())){
     initTRStimer(&xtrsTimer, grid);
     double tx = SuperLU_timer_();
     /* Redistribute B into X on the diagonal processes. */
-    psReDistribute3d_B_to_X(B, m_loc, nrhs, ldb, fst_row, ilsum, x,
-                            ScalePermstruct, Glu_persist, grid3d, SOLVEstruct);
+    if (rhs3d)
+        psReDistribute3d_B3d_to_X(nsupers, B, m_loc, nrhs, ldb, fst_row, x,
+                                  ilsum, ScalePermstruct, Glu_persist, trf3Dpartition,
+                                  grid3d);
+    else
+        psReDistribute3d_B_to_X(B, m_loc, nrhs, ldb, fst_row, ilsum, x,
+                                ScalePermstruct, Glu_persist, grid3d, SOLVEstruct);
 
     xtrsTimer.t_pxReDistribute_B_to_X = SuperLU_timer_() - tx;
 
@@ -7096,7 +6779,8 @@ if ( !(get_new3dsolvetreecomm() && get_acc_solve())){
      * Forward solve Ly = b.
      *---------------------------------------------------*/
 
-    strs_B_init3d_newsolve(nsupers, x, nrhs, LUstruct, grid3d, trf3Dpartition);
+    if (!rhs3d)
+        strs_B_init3d_newsolve(nsupers, x, nrhs, LUstruct, grid3d, trf3Dpartition);
 
     MPI_Barrier (grid3d->comm);
     tx = SuperLU_timer_();
@@ -7266,10 +6950,18 @@ if ( !(get_new3dsolvetreecomm() && get_acc_solve())){
     xtrsTimer.t_backwardSolve = SuperLU_timer_() - tx;
     MPI_Barrier (grid3d->comm);
     stat->utime[SOLVE] = SuperLU_timer_ () - tx_st;
-    strs_X_gather3d(x, nrhs, trf3Dpartition, LUstruct, grid3d, &xtrsTimer);
-    tx = SuperLU_timer_();
-    psReDistribute3d_X_to_B(n, B, m_loc, ldb, fst_row, nrhs, x, ilsum,
-                            ScalePermstruct, Glu_persist, grid3d, SOLVEstruct);
+    if (rhs3d) {
+        /* Each layer returns the supernodes it keeps. */
+        tx = SuperLU_timer_();
+        psReDistribute3d_X_to_B3d(B, m_loc, ldb, nrhs, x, ilsum,
+                                  ScalePermstruct, Glu_persist, trf3Dpartition,
+                                  grid3d);
+    } else {
+        strs_X_gather3d(x, nrhs, trf3Dpartition, LUstruct, grid3d, &xtrsTimer);
+        tx = SuperLU_timer_();
+        psReDistribute3d_X_to_B(n, B, m_loc, ldb, fst_row, nrhs, x, ilsum,
+                                ScalePermstruct, Glu_persist, grid3d, SOLVEstruct);
+    }
 
     xtrsTimer.t_pxReDistribute_X_to_B = SuperLU_timer_() - tx;
 
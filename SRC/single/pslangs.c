@@ -72,7 +72,7 @@ float pslangs(char *norm, SuperMatrix *A, gridinfo_t *grid)
     float   value=0., sum;
     float   *rwork;
     float   tempvalue;
-    float   *temprwork;
+    superlu_colmap_t cm;
 
     Astore = (NRformat_loc *) A->Store;
     m_loc = Astore->m_loc;
@@ -102,6 +102,9 @@ float pslangs(char *norm, SuperMatrix *A, gridinfo_t *grid)
 	    value = SUPERLU_MAX(value,sum);
 	}
 #else /* Sherry ==> */
+	/* The column sums are reduced on the owners of the columns. */
+	superlu_colmap_init(&cm, A->ncol, Astore->nnz_loc, Astore->colind,
+			    grid->comm);
 	if ( !(rwork = floatCalloc_dist(A->ncol)) )
 	    ABORT("floatCalloc_dist fails for rwork.");
 	for (i = 0; i < m_loc; ++i) {
@@ -110,16 +113,16 @@ float pslangs(char *norm, SuperMatrix *A, gridinfo_t *grid)
 		rwork[jcol] += fabs(Aval[j]);
 	    }
 	}
+	superlu_colmap_reduce(&cm, rwork, MPI_FLOAT, MPI_SUM);
 
-	if ( !(temprwork = floatCalloc_dist(A->ncol)) )
-	    ABORT("floatCalloc_dist fails for temprwork.");
-	MPI_Allreduce(rwork, temprwork, A->ncol, MPI_FLOAT, MPI_SUM, grid->comm);
 	value = 0.;
-	for (j = 0; j < A->ncol; ++j) {
-	    value = SUPERLU_MAX(value, temprwork[j]);
+	for (j = cm.fst_col; j < cm.fst_col + cm.ncol_loc; ++j) {
+	    value = SUPERLU_MAX(value, rwork[j]);
 	}
-	SUPERLU_FREE (temprwork);
+	MPI_Allreduce(&value, &tempvalue, 1, MPI_FLOAT, MPI_MAX, grid->comm);
+	value = tempvalue;
 	SUPERLU_FREE (rwork);
+	superlu_colmap_free(&cm);
 #endif
     } else if ( strncmp(norm, "I", 1)==0 ) {
 	/* Find normI(A). */
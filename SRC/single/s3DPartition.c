@@ -29,10 +29,11 @@ void snewTrfPartitionInit(int_t nsupers,  sLUstruct_t *LUstruct, gridinfo3d_t *g
     /*update treelist with weight and depth*/
     getSCUweight_allgrid(nsupers, treeList, xsup,
         LUstruct->Llu->Lrowind_bc_ptr, LUstruct->Llu->Ufstnz_br_ptr,
-        grid3d);
+        grid3d, &LUstruct->costmodel);
 #endif
     // Calculation of tree weight
-    calcTreeWeight(nsupers, setree, treeList, LUstruct->Glu_persist->xsup);
+    calcTreeWeight(nsupers, setree, treeList, LUstruct->Glu_persist->xsup,
+                   &LUstruct->costmodel);
 
     // Calculation of maximum level
     int_t maxLvl = log2i(grid3d->zscp.Np) + 1;
@@ -181,8 +182,8 @@ void snewTrfPartitionInit(int_t nsupers,  sLUstruct_t *LUstruct, gridinfo3d_t *g
 }
 
 
-// function to broad permuted sparse matrix and symbolic factorization data from
-// 2d to 3d grid
+// function to broadcast the permutations, scalings and symbolic factorization
+// data from 2d to 3d grid
 
 void sbcastPermutedSparseA(SuperMatrix *A,
                           sScalePermstruct_t *ScalePermstruct,
@@ -290,44 +291,8 @@ void sbcastPermutedSparseA(SuperMatrix *A,
     }
 
 
-    /* ==== Broadcasting permuted sparse matrix ======= */
-    // Astore = (NRformat_loc *) A->Store;
-//     /typedef struct {
-//     int_t nnz_loc;   /* number of nonzeros in the local submatrix */
-//     int_t m_loc;     /* number of rows local to this processor */
-//     int_t fst_row;   /* global index of the first row */
-//     void  *nzval;    /* pointer to array of nonzero values, packed by row */
-//     int_t *rowptr;   /* pointer to array of beginning of rows in nzval[]
-// 			and colind[]  */
-//     int_t *colind;   /* pointer to array of column indices of the nonzeros */
-//                      /* Note:
-// 			Zero-based indexing is used;
-// 			rowptr[] has n_loc + 1 entries, the last one pointing
-// 			beyond the last row, so that rowptr[n_loc] = nnz_loc.*/
-// } NRformat_loc;
-
-
-    // NRformat_loc *Astore = (NRformat_loc *) A->Store;
-    MPI_Bcast(&(Astore->nnz_loc), sizeof(int_t), MPI_BYTE, 0, grid3d->zscp.comm);
-    MPI_Bcast(&(Astore->m_loc), sizeof(int_t), MPI_BYTE, 0, grid3d->zscp.comm);
-    MPI_Bcast(&(Astore->fst_row), sizeof(int_t), MPI_BYTE, 0, grid3d->zscp.comm);
-
-
-/***** YL: remove the allocation in the following as sGatherNRformat_loc3d_allgrid instead of sGatherNRformat_loc3d has been called, which already allocate A->Store on all grids
- * Note the the broadcast is still needed as the A->Store has been scaled by sscaleMatrixDiagonally only on grid 0
-*/
-#if 1
-    MPI_Bcast(Astore->nzval, Astore->nnz_loc*sizeof(float), MPI_BYTE, 0, grid3d->zscp.comm);
-    MPI_Bcast(Astore->rowptr, (Astore->m_loc+1)*sizeof(int_t), MPI_BYTE, 0, grid3d->zscp.comm);
-    MPI_Bcast(Astore->colind, Astore->nnz_loc*sizeof(int_t), MPI_BYTE, 0, grid3d->zscp.comm);
-#else
-    allocBcastArray( (void **) &(Astore->nzval), Astore->nnz_loc*sizeof(float),
-        0, grid3d->zscp.comm);
-    allocBcastArray( (void **) &(Astore->rowptr), (Astore->m_loc+1)*sizeof(int_t),
-        0, grid3d->zscp.comm);
-    allocBcastArray( (void **) &(Astore->colind), Astore->nnz_loc*sizeof(int_t),
-        0, grid3d->zscp.comm);
-#endif
+    /* The permuted sparse matrix is not broadcast: only layer 0 holds it,
+       every layer gets its part of A from the 3D grid by sScatter_A3d(). */
 
 }
 
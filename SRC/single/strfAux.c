@@ -586,7 +586,7 @@ strf3Dpartition_t* sinitTrf3DpartitionLUstructgrid0(int_t n, superlu_dist_option
         /*update treelist with weight and depth*/
         getSCUweight(nsupers, treeList, xsup,
             LUstruct->Llu->Lrowind_bc_ptr, LUstruct->Llu->Ufstnz_br_ptr,
-            grid3d);
+            grid3d, &LUstruct->costmodel);
         int_t * scuWeight = intCalloc_dist(nsupers);
         for (int_t k = 0; k < nsupers ; ++k)
         {
@@ -603,7 +603,7 @@ strf3Dpartition_t* sinitTrf3DpartitionLUstructgrid0(int_t n, superlu_dist_option
         }
         SUPERLU_FREE(scuWeight);
     }
-    calcTreeWeight(nsupers, setree, treeList, xsup);
+    calcTreeWeight(nsupers, setree, treeList, xsup, &LUstruct->costmodel);
 
     if (grid3d->zscp.Iam){
         SUPERLU_FREE(xsup);
@@ -789,9 +789,9 @@ strf3Dpartition_t* sinitTrf3Dpartition_allgrid(int_t n, superlu_dist_options_t *
     /*update treelist with weight and depth*/
     getSCUweight_allgrid(nsupers, treeList, xsup,
         LUstruct->Llu->Lrowind_bc_ptr, LUstruct->Llu->Ufstnz_br_ptr,
-        grid3d);
+        grid3d, &LUstruct->costmodel);
 
-    calcTreeWeight(nsupers, setree, treeList, xsup);
+    calcTreeWeight(nsupers, setree, treeList, xsup, &LUstruct->costmodel);
 
     gEtreeInfo_t gEtreeInfo;
     gEtreeInfo.setree = setree;
@@ -968,9 +968,9 @@ strf3Dpartition_t* sinitTrf3Dpartition(int_t nsupers,
     /*update treelist with weight and depth*/
     getSCUweight(nsupers, treeList, xsup,
 		  LUstruct->Llu->Lrowind_bc_ptr, LUstruct->Llu->Ufstnz_br_ptr,
-		  grid3d);
+		  grid3d, &LUstruct->costmodel);
 
-    calcTreeWeight(nsupers, setree, treeList, xsup);
+    calcTreeWeight(nsupers, setree, treeList, xsup, &LUstruct->costmodel);
 
     gEtreeInfo_t gEtreeInfo;
     gEtreeInfo.setree = setree;
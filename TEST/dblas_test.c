@@ -0,0 +1,147 @@
+/*! \file
+Copyright (c) 2003, The Regents of the University of California, through
+Lawrence Berkeley National Laboratory (subject to receipt of any required
+approvals from U.S. Dept. of Energy)
+
+All rights reserved.
+
+The source code is distributed under BSD license, see the file License.txt
+at the top-level directory.
+*/
+
+
+/*! @file
+ * \brief Test the blocked DGEMM and DTRSM kernels of the internal CBLAS.
+ *
+ * <pre>
+ * -- Distributed SuperLU routine (version 9.0) --
+ * Lawrence Berkeley National Lab, Univ. of California Berkeley.
+ *
+ * The problem sizes are above BLAS_GEMM_MIN_MNK and BLAS_TRSM_NB, and
+ * cross the DMC and DKC packing boundaries, so dgemm_ and dtrsm_ hand
+ * off to the blocked kernels.  The results are checked against plain
+ * triple loops.
+ * </pre>
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "blas_blocked.h"
+
+#define LDPAD 3
+
+static doublereal
+op_elem(int t, doublereal *a, integer lda, integer i, integer j)
+{
+    return t ? a[j + i*lda] : a[i + j*lda];
+}
+
+static void
+rand_fill(integer m, integer n, doublereal *a, integer lda)
+{
+    integer i, j;
+    for (j = 0; j < n; ++j)
+	for (i = 0; i < m; ++i) a[i + j*lda] = 2. * rand() / RAND_MAX - 1.;
+}
+
+/*! \brief Return max|C - (alpha*op(A)*op(B) + beta*C0)| for one dgemm_ call. */
+static doublereal
+check_gemm(char *ta, char *tb, integer m, integer n, integer k)
+{
+    int opa = (*ta != 'N'), opb = (*tb != 'N');
+    integer lda = (opa ? k : m) + LDPAD, ldb = (opb ? n : k) + LDPAD;
+    integer ldc = m + LDPAD, i, j, l;
+    doublereal alpha = 1.5, beta = -0.5, s, err = 0.;
+    doublereal *a = (doublereal *) SUPERLU_MALLOC(sizeof(doublereal) * lda * (opa ? m : k));
+    doublereal *b = (doublereal *) SUPERLU_MALLOC(sizeof(doublereal) * ldb * (opb ? k : n));
+    doublereal *c = (doublereal *) SUPERLU_MALLOC(sizeof(doublereal) * ldc * n);
+    doublereal *c0 = (doublereal *) SUPERLU_MALLOC(sizeof(doublereal) * ldc * n);
+
+    rand_fill(opa ? k : m, opa ? m : k, a, lda);
+    rand_fill(opb ? n : k, opb ? k : n, b, ldb);
+    rand_fill(m, n, c, ldc);
+    for (i = 0; i < ldc * n; ++i) c0[i] = c[i];
+
+    dgemm_(ta, tb, &m, &n, &k, &alpha, a, &lda, b, &ldb, &beta, c, &ldc);
+
+    for (j = 0; j < n; ++j)
+	for (i = 0; i < m; ++i) {
+	    s = 0.;
+	    for (l = 0; l < k; ++l)
+		s += op_elem(opa, a, lda, i, l) * op_elem(opb, b, ldb, l, j);
+	    s = alpha * s + beta * c0[i + j*ldc];
+	    err = max(err, fabs(c[i + j*ldc] - s));
+	}
+    SUPERLU_FREE(a); SUPERLU_FREE(b); SUPERLU_FREE(c); SUPERLU_FREE(c0);
+    return err;
+}
+
+/*! \brief Return max|op(A)*X - alpha*B| (or X*op(A)) for one dtrsm_ call. */
+static doublereal
+check_trsm(char *side, char *uplo, char *ta, char *diag, integer m, integer n)
+{
+    int lside = (*side == 'L'), upper = (*uplo == 'U');
+    int opa = (*ta != 'N'), unit = (*diag == 'U');
+    integer t = lside ? m : n, lda = t + LDPAD, ldb = m + LDPAD, i, j, l;
+    doublereal alpha = 0.75, s, aij, err = 0.;
+    doublereal *a = (doublereal *) SUPERLU_MALLOC(sizeof(doublereal) * lda * t);
+    doublereal *b = (doublereal *) SUPERLU_MALLOC(sizeof(doublereal) * ldb * n);
+    doublereal *b0 = (doublereal *) SUPERLU_MALLOC(sizeof(doublereal) * ldb * n);
+
+    /* Keep op(A) well conditioned: small off-diagonal, dominant diagonal. */
+    rand_fill(t, t, a, lda);
+    for (j = 0; j < t; ++j) {
+	for (i = 0; i < t; ++i) a[i + j*lda] /= t;
+	a[j + j*lda] = unit ? 99. : 2. + a[j + j*lda];
+    }
+    rand_fill(m, n, b, ldb);
+    for (i = 0; i < ldb * n; ++i) b0[i] = b[i];
+
+    dtrsm_(side, uplo, ta, diag, &m, &n, &alpha, a, &lda, b, &ldb);
+
+    for (j = 0; j < n; ++j)
+	for (i = 0; i < m; ++i) {
+	    s = 0.;
+	    for (l = 0; l < t; ++l) {
+		/* A(r,c) of the stored triangle, r,c in op(A) coordinates */
+		integer r = lside ? i : l, cc = lside ? l : j;
+		integer ar = opa ? cc : r, ac = opa ? r : cc;
+		if ( (upper && ar > ac) || (!upper && ar < ac) ) continue;
+		aij = (ar == ac && unit) ? 1. : a[ar + ac*lda];
+		s += aij * (lside ? b[l + j*ldb] : b[i + l*ldb]);
+	    }
+	    err = max(err, fabs(s - alpha * b0[i + j*ldb]));
+	}
+    SUPERLU_FREE(a); SUPERLU_FREE(b); SUPERLU_FREE(b0);
+    return err;
+}
+
+int main(int argc, char *argv[])
+{
+    char *tr[] = {"N", "T"}, *sd[] = {"L", "R"}, *ul[] = {"U", "L"};
+    char *dg[] = {"N", "U"};
+    int ia, ib, ic, id, nfail = 0;
+    doublereal err, tol = 1e-10;
+
+    for (ia = 0; ia < 2; ++ia)
+	for (ib = 0; ib < 2; ++ib) {
+	    err = check_gemm(tr[ia], tr[ib], 203, 37, 301);
+	    printf("DGEMM %s%s  m=203 n=37 k=301  err %8.2e  %s\n",
+		   tr[ia], tr[ib], err, err < tol ? "PASS" : "FAIL");
+	    nfail += (err >= tol);
+	}
+
+    for (ia = 0; ia < 2; ++ia)
+	for (ib = 0; ib < 2; ++ib)
+	    for (ic = 0; ic < 2; ++ic)
+		for (id = 0; id < 2; ++id) {
+		    err = check_trsm(sd[ia], ul[ib], tr[ic], dg[id], 157, 93);
+		    printf("DTRSM %s%s%s%s m=157 n=93  err %8.2e  %s\n",
+			   sd[ia], ul[ib], tr[ic], dg[id], err,
+			   err < tol ? "PASS" : "FAIL");
+		    nfail += (err >= tol);
+		}
+
+    printf("%d kernel checks failed\n", nfail);
+    return nfail != 0;
+}
@@ -139,7 +139,9 @@ int main(int argc, char *argv[])
     int     iseed[]  = {1988, 1989, 1990, 1991};
     char    equeds[]  = {'N', 'R', 'C', 'B'};
     DiagScale_t equils[] = {NOEQUIL, ROW, COL, BOTH};
-    fact_t  facts[] = {FACTORED, DOFACT, SamePattern, SamePattern_SameRowPerm};
+    fact_t  facts[] = {FACTORED, DOFACT, SamePattern, SamePattern_SameRowPerm,
+                       SamePattern};
+    int     subsets[] = {0, 0, 0, 0, 1}; /* keep {L,U} for the last one */
     trans_t transs[]  = {NOTRANS, TRANS, CONJ};
 
     nprow = 1;  /* Default process rows.      */
@@ -220,7 +222,7 @@ int main(int argc, char *argv[])
 
 	for (iequed = 0; iequed < 4; ++iequed) {
 	    int what_equil = equils[iequed];
-	    if (iequed == 0) nfact = 4;
+	    if (iequed == 0) nfact = 5;
 	    else { /* Only test factored, pre-equilibrated matrix */
 		nfact = 1;
 		options.RowPerm = NOROWPERM; /* Turn off MC64 */
@@ -230,6 +232,7 @@ int main(int argc, char *argv[])
 	    for (ifact = 0; ifact < nfact; ++ifact) {
 		fact = facts[ifact];
 		options.Fact = fact;
+		options.superlu_subset = subsets[ifact];
 		//if (!iam) printf("ifact loop ... %d\n", ifact);
 #ifdef SLU_HAVE_LAPACK
 	        for (diaginv = 0; diaginv < 2; ++diaginv) {
@@ -321,7 +324,7 @@ int main(int argc, char *argv[])
 
 		            /* Restore Fact option. */
 			    options.Fact = fact;
-			    if ( fact == SamePattern ) {
+			    if ( fact == SamePattern && !options.superlu_subset ) {
 			        // {L,U} not re-used in subsequent call to PDGSSVX.
 			        dDestroy_LU(n, &grid, &LUstruct);
 			    } else if (fact == SamePattern_SameRowPerm) {